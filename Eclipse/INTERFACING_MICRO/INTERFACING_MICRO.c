@@ -2,318 +2,734 @@
  * INTERFACING_MICRO.c
  *
  *  Created on: Dec 15, 2020
- *  Description: main  file for the MC1
+ *  Description: main  file for the MC2
+ *  			 the user interface is a task of the cooperative scheduler ,it
+ *  			 runs for every byte from MC1 (UART RX interrupt) ,every key
+ *  			 (keypad scanned by the system tick) and the end of a message
+ *  			 the screens are states of a table driven state machine (fsm.h)
+ *  			 ,their text is in flash (screens.h)
+ *  			 the progress of the gate states sent by MC1 is a bar of
+ *  			 custom characters under the gate screen
+ *  			 the micro is a node of the bus of MC1 (bus.h) ,its address is
+ *  			 set by jumpers
  *      Author: Ahmed Emad
  */
 
 
 #include "timers.h"
 #include "uart.h"
+#include "bus.h"
 #include "lcd.h"
+#include "screens.h"
 #include "keypad.h"
+#include "systick.h"
+#include "scheduler.h"
+#include "fsm.h"
+#include "system_states.h"
+#include "pin_editor.h"
+#include "power.h"
+#include "counters.h"
+#include <avr/pgmspace.h>
 
 /*******************************************************************************
  *                      Preprocessor Macros                                    *
  *******************************************************************************/
 
-/*Constant value between the 2 micros to indicate that
- *the micro ready to receive information from UART*/
+/*time between two scans of the keypad*/
+#define KEYPAD_SCAN_MS 10
 
-#define M_READY 0XFF
+/*time a message is displayed*/
+#define MESSAGE_TIME_MS 1000
 
-/*indicator if the function success or fails to do the task*/
-#define SUCCESS 1
-#define FAILURE 0
+/*a PIN entry without any key for this time is cleared*/
+#define PIN_IDLE_TIME_MS 10000
 
-#define CORRECT_PASSWORD 0XCC
-#define WRONG_PASSWORD   0XBB
+/*no event for this time while waiting for a key powers down the micro*/
+#define POWER_IDLE_TIME_MS 30000
+
+/*no answer of MC1 to M_READY for this time ,the state is asked again*/
+#define ANSWER_TIME_MS 2000
+
+/*LCD position of the time left of a lock out (mm:ss)*/
+#define LOCKOUT_ROW    1
+#define LOCKOUT_COLUMN 8
+
+/*LCD position of the first digit of a PIN*/
+#define PIN_ROW    1
+#define PIN_COLUMN 0
+
+/*LCD row of the progress bar of the gate states*/
+#define GATE_BAR_ROW 1
+
+/*a step of the progress sent by MC1 is a column of the bar*/
+#if (GATE_PROGRESS_STEPS != LCD_BAR_STEPS)
+#error "the progress steps of the gate must be the steps of the LCD bar"
+#endif
+
+/*the link must be within the error the UART tolerates at this F_CPU*/
+#if (UART_BAUD_ERROR(LINK_BAUD) > UART_BAUD_ERROR_MAX)
+#error "LINK_BAUD is too far from the baud rates of the UART at this F_CPU"
+#endif
+
+/*address jumpers to ground (pull ups) ,the node address is 1 + the jumpers
+ * closed : PB0 (1) ,PB1 (2) ,PB3 (4)*/
+#define NODE_ADDRESS_PORT     PORTB
+#define NODE_ADDRESS_PORT_DIR DDRB
+#define NODE_ADDRESS_PORT_IN  PINB
+#define NODE_ADDRESS_PINS     ((1<<PB0) | (1<<PB1) | (1<<PB3))
+/*time for the pull ups (20K at least) to charge an open jumper and its wire*/
+#define NODE_ADDRESS_SETTLE_US 10
 
 /*******************************************************************************
  *                         Types Declaration                                   *
  *******************************************************************************/
-/* declaring  the states of the system*/
+
+/*events posted to the user interface task*/
 typedef enum {
-	NEW_PASSWORD,CHECK_PASSWORD_TO_LOG_IN,CHECK_PASSWORD_FOR_NEW_PASSWORD,VIEW_OPTIONS,OPENING_GATE,BUZZER_ON
-}SystemState;
+	EV_UART_RX,EV_KEY,EV_MESSAGE_TIMEOUT,EV_PIN_TIMEOUT,EV_SECOND,EV_POWER_IDLE,
+	EV_WAKE_UP,EV_ANSWER_TIMEOUT
+}UiEvent;
 
-/*Options the user can choose from*/
-typedef enum{
-	OPEN_GATE_OPTION,CREATE_NEW_PASSWORD
-}Options;
+/*screens of the user interface (states of the state machine)*/
+typedef enum {
+	UI_WAIT_STATE,UI_ENTER_NEW_PASSWORD,UI_CONFIRM_PASSWORD,UI_ENTER_PASSWORD,
+	UI_WAIT_MC1,UI_WAIT_RESULT,UI_OPTIONS,UI_GATE,UI_MESSAGE,UI_LOCKOUT,UI_STATES_NUM
+}UiState;
 
-/*ENUM to hold gate state*/
+/*events of the user interface state machine*/
 typedef enum {
-	CLOSED,GATE_OPENING,OPENED,GATE_CLOSING
-}GateStatus;
+	UI_EV_BYTE,UI_EV_MC1_READY,UI_EV_KEY,UI_EV_MESSAGE_END,
+	UI_EV_NEW_PASSWORD,UI_EV_PASSWORD,UI_EV_OPTIONS,UI_EV_GATE,
+	UI_EV_ALARM,UI_EV_DONE,UI_EV_FAIL,UI_EV_WAIT_RESULT,UI_EV_PIN_TIMEOUT,
+	UI_EV_SECOND,UI_EV_IDLE,UI_EV_RESYNC,UI_EVENTS_NUM
+}UiFsmEvent;
 
 /*******************************************************************************
- *                           Global Variables                                  *
+ *                      Functions Prototypes                                   *
  *******************************************************************************/
-/*global variable to hold the system state*/
-static uint8 g_systemState;
 
+/*Description : the user interface task*/
+static void uiTask(uint8 event,uint8 data);
+
+/*Description : transition actions (return FSM_NO_EVENT or the next event)*/
+static uint8 uiStateReceived(uint8 data);
+static uint8 uiLockoutByte(uint8 data);
+static uint8 uiLockoutSecond(uint8 data);
+static uint8 uiMc1Ready(uint8 data);
+static uint8 uiPasswordKey(uint8 data);
+static uint8 uiKeepNewPassword(uint8 data);
+static uint8 uiConfirmKey(uint8 data);
+static uint8 uiShowMismatch(uint8 data);
+static uint8 uiSavePassword(uint8 data);
+static uint8 uiReadyToSend(uint8 data);
+static uint8 uiSend(uint8 data);
+static uint8 uiResult(uint8 data);
+static uint8 uiShowWrong(uint8 data);
+static uint8 uiOptionKey(uint8 data);
+static uint8 uiGateStatus(uint8 data);
+static uint8 uiMessageEnd(uint8 data);
+static uint8 uiPinTimeout(uint8 data);
+static uint8 uiPowerDown(uint8 data);
+
+/*Description : entry actions of the screens*/
+static void uiRequestState(void);
+static void uiNewPasswordEntry(void);
+static void uiConfirmEntry(void);
+static void uiPasswordEntry(void);
+static void uiWaitResultEntry(void);
+static void uiAnswerExit(void);
+static void uiOptionsEntry(void);
+static void uiGateEntry(void);
+static void uiMessageEntry(void);
+static void uiMessageExit(void);
+static void uiPinExit(void);
+static void uiLockoutEntry(void);
+static void uiLockoutExit(void);
+
+/*Description : display the time left of the lock out*/
+static void uiShowLockout(void);
+
+/*Description : send a byte to MC1*/
+static void uiSendByte(uint8 data);
+
+/*Description : node address of the jumpers*/
+static uint8 uiNodeAddress(void);
+
+/*ISR call back functions posting the events to the task */
+void busReceived(uint8 node,uint8 data);
+void keypadScan(void);
+void messageTimeout(void);
+void pinTimeout(void);
+void answerTimeout(void);
+void lockoutSecond(void);
+void powerIdle(void);
+void powerWakeUp(void);
 
 /*******************************************************************************
- *                      Functions Prototypes                                   *
+ *                      State Machine Tables (flash)                           *
  *******************************************************************************/
-/*
- * Description : Function to get the password from user from keypad
- * 	[in]. string to hold the password
- */
 
-void getPassword (uint8 * a_password_Ptr);
+/*transitions of the screens [UiState][UiFsmEvent]*/
+static const FsmTransition g_uiTransitions[UI_STATES_NUM][UI_EVENTS_NUM] PROGMEM = {
+		/*UI_WAIT_STATE ,asked again without answer*/
+		{{FSM_NO_CHANGE,uiStateReceived},FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 {UI_ENTER_NEW_PASSWORD,NULL_PTR},{UI_ENTER_PASSWORD,NULL_PTR},{UI_OPTIONS,NULL_PTR},{UI_GATE,NULL_PTR},
+		 {UI_LOCKOUT,NULL_PTR},FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 {UI_WAIT_STATE,NULL_PTR}},
+		/*UI_ENTER_NEW_PASSWORD*/
+		{FSM_IGNORE,{FSM_NO_CHANGE,uiMc1Ready},{FSM_NO_CHANGE,uiPasswordKey},FSM_IGNORE,
+		 FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,{UI_CONFIRM_PASSWORD,uiKeepNewPassword},FSM_IGNORE,FSM_IGNORE,{FSM_NO_CHANGE,uiPinTimeout},FSM_IGNORE,{FSM_NO_CHANGE,uiPowerDown},
+		 {UI_WAIT_STATE,NULL_PTR}},
+		/*UI_CONFIRM_PASSWORD*/
+		{FSM_IGNORE,{FSM_NO_CHANGE,uiMc1Ready},{FSM_NO_CHANGE,uiConfirmKey},FSM_IGNORE,
+		 FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,{UI_WAIT_MC1,uiSavePassword},{UI_MESSAGE,uiShowMismatch},FSM_IGNORE,{UI_ENTER_NEW_PASSWORD,NULL_PTR},FSM_IGNORE,{FSM_NO_CHANGE,uiPowerDown},
+		 {UI_WAIT_STATE,NULL_PTR}},
+		/*UI_ENTER_PASSWORD*/
+		{FSM_IGNORE,{FSM_NO_CHANGE,uiMc1Ready},{FSM_NO_CHANGE,uiPasswordKey},FSM_IGNORE,
+		 FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,{UI_WAIT_MC1,uiReadyToSend},FSM_IGNORE,FSM_IGNORE,{FSM_NO_CHANGE,uiPinTimeout},FSM_IGNORE,{FSM_NO_CHANGE,uiPowerDown},
+		 {UI_WAIT_STATE,NULL_PTR}},
+		/*UI_WAIT_MC1*/
+		{FSM_IGNORE,{FSM_NO_CHANGE,uiSend},FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,{UI_WAIT_STATE,NULL_PTR},FSM_IGNORE,{UI_WAIT_RESULT,NULL_PTR},FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 {UI_WAIT_STATE,NULL_PTR}},
+		/*UI_WAIT_RESULT*/
+		{{FSM_NO_CHANGE,uiResult},FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,{UI_WAIT_STATE,NULL_PTR},{UI_MESSAGE,uiShowWrong},FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 {UI_WAIT_STATE,NULL_PTR}},
+		/*UI_OPTIONS*/
+		{FSM_IGNORE,{FSM_NO_CHANGE,uiMc1Ready},{FSM_NO_CHANGE,uiOptionKey},FSM_IGNORE,
+		 FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,{UI_WAIT_MC1,uiReadyToSend},FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,{FSM_NO_CHANGE,uiPowerDown},
+		 {UI_WAIT_STATE,NULL_PTR}},
+		/*UI_GATE ,MC1 leads the sequence*/
+		{{FSM_NO_CHANGE,uiGateStatus},FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,{UI_WAIT_STATE,NULL_PTR},{UI_MESSAGE,NULL_PTR},FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE},
+		/*UI_MESSAGE*/
+		{FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,{FSM_NO_CHANGE,uiMessageEnd},
+		 {UI_ENTER_NEW_PASSWORD,NULL_PTR},FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,{UI_WAIT_STATE,NULL_PTR},FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 {UI_WAIT_STATE,NULL_PTR}},
+		/*UI_LOCKOUT ,MC1 answers at the end of its lock out*/
+		{{FSM_NO_CHANGE,uiLockoutByte},FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,{UI_WAIT_STATE,NULL_PTR},FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,{FSM_NO_CHANGE,uiLockoutSecond},FSM_IGNORE,
+		 FSM_IGNORE}
+};
+
+/*entry and exit actions of the screens*/
+static const FsmStateActions g_uiStateActions[UI_STATES_NUM] PROGMEM = {
+		{uiRequestState,uiAnswerExit}, /*UI_WAIT_STATE*/
+		{uiNewPasswordEntry,uiPinExit},/*UI_ENTER_NEW_PASSWORD*/
+		{uiConfirmEntry,uiPinExit},    /*UI_CONFIRM_PASSWORD*/
+		{uiPasswordEntry,uiPinExit},   /*UI_ENTER_PASSWORD*/
+		{NULL_PTR,NULL_PTR},           /*UI_WAIT_MC1*/
+		{uiWaitResultEntry,uiAnswerExit},/*UI_WAIT_RESULT*/
+		{uiOptionsEntry,NULL_PTR},     /*UI_OPTIONS*/
+		{uiGateEntry,NULL_PTR},        /*UI_GATE*/
+		{uiMessageEntry,uiMessageExit},/*UI_MESSAGE*/
+		{uiLockoutEntry,uiLockoutExit} /*UI_LOCKOUT*/
+};
+
+/*event of the system state received from MC1 [SystemState]*/
+static const uint8 g_stateEvents[SYSTEM_STATES_NUM] PROGMEM = {
+		UI_EV_NEW_PASSWORD,UI_EV_PASSWORD,UI_EV_PASSWORD,UI_EV_OPTIONS,UI_EV_GATE,UI_EV_ALARM
+};
 
-/*
- *  Description : Function to do the process of getting password
- * 	1. enter a password
- * 	2. re-enter the password to confirm it
- * 	3. check that are same
- * 	4. if they matched then send the password to micro1 to store it
- * 	   else repeat the process
- * 	function return flag indicating if process was success or not
- */
-static uint8 createNewPassword(void);
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+/*state machine of the screens*/
+static FsmType g_uiFsm = {&g_uiTransitions[0][0],g_uiStateActions,UI_EVENTS_NUM,UI_WAIT_STATE};
 
-/*
- *  Description : Function to view Options and  get option from user and send it to micro 1
- */
-inline static void  viewOptions(void);
+/*address of this micro on the bus*/
+static uint8 g_nodeAddress;
+
+/*global variable to hold the system state*/
+static uint8 g_systemState;
+
+/*MC1 sent M_READY and waits for the password or the option*/
+static uint8 g_mc1Ready = FALSE;
 
-/*Description : Function to  get the status of the gate and display it on LCD*/
-inline static void gateOpeningStatus(void);
+/*the password entered (or the option) ,the first entry of a new password
+ * and their number of digits*/
+static uint8 g_password[PASSWORD_MAX_LENGTH];
+static uint8 g_newPassword[PASSWORD_MAX_LENGTH];
+static uint8 g_passCounter;
+static uint8 g_newPassCounter;
 
-/*function to get the password from the user
- * and send it to MICRO2 to check it    */
-inline static void getAndSendPassword(void);
+/*event dispatched when the message time finishes*/
+static uint8 g_messageNext;
+
+/*seconds left of the lock out and number of its bytes received*/
+static uint16 g_lockoutSeconds;
+static uint8 g_lockoutBytes;
 
 
 int main(){
 
-	/*Initialize the LCD*/
-	LCD_init();
+	/*fast boot : the link with MC1 is started first ,MC1 reads its EEPROM
+	 * while the LCD finishes its power on reset and the state received in
+	 * the mean time waits in the queue of the task*/
 
-	/*defining variable to hold the the configuration of  UART*/
-	UartConfigType s_uartConfig ={9600,ASYNCHRONOUS_DOUBLE_SPEED_MODE,8,1,NO_PARITY,0,0,0 };
-	/*initialize and configure the UART driver*/
+	/*defining variable to hold the the configuration of  UART with receive interrupt*/
+	UartConfigType s_uartConfig ={LINK_BAUD,UART_OPERATING_MODE(LINK_BAUD),9,1,NO_PARITY,1,0,0 };
+	/*initialize and configure the UART driver ,only the bytes of this
+	 * node interrupt the micro*/
 	UART_init(&s_uartConfig);
+	g_nodeAddress = uiNodeAddress();
+	BUS_init(g_nodeAddress);
+	BUS_setCallBack(busReceived);
 
+	/*fill the task table*/
+	SCHEDULER_init();
+	SCHEDULER_addTask(UI_TASK,uiTask);
 
+	/*start the system tick and scan the keypad periodically*/
+	SYSTICK_init();
+	SYSTICK_startTimer(KEYPAD_TIMER,SYSTICK_MS_TO_TICKS(KEYPAD_SCAN_MS),TRUE,keypadScan);
 
-	while(1){
-
-		/*inform MC1 that micro ready to receive the system state*/
-		UART_sendByte(M_READY);
-
-		/*getting the system state*/
-		g_systemState = UART_recieveByte();
-
-
-		switch (g_systemState) {
-			case NEW_PASSWORD:
-				/*loop until the user enters a correct matched passwords*/
-				while( createNewPassword() != SUCCESS){
-					createNewPassword();
-				}
-				break;
-			case CHECK_PASSWORD_FOR_NEW_PASSWORD :
-			case CHECK_PASSWORD_TO_LOG_IN:
-				getAndSendPassword();
-				break;
-			case VIEW_OPTIONS :
-				viewOptions();
-				break;
-			case OPENING_GATE :
-				gateOpeningStatus();
-				break;
-			case BUZZER_ON:
-				LCD_clearScreen();
-				LCD_displayString("thief!!!");
-				break;
-		}
-	}
+	/* Enable Global Interrupt I-Bit */
+	SREG |= (1<<7);
+
+	/*inform MC1 that micro ready to receive the system state*/
+	FSM_start(&g_uiFsm,UI_WAIT_STATE);
 
+	/*Initialize the LCD (before the first screen ,the tasks run after it)*/
+	LCD_init();
+
+	/*not needed before the first screen : switch off the unused peripherals
+	 * ,a key wakes up from power down*/
+	POWER_init();
+	POWER_setCallBack(powerWakeUp);
 
+	/*run the task for ever*/
+	SCHEDULER_run();
 }
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
  *******************************************************************************/
 
+static void uiTask(uint8 event,uint8 data){
 
+	/*any other event is an activity ,the idle time starts again*/
+	if(event!=EV_POWER_IDLE){
+		SYSTICK_startTimer(POWER_TIMER,SYSTICK_MS_TO_TICKS(POWER_IDLE_TIME_MS),FALSE,powerIdle);
+	}
 
-/*
- * Description : Function to get the password from user from keypad
- * 	[in]. string to hold the password
- */
-void getPassword (uint8 * a_password_Ptr){
+	switch (event) {
+		case EV_UART_RX:
+			if(data==M_READY){
+				FSM_dispatch(&g_uiFsm,UI_EV_MC1_READY,data);
+			}else if(data==STATE_CHANGED){
+				FSM_dispatch(&g_uiFsm,UI_EV_RESYNC,data);
+			}else{
+				FSM_dispatch(&g_uiFsm,UI_EV_BYTE,data);
+			}
+			break;
+		case EV_KEY:
+			FSM_dispatch(&g_uiFsm,UI_EV_KEY,data);
+			break;
+		case EV_MESSAGE_TIMEOUT:
+			FSM_dispatch(&g_uiFsm,UI_EV_MESSAGE_END,0);
+			break;
+		case EV_PIN_TIMEOUT:
+			FSM_dispatch(&g_uiFsm,UI_EV_PIN_TIMEOUT,0);
+			break;
+		case EV_SECOND:
+			FSM_dispatch(&g_uiFsm,UI_EV_SECOND,0);
+			break;
+		case EV_POWER_IDLE:
+			FSM_dispatch(&g_uiFsm,UI_EV_IDLE,0);
+			break;
+		case EV_ANSWER_TIMEOUT:
+			FSM_dispatch(&g_uiFsm,UI_EV_RESYNC,0);
+			break;
+		case EV_WAKE_UP:
+			/*the key is given by the next scans of the keypad*/
+			break;
+	}
+}
 
-	/*counter for current letter*/
-	uint8 passCounter = 0;
-	/*input letter from the user*/
-	uint8 inputLetter;
+/*Description : getting the system state ,go to its screen*/
+static uint8 uiStateReceived(uint8 data){
 
-	/*loop to get the six letters*/
-	for (passCounter = 0; passCounter <= 6;) {
+	/*the progress of the closing gate ,MC1 sends the state once it is closed*/
+	if(GATE_IS_PROGRESS(data)){
+		LCD_barUpdate(data - GATE_PROGRESS_FRAME);
+		return FSM_NO_EVENT;
+	}
+	/*the result of a password whose confirmation was lost ,MC1 now waits
+	 * for M_READY*/
+	if(data==CORRECT_PASSWORD || data==WRONG_PASSWORD){
+		return UI_EV_RESYNC;
+	}
+	if(data >= SYSTEM_STATES_NUM){
+		return FSM_NO_EVENT;
+	}
+	g_systemState = data;
+	return pgm_read_byte(&g_stateEvents[data]);
+}
 
-		inputLetter = KeyPad_getPressedKey();
+/*Description : the 2 bytes of the lock out time after the alarm state ,the
+ * time is counted down here then the state is asked again (MC1 answers when
+ * its own lock out finishes)*/
+static uint8 uiLockoutByte(uint8 data){
 
-		/*if the user  inputs the 6 letters and then enter  then return
-		 *13 is ASCI of enter key else continue loop until hits enter button */
-		if(passCounter==6){
-			if(inputLetter ==13){
-				/*terminate the string with null*/
-				a_password_Ptr[passCounter]='\0';
-				return;
-			}
-		}else{
-			/*store the input letter */
-			a_password_Ptr[passCounter]=inputLetter;
-			++passCounter;
-			LCD_displayCharacter('*');
-		}
+	if(g_lockoutBytes==0){
+		g_lockoutSeconds = (uint16)data << LOCKOUT_BYTE_BITS;
+		g_lockoutBytes = 1;
+		return FSM_NO_EVENT;
+	}
+	if(g_lockoutBytes==1){
+		g_lockoutSeconds |= data;
+		g_lockoutBytes = 2;
+		uiShowLockout();
+		SYSTICK_startTimer(LOCKOUT_TIMER,SYSTICK_MS_TO_TICKS(1000),TRUE,lockoutSecond);
+		return (g_lockoutSeconds==0) ? UI_EV_DONE : FSM_NO_EVENT;
+	}
+	return FSM_NO_EVENT;
+}
 
+static uint8 uiLockoutSecond(uint8 data){
+
+	if(g_lockoutSeconds!=0){
+		g_lockoutSeconds--;
 	}
+	uiShowLockout();
+	return (g_lockoutSeconds==0) ? UI_EV_DONE : FSM_NO_EVENT;
+}
 
+/*Description : MC1 is ready to receive the password or the option*/
+static uint8 uiMc1Ready(uint8 data){
+	g_mc1Ready = TRUE;
+	return FSM_NO_EVENT;
 }
 
 /*
- *  Description : Function to do the process of getting password
- * 	1. enter a password
- * 	2. re-enter the password to confirm it
- * 	3. check that are same
- * 	4. if they matched then send the password to micro1 to store it
- * 	   else repeat the process
+ * Description : give the key to the PIN editor
+ * 	return UI_EV_DONE when a PIN of an allowed length then enter are entered
  */
-static uint8 createNewPassword(void){
+static uint8 uiPasswordKey(uint8 data){
 
-	/*defining two strings to store the user input*/
-	uint8 password[7];
-	uint8 confirmPassword[7];
+	/*the idle time starts again with every key*/
+	SYSTICK_startTimer(PIN_TIMER,SYSTICK_MS_TO_TICKS(PIN_IDLE_TIME_MS),FALSE,pinTimeout);
 
-	LCD_clearScreen();
-	LCD_displayString("EnterNewPASSWORD");
-	LCD_goToRowColumn(1, 0);
+	if(!PIN_EDITOR_key(data)){
+		return FSM_NO_EVENT;
+	}
+	g_passCounter = PIN_EDITOR_getPin(g_password);
+	return UI_EV_DONE;
+}
 
-	/*get  password */
-	getPassword(password);
+static uint8 uiKeepNewPassword(uint8 data){
 
-	LCD_clearScreen();
-	LCD_displayString("CONFIRM PASSWORD");
-	LCD_goToRowColumn(1, 0);
+	for (int var = 0; var < g_passCounter; ++var) {
+		g_newPassword[var] = g_password[var];
+	}
+	g_newPassCounter = g_passCounter;
+	return FSM_NO_EVENT;
+}
 
+/*Description : confirming the new password ,return UI_EV_DONE if the
+ * 2 passwords are matched or UI_EV_FAIL*/
+static uint8 uiConfirmKey(uint8 data){
 
-	/*get  password */
-	getPassword(confirmPassword);
+	if(uiPasswordKey(data)!=UI_EV_DONE){
+		return FSM_NO_EVENT;
+	}
 
 	/*checking for match*/
-	for (int var = 0; var < 6; ++var) {
+	if(g_passCounter != g_newPassCounter){
+		return UI_EV_FAIL;
+	}
+	for (int var = 0; var < g_passCounter; ++var) {
+		if(g_newPassword[var] != g_password[var]){
+			return UI_EV_FAIL;
+		}
+	}
+	return UI_EV_DONE;
+}
+
+/*Description : case passwords  not matched ,repeat the process after the message*/
+static uint8 uiShowMismatch(uint8 data){
+	SCREENS_show(SCREEN_MISMATCH);
+	g_messageNext = UI_EV_NEW_PASSWORD;
+	return FSM_NO_EVENT;
+}
 
-		if(password[var] != confirmPassword[var]){
-			/*case passwords  not matched */
-			LCD_clearScreen();
-			LCD_displayString("PASSWORDS NOT");
-			LCD_goToRowColumn(1, 0);
-			LCD_displayString("MATCHED!tryAgain");
-			_delay_ms(1000);
-			return FAILURE;
+/*Description : case of matching passwords ,send it to MC1 to save it*/
+static uint8 uiSavePassword(uint8 data){
+	SCREENS_show(SCREEN_SAVING_PASSWORD);
+	return uiReadyToSend(data);
+}
 
-		}
+/*Description : send the password (or the option) as soon as MC1 is ready*/
+static uint8 uiReadyToSend(uint8 data){
+	/*MC1 sends M_READY just after the system state so it is
+	 * normally received while the user is entering*/
+	return g_mc1Ready ? UI_EV_MC1_READY : FSM_NO_EVENT;
+}
+
+static uint8 uiSend(uint8 data){
+
+	if(g_systemState==VIEW_OPTIONS){
+		uiSendByte(g_password[0]);
+		return UI_EV_DONE;
 	}
 
-	/*case of matching passwords*/
-	LCD_clearScreen();
-	LCD_displayString("SAVING PASSWORD");
+	/*the digits are key values so 0 is a digit ,not the end of a string*/
+	for (int var = 0; var < g_passCounter; ++var) {
+		uiSendByte(g_password[var]);
+	}
+	uiSendByte('#');
+	/*wait until micro check if it is right (or saved the new password) and
+	 * send the result*/
+	return UI_EV_WAIT_RESULT;
+}
+
+/*Description : the result of the password ,any other byte is not the
+ * answer (the state is asked again after ANSWER_TIME_MS)*/
+static uint8 uiResult(uint8 data){
 
-	/*sending password to MC1 to save it as soon as MC1 is ready  */
-	while(UART_recieveByte()!=M_READY);
-	UART_sendString(password);
-	LCD_clearScreen();
-	LCD_displayString("PASSWORD SAVED");
-	return SUCCESS;
+	if(data==WRONG_PASSWORD){
+		return UI_EV_FAIL;
+	}
+	if(data!=CORRECT_PASSWORD){
+		return FSM_NO_EVENT;
+	}
+	if(g_systemState==NEW_PASSWORD){
+		SCREENS_show(SCREEN_PASSWORD_SAVED);
+	}
+	return UI_EV_DONE;
 }
 
-/*
- *  Description : Function to get option from user and send it to micro 1
- */
-inline static void  viewOptions(void){
+static uint8 uiShowWrong(uint8 data){
+	SCREENS_show(SCREEN_WRONG_PASSWORD);
+	g_messageNext = UI_EV_DONE;
+	return FSM_NO_EVENT;
+}
 
-	/*hold option from user*/
-	uint8 option;
+/*Description : send the option to micro1*/
+static uint8 uiOptionKey(uint8 data){
 
-	/*view Options on the screen*/
-	LCD_clearScreen();
-	LCD_displayString("0-->OPEN GATE");
-	LCD_goToRowColumn(1, 0);
-	LCD_displayString("1-->NEW PASSWORD");
+	if(data!=OPEN_GATE_OPTION && data!=CREATE_NEW_PASSWORD){
+		return FSM_NO_EVENT;
+	}
+	g_password[0] = data;
+	return UI_EV_DONE;
+}
 
-	/*wait until user enter the option*/
-	do {
-		option=KeyPad_getPressedKey();
-	} while (option!=OPEN_GATE_OPTION&&option!=CREATE_NEW_PASSWORD);
+/*Description : display the gate state received with an empty progress bar
+ * ,or the progress of the gate state*/
+static uint8 uiGateStatus(uint8 data){
 
-	/*send the option to micro1*/
-	while(UART_recieveByte()!=M_READY);
-	UART_sendByte(option);
+	if(GATE_IS_PROGRESS(data)){
+		LCD_barUpdate(data - GATE_PROGRESS_FRAME);
+		return FSM_NO_EVENT;
+	}
+	switch (data) {
+		case GATE_OPENING:
+			SCREENS_show(SCREEN_UNLOCKING);
+			LCD_barStart(GATE_BAR_ROW);
+			break;
+		case OPENED:
+			SCREENS_show(SCREEN_GATE_OPEN);
+			LCD_barStart(GATE_BAR_ROW);
+			break;
+		case GATE_CLOSING:
+			SCREENS_show(SCREEN_LOCKING);
+			LCD_barStart(GATE_BAR_ROW);
+			break;
+		case GATE_OBSTRUCTED:
+			SCREENS_show(SCREEN_GATE_OBSTRUCTED);
+			LCD_barStart(GATE_BAR_ROW);
+			break;
+		case GATE_BLOCKED:
+			/*the gate did not close ,the next state is sent after the message*/
+			SCREENS_show(SCREEN_GATE_BLOCKED);
+			g_messageNext = UI_EV_DONE;
+			return UI_EV_FAIL;
+		default:
+			/*CLOSED ,the next state is sent now*/
+			return UI_EV_DONE;
+	}
+	/*inform MC1 that micro ready to receive the gate state*/
+	uiSendByte(M_READY);
+	return FSM_NO_EVENT;
 }
 
-/*function to get the password from the user
- * and send it to MICRO2 to check it    */
-inline static void getAndSendPassword(void){
+static uint8 uiMessageEnd(uint8 data){
+	return g_messageNext;
+}
 
-	/*to hold user input*/
-	uint8 userPassword[7];
+/*Description : no key for PIN_IDLE_TIME_MS ,forget the digits entered*/
+static uint8 uiPinTimeout(uint8 data){
+	PIN_EDITOR_clear();
+	return FSM_NO_EVENT;
+}
+
+/*Description : nothing happened for POWER_IDLE_TIME_MS while waiting for a
+ * key ,power down if MC1 is waiting too (no byte can come)*/
+static uint8 uiPowerDown(uint8 data){
+	if(g_mc1Ready){
+		POWER_down();
+	}
+	return FSM_NO_EVENT;
+}
+
+/*Description : inform MC1 that micro ready to receive the system state ,it
+ * is asked again if MC1 does not answer*/
+static void uiRequestState(void){
+	g_mc1Ready = FALSE;
+	uiSendByte(M_READY);
+	SYSTICK_startTimer(ANSWER_TIMER,SYSTICK_MS_TO_TICKS(ANSWER_TIME_MS),FALSE,answerTimeout);
+}
+
+static void uiNewPasswordEntry(void){
+	SCREENS_show(SCREEN_NEW_PASSWORD);
+	PIN_EDITOR_start(PIN_ROW,PIN_COLUMN);
+}
 
+static void uiConfirmEntry(void){
+	SCREENS_show(SCREEN_CONFIRM_PASSWORD);
+	PIN_EDITOR_start(PIN_ROW,PIN_COLUMN);
+}
+
+static void uiPasswordEntry(void){
 	/*asks user for password*/
-	LCD_clearScreen();
-	LCD_displayString("ENTER PASSWORD");
-	LCD_goToRowColumn(1, 0);
+	SCREENS_show(SCREEN_ENTER_PASSWORD);
+	PIN_EDITOR_start(PIN_ROW,PIN_COLUMN);
+}
 
-	/*get the password entered*/
-	getPassword(userPassword);
+static void uiWaitResultEntry(void){
+	uiSendByte(M_READY);
+	SYSTICK_startTimer(ANSWER_TIMER,SYSTICK_MS_TO_TICKS(ANSWER_TIME_MS),FALSE,answerTimeout);
+}
 
-	/*sending password to MC1 to check it as soon as MC1 is ready  */
-	while(UART_recieveByte()!=M_READY);
-	UART_sendString(userPassword);
+static void uiAnswerExit(void){
+	SYSTICK_stopTimer(ANSWER_TIMER);
+}
 
+static void uiOptionsEntry(void){
+	/*view Options on the screen*/
+	SCREENS_show(SCREEN_OPTIONS);
+}
 
-	/*wait until micro check if it is right and send the result*/
-	UART_sendByte(M_READY);
-	if(UART_recieveByte() == WRONG_PASSWORD){
-		LCD_clearScreen();
-		LCD_displayString("WRONG PASSWORD!!");
-		_delay_ms(1000);
-	}
+static void uiGateEntry(void){
+	/*inform MC1 that micro ready to receive the gate state*/
+	uiSendByte(M_READY);
 }
 
+static void uiMessageEntry(void){
+	SYSTICK_startTimer(MESSAGE_TIMER,SYSTICK_MS_TO_TICKS(MESSAGE_TIME_MS),FALSE,messageTimeout);
+}
 
-/*Description : Function to  get the status of the gate and display it on LCD*/
-inline static void gateOpeningStatus(void){
+static void uiMessageExit(void){
+	SYSTICK_stopTimer(MESSAGE_TIMER);
+}
 
-	/*inform MC1 that micro ready to receive the system state*/
-	UART_sendByte(M_READY);
-	/*getting the gate state*/
-	UART_recieveByte();
+static void uiPinExit(void){
+	SYSTICK_stopTimer(PIN_TIMER);
+}
 
-	LCD_clearScreen();
-	LCD_displayString("UNLOCKING");
+static void uiLockoutEntry(void){
+	SCREENS_show(SCREEN_LOCKED);
+	g_lockoutBytes = 0;
+}
 
-	/*inform MC1 that micro ready to receive the system state*/
-	UART_sendByte(M_READY);
-	/*getting the gate state*/
-	UART_recieveByte();
+static void uiLockoutExit(void){
+	SYSTICK_stopTimer(LOCKOUT_TIMER);
+}
 
-	LCD_clearScreen();
-	LCD_displayString("GATE OPEN");
+static void uiShowLockout(void){
 
-	/*inform MC1 that micro ready to receive the system state*/
-	UART_sendByte(M_READY);
-	/*getting the gate state*/
-	UART_recieveByte();
+	uint8 minutes = (uint8)(g_lockoutSeconds / 60);
+	uint8 seconds = (uint8)(g_lockoutSeconds % 60);
 
-	LCD_clearScreen();
-	LCD_displayString("LOCKING");
+	LCD_goToRowColumn(LOCKOUT_ROW,LOCKOUT_COLUMN);
+	LCD_printf_P(PSTR("%02u:%02u"),minutes,seconds);
+}
 
+static void uiSendByte(uint8 data){
+	BUS_sendByte(g_nodeAddress,data);
 }
 
+static uint8 uiNodeAddress(void){
 
+	uint8 jumpers;
 
+	/*inputs with pull ups ,a closed jumper reads low*/
+	NODE_ADDRESS_PORT_DIR &= ~NODE_ADDRESS_PINS;
+	NODE_ADDRESS_PORT |= NODE_ADDRESS_PINS;
+	/*the pull ups charge the pins (the outputs were low) and PINB is
+	 * latched by the input synchronizer one cycle late*/
+	_delay_us(NODE_ADDRESS_SETTLE_US);
+	jumpers = ~HAL_READ(NODE_ADDRESS_PORT_IN) & NODE_ADDRESS_PINS;
+
+	/*then outputs low ,no current in the pull up of a closed jumper*/
+	NODE_ADDRESS_PORT &= ~NODE_ADDRESS_PINS;
+	NODE_ADDRESS_PORT_DIR |= NODE_ADDRESS_PINS;
+
+	return 1 + ((jumpers & (1<<PB0)) ? 1 : 0) + ((jumpers & (1<<PB1)) ? 2 : 0) +
+			((jumpers & (1<<PB3)) ? 4 : 0);
+}
+
+/*******************************************************************************
+ *                       ISR call back functions                               *
+ *******************************************************************************/
+
+/*Description :bus receive interrupt call back ,give the byte of this node to the task
+ * ,a byte the full queue can not take is counted (COUNTER_BUS_DROPS)*/
+void busReceived(uint8 node,uint8 data){
+	if(!SCHEDULER_post(UI_TASK,EV_UART_RX,data)){
+		COUNTERS_INC(COUNTER_BUS_DROPS);
+	}
+}
+
+/*Description :system tick call back scanning the keypad*/
+void keypadScan(void){
+	uint8 key = KeyPad_scan();
+	if(key!=KEYPAD_NO_KEY){
+		SCHEDULER_post(UI_TASK,EV_KEY,key);
+	}
+}
+
+/*Description :the time of the message finished*/
+void messageTimeout(void){
+	SCHEDULER_post(UI_TASK,EV_MESSAGE_TIMEOUT,0);
+}
+
+/*Description :no key during a PIN entry for PIN_IDLE_TIME_MS*/
+void pinTimeout(void){
+	SCHEDULER_post(UI_TASK,EV_PIN_TIMEOUT,0);
+}
+
+/*Description :MC1 did not answer M_READY for ANSWER_TIME_MS*/
+void answerTimeout(void){
+	SCHEDULER_post(UI_TASK,EV_ANSWER_TIMEOUT,0);
+}
+
+/*Description :one second of the lock out passed*/
+void lockoutSecond(void){
+	SCHEDULER_post(UI_TASK,EV_SECOND,0);
+}
+
+/*Description :no event for POWER_IDLE_TIME_MS*/
+void powerIdle(void){
+	SCHEDULER_post(UI_TASK,EV_POWER_IDLE,0);
+}
+
+/*Description :a key woke the micro up from power down*/
+void powerWakeUp(void){
+	/*the address frames sent while the UART was stopped are lost*/
+	BUS_resync();
+	SCHEDULER_post(UI_TASK,EV_WAKE_UP,0);
+}
@@ -0,0 +1,76 @@
+ /******************************************************************************
+ *
+ * Module: Bus
+ *
+ * File Name: bus.h
+ *
+ * Description: multi drop UART bus of MC1 (the controller ,address 0) and up
+ * 				to BUS_NODES_MAX HMI micros (nodes ,addresses 1..BUS_NODES_MAX)
+ * 				1- the frames have 9 data bits ,an address frame (9th bit
+ * 				   set) tells which node the next data frames belong to :
+ * 				   the node sending them or the node they are sent to ,this
+ * 				   is the conversation
+ * 				2- a node sends its address frame only when the conversation
+ * 				   changes ,the controller at the start of every answer ,
+ * 				   the other bytes of an exchange cost no address frame
+ * 				3- a node keeps the multi processor mode (MPCM) on while the
+ * 				   conversation is not its own ,its receiver drops the data
+ * 				   frames of the other nodes without any interrupt
+ * 				4- the controller receives all the frames
+ * 				the nodes speak only to answer the controller or for a key of
+ * 				the user ,two nodes sending at the same time is not arbitrated
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef BUS_H_
+#define BUS_H_
+
+#include "micro_config.h"
+#include "std_types.h"
+#include "common_macros.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* address of MC1 and the highest node address */
+#define BUS_CONTROLLER 0
+#define BUS_NODES_MAX  8
+
+/* conversation unknown (after the start or frames missed) */
+#define BUS_NO_CONVERSATION 0XFF
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description : start the bus on a UART initialized with 9 data bits and its
+ * 	receive interrupt ,a node starts ignoring the data frames
+ */
+void BUS_init(uint8 address);
+
+/*
+ * Description : set the call back of a received data frame (called from the
+ * 	UART receive interrupt) with the node of the conversation
+ * 	a node gets only the frames of its own conversation
+ */
+void BUS_setCallBack(void(*a_ptr)(uint8 node,uint8 data));
+
+/*
+ * Description : send a data frame ,preceded by the address frame of the node
+ * 	if the conversation changes
+ * 	node : the destination for the controller ,its own address for a node
+ */
+void BUS_sendByte(uint8 node,uint8 data);
+
+/*
+ * Description : the conversation is unknown (address frames may have been
+ * 	missed while the UART was stopped) ,the next byte sent starts with its
+ * 	address frame
+ */
+void BUS_resync(void);
+
+#endif /* BUS_H_ */
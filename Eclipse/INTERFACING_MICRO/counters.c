@@ -0,0 +1,79 @@
+/******************************************************************************
+ *
+ * Module: Counters
+ *
+ * File Name: counters.c
+ *
+ * Description: performance counters snapshot and idle time
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+#include "counters.h"
+#include "systick.h"
+#include <avr/interrupt.h>
+
+/*******************************************************************************
+ *                            GLOBAL VARIABLES                    *
+ *******************************************************************************/
+
+volatile uint32 g_counters[COUNTERS_NUM];
+
+/*time stamp of the sleep in progress*/
+static uint16 g_idleStart;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/* 32 bits little endian */
+static void COUNTERS_send32(void(*a_sendByte)(uint8 data),uint32 value);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void COUNTERS_snapshot(void(*a_sendByte)(uint8 data)){
+
+	uint32 counters[COUNTERS_NUM];
+	uint32 cycles;
+	uint8 sreg = SREG;
+	uint8 i;
+
+	/*all of them at the same time*/
+	cli();
+	for(i = 0; i < COUNTERS_NUM; i++){
+		counters[i] = g_counters[i];
+	}
+	SREG = sreg;
+	cycles = SYSTICK_getTicks() * ((SYSTICK_COMPARE_VALUE + 1) * SYSTICK_PRESCALER);
+
+	(*a_sendByte)(COUNTERS_MAGIC1);
+	(*a_sendByte)(COUNTERS_MAGIC2);
+	(*a_sendByte)(COUNTERS_NUM);
+	COUNTERS_send32(a_sendByte,cycles);
+	for(i = 0; i < COUNTERS_NUM; i++){
+		COUNTERS_send32(a_sendByte,counters[i]);
+	}
+}
+
+void COUNTERS_idleBegin(void){
+	g_idleStart = SYSTICK_getTimeStamp();
+}
+
+void COUNTERS_idleEnd(void){
+	COUNTERS_ADD(COUNTER_IDLE_CYCLES,(uint32)(uint16)(SYSTICK_getTimeStamp() - g_idleStart) * SYSTICK_PRESCALER);
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+static void COUNTERS_send32(void(*a_sendByte)(uint8 data),uint32 value){
+
+	uint8 i;
+
+	for(i = 0; i < 4; i++){
+		(*a_sendByte)((uint8)(value >> (8*i)));
+	}
+}
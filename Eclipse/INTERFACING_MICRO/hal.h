@@ -0,0 +1,44 @@
+/******************************************************************************
+ *
+ * Module: HAL
+ *
+ * File Name: hal.h
+ *
+ * Description: register access layer used by the drivers
+ * 				1- on the micro HAL_READ/HAL_WRITE are the register itself
+ * 				2- in the host build (HAL_HOST defined) every access goes to
+ * 				   the software model of the peripherals (Eclipse/host) so the
+ * 				   side effects of a register (UDR ,TWCR ,flags cleared by
+ * 				   writing one ,...) can be simulated
+ * 				a driver must use HAL_READ/HAL_WRITE (or the bit macros of
+ * 				common_macros.h) for every access that has a side effect
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef HAL_H_
+#define HAL_H_
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#ifdef HAL_HOST
+
+#include "hal_host.h"
+
+/* read a register (or any variable) through the peripherals model */
+#define HAL_READ(REG)        HAL_HOST_read((const volatile void *)&(REG),sizeof(REG))
+
+/* write a register (or any variable) through the peripherals model */
+#define HAL_WRITE(REG,VALUE) HAL_HOST_write((volatile void *)&(REG),(VALUE),sizeof(REG))
+
+#else
+
+#define HAL_READ(REG)        (REG)
+#define HAL_WRITE(REG,VALUE) ((REG)=(VALUE))
+
+#endif
+
+#endif /* HAL_H_ */
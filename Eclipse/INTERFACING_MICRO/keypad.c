@@ -11,6 +11,17 @@
  *******************************************************************************/
 
 #include "keypad.h"
+#include "counters.h"
+
+/*******************************************************************************
+ *                            GLOBAL VARIABLES                    *
+ *******************************************************************************/
+
+/* switch number seen on the previous scan (0 no switch pressed) */
+static uint8 g_lastSwitch = 0;
+
+/* the pressed key was already returned ,wait for its release */
+static uint8 g_keyReported = FALSE;
 
 /*******************************************************************************
  *                      Functions Prototypes(Private)                          *
@@ -30,6 +41,12 @@ static uint8 KeyPad_4x3_adjustKeyNumber(uint8 button_number);
 static uint8 KeyPad_4x4_adjustKeyNumber(uint8 button_number);
 #endif
 
+/*
+ * Function responsible for one pass over the keypad
+ * return the pressed switch number or 0 if no switch is pressed
+ */
+static uint8 KeyPad_readSwitch(void);
+
 /*******************************************************************************
  *                      Functions Definitions                                  *
  *******************************************************************************/
@@ -57,6 +74,7 @@ uint8 KeyPad_getPressedKey(void)
 				if(BIT_IS_CLEAR(KEYPAD_PORT_IN,row)) /* if the switch is press in this row */ 
 				{
 					while(BIT_IS_CLEAR(KEYPAD_PORT_IN,row));
+					COUNTERS_INC(COUNTER_KEYPAD_EVENTS);
 					#if (N_col == 3)
 						return KeyPad_4x3_adjustKeyNumber((row*N_col)+col+1);
 					#elif (N_col == 4)
@@ -68,6 +86,58 @@ uint8 KeyPad_getPressedKey(void)
 	}	
 }
 
+uint8 KeyPad_scan(void)
+{
+	uint8 button_number = KeyPad_readSwitch();
+
+	/* the switch changed since the last scan ,wait until it is stable */
+	if(button_number != g_lastSwitch)
+	{
+		g_lastSwitch = button_number;
+		g_keyReported = FALSE;
+		return KEYPAD_NO_KEY;
+	}
+
+	if(button_number == 0 || g_keyReported)
+	{
+		return KEYPAD_NO_KEY;
+	}
+
+	g_keyReported = TRUE;
+	COUNTERS_INC(COUNTER_KEYPAD_EVENTS);
+	#if (N_col == 3)
+		return KeyPad_4x3_adjustKeyNumber(button_number);
+	#elif (N_col == 4)
+		return KeyPad_4x4_adjustKeyNumber(button_number);
+	#endif
+}
+
+void KeyPad_prepareWakeUp(void)
+{
+	/* columns outputs low ,rows inputs with the internal pull up resistors */
+	KEYPAD_PORT_DIR = 0xF0;
+	KEYPAD_PORT_OUT = 0x0F;
+}
+
+static uint8 KeyPad_readSwitch(void)
+{
+	uint8 col,row;
+	for(col=0;col<N_col;col++) /* loop for columns */
+	{
+		KEYPAD_PORT_DIR = (0b00010000<<col);
+		KEYPAD_PORT_OUT = (~(0b00010000<<col));
+
+		for(row=0;row<N_row;row++) /* loop for rows */
+		{
+			if(BIT_IS_CLEAR(KEYPAD_PORT_IN,row)) /* if the switch is press in this row */
+			{
+				return (row*N_col)+col+1;
+			}
+		}
+	}
+	return 0;
+}
+
 #if (N_col == 3) 
 
 static uint8 KeyPad_4x3_adjustKeyNumber(uint8 button_number)
@@ -30,6 +30,9 @@
 #define KEYPAD_PORT_IN  PINA
 #define KEYPAD_PORT_DIR DDRA 
 
+/* returned by KeyPad_scan when there is no new key (0 is a key of the keypad) */
+#define KEYPAD_NO_KEY 0XFF
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
@@ -39,4 +42,18 @@
  */
 uint8 KeyPad_getPressedKey(void);
 
+/*
+ * Function responsible for scanning the keypad once without waiting ,it is
+ * called periodically (every 10 ms) ,a key is returned once when it is seen
+ * pressed in two scans in a row (debounce) else KEYPAD_NO_KEY
+ */
+uint8 KeyPad_scan(void);
+
+/*
+ * Function responsible for driving all the columns low (the rows stay inputs
+ * with pull ups) so any pressed key pulls its row low ,used to wake up from
+ * power down ,the next scan drives the columns one by one again
+ */
+void KeyPad_prepareWakeUp(void);
+
 #endif /* KEYPAD_H_ */
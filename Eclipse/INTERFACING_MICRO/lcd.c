@@ -11,6 +11,50 @@
  *******************************************************************************/
 
 #include "lcd.h"
+#include "counters.h"
+#include <stdarg.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* quotient of a 16 bits value by 10 : multiply by 0xCCCD (2^19/10 rounded up)
+ * and shift ,exact for all the 16 bits values ,the AVR MUL instead of the
+ * division loop of the library */
+#define LCD_DIV10(VALUE) ((uint16)(((uint32)(VALUE) * 0xCCCDUL) >> 19))
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/* put a byte on the data bus and latch it by a pulse on E (RS is already set) */
+static void LCD_write(uint8 value);
+
+/* character of a cell of the progress bar */
+static uint8 LCD_barCell(uint8 cell);
+
+/* a value of LCD_printf_P ,conversion 'u' ,'d' or 'x' ,padded before it by
+ * fill to width characters */
+static void LCD_displayNumber(uint16 value,uint8 conversion,uint8 width,uint8 fill);
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* partial cells of the progress bar (custom characters 1 to 5) ,the columns
+ * are lit from the left ,the top and bottom rows stay off */
+static const uint8 g_barCharacters[LCD_CHARACTER_COLUMNS][LCD_CHARACTER_ROWS] PROGMEM = {
+		{0x00,0x10,0x10,0x10,0x10,0x10,0x10,0x00},
+		{0x00,0x18,0x18,0x18,0x18,0x18,0x18,0x00},
+		{0x00,0x1C,0x1C,0x1C,0x1C,0x1C,0x1C,0x00},
+		{0x00,0x1E,0x1E,0x1E,0x1E,0x1E,0x1E,0x00},
+		{0x00,0x1F,0x1F,0x1F,0x1F,0x1F,0x1F,0x00}
+};
+
+/* the characters of the bar are in the CGRAM ,row of the bar and its steps shown */
+static uint8 g_barLoaded = FALSE;
+static uint8 g_barRow;
+static uint8 g_barSteps;
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
@@ -18,20 +62,24 @@
 void LCD_init(void)
 {
 	LCD_CTRL_PORT_DIR |= (1<<E) | (1<<RS) | (1<<RW); /* Configure the control pins(E,RS,RW) as output pins */
-	
+	CLEAR_BIT(LCD_CTRL_PORT,E); /* no write until the LCD is ready */
 	#if (DATA_BITS_MODE == 4)
 		#ifdef UPPER_PORT_PINS
 			LCD_DATA_PORT_DIR |= 0xF0; /* Configure the highest 4 bits of the data port as output pins */
 		#else
 			LCD_DATA_PORT_DIR |= 0x0F; /* Configure the lowest 4 bits of the data port as output pins */
-		#endif		 
+		#endif
+	#elif (DATA_BITS_MODE == 8)
+		LCD_DATA_PORT_DIR = 0xFF; /* Configure the data port as output port */
+	#endif
+	/* the LCD ignores any instruction during its internal reset after power on */
+	_delay_ms(LCD_POWER_ON_MS);
+	#if (DATA_BITS_MODE == 4)
 		LCD_sendCommand(FOUR_BITS_DATA_MODE); /* initialize LCD in 4-bit mode */
 		LCD_sendCommand(TWO_LINE_LCD_Four_BIT_MODE); /* use 2-line lcd + 4-bit Data Mode + 5*7 dot display Mode */
 	#elif (DATA_BITS_MODE == 8)
-		LCD_DATA_PORT_DIR = 0xFF; /* Configure the data port as output port */ 
 		LCD_sendCommand(TWO_LINE_LCD_Eight_BIT_MODE); /* use 2-line lcd + 8-bit Data Mode + 5*7 dot display Mode */
 	#endif
-	
 	LCD_sendCommand(CURSOR_OFF); /* cursor off */
 	LCD_sendCommand(CLEAR_COMMAND); /* clear LCD at the beginning */
 }
@@ -39,79 +87,23 @@ void LCD_init(void)
 void LCD_sendCommand(uint8 command)
 {
 	CLEAR_BIT(LCD_CTRL_PORT,RS); /* Instruction Mode RS=0 */
-	CLEAR_BIT(LCD_CTRL_PORT,RW); /* write data to LCD so RW=0 */
-	_delay_ms(1); /* delay for processing Tas = 50ns */
-	SET_BIT(LCD_CTRL_PORT,E); /* Enable LCD E=1 */
-	_delay_ms(1); /* delay for processing Tpw - Tdws = 190ns */
-#if (DATA_BITS_MODE == 4)
-	/* out the highest 4 bits of the required command to the data bus D4 --> D7 */
-#ifdef UPPER_PORT_PINS
-	LCD_DATA_PORT = (LCD_DATA_PORT & 0x0F) | (command & 0xF0);
-#else
-	LCD_DATA_PORT = (LCD_DATA_PORT & 0xF0) | ((command & 0xF0) >> 4);
-#endif
-
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	CLEAR_BIT(LCD_CTRL_PORT,E); /* disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
-	SET_BIT(LCD_CTRL_PORT,E); /* Enable LCD E=1 */
-	_delay_ms(1); /* delay for processing Tpw - Tdws = 190ns */
-
-	/* out the lowest 4 bits of the required command to the data bus D4 --> D7 */
-#ifdef UPPER_PORT_PINS
-	LCD_DATA_PORT = (LCD_DATA_PORT & 0x0F) | ((command & 0x0F) << 4);
-#else
-	LCD_DATA_PORT = (LCD_DATA_PORT & 0xF0) | (command & 0x0F);
-#endif
-
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	CLEAR_BIT(LCD_CTRL_PORT,E); /* disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
-#elif (DATA_BITS_MODE == 8)
-	LCD_DATA_PORT = command; /* out the required command to the data bus D0 --> D7 */
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	CLEAR_BIT(LCD_CTRL_PORT,E); /* disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
-#endif
+	LCD_write(command);
+	/* clear display (0x01) and return home (0x02 ,0x03) are the only long instructions */
+	if(command < 0x04)
+	{
+		_delay_us(LCD_CLEAR_US);
+	}
+	else
+	{
+		_delay_us(LCD_EXECUTION_US);
+	}
 }
 
 void LCD_displayCharacter(uint8 data)
 {
 	SET_BIT(LCD_CTRL_PORT,RS); /* Data Mode RS=1 */
-	CLEAR_BIT(LCD_CTRL_PORT,RW); /* write data to LCD so RW=0 */
-	_delay_ms(1); /* delay for processing Tas = 50ns */
-	SET_BIT(LCD_CTRL_PORT,E); /* Enable LCD E=1 */
-	_delay_ms(1); /* delay for processing Tpw - Tdws = 190ns */
-#if (DATA_BITS_MODE == 4)
-	/* out the highest 4 bits of the required data to the data bus D4 --> D7 */
-#ifdef UPPER_PORT_PINS
-	LCD_DATA_PORT = (LCD_DATA_PORT & 0x0F) | (data & 0xF0);
-#else
-	LCD_DATA_PORT = (LCD_DATA_PORT & 0xF0) | ((data & 0xF0) >> 4);
-#endif
-
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	CLEAR_BIT(LCD_CTRL_PORT,E); /* disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
-	SET_BIT(LCD_CTRL_PORT,E); /* Enable LCD E=1 */
-	_delay_ms(1); /* delay for processing Tpw - Tdws = 190ns */
-
-	/* out the lowest 4 bits of the required data to the data bus D4 --> D7 */
-#ifdef UPPER_PORT_PINS
-	LCD_DATA_PORT = (LCD_DATA_PORT & 0x0F) | ((data & 0x0F) << 4);
-#else
-	LCD_DATA_PORT = (LCD_DATA_PORT & 0xF0) | (data & 0x0F);
-#endif
-
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	CLEAR_BIT(LCD_CTRL_PORT,E); /* disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
-#elif (DATA_BITS_MODE == 8)
-	LCD_DATA_PORT = data; /* out the required command to the data bus D0 --> D7 */
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	CLEAR_BIT(LCD_CTRL_PORT,E); /* disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
-#endif
+	LCD_write(data);
+	_delay_us(LCD_EXECUTION_US);
 }
 
 void LCD_displayString(const char *Str)
@@ -131,6 +123,25 @@ void LCD_displayString(const char *Str)
 	*********************************************************/
 }
 
+void LCD_displayString_P(const char *Str)
+{
+	uint8 data;
+	/* read from the flash one character at a time ,nothing in SRAM */
+	while((data = pgm_read_byte(Str)) != '\0')
+	{
+		LCD_displayCharacter(data);
+		Str++;
+	}
+}
+
+void LCD_showScreen(const LcdScreenType *Screen)
+{
+	LCD_clearScreen();
+	LCD_displayString_P((const char *)pgm_read_ptr(&Screen->line1));
+	LCD_goToRowColumn(1,0);
+	LCD_displayString_P((const char *)pgm_read_ptr(&Screen->line2));
+}
+
 void LCD_goToRowColumn(uint8 row,uint8 col)
 {
 	uint8 Address;
@@ -139,6 +150,7 @@ void LCD_goToRowColumn(uint8 row,uint8 col)
 	switch(row)
 	{
 		case 0:
+		default:
 				Address=col;
 				break;
 		case 1:
@@ -164,12 +176,226 @@ void LCD_displayStringRowColumn(uint8 row,uint8 col,const char *Str)
 
 void LCD_intgerToString(int data)
 {
-   char buff[16]; /* String to hold the ascii result */
-   itoa(data,buff,10); /* 10 for decimal */
-   LCD_displayString(buff);
+	LCD_printf_P(PSTR("%d"),data);
+}
+
+void LCD_printf_P(const char *Format,...)
+{
+	va_list args;
+	const char *Str;
+	uint8 data;
+	uint8 width;
+	uint8 fill;
+	va_start(args,Format);
+	while((data = pgm_read_byte(Format++)) != '\0')
+	{
+		if(data != '%')
+		{
+			LCD_displayCharacter(data);
+			continue;
+		}
+		/* flag and width of the conversion */
+		fill = ' ';
+		width = 0;
+		data = pgm_read_byte(Format++);
+		if(data == '0')
+		{
+			fill = '0';
+			data = pgm_read_byte(Format++);
+		}
+		while(data >= '0' && data <= '9')
+		{
+			width = width * 10 + (data - '0');
+			data = pgm_read_byte(Format++);
+		}
+		switch(data)
+		{
+			case 'u':
+			case 'd':
+			case 'x':
+				LCD_displayNumber((uint16)va_arg(args,unsigned int),data,width,fill);
+				break;
+			case 's':
+				Str = va_arg(args,const char *);
+				while((data = pgm_read_byte(Str)) != '\0')
+				{
+					LCD_displayCharacter(data);
+					Str++;
+					width = (width != 0) ? width - 1 : 0;
+				}
+				for(; width != 0; width--)
+				{
+					LCD_displayCharacter(' ');
+				}
+				break;
+			case 'c':
+				LCD_displayCharacter((uint8)va_arg(args,int));
+				break;
+			case '\0':
+				/* a % at the end of the format */
+				Format--;
+				break;
+			default:
+				/* %% (or an unknown conversion) is the character itself */
+				LCD_displayCharacter(data);
+				break;
+		}
+	}
+	va_end(args);
 }
 
 void LCD_clearScreen(void)
 {
 	LCD_sendCommand(CLEAR_COMMAND); //clear display 
 }
+
+void LCD_defineCharacter(uint8 code,const uint8 *Pattern)
+{
+	uint8 row;
+	/* the data written after it go to the CGRAM ,8 bytes per character */
+	LCD_sendCommand(SET_CGRAM_ADDRESS | ((code % LCD_CUSTOM_CHARACTERS) * LCD_CHARACTER_ROWS));
+	for(row = 0; row < LCD_CHARACTER_ROWS; row++)
+	{
+		LCD_displayCharacter(pgm_read_byte(&Pattern[row]));
+	}
+}
+
+void LCD_barStart(uint8 row)
+{
+	uint8 code;
+	if(!g_barLoaded)
+	{
+		for(code = 1; code <= LCD_CHARACTER_COLUMNS; code++)
+		{
+			LCD_defineCharacter(code,g_barCharacters[code - 1]);
+		}
+		g_barLoaded = TRUE;
+	}
+	g_barRow = row;
+	g_barSteps = 0;
+}
+
+void LCD_barUpdate(uint8 steps)
+{
+	uint8 cell;
+	uint8 last;
+	if(steps > LCD_BAR_STEPS)
+	{
+		steps = LCD_BAR_STEPS;
+	}
+	if(steps == g_barSteps)
+	{
+		return;
+	}
+	/* the cells from the old end of the bar to the new one */
+	cell = ((steps < g_barSteps) ? steps : g_barSteps) / LCD_CHARACTER_COLUMNS;
+	last = (((steps > g_barSteps) ? steps : g_barSteps) - 1) / LCD_CHARACTER_COLUMNS;
+	g_barSteps = steps;
+	LCD_goToRowColumn(g_barRow,cell);
+	for(; cell <= last; cell++)
+	{
+		LCD_displayCharacter(LCD_barCell(cell));
+	}
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+static void LCD_displayNumber(uint16 value,uint8 conversion,uint8 width,uint8 fill)
+{
+	uint32 digits = 0; /* 4 bits per digit ,the last one found (first shown) the lowest */
+	uint8 count = 0;
+	uint8 sign = 0;
+	uint8 digit;
+	uint16 quotient;
+	if(conversion == 'd' && (value & 0x8000))
+	{
+		sign = '-';
+		value = 0 - value;
+		count = 1;
+	}
+	/* the digits are found from the lowest one */
+	do
+	{
+		if(conversion == 'x')
+		{
+			digit = value & 0x0F;
+			value >>= 4;
+		}
+		else
+		{
+			quotient = LCD_DIV10(value);
+			digit = value - quotient * 10;
+			value = quotient;
+		}
+		digits = (digits << 4) | digit;
+		count++;
+	}while(value != 0);
+	/* the sign is before the zeros but after the spaces */
+	if(sign && fill == '0')
+	{
+		LCD_displayCharacter(sign);
+	}
+	for(; width > count; width--)
+	{
+		LCD_displayCharacter(fill);
+	}
+	if(sign)
+	{
+		if(fill != '0')
+		{
+			LCD_displayCharacter(sign);
+		}
+		count--;
+	}
+	for(; count != 0; count--)
+	{
+		digit = digits & 0x0F;
+		digits >>= 4;
+		LCD_displayCharacter((digit < 10) ? '0' + digit : 'a' + digit - 10);
+	}
+}
+
+static uint8 LCD_barCell(uint8 cell)
+{
+	uint8 first = cell * LCD_CHARACTER_COLUMNS;
+	if(g_barSteps <= first)
+	{
+		return ' ';
+	}
+	/* the code of a partial cell is its number of lit columns */
+	return (g_barSteps - first >= LCD_CHARACTER_COLUMNS) ? LCD_CHARACTER_COLUMNS : (g_barSteps - first);
+}
+
+static void LCD_write(uint8 value)
+{
+	COUNTERS_INC(COUNTER_LCD_BYTES);
+	CLEAR_BIT(LCD_CTRL_PORT,RW); /* write data to LCD so RW=0 */
+	_delay_us(1); /* delay for processing Tas = 50ns */
+	SET_BIT(LCD_CTRL_PORT,E); /* Enable LCD E=1 */
+#if (DATA_BITS_MODE == 4)
+	/* out the highest 4 bits of the value to the data bus D4 --> D7 */
+#ifdef UPPER_PORT_PINS
+	LCD_DATA_PORT = (LCD_DATA_PORT & 0x0F) | (value & 0xF0);
+#else
+	LCD_DATA_PORT = (LCD_DATA_PORT & 0xF0) | ((value & 0xF0) >> 4);
+#endif
+	_delay_us(1); /* delay for processing Tpw = 230ns */
+	CLEAR_BIT(LCD_CTRL_PORT,E); /* disable LCD E=0 */
+	_delay_us(1); /* delay for processing Th = 10ns ,Tcycle = 500ns */
+	SET_BIT(LCD_CTRL_PORT,E); /* Enable LCD E=1 */
+	/* out the lowest 4 bits of the value to the data bus D4 --> D7 */
+#ifdef UPPER_PORT_PINS
+	LCD_DATA_PORT = (LCD_DATA_PORT & 0x0F) | ((value & 0x0F) << 4);
+#else
+	LCD_DATA_PORT = (LCD_DATA_PORT & 0xF0) | (value & 0x0F);
+#endif
+	_delay_us(1); /* delay for processing Tpw = 230ns */
+	CLEAR_BIT(LCD_CTRL_PORT,E); /* disable LCD E=0 */
+#elif (DATA_BITS_MODE == 8)
+	LCD_DATA_PORT = value; /* out the value to the data bus D0 --> D7 */
+	_delay_us(1); /* delay for processing Tpw = 230ns */
+	CLEAR_BIT(LCD_CTRL_PORT,E); /* disable LCD E=0 */
+#endif
+}
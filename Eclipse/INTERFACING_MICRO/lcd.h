@@ -16,6 +16,7 @@
 #include "std_types.h"
 #include "common_macros.h"
 #include "micro_config.h"
+#include <avr/pgmspace.h>
 
 /*******************************************************************************
  *                      Preprocessor Macros                                    *
@@ -27,6 +28,13 @@
 #define UPPER_PORT_PINS
 #endif
 
+/* HD44780 timing : internal reset after power on ,execution of clear display
+ * and return home ,execution of the other instructions and of a data write
+ * (37us + 4us ,the LCD is not read so the busy flag is not used) */
+#define LCD_POWER_ON_MS  15
+#define LCD_CLEAR_US     1600
+#define LCD_EXECUTION_US 45
+
 /* LCD HW Pins */
 #define RS PD4
 #define RW PD5
@@ -45,6 +53,28 @@
 #define CURSOR_OFF 0x0C
 #define CURSOR_ON 0x0E
 #define SET_CURSOR_LOCATION 0x80 
+#define SET_CGRAM_ADDRESS 0x40
+
+/* custom characters : codes 0 to 7 ,5x8 dots each (a byte per row ,the 5
+ * lowest bits are the dots) in the CGRAM ,kept by a clear display */
+#define LCD_CUSTOM_CHARACTERS 8
+#define LCD_CHARACTER_ROWS 8
+#define LCD_CHARACTER_COLUMNS 5
+
+/* progress bar : LCD_BAR_CELLS cells of a row ,a column of dots per step ,a
+ * partial cell is the custom character of its lit columns (1 to 5) */
+#define LCD_BAR_CELLS 16
+#define LCD_BAR_STEPS (LCD_BAR_CELLS * LCD_CHARACTER_COLUMNS)
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* a screen : 2 lines in flash */
+typedef struct{
+	const char * line1;
+	const char * line2;
+}LcdScreenType;
 
 /*******************************************************************************
  *                      Functions Prototypes                                   *
@@ -52,10 +82,29 @@
 void LCD_sendCommand(uint8 command);
 void LCD_displayCharacter(uint8 data);
 void LCD_displayString(const char *Str);
+/* a string in flash (PSTR or PROGMEM) */
+void LCD_displayString_P(const char *Str);
+/* clear the LCD and draw the 2 lines of a screen ,the screen and its lines
+ * are in flash */
+void LCD_showScreen(const LcdScreenType *Screen);
 void LCD_init(void);
 void LCD_clearScreen(void);
 void LCD_displayStringRowColumn(uint8 row,uint8 col,const char *Str);
 void LCD_goToRowColumn(uint8 row,uint8 col);
 void LCD_intgerToString(int data);
+/* formatted output written to the LCD as it is formatted (no buffer) ,the
+ * format is in flash (PSTR) ,the values are 16 bits (int of the AVR) :
+ * %u %d %x ,a width and a 0 flag (%5u ,%02u ,%04x) ,%s a string in flash
+ * (padded after it to the width) ,%c and %% */
+void LCD_printf_P(const char *Format,...);
+/* load a custom character ,its rows are in flash ,the position must be set
+ * (LCD_goToRowColumn) before the next character */
+void LCD_defineCharacter(uint8 code,const uint8 *Pattern);
+/* start an empty progress bar on a blank row (the custom characters of the
+ * bar are loaded the first time) */
+void LCD_barStart(uint8 row);
+/* show the steps of the bar (0 to LCD_BAR_STEPS) ,only the cells that
+ * changed are written (one cell for one more step) */
+void LCD_barUpdate(uint8 steps);
 
 #endif /* LCD_H_ */
@@ -0,0 +1,116 @@
+ /******************************************************************************
+ *
+ * Module: PIN Editor
+ *
+ * File Name: pin_editor.c
+ *
+ * Description: the editor remembers the column of the LCD cursor so a digit
+ * 				added after the last one is written without moving the cursor
+ * 				,only a deletion needs the cursor command
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#include "pin_editor.h"
+#include "lcd.h"
+
+/*******************************************************************************
+ *                            GLOBAL VARIABLES                    *
+ *******************************************************************************/
+
+/*digits entered and their number*/
+static uint8 g_pin[PASSWORD_MAX_LENGTH];
+static uint8 g_length;
+
+/*LCD position of the first digit and column of the LCD cursor*/
+static uint8 g_row;
+static uint8 g_column;
+static uint8 g_cursor;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/* write one cell of the PIN ,the cursor is moved only when it is not there */
+static void PIN_EDITOR_writeCell(uint8 index,uint8 character);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description : start a new empty PIN
+ */
+void PIN_EDITOR_start(uint8 row,uint8 column){
+
+	g_length = 0;
+	g_row = row;
+	g_column = column;
+	/*unknown until the first cell is written*/
+	g_cursor = 0XFF;
+}
+
+/*
+ * Description : handle a key
+ */
+uint8 PIN_EDITOR_key(uint8 key){
+
+	if(key <= 9){
+		if(g_length < PASSWORD_MAX_LENGTH){
+			g_pin[g_length] = key;
+			PIN_EDITOR_writeCell(g_length,PIN_EDITOR_ECHO);
+			g_length++;
+		}
+	}else if(key == PIN_EDITOR_BACKSPACE_KEY){
+		if(g_length > 0){
+			g_length--;
+			PIN_EDITOR_writeCell(g_length,' ');
+		}
+	}else if(key == PIN_EDITOR_CLEAR_KEY){
+		PIN_EDITOR_clear();
+	}else if(key == PIN_EDITOR_ENTER_KEY){
+		return (g_length >= PASSWORD_MIN_LENGTH);
+	}
+	return FALSE;
+}
+
+/*
+ * Description : delete all the digits
+ */
+void PIN_EDITOR_clear(void){
+
+	while(g_length > 0){
+		g_length--;
+		PIN_EDITOR_writeCell(g_length,' ');
+	}
+}
+
+/*
+ * Description : copy the digits entered
+ */
+uint8 PIN_EDITOR_getPin(uint8 * a_pin){
+
+	uint8 i;
+
+	for(i = 0; i < g_length; i++){
+		a_pin[i] = g_pin[i];
+	}
+	return g_length;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+static void PIN_EDITOR_writeCell(uint8 index,uint8 character){
+
+	uint8 column = g_column + index;
+
+	if(g_cursor != column){
+		LCD_goToRowColumn(g_row,column);
+	}
+	LCD_displayCharacter(character);
+	/*the LCD moves its cursor to the next cell after a character*/
+	g_cursor = column + 1;
+}
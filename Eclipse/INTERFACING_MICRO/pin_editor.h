@@ -0,0 +1,64 @@
+ /******************************************************************************
+ *
+ * Module: PIN Editor
+ *
+ * File Name: pin_editor.h
+ *
+ * Description: entry of a PIN on the keypad with its echo on the LCD
+ * 				1- digits 0..9 are added (shown as '*') up to PASSWORD_MAX_LENGTH
+ * 				2- '-' deletes the last digit ,'*' clears the PIN
+ * 				3- enter accepts a PIN of PASSWORD_MIN_LENGTH digits or more
+ * 				4- the other keys are ignored
+ * 				only the LCD cell of the digit that changed is written
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef PIN_EDITOR_H_
+#define PIN_EDITOR_H_
+
+#include "std_types.h"
+#include "system_states.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* editing keys of the keypad (keypad.c) */
+#define PIN_EDITOR_ENTER_KEY     13
+#define PIN_EDITOR_BACKSPACE_KEY '-'
+#define PIN_EDITOR_CLEAR_KEY     '*'
+
+/* character shown for every digit */
+#define PIN_EDITOR_ECHO '*'
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description : start a new empty PIN ,the first digit is shown at row ,column
+ * 	(the cells of the PIN are expected to be blank)
+ */
+void PIN_EDITOR_start(uint8 row,uint8 column);
+
+/*
+ * Description : handle a key ,return TRUE when a PIN of an allowed length is
+ * 	entered (enter key) else FALSE
+ */
+uint8 PIN_EDITOR_key(uint8 key);
+
+/*
+ * Description : delete all the digits (and blank their cells)
+ */
+void PIN_EDITOR_clear(void);
+
+/*
+ * Description : copy the digits entered
+ * 	[out] a_pin : PASSWORD_MAX_LENGTH bytes at least
+ * 	return number of digits
+ */
+uint8 PIN_EDITOR_getPin(uint8 * a_pin);
+
+#endif /* PIN_EDITOR_H_ */
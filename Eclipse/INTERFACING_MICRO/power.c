@@ -0,0 +1,114 @@
+ /******************************************************************************
+ *
+ * Module: Power
+ *
+ * File Name: power.c
+ *
+ * Description: the ATmega16 has no power reduction register ,a peripheral is
+ * 				off when its enable bit (or its clock select) is cleared
+ * 				power down stops the TIMER0 clock too ,the tick is suspended
+ * 				before so the TIMER0 prescaler and counter start again from
+ * 				where they stopped
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#include "power.h"
+#include "keypad.h"
+#include "systick.h"
+#include "scheduler.h"
+#include <avr/sleep.h>
+
+/*******************************************************************************
+ *                            GLOBAL VARIABLES                    *
+ *******************************************************************************/
+
+static void (*volatile g_callBackPtrWakeUp)(void) = NULL_PTR;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/* restore the clocks after power down and call the application */
+static void POWER_wakeUp(void);
+
+/*******************************************************************************
+ *                       Interrupt Service Routines                            *
+ *******************************************************************************/
+
+ISR(INT2_vect){
+	POWER_wakeUp();
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description : switch off the unused peripherals ,prepare the wake up line
+ * 	and sleep in idle mode between events
+ */
+void POWER_init(void){
+
+	/* analog comparator (on after reset) ,ADC and TWI off */
+	ACSR = (1<<ACD);
+	ADCSRA = 0;
+	TWCR = 0;
+	/* no clock for TIMER1 and TIMER2 */
+	TCCR1B = 0;
+	TCCR2 = 0;
+
+	/* wake up line input with pull up ,INT2 on the falling edge (ISC2 = 0) */
+	CLEAR_BIT(POWER_WAKE_PORT_DIR,POWER_WAKE_PIN);
+	SET_BIT(POWER_WAKE_PORT,POWER_WAKE_PIN);
+	CLEAR_BIT(MCUCSR,ISC2);
+	CLEAR_BIT(GICR,INT2);
+
+	SCHEDULER_setSleepMode(SLEEP_MODE_IDLE);
+}
+
+/*
+ * Description : power down when the scheduler has nothing to do
+ */
+void POWER_down(void){
+
+	uint8 sreg = SREG;
+	cli();
+
+	KeyPad_prepareWakeUp();
+	SYSTICK_suspend();
+	SCHEDULER_setSleepMode(SLEEP_MODE_PWR_DOWN);
+
+	/* changing ISC2 may set the flag ,an old edge would wake up at once */
+	HAL_WRITE(GIFR,(1<<INTF2));
+	SET_BIT(GICR,INT2);
+
+	/* a key already held gives no edge */
+	if(BIT_IS_CLEAR(POWER_WAKE_PORT_IN,POWER_WAKE_PIN)){
+		POWER_wakeUp();
+	}
+	SREG = sreg;
+}
+
+/*
+ * Description : set the call back of the wake up
+ */
+void POWER_setCallBack(void(*a_ptr)(void)){
+	g_callBackPtrWakeUp = a_ptr;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+static void POWER_wakeUp(void){
+
+	CLEAR_BIT(GICR,INT2);
+	SCHEDULER_setSleepMode(SLEEP_MODE_IDLE);
+	SYSTICK_resume();
+
+	if(g_callBackPtrWakeUp != NULL_PTR){
+		(*g_callBackPtrWakeUp)();
+	}
+}
@@ -0,0 +1,64 @@
+ /******************************************************************************
+ *
+ * Module: Power
+ *
+ * File Name: power.h
+ *
+ * Description: power manager of the HMI micro
+ * 				1- the peripherals not used (ADC ,analog comparator ,TWI ,
+ * 				   TIMER1 ,TIMER2) are switched off once at start up
+ * 				2- between events the scheduler sleeps in idle mode ,the UART
+ * 				   and the system tick wake it up
+ * 				3- when the user interface is quiet (waiting for a key and MC1
+ * 				   waiting for the HMI) it can power down : the system tick is
+ * 				   stopped and only a key wakes the micro up (INT2)
+ * 				wiring : the 4 rows of the keypad are connected to INT2 (PB2)
+ * 				through diodes (cathodes on the rows) ,PB2 has its pull up so
+ * 				it is low while a key is pressed and the columns are low
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef POWER_H_
+#define POWER_H_
+
+#include "micro_config.h"
+#include "std_types.h"
+#include "common_macros.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* wake up line of the keypad (INT2) */
+#define POWER_WAKE_PORT     PORTB
+#define POWER_WAKE_PORT_DIR DDRB
+#define POWER_WAKE_PORT_IN  PINB
+#define POWER_WAKE_PIN      PB2
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description : switch off the unused peripherals ,prepare the wake up line
+ * 	and sleep in idle mode between events
+ */
+void POWER_init(void);
+
+/*
+ * Description : power down when the scheduler has nothing to do ,the system
+ * 	tick is stopped until a key is pressed ,then the call back is called (from
+ * 	the INT2 ISR) with the system tick running again
+ * 	the UART can not receive while the clocks are stopped ,call it only when
+ * 	no byte is expected
+ */
+void POWER_down(void);
+
+/*
+ * Description : set the call back of the wake up
+ */
+void POWER_setCallBack(void(*a_ptr)(void));
+
+#endif /* POWER_H_ */
@@ -0,0 +1,78 @@
+/******************************************************************************
+ *
+ * Module: Scheduler
+ *
+ * File Name: scheduler.h
+ *
+ * Description: cooperative run to completion scheduler
+ * 				1- static task table ,the task id is its priority (0 highest)
+ * 				2- every task has an event queue ,events are posted from ISRs
+ * 				   or other tasks
+ * 				3- a bitmap of ready tasks gives the highest priority ready
+ * 				   task in constant time
+ * 				4- the CPU sleeps when no task is ready ,in idle mode unless the
+ * 				   application chooses a deeper mode (SCHEDULER_setSleepMode)
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include "micro_config.h"
+#include "std_types.h"
+#include "common_macros.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* number of events every task can hold (power of 2) */
+#define SCHEDULER_QUEUE_SIZE 8
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* tasks of the application ordered by priority (highest first, 8 tasks maximum) */
+typedef enum {
+	UI_TASK,SCHEDULER_TASKS_NUM
+}SchedulerTaskId;
+
+/* a task runs to completion for every event posted to it */
+typedef void (*SchedulerTask)(uint8 event,uint8 data);
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description : clear the task table and all event queues
+ */
+void SCHEDULER_init(void);
+
+/*
+ * Description : put a task in the task table
+ */
+void SCHEDULER_addTask(SchedulerTaskId id,SchedulerTask task);
+
+/*
+ * Description : post an event to a task (safe to call from ISRs)
+ * 	return TRUE or FALSE if the queue of the task is full
+ */
+uint8 SCHEDULER_post(SchedulerTaskId id,uint8 event,uint8 data);
+
+/*
+ * Description : sleep mode used when no task is ready (SLEEP_MODE_xxx of
+ * 	avr/sleep.h ,safe to call from ISRs) ,the application must keep a wake up
+ * 	source enabled for the mode chosen
+ */
+void SCHEDULER_setSleepMode(uint8 mode);
+
+/*
+ * Description : run the ready tasks forever ,sleep when nothing is ready
+ */
+void SCHEDULER_run(void);
+
+#endif /* SCHEDULER_H_ */
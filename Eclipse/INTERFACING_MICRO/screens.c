@@ -0,0 +1,41 @@
+ /******************************************************************************
+ *
+ * Module: Screens
+ *
+ * File Name: screens.c
+ *
+ * Description: the lines of the screens and their table ,all in flash
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#include "screens.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define SCREENS_LINES(ID,LINE1,LINE2) \
+	static const char ID##_LINE1[] PROGMEM = LINE1; \
+	static const char ID##_LINE2[] PROGMEM = LINE2;
+
+#define SCREENS_ENTRY(ID,LINE1,LINE2) {ID##_LINE1,ID##_LINE2},
+
+/*******************************************************************************
+ *                      Screens Table (flash)                                  *
+ *******************************************************************************/
+
+SCREENS_LIST(SCREENS_LINES)
+
+static const LcdScreenType g_screens[SCREENS_NUM] PROGMEM = {
+		SCREENS_LIST(SCREENS_ENTRY)
+};
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void SCREENS_show(ScreenId id){
+	LCD_showScreen(&g_screens[id]);
+}
@@ -0,0 +1,59 @@
+ /******************************************************************************
+ *
+ * Module: Screens
+ *
+ * File Name: screens.h
+ *
+ * Description: the fixed screens of the user interface ,their 2 lines stay in
+ * 				flash (table of screens.c) and are drawn by SCREENS_show
+ * 				,no copy of them is made in SRAM at start up
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef SCREENS_H_
+#define SCREENS_H_
+
+#include "lcd.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* ids of the screens and their 2 lines (16 characters at most) */
+#define SCREENS_LIST(SCREEN) \
+	SCREEN(SCREEN_NEW_PASSWORD,     "EnterNewPASSWORD","")                 \
+	SCREEN(SCREEN_CONFIRM_PASSWORD, "CONFIRM PASSWORD","")                 \
+	SCREEN(SCREEN_ENTER_PASSWORD,   "ENTER PASSWORD",  "")                 \
+	SCREEN(SCREEN_OPTIONS,          "0-->OPEN GATE",   "1-->NEW PASSWORD") \
+	SCREEN(SCREEN_MISMATCH,         "PASSWORDS NOT",   "MATCHED!tryAgain") \
+	SCREEN(SCREEN_SAVING_PASSWORD,  "SAVING PASSWORD", "")                 \
+	SCREEN(SCREEN_PASSWORD_SAVED,   "PASSWORD SAVED",  "")                 \
+	SCREEN(SCREEN_WRONG_PASSWORD,   "WRONG PASSWORD!!","")                 \
+	SCREEN(SCREEN_UNLOCKING,        "UNLOCKING",       "")                 \
+	SCREEN(SCREEN_GATE_OPEN,        "GATE OPEN",       "")                 \
+	SCREEN(SCREEN_LOCKING,          "LOCKING",         "")                 \
+	SCREEN(SCREEN_GATE_OBSTRUCTED,  "GATE OBSTRUCTED", "")                 \
+	SCREEN(SCREEN_GATE_BLOCKED,     "GATE BLOCKED",    "NOT CLOSED!!")     \
+	SCREEN(SCREEN_LOCKED,           "thief!!!",        "LOCKED")
+
+#define SCREENS_ID(ID,LINE1,LINE2) ID,
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef enum {
+	SCREENS_LIST(SCREENS_ID)
+	SCREENS_NUM
+}ScreenId;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/* clear the LCD and draw a screen of the table */
+void SCREENS_show(ScreenId id);
+
+#endif /* SCREENS_H_ */
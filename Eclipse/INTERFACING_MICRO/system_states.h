@@ -0,0 +1,102 @@
+/******************************************************************************
+ *
+ * Module: System States
+ *
+ * File Name: system_states.h
+ *
+ * Description: states and constants of the protocol between MC1 and MC2
+ * 				(the same file is used by both micros)
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef SYSTEM_STATES_H_
+#define SYSTEM_STATES_H_
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/*baud rate of the link (the bus of MC1 ,the HMI micros and the gateway) for
+ *the clock of the micros ,the fastest standard rate (the gateway is on a PC
+ *serial port) within UART_BAUD_ERROR_MAX of uart.h and with frames of at
+ *least 1144 cycles like 9600 at 1 MHz ,so the receive interrupt has the
+ *same time for a frame
+ *  clock   baud   mode   UBRR  error  frame (11 bits)
+ *  1 MHz   9600   U2X    12    0.2%   1144 us  (19200 : 7% ,fails)
+ *  8 MHz   38400  normal 12    0.2%   286 us   (57600 : 2.1% ,fails)
+ *  16 MHz  57600  U2X    34    0.8%   192 us   (115200 : 2.1% ,fails)
+ *a micro checks its rate when it is built (#error)*/
+#define LINK_BAUD_FOR(CLOCK) \
+	(((CLOCK) <= 2000000UL) ? 9600UL : ((CLOCK) < 16000000UL) ? 38400UL : 57600UL)
+#define LINK_BAUD LINK_BAUD_FOR(F_CPU)
+
+/*Constant value between the 2 micros to indicate that
+ *the micro ready to receive information from UART*/
+#define M_READY 0XFF
+
+/*specific values to inform if password are correct or not */
+#define CORRECT_PASSWORD 0XCC
+#define WRONG_PASSWORD   0XBB
+
+/*sent by MC1 to a node waiting for the password of a system state that
+ *changed without it (the first password was set up from another node) ,the
+ *node asks for the state again (M_READY)*/
+#define STATE_CHANGED 0XEE
+
+/*number of digits of the password (PIN policy) ,the digits are sent as the
+ *key values 0..9 followed by '#'*/
+#define PASSWORD_MIN_LENGTH 4
+#define PASSWORD_MAX_LENGTH 12
+
+/*after the BUZZER_ON state MC1 sends the seconds left of the lock out in 2
+ *bytes of 7 bits (high byte first) so they are never M_READY*/
+#define LOCKOUT_BYTE_BITS 7
+#define LOCKOUT_BYTE_MASK 0X7F
+
+/*while a gate state lasts MC1 sends its progress (GATE_PROGRESS_STEPS steps
+ *from the gate state sent to the end of its time) to the nodes waiting for
+ *the gate ,without any M_READY ,a progress frame is GATE_PROGRESS_FRAME +
+ *steps so it is never a system state ,a gate state or M_READY ,a frame is
+ *sent only when the steps change and GATE_PROGRESS_MIN_MS at most often*/
+#define GATE_PROGRESS_STEPS  80
+#define GATE_PROGRESS_FRAME  0X40
+#define GATE_PROGRESS_MIN_MS 20
+#define GATE_IS_PROGRESS(DATA) ((DATA) >= GATE_PROGRESS_FRAME && (DATA) <= GATE_PROGRESS_FRAME + GATE_PROGRESS_STEPS)
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* declaring  the states of the system (sent by MC1 to MC2)*/
+typedef enum {
+	NEW_PASSWORD,CHECK_PASSWORD_TO_LOG_IN,CHECK_PASSWORD_FOR_NEW_PASSWORD,VIEW_OPTIONS,OPENING_GATE,BUZZER_ON,
+	SYSTEM_STATES_NUM
+}SystemState;
+
+/*Options the user can choose from (sent by MC2 to MC1)
+ *PROVISION_USERS is sent by the gateway after a log in with the password of
+ *the system ,MC1 answers M_READY for every page of the user table it can
+ *take (user_table.h) or WRONG_PASSWORD if it refuses ,then after the last
+ *page CORRECT_PASSWORD if all the pages were stored right
+ *GATE_CONFIG is sent the same way ,MC1 answers M_READY for the timing
+ *profile of the gate (gate_config.h) or WRONG_PASSWORD ,then after the
+ *profile CORRECT_PASSWORD if it is used or WRONG_PASSWORD if it is not valid*/
+typedef enum{
+	OPEN_GATE_OPTION,CREATE_NEW_PASSWORD,PROVISION_USERS,GATE_CONFIG
+}Options;
+
+/*ENUM to hold gate state (sent by MC1 to MC2 while the gate is working)
+ *MC2 answers M_READY for every state but the last ones :
+ *CLOSED ends the sequence ,the system state follows
+ *GATE_OBSTRUCTED the motor stalled and was stopped ,the gate closes again
+ *after the holding time
+ *GATE_BLOCKED the motor stalled again ,the gate stays where it stopped and
+ *the sequence ends (never reported CLOSED)*/
+typedef enum {
+	CLOSED,GATE_OPENING,OPENED,GATE_CLOSING,GATE_OBSTRUCTED,GATE_BLOCKED,
+	GATE_STATES_NUM
+}GateStatus;
+
+#endif /* SYSTEM_STATES_H_ */
@@ -0,0 +1,166 @@
+/******************************************************************************
+ *
+ * Module: System Tick
+ *
+ * File Name: systick.c
+ *
+ * Description: periodic system tick on TIMER0 with software timers
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+#include "systick.h"
+#include "timers.h"
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef struct{
+	uint16 remaining; /* ticks left ,0 means the timer is stopped */
+	uint16 reload;    /* ticks loaded again after expiry ,0 for one shot timers */
+	void (*callBack)(void);
+}SoftwareTimer;
+
+/*******************************************************************************
+ *                            GLOBAL VARIABLES                    *
+ *******************************************************************************/
+
+/*number of ticks since the system tick started*/
+static volatile uint32 g_ticks = 0;
+
+static volatile SoftwareTimer g_timers[SYSTICK_TIMERS_NUM];
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/* TIMER0 compare call back : runs every SYSTICK_PERIOD_MS */
+static void SYSTICK_tick(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description : start TIMER0 in compare mode to generate the system tick
+ */
+void SYSTICK_init(void){
+
+	/* Create configuration structure for compare mode timer0 with interrupt */
+	TimersConfigType s_timer0Config = {COMPARE,SYSTICK_CLOCK,1,TIMER0 };
+	TimersCompareModeConfig s_cmpModeT0Config ={SYSTICK_COMPARE_VALUE,0,OCN_DISCONNECTED,OCN_DISCONNECTED};
+	uint8 timer;
+
+	for (timer = 0; timer < SYSTICK_TIMERS_NUM; ++timer) {
+		g_timers[timer].remaining = 0;
+	}
+	g_ticks = 0;
+
+	TIMERS_setCallBackTimer0(SYSTICK_tick);
+	TIMERS_init(&s_timer0Config,&s_cmpModeT0Config);
+}
+
+/*
+ * Description : return number of ticks since SYSTICK_init
+ */
+uint32 SYSTICK_getTicks(void){
+
+	uint32 ticks;
+	/* the 32 bits counter is changed by the ISR so read it with interrupts disabled */
+	uint8 sreg = SREG;
+	cli();
+	ticks = g_ticks;
+	SREG = sreg;
+	return ticks;
+}
+
+/*
+ * Description : time in units of SYSTICK_PRESCALER cycles ,low 16 bits
+ */
+uint16 SYSTICK_getTimeStamp(void){
+
+	uint16 ticks = (uint16)g_ticks;
+	uint8 count = HAL_READ(TCNT0);
+
+	/* the tick starts at the compare match (the flag and the ISR) ,the
+	 * counter clears one count later */
+	if(BIT_IS_SET(TIFR,OCF0)){
+		ticks++;
+	}
+	count = (count == SYSTICK_COMPARE_VALUE) ? 0 : (uint8)(count + 1);
+	return ticks*(SYSTICK_COMPARE_VALUE + 1) + count;
+}
+
+/*
+ * Description : start (or restart) a software timer
+ * 	[in] timer : id of the timer
+ * 	[in] ticks : number of ticks until the call back is called
+ * 	[in] periodic : TRUE to reload the timer every time it expires
+ * 	[in] a_ptr : call back (called from the TIMER0 ISR)
+ */
+void SYSTICK_startTimer(SystickTimerId timer,uint16 ticks,uint8 periodic,void(*a_ptr)(void)){
+
+	uint8 sreg = SREG;
+
+	if(ticks == 0){
+		ticks = 1;
+	}
+
+	cli();
+	g_timers[timer].callBack = a_ptr;
+	g_timers[timer].reload = periodic ? ticks : 0;
+	g_timers[timer].remaining = ticks;
+	SREG = sreg;
+}
+
+/*
+ * Description : stop a software timer without calling its call back
+ */
+void SYSTICK_stopTimer(SystickTimerId timer){
+
+	uint8 sreg = SREG;
+	cli();
+	g_timers[timer].remaining = 0;
+	SREG = sreg;
+}
+
+/*
+ * Description : stop the clock of TIMER0 ,the counter keeps its value
+ */
+void SYSTICK_suspend(void){
+	/* CS02:0 = 0 no clock source */
+	TCCR0 &= 0XF8;
+}
+
+/*
+ * Description : start the clock of TIMER0 again
+ */
+void SYSTICK_resume(void){
+	/* the TimerClock values of TIMER0 are its CS02:0 bits */
+	TCCR0 |= SYSTICK_CLOCK;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+static void SYSTICK_tick(void){
+
+	uint8 timer;
+
+	g_ticks++;
+
+	for (timer = 0; timer < SYSTICK_TIMERS_NUM; ++timer) {
+		if(g_timers[timer].remaining != 0){
+			g_timers[timer].remaining--;
+			if(g_timers[timer].remaining == 0){
+				/* reload before calling so the call back can restart or stop the timer */
+				g_timers[timer].remaining = g_timers[timer].reload;
+				if(g_timers[timer].callBack != NULL_PTR){
+					(*g_timers[timer].callBack)();
+				}
+			}
+		}
+	}
+}
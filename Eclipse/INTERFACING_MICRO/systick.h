@@ -0,0 +1,103 @@
+/******************************************************************************
+ *
+ * Module: System Tick
+ *
+ * File Name: systick.h
+ *
+ * Description: periodic system tick on TIMER0 (compare mode) with a small table
+ * 				of software timers ,each timer calls its call back (from the
+ * 				TIMER0 ISR) when it expires so the application never has to
+ * 				count timer overflows or wait for them
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef SYSTICK_H_
+#define SYSTICK_H_
+
+#include "micro_config.h"
+#include "std_types.h"
+#include "common_macros.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* time between two ticks */
+#define SYSTICK_PERIOD_MS 2
+
+/* TIMER0 clock and compare value for one tick */
+#if (F_CPU <= 2000000UL)
+#define SYSTICK_CLOCK     F_CPU_8
+#define SYSTICK_PRESCALER 8UL
+#elif (F_CPU <= 8000000UL)
+#define SYSTICK_CLOCK     F_CPU_64
+#define SYSTICK_PRESCALER 64UL
+#else
+#define SYSTICK_CLOCK     F_CPU_256
+#define SYSTICK_PRESCALER 256UL
+#endif
+
+#define SYSTICK_COMPARE_VALUE (((F_CPU/SYSTICK_PRESCALER)*SYSTICK_PERIOD_MS)/1000UL - 1)
+
+#if (SYSTICK_COMPARE_VALUE > 255)
+#error "SYSTICK_PERIOD_MS is too long for TIMER0 at this F_CPU"
+#endif
+
+/* convert a time in milli seconds to number of ticks */
+#define SYSTICK_MS_TO_TICKS(MS) ((uint16)(((MS) + SYSTICK_PERIOD_MS - 1)/SYSTICK_PERIOD_MS))
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* software timers used by the application */
+typedef enum {
+	KEYPAD_TIMER,MESSAGE_TIMER,PIN_TIMER,LOCKOUT_TIMER,POWER_TIMER,ANSWER_TIMER,
+	SYSTICK_TIMERS_NUM
+}SystickTimerId;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description : start TIMER0 in compare mode to generate the system tick
+ */
+void SYSTICK_init(void);
+
+/*
+ * Description : return number of ticks since SYSTICK_init
+ */
+uint32 SYSTICK_getTicks(void);
+
+/*
+ * Description : time in units of SYSTICK_PRESCALER cycles (ticks and the
+ * 	TIMER0 count) ,low 16 bits ,for short intervals measured with the
+ * 	interrupts disabled
+ */
+uint16 SYSTICK_getTimeStamp(void);
+
+/*
+ * Description : start (or restart) a software timer
+ * 	[in] timer : id of the timer
+ * 	[in] ticks : number of ticks until the call back is called
+ * 	[in] periodic : TRUE to reload the timer every time it expires
+ * 	[in] a_ptr : call back (called from the TIMER0 ISR)
+ */
+void SYSTICK_startTimer(SystickTimerId timer,uint16 ticks,uint8 periodic,void(*a_ptr)(void));
+
+/*
+ * Description : stop a software timer without calling its call back
+ */
+void SYSTICK_stopTimer(SystickTimerId timer);
+
+/*
+ * Description : stop and restart the clock of TIMER0 (power down) ,the ticks
+ * 	and the software timers do not count the time in between
+ */
+void SYSTICK_suspend(void);
+void SYSTICK_resume(void);
+
+#endif /* SYSTICK_H_ */
@@ -10,20 +10,22 @@
  *
  *******************************************************************************/
 #include "timers.h"
+#include "counters.h"
 
 /*******************************************************************************
  *                            GLOBAL VARIABLES                    *
  *******************************************************************************/
 
-static volatile void (*g_callBackPtrTimer0)(void) = NULL_PTR;
-static volatile void (*g_callBackPtrTimer1)(void) = NULL_PTR;
-static volatile void (*g_callBackPtrTimer2)(void) = NULL_PTR;
+static void (*volatile g_callBackPtrTimer0)(void) = NULL_PTR;
+static void (*volatile g_callBackPtrTimer1)(void) = NULL_PTR;
+static void (*volatile g_callBackPtrTimer2)(void) = NULL_PTR;
 /*******************************************************************************
  *                       Interrupt Service Routines                            *
  *******************************************************************************/
 
 /*set up call back functions for overflow mode interrupt service routine*/
 ISR(TIMER0_OVF_vect){
+	COUNTERS_INC(COUNTER_ISR_TIMER);
 	if(g_callBackPtrTimer0 != NULL_PTR)
 	{
 		/* Call the Call Back function in the application after the edge is detected */
@@ -31,6 +33,7 @@ ISR(TIMER0_OVF_vect){
 	}
 }
 ISR(TIMER1_OVF_vect){
+	COUNTERS_INC(COUNTER_ISR_TIMER);
 	if(g_callBackPtrTimer1 != NULL_PTR)
 	{
 		/* Call the Call Back function in the application after the edge is detected */
@@ -38,6 +41,7 @@ ISR(TIMER1_OVF_vect){
 	}
 }
 ISR(TIMER2_OVF_vect){
+	COUNTERS_INC(COUNTER_ISR_TIMER);
 	if(g_callBackPtrTimer1 != NULL_PTR)
 	{
 		/* Call the Call Back function in the application after the edge is detected */
@@ -49,6 +53,7 @@ ISR(TIMER2_OVF_vect){
 /*set up call back functions for compare  mode interrupt service routine*/
 
 ISR(TIMER0_COMP_vect){
+	COUNTERS_INC(COUNTER_ISR_TIMER);
 	if(g_callBackPtrTimer0 != NULL_PTR)
 	{
 		/* Call the Call Back function in the application after the edge is detected */
@@ -56,6 +61,7 @@ ISR(TIMER0_COMP_vect){
 	}
 }
 ISR(TIMER1_COMPA_vect){
+	COUNTERS_INC(COUNTER_ISR_TIMER);
 	if(g_callBackPtrTimer1 != NULL_PTR)
 	{
 		/* Call the Call Back function in the application after the edge is detected */
@@ -63,6 +69,7 @@ ISR(TIMER1_COMPA_vect){
 	}
 }
 ISR(TIMER1_COMPB_vect){
+	COUNTERS_INC(COUNTER_ISR_TIMER);
 	if(g_callBackPtrTimer1 != NULL_PTR)
 	{
 		/* Call the Call Back function in the application after the edge is detected */
@@ -70,6 +77,7 @@ ISR(TIMER1_COMPB_vect){
 	}
 }
 ISR(TIMER2_COMP_vect){
+	COUNTERS_INC(COUNTER_ISR_TIMER);
 	if(g_callBackPtrTimer2 != NULL_PTR)
 	{
 		/* Call the Call Back function in the application after the edge is detected */
@@ -82,6 +90,7 @@ ISR(TIMER2_COMP_vect){
 
 ISR(TIMER1_CAPT_vect)
 {
+	COUNTERS_INC(COUNTER_ISR_TIMER);
 	if(g_callBackPtrTimer1 != NULL_PTR)
 	{
 		/* Call the Call Back function in the application after the edge is detected */
@@ -155,7 +164,7 @@ void TIMERS_init(const TimersConfigType* config_ptr,...){
 		/******** getting the second argument compareConfig ******************/
 		TimersCompareModeConfig * compareConfigPtr=NULL_PTR;
 		va_list ap;
-		va_start( ap,1);
+		va_start( ap,config_ptr);
 		compareConfigPtr =va_arg(ap,TimersCompareModeConfig *);
 		va_end(ap);
 		/******************************************************************/
@@ -180,7 +189,7 @@ void TIMERS_init(const TimersConfigType* config_ptr,...){
 		/***************** getting the second argument compareConfig ******************/
 		TimersPwmModeConfig * pwmConfig_Ptr =NULL_PTR;
 		va_list ap;
-		va_start( ap,1);
+		va_start( ap,config_ptr);
 		pwmConfig_Ptr =va_arg(ap,TimersPwmModeConfig *);
 		va_end(ap);
 		/*****************************************************************************/
@@ -206,7 +215,7 @@ void TIMERS_init(const TimersConfigType* config_ptr,...){
 		/***************** getting the second argument compareConfig ******************/
 		TimersIcuConfigType * Icu_Config_Ptr =NULL_PTR;
 		va_list ap;
-		va_start( ap,1);
+		va_start( ap,config_ptr);
 		Icu_Config_Ptr =va_arg(ap,TimersIcuConfigType *);
 		va_end(ap);
 		/*****************************************************************************/
@@ -303,6 +312,50 @@ void TIMERS_clearTimerValue(TimerNum timer){
 
 }
 
+/*function to change the compare value(s) of a running timer in COMPARE or PWM mode
+ * compareValue2 is only used for TIMER1 (OCR1B)*/
+void TIMERS_setCompareValue(TimerNum timer,uint16 compareValue1,uint16 compareValue2){
+
+	switch (timer) {
+	case TIMER0:
+		OCR0 = (uint8)compareValue1;
+		break;
+	case TIMER1:
+		OCR1A = compareValue1;
+		OCR1B = compareValue2;
+		break;
+	case TIMER2:
+		OCR2 = (uint8)compareValue1;
+		break;
+	}
+
+}
+
+/*function to change the mode of OCn (OC1A for TIMER1) of a running timer in
+ * PWM mode ,DISCONNECTED gives the pin back to its PORT bit*/
+void TIMERS_setPwmOutput(TimerNum timer,TimersPwmModeOCnMode mode){
+
+	uint8 bits = 0;
+
+	/* COMn1 ,COMn0 of OC0 ,OC1A and OC2 are at the same place */
+	if(mode == INVERTING){
+		bits = (1<<COM01) | (1<<COM00);
+	}else if(mode == NON_INVERTING){
+		bits = (1<<COM01);
+	}
+	switch (timer) {
+	case TIMER0:
+		TCCR0 = (TCCR0 & ~((1<<COM01) | (1<<COM00))) | bits;
+		break;
+	case TIMER1:
+		TCCR1A = (TCCR1A & ~((1<<COM1A1) | (1<<COM1A0))) | (bits << (COM1A0 - COM00));
+		break;
+	case TIMER2:
+		TCCR2 = (TCCR2 & ~((1<<COM21) | (1<<COM20))) | bits;
+		break;
+	}
+}
+
 void TIMERS_setCallBackTimer0(void(*a_ptr)(void)){
 	g_callBackPtrTimer0 = a_ptr ;
 }
@@ -666,8 +719,11 @@ inline static void TIMER1_Initpwm (const TimersConfigType * config_ptr ,const Ti
 
 	DDRD |= (1<<PD5); //set PD5/OC1A as output pin --> pin where the PWM signal is generated from MC.
 
+	/* OCR1B is loaded even if OC1B pin is disconnected as its compare match
+	 * can still be used as an interrupt or ADC trigger */
+	OCR1B =pwmConfig_Ptr->Timer1_comparevalue2;
+
 	if (pwmConfig_Ptr->Timer1_OC1B_mode!=DISCONNECTED){
-		OCR1B =pwmConfig_Ptr->Timer1_comparevalue2;
 		DDRD |= (1<<PD4); //set PD5/OC1B as output pin --> pin where the PWM signal is generated from MC.
 	}
 
@@ -679,6 +735,8 @@ inline static void TIMER1_Initpwm (const TimersConfigType * config_ptr ,const Ti
 	 */
 	switch (pwmConfig_Ptr->OCn_Mode) {
 		case DISCONNECTED:
+			/* COM1A1=0 & COM1A0=0 ,OC1A follows its PORT bit */
+			TCCR1A = (1<<WGM11) ;
 			break;
 		case INVERTING:
 			/* COM1A1=1 & COM1A0=1  */
@@ -4,6 +4,33 @@
  *Created on: Dec 17, 2020
  *
  *Description: main  file for the MC1
+ *			   the work is done by tasks of the cooperative scheduler:
+ *			   LINK_TASK    : protocol with the HMI micros (MC2) on the bus
+ *			                  (bus.h) ,every node has its own session : its
+ *			                  system state and where its exchange is
+ *			   GATE_TASK    : motor sequence of opening/closing the gate ,the
+ *			                  progress of every gate state is sent to the
+ *			                  nodes waiting for the gate (progress bar)
+ *			   STORAGE_TASK : writes the password ,the wrong passwords counter
+ *			                  ,the gate profile and the pages of the user table
+ *			                  to the EEPROM in the back ground
+ *			   the password itself is never stored ,only a random salt and the
+ *			   SipHash of the password keyed by that salt (siphash.h)
+ *			   every password to check is first counted as wrong in the EEPROM
+ *			   ,it is checked (and the counter cleared if it is right) when
+ *			   that write cycle is over
+ *			   the system states and the gate sequence are table driven state
+ *			   machines (fsm.h) ,their tables are at the top of this file
+ *			   the gate ,the alarm and the password are shared by the nodes :
+ *			   a lock out holds for all of them and the gate states are sent
+ *			   to every node waiting for the gate
+ *			   a node logged in with the password of the system may stream the
+ *			   table of the users (user_table.h) ,a page per M_READY sent by
+ *			   MC1 ,every page is written in one EEPROM write cycle and read
+ *			   back ,the users log in like the password but can not change it
+ *			   the times of the gate ,the siren and the speed of the motor are
+ *			   the profile of the EEPROM (gate_config.h) ,loaded at boot and
+ *			   changed by a node logged in with the password of the system
  *
  * Author: Ahmed Emad
  */
@@ -11,99 +38,513 @@
 
 #include "i2c.h"
 #include "uart.h"
+#include "bus.h"
 #include "timers.h"
 #include "external_eeprom.h"
 #include "buzzer.h"
 #include "motor.h"
+#include "current_sense.h"
+#include "systick.h"
+#include "scheduler.h"
+#include "fsm.h"
+#include "system_states.h"
+#include "trace.h"
+#include "counters.h"
+#include "siphash.h"
+#include "user_table.h"
+#include "gate_config.h"
+#include <avr/pgmspace.h>
 
 
 /*******************************************************************************
  *                      Preprocessor Macros                                    *
  *******************************************************************************/
 
-/*Constant value between the 2 micros to indicate that
- *the micro ready to receive information from UART*/
-#define M_READY 0XFF
-
 /*Specific value to check if that first time
  *for the system or  at was  initialized
- *stored in the external EEPROM */
-#define PREVIOUS_LOGIN_INDICATOR 0XAA
+ *stored in the external EEPROM ,it also tells which slot holds the salt and
+ *the digest (PREVIOUS_LOGIN_INDICATOR : PASSWORD_ADDRESS ,
+ *PREVIOUS_LOGIN_INDICATOR_SLOT1 : PASSWORD_SLOT1_ADDRESS)*/
+#define PREVIOUS_LOGIN_INDICATOR 0XAB
+#define PREVIOUS_LOGIN_INDICATOR_SLOT1 0XAC
+/*indicator of the old images where the password was stored as plain text
+ *,they are converted to a salted digest at boot*/
+#define PLAIN_PASSWORD_INDICATOR 0XAA
 /*the address where PREVIOUS_LOGIN_INDICATOR is stored in the external EEPROM*/
 #define PREVIOUS_LOGIN_INDICATOR_ADDRESS 0X0001
 
-/*address where password will be stored*/
+/*addresses of the 2 slots of the salt and the digest ,a new password is
+ *written to the slot not used then the indicator is changed (one byte) ,a
+ *power cut before leaves the old password*/
 #define PASSWORD_ADDRESS 0X0002
+#define PASSWORD_SLOT1_ADDRESS 0X07E0
+
+/*number of wrong passwords in a row that turns on the alarm*/
+#define MAX_FAIL_TRIALS 3
+
+/*wrong passwords in a row ,one bit cleared per wrong password (unary) :
+ *counting up only clears bits so the count never goes back ,and the writes
+ *are spread over the bytes (8 counts per byte) ,every wrong password is
+ *still one byte write and one full write cycle of the M24C16*/
+#define FAIL_COUNTER_ADDRESS 0X0020
+#define FAIL_COUNTER_BYTES 4
+#define FAIL_COUNT_MAX (FAIL_COUNTER_BYTES*8)
+
+/*lock out time after MAX_FAIL_TRIALS wrong passwords ,doubled by every
+ *other wrong password up to LOCKOUT_MAX_S*/
+#define LOCKOUT_BASE_S 30
+#define LOCKOUT_MAX_S 3600
+
+/*time the motor current must stay above the stall level to stop the gate*/
+#define GATE_STALL_TRIP_MS 100
+
+/*stalls of one gate sequence ,the last one leaves the gate blocked*/
+#define GATE_STALLS_MAX 3
+
+/*PWM frequency of the motor enable pin (the duty cycle is in the gate profile)*/
+#define GATE_MOTOR_PWM_FREQUENCY 500
+
+/*the second slot is after the user table ,in the M24C16 (2 KB)*/
+#if (PASSWORD_SLOT1_ADDRESS < USER_TABLE_KEY_ADDRESS + USER_TABLE_PAGES * EEPROM_PAGE_SIZE || \
+		PASSWORD_SLOT1_ADDRESS + SIPHASH_KEY_SIZE + SIPHASH_TAG_SIZE > 0X0800)
+#error "the second slot of the password must be between the user table and the end of the EEPROM"
+#endif
+
+/*the gate profile is read in the same burst as the persistent state*/
+#if (GATE_CONFIG_ADDRESS != FAIL_COUNTER_ADDRESS + FAIL_COUNTER_BYTES)
+#error "the gate profile must follow the wrong passwords counter"
+#endif
+
+/*time between two bytes written to the EEPROM (write cycle of the M24C16)*/
+#define EEPROM_WRITE_CYCLE_MS 10
+
+/*reads of the persistent state before it is taken as lost*/
+#define EEPROM_READ_TRIES 3
+
+/*cycles of a password check are traced in units of 256 cycles*/
+#define PASSWORD_CYCLES_SHIFT 8
+
+/*boot time stamps are traced in units of 256 cycles since SYSTICK_init*/
+#define BOOT_CYCLES_SHIFT 8
 
-/*specific values to inform if password are correct or not */
-#define CORRECT_PASSWORD 0XCC
-#define WRONG_PASSWORD   0XBB
+/*storage task progress after the last password byte*/
+#define STORAGE_WRITE_INDICATOR 0XFE
+#define STORAGE_IDLE 0XFF
 
-/*indicator if the function success or fails to do the task*/
-#define SUCCESS 1
-#define FAILURE 0
+/*pages of the user table received before they are stored (one is written
+ *while the next arrives) and longest time between two pages of a stream*/
+#define PROVISION_BUFFERS 2
+#define PROVISION_TIMEOUT_MS 2000
+
+/*the link must be within the error the UART tolerates at this F_CPU*/
+#if (UART_BAUD_ERROR(LINK_BAUD) > UART_BAUD_ERROR_MAX)
+#error "LINK_BAUD is too far from the baud rates of the UART at this F_CPU"
+#endif
 
 
 /*******************************************************************************
  *                         Types Declaration                                   *
  *******************************************************************************/
-/* declaring  the states of the system*/
-typedef enum {
-	NEW_PASSWORD,CHECK_PASSWORD_TO_LOG_IN,CHECK_PASSWORD_FOR_NEW_PASSWORD,VIEW_OPTIONS,OPENING_GATE,BUZZER_ON
-}SystemState;
-
-/*Options the user can choose from*/
-typedef enum{
-	OPEN_GATE_OPTION,CREATE_NEW_PASSWORD
-}options;
 
-/*ENUM to hold gate state*/
+/*events posted to the tasks*/
 typedef enum {
-	CLOSED,GATE_OPENING,OPENED,GATE_CLOSING
-}GateStatus;
-/*******************************************************************************
- *                           Global Variables                                  *
- *******************************************************************************/
-/*global variable to hold the system state*/
-static  volatile uint8 g_systemState;
+	EV_UART_RX,EV_BUS_NODE,EV_ALARM_TIMEOUT,EV_GATE_DONE,     /*LINK_TASK*/
+	EV_PAGE_STORED,EV_PROVISION_TIMEOUT,EV_FAIL_COUNT_STORED, /*LINK_TASK*/
+	EV_GATE_START,EV_HMI_READY,EV_GATE_TIMEOUT,EV_GATE_STALL, /*GATE_TASK*/
+	EV_GATE_PROGRESS,                                         /*GATE_TASK*/
+	EV_STORE_PASSWORD,EV_STORE_FAIL_COUNT,EV_STORAGE_NEXT,    /*STORAGE_TASK*/
+	EV_CONVERT_PASSWORD,EV_STORE_PAGE,EV_LOAD_USERS,          /*STORAGE_TASK*/
+	EV_STORE_CONFIG                                           /*STORAGE_TASK*/
+}SystemEvent;
+
+/*events of the system state machine*/
+typedef enum {
+	SYS_EV_PASSWORD_RECEIVED,SYS_EV_PASSWORD_CORRECT,SYS_EV_TOO_MANY_TRIALS,
+	SYS_EV_OPTION_RECEIVED,SYS_EV_GATE_OPTION,SYS_EV_NEW_PASSWORD_OPTION,
+	SYS_EV_GATE_DONE,SYS_EV_ALARM_TIMEOUT,SYS_EVENTS_NUM
+}SystemFsmEvent;
 
-/*string to hold the password of the system*/
-uint8 g_password[7];
+/*events of the gate state machine*/
+typedef enum {
+	GATE_EV_START,GATE_EV_HMI_READY,GATE_EV_PHASE_END,GATE_EV_NEXT,GATE_EV_STALL,
+	GATE_EV_BLOCKED,GATE_EVENTS_NUM
+}GateFsmEvent;
 
-/*indicator for gate state at open gate option*/
-static  volatile uint8 g_gateStatus=CLOSED;
+/*what the link task is waiting for from MC2*/
+typedef enum {
+	LINK_WAIT_READY,LINK_RECEIVE_PASSWORD,LINK_RECEIVE_OPTION,LINK_WAIT_RESULT_READY,LINK_GATE,LINK_ALARM,
+	LINK_PROVISION,LINK_CONFIG
+}LinkState;
+
+/*session of a node of the bus*/
+typedef struct {
+	FsmType system;         /*system state machine of the node*/
+	uint8 node;
+	uint8 linkState;        /*what is expected from the node*/
+	uint8 hmiReady;         /*the node sent M_READY and still waits for the answer*/
+	uint8 passwordResult;   /*result of its last password check*/
+	uint8 checkPending;     /*its password is counted as wrong ,checked once the counter is stored*/
+	uint8 admin;            /*logged in with the password of the system (not as a user)*/
+	uint8 receivedLength;
+	uint8 receivedPassword[PASSWORD_MAX_LENGTH + 1];
+}LinkSessionType;
+
+/*EEPROM image of the password at PASSWORD_ADDRESS*/
+typedef struct {
+	uint8 salt[SIPHASH_KEY_SIZE];
+	uint8 tag[SIPHASH_TAG_SIZE];
+}CredentialType;
+
+/*EEPROM image of all the persistent state from PREVIOUS_LOGIN_INDICATOR_ADDRESS
+ *to the end of the gate profile ,read in one burst at boot*/
+typedef struct {
+	uint8 indicator;
+	CredentialType credential;
+	uint8 unused[FAIL_COUNTER_ADDRESS - PASSWORD_ADDRESS - sizeof(CredentialType)];
+	uint8 failBytes[FAIL_COUNTER_BYTES];
+	uint8 config[GATE_CONFIG_SIZE];
+}PersistentImageType;
 
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 
 /*
- *  Description :1.receives the password from micro2
- *               2. checks if its corrects
- *               3.if correct view options
- *               4.if wrong 3 times it will turn on the buzzer
+ *  Description :transition action checking the password received from micro2
+ *               returns SYS_EV_PASSWORD_CORRECT ,SYS_EV_TOO_MANY_TRIALS after
+ *               3 wrong passwords or FSM_NO_EVENT
  */
-uint8 checkPassword(void);
+static uint8 checkPassword(uint8 data);
+
+/*Description : transition action keeping the new password and storing it in the EEPROM*/
+static uint8 storePassword(uint8 data);
+
+/*Description : new salt and digest of a password ,stored in the back ground*/
+static void saveCredential(const uint8 * password,uint8 length);
+
+/*Description : read all the persistent state from the EEPROM in one burst
+ * (credential ,wrong passwords counter and gate profile) ,return the
+ * indicator byte*/
+static uint8 loadPersistentState(void);
+
+/*Description : load the persistent state and start the system state machine
+ * of every node in the state it tells ,locked out if it can not be read (it
+ * is never taken as the first boot) ,return the state*/
+static uint8 startSystem(void);
+
+/*Description : convert an old image with a plain text password to a digest*/
+static void convertPlainPassword(void);
+
+/*Description : transition action returning the event of the option received*/
+static uint8 optionReceived(uint8 data);
+
+/*Description : entry action of OPENING_GATE ,start the gate task*/
+static void gateStart(void);
+
+/*Description : entry action of BUZZER_ON ,lock out the log in
+ * 1.start counting down the lock out time of the wrong passwords counter
+ * 2.start the siren pattern of the buzzer (for the siren time of the gate
+ *   profile at most)
+ * 3.when the time finishes the system returns to log in */
+static void alarmOn(void);
+
+/*Description : exit action of BUZZER_ON ,TURN OFF THE BUZZER */
+static void alarmOff(void);
+
+/*Description : transition actions of the gate state machine*/
+static uint8 gateInit(uint8 data);
+static uint8 gateHmiReady(uint8 data);
+static uint8 gatePhaseEnd(uint8 data);
+static uint8 gateFinish(uint8 data);
+static uint8 gateStalled(uint8 data);
+static uint8 gateBlocked(uint8 data);
+
+/*Description : entry actions of the gate states ,send the gate state to MC2
+ * and start the movement (or holding) of the gate ,CLOSED and GATE_BLOCKED
+ * only send it*/
+static void gateOpeningEntry(void);
+static void gateOpenedEntry(void);
+static void gateClosingEntry(void);
+static void gateObstructedEntry(void);
+
+/*Description : tasks of the scheduler*/
+static void linkTask(uint8 event,uint8 data);
+static void gateTask(uint8 event,uint8 data);
+static void storageTask(uint8 event,uint8 data);
+
+/*Description : link task handling of a byte received from the node of the session*/
+static void linkReceive(uint8 data);
+
+/*Description : answer M_READY of the node by its system state and start its work*/
+static void linkAnswerReady(void);
+
+/*Description : send a byte to the node of the session*/
+static void linkSend(uint8 data);
+
+/*Description : send the result of the password of the node of the session
+ * (it is ready for it)*/
+static void linkSendResult(void);
+
+/*Description : every node in OPENING_GATE is waiting for the next gate state*/
+static uint8 linkGateReady(void);
+
+/*Description : seconds left of the lock out (0 : no lock out)*/
+static uint16 lockoutLeft(void);
+
+/*Description : lock out time of a number of wrong passwords in a row*/
+static uint16 lockoutSeconds(uint8 failCount);
+
+/*Description : count one more wrong password (or clear the counter) and
+ * write it to the EEPROM in the back ground*/
+static void setFailCount(uint8 failCount);
+
+/*Description : trace a boot time stamp (cycles since SYSTICK_init)*/
+static void traceBootTime(TraceEventId id);
+
+/*Description : option PROVISION_USERS of the node of the session ,start a
+ * stream of the user table or refuse it*/
+static void linkProvisionStart(void);
+
+/*Description : a byte of the user table stream ,a full page is stored by the
+ * storage task*/
+static void linkProvisionReceive(uint8 data);
+
+/*Description : end the stream of the user table ,answer the node by the result*/
+static void linkProvisionEnd(uint8 result);
+
+/*Description : option GATE_CONFIG of the node of the session ,wait for the
+ * gate profile or refuse it*/
+static void linkConfigStart(void);
+
+/*Description : a byte of the gate profile ,a complete one is used if it is
+ * valid and stored by the storage task*/
+static void linkConfigReceive(uint8 data);
+
+/*Description : end the gate profile ,answer the node by the result*/
+static void linkConfigEnd(uint8 result);
 
-/*Description : function to turn on buzzer for 10 seconds
- * 1.turn on timer for 10 seconds
- * 2.turn on buzzer
- * 3.after 10 seconds deinit timer and off the buzzer
- * 4.return to log in */
-inline static void alarmOn(void);
+/*Description : write one byte of the wrong passwords counter that differs
+ * from the EEPROM ,return FALSE if the EEPROM is up to date*/
+static uint8 storageFailCountStep(void);
 
-/*Description : function to open gate
- * 1. turn on motor clockwise for 2 seconds
- * 2. hold it for  */
+/*Description : write the next part of the salt and the digest (a page at
+ * most) or the indicator ,return FALSE if they are all written*/
+static uint8 storageCredentialStep(void);
 
-inline static void openGate(void);
+/*Description : write the gate profile received ,return FALSE if there is
+ * nothing to write*/
+static uint8 storageConfigStep(void);
 
-/*ISR call back function to return system back in log in mode */
-void changeSystemState(void);
+/*Description : write the user table flag or the next page received ,return
+ * FALSE if there is nothing to write*/
+static uint8 storageUsersStep(void);
 
+/*Description : read back the page written by the last write cycle and tell
+ * the link task*/
+static void storageVerifyPage(void);
 
-/*Description :ISR function to count 15 seconds then change gate state*/
+/*Description : read the user table flag and key (after the boot)*/
+static void storageLoadUsers(void);
+
+/*Description : start the gate timer for the current gate state and the
+ * timer of its progress*/
+static void gateStartTimer(uint16 ticks);
+
+/*Description : send the progress of the gate state to the nodes waiting for
+ * the gate if its steps changed*/
+static void gateSendProgress(void);
+
+/*Description : send the gate state to MC2 (it was ready for it)*/
+static void gateSendStatus(void);
+
+/*Description : dispatch an event to the system (gate) state machine and
+ * trace the new state*/
+static void systemDispatch(uint8 event,uint8 data);
+static void gateDispatch(uint8 event,uint8 data);
+
+/*ISR call back functions posting the events to the tasks */
+void busReceived(uint8 node,uint8 data);
+void alarmSecond(void);
 void changeGateState(void);
+void gateProgress(void);
+void gateObstructed(void);
+void storageTimeout(void);
+void provisionTimeout(void);
+
+/*******************************************************************************
+ *                      State Machines Tables (flash)                          *
+ *******************************************************************************/
+
+/*transitions of the system states [SystemState][SystemFsmEvent]*/
+static const FsmTransition g_systemTransitions[SYSTEM_STATES_NUM][SYS_EVENTS_NUM] PROGMEM = {
+		/*NEW_PASSWORD*/
+		{{VIEW_OPTIONS,storePassword},FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,FSM_IGNORE},
+		/*CHECK_PASSWORD_TO_LOG_IN*/
+		{{FSM_NO_CHANGE,checkPassword},{VIEW_OPTIONS,NULL_PTR},{BUZZER_ON,NULL_PTR},
+		 FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,FSM_IGNORE},
+		/*CHECK_PASSWORD_FOR_NEW_PASSWORD*/
+		{{FSM_NO_CHANGE,checkPassword},{NEW_PASSWORD,NULL_PTR},{BUZZER_ON,NULL_PTR},
+		 FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,FSM_IGNORE},
+		/*VIEW_OPTIONS*/
+		{FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 {FSM_NO_CHANGE,optionReceived},{OPENING_GATE,NULL_PTR},{CHECK_PASSWORD_FOR_NEW_PASSWORD,NULL_PTR},
+		 FSM_IGNORE,FSM_IGNORE},
+		/*OPENING_GATE*/
+		{FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 {VIEW_OPTIONS,NULL_PTR},FSM_IGNORE},
+		/*BUZZER_ON*/
+		{FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,FSM_IGNORE,FSM_IGNORE,
+		 FSM_IGNORE,{CHECK_PASSWORD_TO_LOG_IN,NULL_PTR}}
+};
+
+/*entry and exit actions of the system states*/
+static const FsmStateActions g_systemStateActions[SYSTEM_STATES_NUM] PROGMEM = {
+		{NULL_PTR,NULL_PTR},  /*NEW_PASSWORD*/
+		{NULL_PTR,NULL_PTR},  /*CHECK_PASSWORD_TO_LOG_IN*/
+		{NULL_PTR,NULL_PTR},  /*CHECK_PASSWORD_FOR_NEW_PASSWORD*/
+		{NULL_PTR,NULL_PTR},  /*VIEW_OPTIONS*/
+		{gateStart,NULL_PTR}, /*OPENING_GATE*/
+		{alarmOn,alarmOff}    /*BUZZER_ON*/
+};
+
+/*what the link task waits for after sending the system state [SystemState]*/
+static const uint8 g_linkStates[SYSTEM_STATES_NUM] PROGMEM = {
+		LINK_RECEIVE_PASSWORD,LINK_RECEIVE_PASSWORD,LINK_RECEIVE_PASSWORD,
+		LINK_RECEIVE_OPTION,LINK_GATE,LINK_ALARM
+};
+
+/*transitions of the gate [GateStatus][GateFsmEvent]*/
+static const FsmTransition g_gateTransitions[GATE_STATES_NUM][GATE_EVENTS_NUM] PROGMEM = {
+		/*CLOSED*/
+		{{FSM_NO_CHANGE,gateInit},{FSM_NO_CHANGE,gateHmiReady},FSM_IGNORE,{GATE_OPENING,NULL_PTR},
+		 FSM_IGNORE,FSM_IGNORE},
+		/*GATE_OPENING*/
+		{FSM_IGNORE,{FSM_NO_CHANGE,gateHmiReady},{FSM_NO_CHANGE,gatePhaseEnd},{OPENED,NULL_PTR},
+		 {GATE_OBSTRUCTED,gateStalled},{GATE_BLOCKED,gateBlocked}},
+		/*OPENED*/
+		{FSM_IGNORE,{FSM_NO_CHANGE,gateHmiReady},{FSM_NO_CHANGE,gatePhaseEnd},{GATE_CLOSING,NULL_PTR},
+		 FSM_IGNORE,FSM_IGNORE},
+		/*GATE_CLOSING ,a stall is never taken as the end of the closing time*/
+		{FSM_IGNORE,FSM_IGNORE,{CLOSED,gateFinish},FSM_IGNORE,
+		 {GATE_OBSTRUCTED,gateStalled},{GATE_BLOCKED,gateBlocked}},
+		/*GATE_OBSTRUCTED ,close again after the holding time*/
+		{FSM_IGNORE,{FSM_NO_CHANGE,gateHmiReady},{FSM_NO_CHANGE,gatePhaseEnd},{GATE_CLOSING,NULL_PTR},
+		 FSM_IGNORE,FSM_IGNORE},
+		/*GATE_BLOCKED ,a new sequence starts like from CLOSED*/
+		{{FSM_NO_CHANGE,gateInit},{FSM_NO_CHANGE,gateHmiReady},FSM_IGNORE,{GATE_OPENING,NULL_PTR},
+		 FSM_IGNORE,FSM_IGNORE}
+};
+
+/*entry and exit actions of the gate states*/
+static const FsmStateActions g_gateStateActions[GATE_STATES_NUM] PROGMEM = {
+		{gateSendStatus,NULL_PTR},      /*CLOSED*/
+		{gateOpeningEntry,NULL_PTR},    /*GATE_OPENING*/
+		{gateOpenedEntry,NULL_PTR},     /*OPENED*/
+		{gateClosingEntry,NULL_PTR},    /*GATE_CLOSING*/
+		{gateObstructedEntry,NULL_PTR}, /*GATE_OBSTRUCTED*/
+		{gateSendStatus,NULL_PTR}       /*GATE_BLOCKED*/
+};
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+/*sessions of the nodes (node address - 1) and the session served now (its
+ * node sent the byte handled by the link task ,or it is answered)*/
+static LinkSessionType g_sessions[BUS_NODES_MAX];
+static LinkSessionType * g_session = &g_sessions[0];
+
+/*node of the bytes received (last EV_BUS_NODE) and the last node posted*/
+static uint8 g_rxNode = BUS_NO_CONVERSATION;
+static volatile uint8 g_postedNode = BUS_NO_CONVERSATION;
+
+/*state machine of the gate*/
+static FsmType g_gateFsm = {&g_gateTransitions[0][0],g_gateStateActions,GATE_EVENTS_NUM,CLOSED};
+
+/*salt and digest of the password of the system (the EEPROM image)*/
+static CredentialType g_credential;
+
+/*slot of the EEPROM holding g_credential (0 : PASSWORD_ADDRESS ,1 :
+ * PASSWORD_SLOT1_ADDRESS) ,the new one is written to the other*/
+static uint8 g_credentialSlot = 0;
+
+/*a password is stored (the first time set up is done)*/
+static uint8 g_initialized = FALSE;
+
+/*the persistent state could not be read ,the nodes are locked out until it is*/
+static uint8 g_stateLost = FALSE;
+
+/*a node got its first answer since the boot*/
+static uint8 g_linked = FALSE;
+
+/*wrong passwords in a row (kept in the EEPROM) and the bytes of its
+ * unary encoding as they are in the EEPROM*/
+static uint8 g_failCount = 0;
+static uint8 g_failBytes[FAIL_COUNTER_BYTES];
+
+/*passwords counted as wrong and not checked yet ,the link task waits for
+ * the counter to be in the EEPROM*/
+static uint8 g_checksPending = 0;
+static uint8 g_failCountWaited = FALSE;
+
+/*seconds left of the lock out and seconds of siren left (TIMER0 ISR)*/
+static volatile uint16 g_lockoutSeconds;
+static volatile uint8 g_sirenSeconds;
+
+/*the time (or movement) of the current gate state finished*/
+static  uint8 g_gatePhaseDone = FALSE;
+
+/*stalls of the current gate sequence*/
+static uint8 g_gateStalls;
+
+/*ticks of the current gate state ,ticks passed (counted by the progress
+ * timer) ,its period and the progress steps sent*/
+static uint16 g_gateTicks;
+static uint16 g_gateElapsed;
+static uint16 g_gateProgressPeriod;
+static uint8 g_gateSteps;
+
+/*index of the next password byte to write to the EEPROM*/
+static uint8 g_storageIndex = STORAGE_IDLE;
+
+/*an EEPROM write cycle is running*/
+static uint8 g_storageBusy = FALSE;
+
+/*key of the user table (its first page) and the table is used for the log in*/
+static uint8 g_userKey[SIPHASH_KEY_SIZE];
+static uint8 g_usersValid = FALSE;
+
+/*the user table flag in the EEPROM differs from g_usersValid*/
+static uint8 g_usersFlagPending = FALSE;
+
+/*session streaming the user table (NULL_PTR : no stream) ,pages received
+ * and bytes of the page being received ,pages read back (wrong ones too)*/
+static LinkSessionType * g_provisionSession = NULL_PTR;
+static uint8 g_pages[PROVISION_BUFFERS][EEPROM_PAGE_SIZE];
+static uint8 g_pageFill;
+static uint8 g_pagesReceived;
+static uint8 g_pagesStored;
+static uint8 g_pagesWrong;
+
+/*the last write cycle of the storage task was a page to read back*/
+static uint8 g_pageWritten = FALSE;
+
+/*timing profile of the gate (in system ticks) and duty cycle of the motor*/
+static GateConfigType g_gateConfig;
+
+/*session sending a gate profile (NULL_PTR : none) ,the profile being
+ * received and its bytes ,the profile used (written to the EEPROM while
+ * pending)*/
+static LinkSessionType * g_configSession = NULL_PTR;
+static uint8 g_configReceived[GATE_CONFIG_SIZE];
+static uint8 g_configFill;
+static uint8 g_configImage[GATE_CONFIG_SIZE];
+static uint8 g_configPending = FALSE;
 
 
 
@@ -112,326 +553,1169 @@ void changeGateState(void);
 
 int main (){
 
-	/*variable to hold the history byte to check over if this first time*/
-	uint8 logInHistory;
-	/*to hold the option entered from user*/
-	uint8 option;
+	uint8 initialState;
+	uint8 i;
+
+	/*system state machine of a session*/
+	const FsmType s_systemFsm = {&g_systemTransitions[0][0],g_systemStateActions,SYS_EVENTS_NUM,NEW_PASSWORD};
 
-	/*configure the BUZZER PIN as an output pin PA0*/
 	/*configure the MOTOR PIN as an output pin ,PA0,PA1*/
-	DDRA |= 0X07;
+	DDRA |= 0X03;
+
+	/*the analog comparator (on after reset) is not used ,the ADC ,TIMER1 and
+	 * TIMER2 are on only while the gate moves or the buzzer plays*/
+	ACSR = (1<<ACD);
 
-	/*defining variable to hold the the configuration of  UART*/
-	UartConfigType s_uartConfig ={9600,ASYNCHRONOUS_DOUBLE_SPEED_MODE,8,1,NO_PARITY,0,0,0 };
+	/*defining variable to hold the the configuration of  UART with receive interrupt*/
+	UartConfigType s_uartConfig ={LINK_BAUD,UART_OPERATING_MODE(LINK_BAUD),9,1,NO_PARITY,1,0,0 };
 
-	/*initialize and configure the UART driver*/
+	/*initialize and configure the UART driver ,MC1 is the controller of the
+	 * bus and receives the frames of all the nodes*/
 	UART_init(&s_uartConfig);
+	BUS_init(BUS_CONTROLLER);
+	BUS_setCallBack(busReceived);
+
+	/*start the system tick used for the gate ,alarm ,buzzer and EEPROM timing
+	 * (before the system states ,the lock out may start at boot)*/
+	SYSTICK_init();
 
+	/*configure the BUZZER PIN (OC2) ,silent*/
+	BUZZER_init();
+
+	/*fill the task table (the start of the system may post to the storage task)*/
+	SCHEDULER_init();
+	SCHEDULER_addTask(LINK_TASK,linkTask);
+	SCHEDULER_addTask(GATE_TASK,gateTask);
+	SCHEDULER_addTask(STORAGE_TASK,storageTask);
 
 	/*initialize EEPROM*/
 	EEPROM_init();
-	/*read the log in history byte to check over if this first time*/
-	EEPROM_readByte(PREVIOUS_LOGIN_INDICATOR_ADDRESS, &logInHistory);
+	for (i = 0; i < BUS_NODES_MAX; ++i) {
+		g_sessions[i].system = s_systemFsm;
+		g_sessions[i].node = i + 1;
+	}
+	/*fast boot : the log in history byte ,the salt ,the digest and the
+	 * counter are read in one burst ,the HMI may already wait for the state*/
+	initialState = startSystem();
+	FSM_start(&g_gateFsm,CLOSED);
+	TRACE(TRACE_BOOT,initialState);
+
+	/*the users are not needed to answer the HMI either*/
+	SCHEDULER_post(STORAGE_TASK,EV_LOAD_USERS,0);
+	/*the TWI is on only during a transfer*/
+	TWI_disable();
+	traceBootTime(TRACE_BOOT_READY);
+
+	/* Enable Global Interrupt I-Bit */
+	SREG |= (1<<7);
+
+	/*run the tasks for ever*/
+	SCHEDULER_run();
+
+}
+
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
 
+/*
+ *  Description :transition action checking the password received from micro2
+ *               returns SYS_EV_PASSWORD_CORRECT ,SYS_EV_TOO_MANY_TRIALS after
+ *               3 wrong passwords or FSM_NO_EVENT
+ */
+static uint8 checkPassword(uint8 data){
+
+	uint8 tag[SIPHASH_TAG_SIZE];
+	uint8 match;
+	uint32 cycles = SYSTICK_getCycles();
+
+	/*a lock out started from another node holds for this one ,the password
+	 * is not checked*/
+	if(lockoutLeft()!=0){
+		g_session->passwordResult = WRONG_PASSWORD;
+		g_session->admin = FALSE;
+		return SYS_EV_TOO_MANY_TRIALS;
+	}
+
+	/*the digest is always computed and compared completely so the time
+	 * of the check does not tell how much of the password was right*/
+	SIPHASH_hash(g_credential.salt,g_session->receivedPassword,g_session->receivedLength,tag);
+	match = SIPHASH_equal(tag,g_credential.tag);
+	g_session->admin = match;
+
+	/*a user may log in but not change the password*/
+	if(!match && g_usersValid && FSM_getState(&g_session->system)==CHECK_PASSWORD_TO_LOG_IN){
+		match = USER_TABLE_find(g_userKey,g_session->receivedPassword,g_session->receivedLength);
+		TWI_disable();
+	}
+
+	/*cost of the check (login latency budget ,see trace_decode)*/
+	cycles = (SYSTICK_getCycles() - cycles) >> PASSWORD_CYCLES_SHIFT;
+	TRACE(TRACE_PASSWORD_CYCLES,(cycles > 0XFF) ? 0XFF : cycles);
+
+	if(!match){
+		/*already counted (and stored) before the check*/
+		g_session->passwordResult = WRONG_PASSWORD;
+		TRACE(TRACE_PASSWORD_WRONG,g_failCount);
+		/*go to state of the buzzer if the user enter the password wrong
+		 * 3 times ,after a lock out every wrong password locks out again*/
+		if(g_failCount>=MAX_FAIL_TRIALS){
+			return SYS_EV_TOO_MANY_TRIALS;
+		}
+		return FSM_NO_EVENT;
+	}
+	/*the password is  right*/
+	/*clear the counter for the coming log in ,but for the passwords of the
+	 * other nodes not checked yet*/
+	setFailCount(g_checksPending);
+	g_session->passwordResult = CORRECT_PASSWORD;
+	TRACE(TRACE_PASSWORD_OK,0);
+	return SYS_EV_PASSWORD_CORRECT;
+}
+
+/*Description : transition action keeping the new password and storing it in the EEPROM*/
+static uint8 storePassword(uint8 data){
+
+	uint8 i;
+
+	/*keep only its digest with a new salt and store them in the back ground*/
+	saveCredential(g_session->receivedPassword,g_session->receivedLength);
+	g_session->admin = TRUE;
+
+	/*confirmed when the node is ready for the result*/
+	g_session->passwordResult = CORRECT_PASSWORD;
+
+	/*the first password is set up from one node ,the others must log in ,a
+	 * node already waiting for its new password is told to ask for the
+	 * state again (the bytes it sends until then are not a password)*/
+	if(!g_initialized){
+		g_initialized = TRUE;
+		for (i = 0; i < BUS_NODES_MAX; ++i) {
+			if(&g_sessions[i]!=g_session && FSM_getState(&g_sessions[i].system)==NEW_PASSWORD){
+				FSM_start(&g_sessions[i].system,CHECK_PASSWORD_TO_LOG_IN);
+				g_sessions[i].hmiReady = FALSE;
+				if(g_sessions[i].linkState!=LINK_WAIT_READY){
+					g_sessions[i].linkState = LINK_WAIT_READY;
+					BUS_sendByte(g_sessions[i].node,STATE_CHANGED);
+				}
+			}
+		}
+	}
+	return FSM_NO_EVENT;
+}
+
+/*Description : new salt and digest of a password ,written to the EEPROM by
+ * the storage task*/
+static void saveCredential(const uint8 * password,uint8 length){
+
+	uint8 key[SIPHASH_KEY_SIZE];
+	uint8 seed[5];
+	uint32 cycles = SYSTICK_getCycles();
+	uint8 i;
+
+	/*the salt is the hash of the time the password arrived (the typing of
+	 * the user) keyed by the previous salt ,each half with its own index*/
+	for (i = 0; i < SIPHASH_KEY_SIZE; ++i) {
+		key[i] = g_credential.salt[i];
+	}
+	for (i = 0; i < 4; ++i) {
+		seed[i] = (uint8)(cycles >> (8*i));
+	}
+	for (i = 0; i < SIPHASH_KEY_SIZE/SIPHASH_TAG_SIZE; ++i) {
+		seed[4] = i;
+		SIPHASH_hash(key,seed,sizeof(seed),&g_credential.salt[i*SIPHASH_TAG_SIZE]);
+	}
+
+	SIPHASH_hash(g_credential.salt,password,length,g_credential.tag);
+	SCHEDULER_post(STORAGE_TASK,EV_STORE_PASSWORD,0);
+}
+
+/*Description : read all the persistent state from the EEPROM in one burst*/
+static uint8 loadPersistentState(void){
+
+	PersistentImageType image;
+	uint8 i,bit,tries;
+
+	/*one address phase instead of one per byte (one more if the password
+	 * was written to the second slot) ,a failed read is tried again*/
+	for (tries = 0; tries < EEPROM_READ_TRIES; ++tries) {
+		if(EEPROM_readBytes(PREVIOUS_LOGIN_INDICATOR_ADDRESS,(uint8 *)&image,sizeof(PersistentImageType)) &&
+				(image.indicator!=PREVIOUS_LOGIN_INDICATOR_SLOT1 ||
+				 EEPROM_readBytes(PASSWORD_SLOT1_ADDRESS,(uint8 *)&image.credential,sizeof(CredentialType)))){
+			break;
+		}
+	}
+	g_stateLost = (tries==EEPROM_READ_TRIES);
+	if(g_stateLost){
+		/*nothing read is used ,the image is taken as erased (the profile
+		 * gets its defaults)*/
+		TRACE(TRACE_STATE_LOST,tries);
+		for (i = 0; i < sizeof(PersistentImageType); ++i) {
+			((uint8 *)&image)[i] = 0XFF;
+		}
+	}
+
+	g_credential = image.credential;
+	g_credentialSlot = (image.indicator==PREVIOUS_LOGIN_INDICATOR_SLOT1);
+	/*an erased or wrong profile gives the defaults*/
+	TRACE(TRACE_GATE_CONFIG,GATE_CONFIG_load(image.config,&g_gateConfig));
+	g_failCount = 0;
+	for (i = 0; i < FAIL_COUNTER_BYTES; ++i) {
+		g_failBytes[i] = image.failBytes[i];
+		/*every cleared bit is a wrong password*/
+		for (bit = 0; bit < 8; ++bit) {
+			if(!(g_failBytes[i] & (1<<bit))){
+				g_failCount++;
+			}
+		}
+	}
+	return image.indicator;
+}
+
+static uint8 startSystem(void){
+
+	uint8 logInHistory = loadPersistentState();
+	uint8 initialState;
+	uint8 i;
+
+	traceBootTime(TRACE_BOOT_LOADED);
+
+	if(g_stateLost){
+		/*a read error is never the first boot (any node could set a new
+		 * password) ,locked out and read again at the end of it*/
+		g_failCount = MAX_FAIL_TRIALS;
+		initialState = BUZZER_ON;
 
 	/*if the system was previously initialized */
-	if(logInHistory==PREVIOUS_LOGIN_INDICATOR){
-		g_systemState = CHECK_PASSWORD_TO_LOG_IN;
-		/*load the password from the EEPROM*/
-		EEPROM_readString(PASSWORD_ADDRESS, g_password);
+	}else if(logInHistory==PREVIOUS_LOGIN_INDICATOR || logInHistory==PREVIOUS_LOGIN_INDICATOR_SLOT1 ||
+			logInHistory==PLAIN_PASSWORD_INDICATOR){
+		/*a power cycle does not end a lock out ,it starts again*/
+		g_initialized = TRUE;
+		initialState = (g_failCount>=MAX_FAIL_TRIALS) ? BUZZER_ON : CHECK_PASSWORD_TO_LOG_IN;
 
 	}else{
-		/*this first time user should create new password*/
-		g_systemState = NEW_PASSWORD;
+		/*this first time user should create new password ,the counter
+		 * bytes are cleared by the first EEPROM write*/
+		g_failCount = 0;
+		initialState = NEW_PASSWORD;
+	}
+	for (i = 0; i < BUS_NODES_MAX; ++i) {
+		g_sessions[i].linkState = LINK_WAIT_READY;
+		/*the entry action of BUZZER_ON starts the lock out once*/
+		FSM_start(&g_sessions[i].system,initialState);
 	}
 
-	/* Enable Global Interrupt I-Bit */
-	SREG |= (1<<7);
+	/*replace the plain text password of an old image by its digest ,not
+	 * needed to answer the HMI so done by the storage task*/
+	if(!g_stateLost && logInHistory==PLAIN_PASSWORD_INDICATOR){
+		SCHEDULER_post(STORAGE_TASK,EV_CONVERT_PASSWORD,0);
+	}
+	return initialState;
+}
+
+/*Description : an old image keeps the password as plain text ,hash it and
+ * write the digest over it*/
+static void convertPlainPassword(void){
+
+	uint8 password[PASSWORD_MAX_LENGTH];
+	uint8 i;
 
-	while (1){
+	/*the plain text is where the salt is stored now (loaded at boot) ,so it
+	 * is also the old salt the new one is derived from*/
+	for (i = 0; i < PASSWORD_MAX_LENGTH; ++i) {
+		password[i] = g_credential.salt[i];
+		if(password[i]=='\0'){
+			break;
+		}
+	}
+	saveCredential(password,i);
+}
 
-		/*wait until MC2 ready to receive */
-		while (UART_recieveByte()!= M_READY);
-		/*informing MC2 the system state*/
-		UART_sendByte(g_systemState);
+static void setFailCount(uint8 failCount){
 
+	g_failCount = (failCount < FAIL_COUNT_MAX) ? failCount : FAIL_COUNT_MAX;
+	SCHEDULER_post(STORAGE_TASK,EV_STORE_FAIL_COUNT,0);
+}
 
-		switch (g_systemState) {
-			case NEW_PASSWORD:
-				/*informing MC2 that i am ready to receive password*/
-				UART_sendByte(M_READY);
-				/*get entered password*/
-				UART_receiveString(g_password);
+static void traceBootTime(TraceEventId id){
 
-				/*store it in EEPROM */
-				EEPROM_writeString(PASSWORD_ADDRESS, g_password);
-				/*write the indicator flag for initialization*/
-				EEPROM_writeByte(PREVIOUS_LOGIN_INDICATOR_ADDRESS, PREVIOUS_LOGIN_INDICATOR);
+	uint32 cycles = SYSTICK_getCycles() >> BOOT_CYCLES_SHIFT;
+	TRACE(id,(cycles > 0XFF) ? 0XFF : cycles);
+}
 
-				g_systemState = VIEW_OPTIONS;
-				break;
+/*Description : transition action returning the event of the option received*/
+static uint8 optionReceived(uint8 data){
 
-			case VIEW_OPTIONS :
-				/*wait until MC2 Send the option entered by user*/
-				UART_sendByte(M_READY);
-				option=UART_recieveByte();
+	if(data==CREATE_NEW_PASSWORD){
+		/*check password*/
+		return SYS_EV_NEW_PASSWORD_OPTION;
+	}
+	return SYS_EV_GATE_OPTION;
+}
 
-				if(option==CREATE_NEW_PASSWORD){
-					/*check password*/
-					g_systemState = CHECK_PASSWORD_FOR_NEW_PASSWORD;
-				}else{
-					g_systemState =OPENING_GATE;
-				}
-				break;
+/*Description : entry action of OPENING_GATE ,start the gate task*/
+static void gateStart(void){
+	SCHEDULER_post(GATE_TASK,EV_GATE_START,0);
+}
 
-			case CHECK_PASSWORD_FOR_NEW_PASSWORD :
+/*Description : entry action of BUZZER_ON ,turn on the alarm for the lock out
+ * 1.start the alarm software timer
+ * 2.start the siren pattern of the buzzer
+ * 3.when the timer expires the system returns to log in */
+static void alarmOn(void){
 
-				/*if password right then go and create new password*/
-				if (checkPassword()==SUCCESS){
-					g_systemState = NEW_PASSWORD;
-				}
-				break;
-			case CHECK_PASSWORD_TO_LOG_IN :
-				/*if password right then go and create new password*/
-				if (checkPassword()==SUCCESS){
-					g_systemState = VIEW_OPTIONS;
-				}
+	/*already locked out from another node*/
+	if(lockoutLeft()!=0){
+		return;
+	}
+
+	/*count down every second ,the call back informs the link task at the end*/
+	g_lockoutSeconds = lockoutSeconds(g_failCount);
+	g_sirenSeconds = g_gateConfig.alarmSeconds;
+	SYSTICK_startTimer(ALARM_TIMER,SYSTICK_MS_TO_TICKS(1000),TRUE,alarmSecond);
+
+	/*start the siren ,it is played in the back ground by the system tick*/
+	BUZZER_play(BUZZER_ALARM_SIREN);
+}
+
+/*Description : exit action of BUZZER_ON ,TURN OFF THE BUZZER */
+static void alarmOff(void){
+	SYSTICK_stopTimer(ALARM_TIMER);
+	BUZZER_stop();
+}
+
+static uint16 lockoutSeconds(uint8 failCount){
+
+	uint16 seconds = LOCKOUT_BASE_S;
+
+	while(failCount > MAX_FAIL_TRIALS && seconds < LOCKOUT_MAX_S){
+		seconds <<= 1;
+		failCount--;
+	}
+	return (seconds < LOCKOUT_MAX_S) ? seconds : LOCKOUT_MAX_S;
+}
+
+static uint16 lockoutLeft(void){
+
+	uint16 seconds;
+	uint8 sreg = SREG;
+
+	cli();
+	seconds = g_lockoutSeconds;
+	SREG = sreg;
+	return seconds;
+}
+
+/*******************************************************************************
+ *                           LINK TASK                                         *
+ *******************************************************************************/
+
+static void linkTask(uint8 event,uint8 data){
+
+	uint8 i;
+
+	switch (event) {
+		case EV_BUS_NODE:
+			/*the next bytes are sent by this node*/
+			g_rxNode = data;
+			break;
+		case EV_UART_RX:
+			if(g_rxNode<1 || g_rxNode>BUS_NODES_MAX){
 				break;
-			case OPENING_GATE :
-				openGate();
+			}
+			g_session = &g_sessions[g_rxNode - 1];
+			/*a technician or the gateway asks for the trace or the counters
+			 * ,the bytes are not used by MC2 (but may be in a page of the user
+			 * table or in a gate profile) ,the answer is sent to the node
+			 * asking for it ,only if it is logged in with the password of the
+			 * system and waits for an option*/
+			if(g_session->linkState==LINK_PROVISION || g_session->linkState==LINK_CONFIG){
+				linkReceive(data);
+			}else if((data==TRACE_DUMP_REQUEST || data==COUNTERS_REQUEST) &&
+					(!g_session->admin || g_session->linkState!=LINK_RECEIVE_OPTION)){
+				linkSend(WRONG_PASSWORD);
+			}else if(data==TRACE_DUMP_REQUEST){
+				TRACE_dump(linkSend);
+			}else if(data==COUNTERS_REQUEST){
+				COUNTERS_snapshot(linkSend);
+			}else{
+				linkReceive(data);
+			}
+			break;
+		case EV_ALARM_TIMEOUT:
+		case EV_GATE_DONE:
+			if(event==EV_ALARM_TIMEOUT && g_stateLost){
+				/*the persistent state is read again ,every node starts
+				 * over in the state it tells (or is locked out again)*/
+				alarmOff();
+				startSystem();
+				TWI_disable();
 				break;
-			case BUZZER_ON:
-				alarmOn();
+			}
+			/*return the nodes locked out back in log in mode or the nodes
+			 * waiting for the gate back to the options*/
+			for (i = 0; i < BUS_NODES_MAX; ++i) {
+				g_session = &g_sessions[i];
+				if(event==EV_ALARM_TIMEOUT && FSM_getState(&g_session->system)==BUZZER_ON){
+					systemDispatch(SYS_EV_ALARM_TIMEOUT,0);
+					g_session->linkState = LINK_WAIT_READY;
+				}else if(event==EV_GATE_DONE && FSM_getState(&g_session->system)==OPENING_GATE){
+					systemDispatch(SYS_EV_GATE_DONE,0);
+					g_session->linkState = LINK_WAIT_READY;
+				}
+			}
+			break;
+		case EV_PAGE_STORED:
+			/*the stream may have timed out*/
+			if(g_provisionSession==NULL_PTR){
 				break;
+			}
+			g_session = g_provisionSession;
+			if(g_pagesStored==USER_TABLE_PAGES){
+				g_usersValid = (g_pagesWrong==0);
+				g_usersFlagPending = TRUE;
+				SCHEDULER_post(STORAGE_TASK,EV_STORE_PAGE,0);
+				TRACE(TRACE_USERS_STORED,g_pagesWrong);
+				linkProvisionEnd(g_usersValid ? CORRECT_PASSWORD : WRONG_PASSWORD);
+			}else if(g_pagesStored + 1 < USER_TABLE_PAGES){
+				/*its buffer is free for the page after the next one*/
+				linkSend(M_READY);
+			}
+			break;
+		case EV_FAIL_COUNT_STORED:
+			/*the passwords counted as wrong are checked now*/
+			for (i = 0; i < BUS_NODES_MAX; ++i) {
+				g_session = &g_sessions[i];
+				if(!g_session->checkPending){
+					continue;
+				}
+				g_session->checkPending = FALSE;
+				g_checksPending--;
+				systemDispatch(SYS_EV_PASSWORD_RECEIVED,0);
+				if(g_session->hmiReady){
+					g_session->hmiReady = FALSE;
+					linkSendResult();
+				}
+			}
+			break;
+		case EV_PROVISION_TIMEOUT:
+			if(g_provisionSession!=NULL_PTR){
+				g_session = g_provisionSession;
+				linkProvisionEnd(WRONG_PASSWORD);
+			}else if(g_configSession!=NULL_PTR){
+				g_session = g_configSession;
+				linkConfigEnd(WRONG_PASSWORD);
+			}
+			break;
+	}
+
+	/*nodes that asked for the system state while the alarm or the gate was working*/
+	for (i = 0; i < BUS_NODES_MAX; ++i) {
+		g_session = &g_sessions[i];
+		if(g_session->linkState==LINK_WAIT_READY && g_session->hmiReady){
+			g_session->hmiReady = FALSE;
+			linkAnswerReady();
 		}
+	}
+}
 
+static void systemDispatch(uint8 event,uint8 data){
 
+	uint8 state = FSM_getState(&g_session->system);
 
+	FSM_dispatch(&g_session->system,event,data);
+	if(FSM_getState(&g_session->system)!=state){
+		TRACE(TRACE_SYSTEM_STATE,FSM_getState(&g_session->system));
 	}
-
 }
 
+static void linkReceive(uint8 data){
 
-/*
- *  Description :1.receives the password from micro2
- *               2. checks if its corrects
- *               3.if correct view options
- *               4.if wrong 3 times it will turn on the buzzer
- */
+	uint8 systemState;
 
-uint8 checkPassword(void){
-
-	/*count number of failTrials*/
-	static uint8 failTrials=0;
-	uint8 user_password[7];
-	/*wait until micro2 enter the password and send it */
-	/*informing MC2 that i am ready to receive password*/
-	UART_sendByte(M_READY);
-
-	/*get entered password*/
-	UART_receiveString(user_password);
-
-	/*load the password from the EEPROM*/
-	EEPROM_readString(PASSWORD_ADDRESS, g_password);
-
-	/*checking for match*/
-	for (int var = 0; var < 6; ++var) {
-
-		if(g_password[var] != user_password[var]){
-			failTrials++;
-			/*wait until MC2 ready to receive */
-			while (UART_recieveByte()!= M_READY);
-			/*informing MC2 the password is wrong*/
-			UART_sendByte(WRONG_PASSWORD);
-			/*go to state of the buzzer if the user
-			 * enter the password wrong 3 times*/
-			if(failTrials==3){
-				g_systemState=BUZZER_ON;
-				/*clear failTrials for the coming log in*/
-				failTrials=0;
+	switch (g_session->linkState) {
+		case LINK_WAIT_READY:
+			if(data==M_READY){
+				linkAnswerReady();
 			}
-			return FAILURE;
+			break;
 
-		}
+		case LINK_RECEIVE_PASSWORD:
+			/*the node lost the answer to its M_READY (never a digit) and
+			 * asks for the state again*/
+			if(data==M_READY){
+				linkAnswerReady();
+			/*the password ends with #*/
+			}else if(data=='#'){
+				g_session->receivedPassword[g_session->receivedLength]='\0';
+				/*the result of the check (or the confirmation of a new
+				 * password) is sent when the node is ready for it*/
+				g_session->linkState = LINK_WAIT_RESULT_READY;
+				systemState = FSM_getState(&g_session->system);
+				if((systemState==CHECK_PASSWORD_TO_LOG_IN || systemState==CHECK_PASSWORD_FOR_NEW_PASSWORD) &&
+						lockoutLeft()==0){
+					/*counted as wrong in the EEPROM before it is checked ,a
+					 * power cut once the answer is seen can not forget it*/
+					g_session->checkPending = TRUE;
+					g_checksPending++;
+					g_failCountWaited = TRUE;
+					setFailCount(g_failCount + 1);
+				}else{
+					systemDispatch(SYS_EV_PASSWORD_RECEIVED,0);
+				}
+			}else if(g_session->receivedLength < PASSWORD_MAX_LENGTH){
+				g_session->receivedPassword[g_session->receivedLength]=data;
+				g_session->receivedLength++;
+			}
+			break;
+
+		case LINK_RECEIVE_OPTION :
+			if(data==M_READY){
+				linkAnswerReady();
+				break;
+			}
+			g_session->linkState = LINK_WAIT_READY;
+			if(data==PROVISION_USERS){
+				/*the system state does not change during the stream*/
+				linkProvisionStart();
+			}else if(data==GATE_CONFIG){
+				linkConfigStart();
+			}else{
+				systemDispatch(SYS_EV_OPTION_RECEIVED,data);
+			}
+			break;
+
+		case LINK_PROVISION:
+			linkProvisionReceive(data);
+			break;
+
+		case LINK_CONFIG:
+			linkConfigReceive(data);
+			break;
+
+		case LINK_WAIT_RESULT_READY:
+			if(data==M_READY && g_session->checkPending){
+				/*answered after the check*/
+				g_session->hmiReady = TRUE;
+			}else if(data==M_READY){
+				linkSendResult();
+			}
+			break;
+
+		case LINK_GATE:
+			/*the gate task answers by the gate state when it changes*/
+			if(data==M_READY){
+				g_session->hmiReady = TRUE;
+				SCHEDULER_post(GATE_TASK,EV_HMI_READY,0);
+			}
+			break;
+
+		case LINK_ALARM:
+			/*answered after the alarm*/
+			if(data==M_READY){
+				g_session->hmiReady = TRUE;
+			}
+			break;
 	}
-	/*wait until MC2 ready to receive */
-	while (UART_recieveByte()!= M_READY);
-	/*informing MC2 the password is wrong*/
-	UART_sendByte(CORRECT_PASSWORD);
-	/*the password is  right*/
-	/*clear failTrials for the coming log in*/
-	failTrials=0;
-	return SUCCESS;
 }
 
+static void linkAnswerReady(void){
+
+	uint8 systemState = FSM_getState(&g_session->system);
+	uint16 seconds;
+
+	/*informing the node the system state*/
+	linkSend(systemState);
+	if(!g_linked){
+		g_linked = TRUE;
+		traceBootTime(TRACE_BOOT_LINKED);
+	}
+
+	if(systemState==BUZZER_ON){
+		/*and the seconds left of the lock out*/
+		seconds = lockoutLeft();
+		linkSend((uint8)(seconds >> LOCKOUT_BYTE_BITS) & LOCKOUT_BYTE_MASK);
+		linkSend((uint8)seconds & LOCKOUT_BYTE_MASK);
+	}
+
+	g_session->linkState = pgm_read_byte(&g_linkStates[systemState]);
+	if(g_session->linkState==LINK_RECEIVE_PASSWORD || g_session->linkState==LINK_RECEIVE_OPTION){
+		/*informing the node that i am ready to receive password (or the option)*/
+		linkSend(M_READY);
+		g_session->receivedLength = 0;
+	}
+}
+
+static void linkSend(uint8 data){
+	BUS_sendByte(g_session->node,data);
+}
+
+static void linkSendResult(void){
+
+	/*informing the node the password is right or wrong*/
+	linkSend(g_session->passwordResult);
+	if(g_session->passwordResult==CORRECT_PASSWORD){
+		BUZZER_play(BUZZER_SUCCESS_CHIRP);
+	}else if(FSM_getState(&g_session->system)!=BUZZER_ON){
+		BUZZER_play(BUZZER_FAILURE_BEEP);
+	}
+	g_session->linkState = LINK_WAIT_READY;
+}
+
+static void linkProvisionStart(void){
 
-/*Description : function to turn on buzzer for 8 seconds
- * 1.turn on timer for 10 seconds
- * 2.turn on buzzer
- * 3.after 10 seconds deinit timer and off the buzzer
- * 4.return to log in */
-inline static void alarmOn(void){
+	uint8 i;
 
-	/* Create configuration structure for normal mode timer1 */
-	TimersConfigType s_timer1Config = {NORMAL,F_CPU_1024,1,TIMER1 };
-	/*set the call back to return system back in log in mode*/
-	TIMERS_setCallBackTimer1(changeSystemState);
+	/*only the password of the system ,one stream at a time (the storage
+	 * task may still read back the last page of an ended one)*/
+	if(!g_session->admin || g_provisionSession!=NULL_PTR || g_configSession!=NULL_PTR || g_pageWritten){
+		linkSend(WRONG_PASSWORD);
+		return;
+	}
+	g_provisionSession = g_session;
+	g_session->linkState = LINK_PROVISION;
+	g_pageFill = 0;
+	g_pagesReceived = 0;
+	g_pagesStored = 0;
+	g_pagesWrong = 0;
+
+	/*the old table is not used from now ,its flag is cleared before the
+	 * first page is written*/
+	g_usersValid = FALSE;
+	g_usersFlagPending = TRUE;
+	SCHEDULER_post(STORAGE_TASK,EV_STORE_PAGE,0);
+
+	/*a credit per page buffer*/
+	for (i = 0; i < PROVISION_BUFFERS; ++i) {
+		linkSend(M_READY);
+	}
+	SYSTICK_startTimer(PROVISION_TIMER,SYSTICK_MS_TO_TICKS(PROVISION_TIMEOUT_MS),FALSE,provisionTimeout);
+}
 
-	TIMERS_init(&s_timer1Config);
+static void linkProvisionReceive(uint8 data){
 
-	/*TURN ON THE BUZZER*/
-	buzzerOn();
-	
-	/* wait until timer ends up counting */
-	while(g_systemState==BUZZER_ON);
+	/*more pages than credits are not taken*/
+	if(g_pagesReceived - g_pagesStored >= PROVISION_BUFFERS || g_pagesReceived==USER_TABLE_PAGES){
+		return;
+	}
+	g_pages[g_pagesReceived % PROVISION_BUFFERS][g_pageFill] = data;
+	g_pageFill++;
+	if(g_pageFill==EEPROM_PAGE_SIZE){
+		g_pageFill = 0;
+		g_pagesReceived++;
+		SCHEDULER_post(STORAGE_TASK,EV_STORE_PAGE,0);
+		SYSTICK_startTimer(PROVISION_TIMER,SYSTICK_MS_TO_TICKS(PROVISION_TIMEOUT_MS),FALSE,provisionTimeout);
+	}
+}
 
-	/*TURN OFF THE BUZZER*/
-	buzzerOff();
-	/*deinit the timer*/
-	TIMERS_deinit(TIMER1);
+static void linkProvisionEnd(uint8 result){
 
+	SYSTICK_stopTimer(PROVISION_TIMER);
+	g_provisionSession = NULL_PTR;
+	linkSend(result);
+	g_session->linkState = LINK_WAIT_READY;
 }
 
-/*ISR call back function to return system back in log in mode
- * in case of Buzzer on state*/
-void changeSystemState(void){
-	/*hold the number this function called to calculate one minute*/
-	static uint8 entry_counter=0;
-	entry_counter++;
-	if (entry_counter==8){
-		g_systemState = CHECK_PASSWORD_TO_LOG_IN;
+static void linkConfigStart(void){
 
-		/*Reinitialize the counter for the next time*/
-		entry_counter = 0;
+	/*only the password of the system ,while no stream uses the provision timer*/
+	if(!g_session->admin || g_provisionSession!=NULL_PTR || g_configSession!=NULL_PTR){
+		linkSend(WRONG_PASSWORD);
+		return;
 	}
+	g_configSession = g_session;
+	g_session->linkState = LINK_CONFIG;
+	g_configFill = 0;
+	linkSend(M_READY);
+	SYSTICK_startTimer(PROVISION_TIMER,SYSTICK_MS_TO_TICKS(PROVISION_TIMEOUT_MS),FALSE,provisionTimeout);
 }
 
-/*Description : function to rotate motor 15 seconds clockwise
- * then hold for 3 seconds the rotate 15 seconds anti-clockwise
- * 1.Initialize timer 1 to create PWM signal to create 125Khzsignal
- * 2.initialize timer 0 to count 15 seconds
- * 3.adjust polarity to rotate clockwise
- * 4.stop the motor
- * 5.adjust polarity to rotate anti-clockwise for 15 seconds
- * 6.stop both timers*/
-inline static void openGate(void){
+static void linkConfigReceive(uint8 data){
 
-	/*initialize the timer PWM mode without rotating the motor*/
-	motor_init();
+	GateConfigType config;
+	uint8 i;
 
-	/* Create configuration structure for normal mode timer1 to count 15 seconds as gate opening*/
-	TimersConfigType s_timer1Config = {NORMAL,F_CPU_256,1,TIMER1 };
+	g_configReceived[g_configFill] = data;
+	g_configFill++;
+	if(g_configFill<GATE_CONFIG_SIZE){
+		return;
+	}
+	/*the gate states started after it use the new times ,a profile not
+	 * written yet is replaced*/
+	if(GATE_CONFIG_load(g_configReceived,&config)){
+		g_gateConfig = config;
+		for (i = 0; i < GATE_CONFIG_SIZE; ++i) {
+			g_configImage[i] = g_configReceived[i];
+		}
+		g_configPending = TRUE;
+		SCHEDULER_post(STORAGE_TASK,EV_STORE_CONFIG,0);
+		TRACE(TRACE_GATE_CONFIG,TRUE);
+		linkConfigEnd(CORRECT_PASSWORD);
+	}else{
+		linkConfigEnd(WRONG_PASSWORD);
+	}
+}
 
+static void linkConfigEnd(uint8 result){
 
-	/*Create configuration structure for COMPARE mode timer1 to count 3 seconds*/
-	TimersCompareModeConfig s_cmpModeT1Config ={21900,0,OCN_DISCONNECTED,OCN_DISCONNECTED};
+	SYSTICK_stopTimer(PROVISION_TIMER);
+	g_configSession = NULL_PTR;
+	linkSend(result);
+	g_session->linkState = LINK_WAIT_READY;
+}
 
-	/*set the call back to return system back in log in mode*/
-	TIMERS_setCallBackTimer1(changeGateState);
+static uint8 linkGateReady(void){
 
-	g_gateStatus = OPENING_GATE;
+	uint8 i;
 
-	/*wait until MC2 ready to receive */
-	while (UART_recieveByte()!= M_READY);
-	/*informing MC2 CASE OF GATE*/
-	UART_sendByte(g_gateStatus);
+	for (i = 0; i < BUS_NODES_MAX; ++i) {
+		if(FSM_getState(&g_sessions[i].system)==OPENING_GATE &&
+				(g_sessions[i].linkState!=LINK_GATE || !g_sessions[i].hmiReady)){
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
 
-	// Rotate the motor --> clock wise
-	motor_rotateClockwise();
+/*******************************************************************************
+ *                           GATE TASK                                         *
+ *******************************************************************************/
 
+/*Description : rotate motor clockwise for the opening time of the gate
+ * profile then hold it open then rotate anti-clockwise for the closing
+ * time ,every gate state is sent to MC2
+ * when it starts and MC2 is ready for it ,a movement ends when its time
+ * finishes ,a stall stops the gate (obstructed) and closes it again after
+ * the holding time until GATE_STALLS_MAX stalls leave it blocked*/
+static void gateTask(uint8 event,uint8 data){
+
+	switch (event) {
+		case EV_GATE_START:
+			gateDispatch(GATE_EV_START,0);
+			break;
+		case EV_HMI_READY:
+			gateDispatch(GATE_EV_HMI_READY,0);
+			break;
+		case EV_GATE_TIMEOUT:
+			/*ignore an event of a previous gate state*/
+			if(data==FSM_getState(&g_gateFsm)){
+				gateDispatch(GATE_EV_PHASE_END,0);
+			}
+			break;
+		case EV_GATE_STALL:
+			if(data==FSM_getState(&g_gateFsm)){
+				g_gateStalls++;
+				gateDispatch((g_gateStalls < GATE_STALLS_MAX) ? GATE_EV_STALL : GATE_EV_BLOCKED,0);
+			}
+			break;
+		case EV_GATE_PROGRESS:
+			if(data==FSM_getState(&g_gateFsm) && !g_gatePhaseDone){
+				gateSendProgress();
+			}
+			break;
+	}
+}
+
+static void gateDispatch(uint8 event,uint8 data){
+
+	uint8 state = FSM_getState(&g_gateFsm);
+
+	FSM_dispatch(&g_gateFsm,event,data);
+	if(FSM_getState(&g_gateFsm)!=state){
+		TRACE(TRACE_GATE_STATE,FSM_getState(&g_gateFsm));
+	}
+}
 
-	/*start the timer in normal mode for 15 seconds count*/
-	TIMERS_init(&s_timer1Config);
+/*Description : initialize the timer PWM mode without rotating the motor
+ * and wait for MC2 to be ready for the first gate state*/
+static uint8 gateInit(uint8 data){
 
-	/*wait until 15 seconds pass*/
-	while(g_gateStatus==OPENING_GATE);
+	/*PWM frequency and duty cycle (speed) of the gate motor*/
+	MotorConfigType s_motorConfig = {GATE_MOTOR_PWM_FREQUENCY,g_gateConfig.dutyCycle};
 
-	/*stop the timer*/
-	TIMERS_deinit(TIMER1);
+	motor_init(&s_motorConfig);
+	/*watch the motor current to stop the gate if it is obstructed*/
+	CURRENT_SENSE_init(GATE_STALL_TRIP_MS,gateObstructed);
+	g_gatePhaseDone = TRUE;
+	g_gateStalls = 0;
 
-	/*wait until MC2 ready to receive */
-	while (UART_recieveByte()!= M_READY);
-	/*informing MC2 CASE OF GATE*/
-	UART_sendByte(g_gateStatus);
+	return linkGateReady() ? GATE_EV_NEXT : FSM_NO_EVENT;
+}
+
+/*Description : a node is ready for the next gate state*/
+static uint8 gateHmiReady(uint8 data){
+	return (g_gatePhaseDone && linkGateReady()) ? GATE_EV_NEXT : FSM_NO_EVENT;
+}
 
-	// Stop the motor
+/*Description : the time of the gate state finished*/
+static uint8 gatePhaseEnd(uint8 data){
+
+	SYSTICK_stopTimer(GATE_TIMER);
+	SYSTICK_stopTimer(PROGRESS_TIMER);
+	/*stop the motor as soon as the movement ends*/
+	CURRENT_SENSE_stop();
 	motor_stop();
+	g_gatePhaseDone = TRUE;
+
+	return linkGateReady() ? GATE_EV_NEXT : FSM_NO_EVENT;
+}
 
-	/*change configuration settings to configure compare mode */
-	s_timer1Config.Mode=COMPARE;
-	/*start the timer*/
-	TIMERS_init(&s_timer1Config,&s_cmpModeT1Config);
+/*Description : the gate is closed ,Stop the motor and the PWM signal*/
+static uint8 gateFinish(uint8 data){
 
-	/*wait until 3 seconds pass*/
-	while(g_gateStatus==OPENED);
+	SYSTICK_stopTimer(GATE_TIMER);
+	SYSTICK_stopTimer(PROGRESS_TIMER);
+	CURRENT_SENSE_stop();
+	motor_deInit();
+	g_gatePhaseDone = FALSE;
+	SCHEDULER_post(LINK_TASK,EV_GATE_DONE,0);
 
-	/*stop the timer*/
-	TIMERS_deinit(TIMER1);
+	return FSM_NO_EVENT;
+}
+
+/*Description : the motor stalled while moving ,it is already stopped by the
+ * current sense ,the movement is not finished so the gate is obstructed*/
+static uint8 gateStalled(uint8 data){
+
+	SYSTICK_stopTimer(GATE_TIMER);
+	SYSTICK_stopTimer(PROGRESS_TIMER);
+	CURRENT_SENSE_stop();
+	motor_stop();
+
+	return FSM_NO_EVENT;
+}
 
+/*Description : the last stall of the sequence ,leave the gate where it
+ * stopped and the nodes back to the options*/
+static uint8 gateBlocked(uint8 data){
 
-	/*wait until MC2 ready to receive */
-	while (UART_recieveByte()!= M_READY);
-	/*informing MC2 CASE OF GATE*/
-	UART_sendByte(g_gateStatus);
+	SYSTICK_stopTimer(GATE_TIMER);
+	SYSTICK_stopTimer(PROGRESS_TIMER);
+	CURRENT_SENSE_stop();
+	motor_deInit();
+	SCHEDULER_post(LINK_TASK,EV_GATE_DONE,0);
 
+	return FSM_NO_EVENT;
+}
 
-	/*change configuration settings to configure Normal mode for 15 seconds count*/
-	s_timer1Config.Mode=NORMAL;
+static void gateOpeningEntry(void){
+	gateSendStatus();
+	// Rotate the motor --> clock wise
+	motor_rotateClockwise();
+	CURRENT_SENSE_start();
+	gateStartTimer(g_gateConfig.openTicks);
+}
 
+static void gateOpenedEntry(void){
+	gateSendStatus();
+	gateStartTimer(g_gateConfig.holdTicks);
+}
 
+static void gateClosingEntry(void){
+	gateSendStatus();
 	// Rotate the motor --> anti-clock wise to close the door
 	motor_rotateAntiClockwise();
+	CURRENT_SENSE_start();
+	gateStartTimer(g_gateConfig.closeTicks);
+}
 
-	/*start the timer to count 15 seconds */
- 	TIMERS_init(&s_timer1Config);
+static void gateObstructedEntry(void){
+	gateSendStatus();
+	/*give time to clear the way before closing again*/
+	gateStartTimer(g_gateConfig.holdTicks);
+}
 
-	/*wait until 15 seconds pass*/
-	while(g_gateStatus==GATE_CLOSING);
+static void gateSendStatus(void){
 
-	/*stop the timer*/
-	TIMERS_deinit(TIMER1);
+	uint8 i;
 
-	// Stop the motor
-	motor_stop();
+	g_gatePhaseDone = FALSE;
+	/*informing every node waiting for the gate CASE OF GATE*/
+	for (i = 0; i < BUS_NODES_MAX; ++i) {
+		if(g_sessions[i].linkState==LINK_GATE){
+			g_sessions[i].hmiReady = FALSE;
+			BUS_sendByte(g_sessions[i].node,FSM_getState(&g_gateFsm));
+		}
+	}
+}
+
+static void gateStartTimer(uint16 ticks){
 
-	g_systemState=VIEW_OPTIONS;
+	SYSTICK_startTimer(GATE_TIMER,ticks,FALSE,changeGateState);
 
+	/*a progress step per period for the long gate states ,more steps per
+	 * frame for the short ones*/
+	g_gateTicks = ticks;
+	g_gateElapsed = 0;
+	g_gateSteps = 0;
+	g_gateProgressPeriod = ticks / GATE_PROGRESS_STEPS;
+	if(g_gateProgressPeriod < SYSTICK_MS_TO_TICKS(GATE_PROGRESS_MIN_MS)){
+		g_gateProgressPeriod = SYSTICK_MS_TO_TICKS(GATE_PROGRESS_MIN_MS);
+	}
+	SYSTICK_startTimer(PROGRESS_TIMER,g_gateProgressPeriod,TRUE,gateProgress);
 }
-/*Description :ISR call back function function to count  the required time
- * for opening and closing motor and time gate held open*/
-void changeGateState(void){
 
-	/*variable to count number of overflows happened*/
-	static uint8 tickCount = 0;
+static void gateSendProgress(void){
 
-	tickCount++;
+	uint8 steps = GATE_PROGRESS_STEPS;
+	uint8 i;
 
-	switch (g_gateStatus) {
-		case OPENING_GATE:
-			/*number of overflows required for 15 seconds is 7  */
-			if(tickCount==7){
-				/*reinitialize the counter for the next state*/
-				tickCount = 0;
-				g_gateStatus =OPENED;
-			}
-			break;
-		case OPENED:
-			if(tickCount==2){ /*number of overflows required for 3 seconds*/
-				/*reinitialize the counter for the next state*/
+	g_gateElapsed += g_gateProgressPeriod;
+	if(g_gateElapsed < g_gateTicks){
+		steps = (uint8)(((uint32)g_gateElapsed * GATE_PROGRESS_STEPS) / g_gateTicks);
+	}
+	if(steps==GATE_PROGRESS_STEPS){
+		SYSTICK_stopTimer(PROGRESS_TIMER);
+	}
+	if(steps==g_gateSteps){
+		return;
+	}
+	g_gateSteps = steps;
+	for (i = 0; i < BUS_NODES_MAX; ++i) {
+		if(g_sessions[i].linkState==LINK_GATE){
+			BUS_sendByte(g_sessions[i].node,GATE_PROGRESS_FRAME + steps);
+		}
+	}
+}
 
-				/*reinitialize the counter for the next state*/
-				tickCount = 0;
-				g_gateStatus =GATE_CLOSING;
-			}
-			break;
-		case GATE_CLOSING :
-			if(tickCount==7){ /*number of overflows required for 15 seconds is 7*/
-				/*reinitialize the counter for the next TIME*/
-				tickCount = 0;
-				g_gateStatus =CLOSED;
+/*******************************************************************************
+ *                           STORAGE TASK                                      *
+ *******************************************************************************/
+
+/*Description : write the wrong passwords counter one byte per EEPROM write
+ * cycle ,the salt and the digest to the free slot a page per write cycle then
+ * the initialization flag ,then the gate profile and the pages of the user table one page per write
+ * cycle ,so the other
+ * tasks are never blocked*/
+static void storageTask(uint8 event,uint8 data){
+
+	if(event==EV_CONVERT_PASSWORD){
+		/*deferred from the boot ,the digest is then stored like a new one*/
+		convertPlainPassword();
+		return;
+	}else if(event==EV_LOAD_USERS){
+		storageLoadUsers();
+		return;
+	}else if(event==EV_STORE_PASSWORD){
+		/*start again from the first byte*/
+		g_storageIndex = 0;
+	}else if(event==EV_STORAGE_NEXT){
+		g_storageBusy = FALSE;
+		if(g_pageWritten){
+			storageVerifyPage();
+		}
+	}
+	/*EV_STORE_FAIL_COUNT ,EV_STORE_PAGE ,EV_STORE_CONFIG : compared with the EEPROM below*/
+
+	if(g_storageBusy){
+		return;
+	}
+
+	/*the counter first ,a wrong password is stored before it can be
+	 * forgotten by a power cut ,the users last*/
+	if(!storageFailCountStep()){
+		/*the counter is in the EEPROM (its last write cycle is over) ,the
+		 * passwords counted may be checked*/
+		if(g_failCountWaited){
+			g_failCountWaited = FALSE;
+			SCHEDULER_post(LINK_TASK,EV_FAIL_COUNT_STORED,0);
+		}
+		if(!storageCredentialStep() && !storageConfigStep() && !storageUsersStep()){
+			TWI_disable();
+			return;
+		}
+	}
+
+	/*wait for the write cycle before the next byte ,the EEPROM writes
+	 * alone so the TWI is switched off ,one more tick as the first one
+	 * is already running (the counter is stored when the timer ends)*/
+	TWI_disable();
+	g_storageBusy = TRUE;
+	SYSTICK_startTimer(STORAGE_TIMER,SYSTICK_MS_TO_TICKS(EEPROM_WRITE_CYCLE_MS) + 1,FALSE,storageTimeout);
+}
+
+static uint8 storageCredentialStep(void){
+
+	uint16 address;
+	uint8 count;
+
+	if(g_storageIndex==STORAGE_IDLE){
+		return FALSE;
+	}
+	if(g_storageIndex==STORAGE_WRITE_INDICATOR){
+		/*the new slot is complete ,the indicator flag (initialization) now
+		 * points to it*/
+		g_credentialSlot ^= 1;
+		EEPROM_writeByte(PREVIOUS_LOGIN_INDICATOR_ADDRESS,
+				g_credentialSlot ? PREVIOUS_LOGIN_INDICATOR_SLOT1 : PREVIOUS_LOGIN_INDICATOR);
+		g_storageIndex = STORAGE_IDLE;
+	}else{
+		/*store the salt and the digest in the slot not used ,up to the end
+		 * of an EEPROM page per write cycle*/
+		address = (g_credentialSlot ? PASSWORD_ADDRESS : PASSWORD_SLOT1_ADDRESS) + g_storageIndex;
+		count = EEPROM_PAGE_SIZE - (address % EEPROM_PAGE_SIZE);
+		if(count > sizeof(CredentialType) - g_storageIndex){
+			count = sizeof(CredentialType) - g_storageIndex;
+		}
+		EEPROM_writePage(address,((uint8 *)&g_credential) + g_storageIndex,count);
+		g_storageIndex += count;
+		if(g_storageIndex==sizeof(CredentialType)){
+			g_storageIndex = STORAGE_WRITE_INDICATOR;
+		}
+	}
+	return TRUE;
+}
+
+static uint8 storageConfigStep(void){
+
+	if(!g_configPending){
+		return FALSE;
+	}
+	/*one write cycle ,the profile is in the page of the counter*/
+	EEPROM_writePage(GATE_CONFIG_ADDRESS,g_configImage,GATE_CONFIG_SIZE);
+	g_configPending = FALSE;
+	return TRUE;
+}
+
+static uint8 storageUsersStep(void){
+
+	/*the flag is cleared before the first page and set after the last one*/
+	if(g_usersFlagPending){
+		EEPROM_writeByte(USER_TABLE_FLAG_ADDRESS,g_usersValid ? USER_TABLE_VALID : USER_TABLE_INVALID);
+		g_usersFlagPending = FALSE;
+		return TRUE;
+	}
+	/*an ended stream leaves its last pages*/
+	if(g_provisionSession==NULL_PTR || g_pagesStored==g_pagesReceived){
+		return FALSE;
+	}
+	EEPROM_writePage(USER_TABLE_PAGE_ADDRESS(g_pagesStored),g_pages[g_pagesStored % PROVISION_BUFFERS],EEPROM_PAGE_SIZE);
+	g_pageWritten = TRUE;
+	return TRUE;
+}
+
+static void storageVerifyPage(void){
+
+	uint8 page[EEPROM_PAGE_SIZE];
+	uint8 * written = g_pages[g_pagesStored % PROVISION_BUFFERS];
+	uint8 i,wrong = FALSE;
+
+	/*one burst ,the write cycle is over*/
+	if(!EEPROM_readBytes(USER_TABLE_PAGE_ADDRESS(g_pagesStored),page,EEPROM_PAGE_SIZE)){
+		wrong = TRUE;
+	}
+	for (i = 0; i < EEPROM_PAGE_SIZE; ++i) {
+		wrong |= (page[i]!=written[i]);
+	}
+	/*the first page is the key of the table*/
+	if(g_pagesStored==0){
+		for (i = 0; i < SIPHASH_KEY_SIZE; ++i) {
+			g_userKey[i] = written[i];
+		}
+	}
+	g_pagesWrong += wrong;
+	g_pagesStored++;
+	g_pageWritten = FALSE;
+	SCHEDULER_post(LINK_TASK,EV_PAGE_STORED,0);
+}
+
+static void storageLoadUsers(void){
+
+	uint8 flag;
+
+	if(EEPROM_readByte(USER_TABLE_FLAG_ADDRESS,&flag) && flag==USER_TABLE_VALID){
+		g_usersValid = EEPROM_readBytes(USER_TABLE_KEY_ADDRESS,g_userKey,SIPHASH_KEY_SIZE);
+	}
+	TWI_disable();
+}
+
+static uint8 storageFailCountStep(void){
+
+	uint8 i,zeros,expected;
+
+	for (i = 0; i < FAIL_COUNTER_BYTES; ++i) {
+		/*bits of this byte cleared by the count*/
+		zeros = (g_failCount > 8*i) ? (g_failCount - 8*i) : 0;
+		expected = (zeros >= 8) ? 0 : (uint8)(0XFF << zeros);
+		if(g_failBytes[i]!=expected){
+			/*a failed write is tried again after the write cycle time ,the
+			 * passwords counted are not checked until it is stored*/
+			if(EEPROM_writeByte(FAIL_COUNTER_ADDRESS + i, expected)){
+				g_failBytes[i] = expected;
 			}
-			break;
+			return TRUE;
+		}
 	}
+	return FALSE;
+}
 
+/*******************************************************************************
+ *                       ISR call back functions                               *
+ *******************************************************************************/
+
+/*Description :bus receive interrupt call back ,give the byte to the link task
+ * ,its node only when the conversation changed ,a byte the full queue can not
+ * take is counted (COUNTER_BUS_DROPS) ,the node is posted again with the next one*/
+void busReceived(uint8 node,uint8 data){
+
+	if(node!=g_postedNode){
+		if(!SCHEDULER_post(LINK_TASK,EV_BUS_NODE,node)){
+			COUNTERS_INC(COUNTER_BUS_DROPS);
+			return;
+		}
+		g_postedNode = node;
+	}
+	if(!SCHEDULER_post(LINK_TASK,EV_UART_RX,data)){
+		COUNTERS_INC(COUNTER_BUS_DROPS);
+	}
+}
+
+/*Description :alarm timer call back every second of the lock out ,stop the
+ * siren after the siren time of the gate profile and return system back in log in mode at the end*/
+void alarmSecond(void){
+
+	if(g_sirenSeconds!=0){
+		g_sirenSeconds--;
+		if(g_sirenSeconds==0){
+			BUZZER_stop();
+		}
+	}
+	if(g_lockoutSeconds!=0){
+		g_lockoutSeconds--;
+	}
+	if(g_lockoutSeconds==0){
+		SYSTICK_stopTimer(ALARM_TIMER);
+		TRACE(TRACE_TIMER_EXPIRED,ALARM_TIMER);
+		SCHEDULER_post(LINK_TASK,EV_ALARM_TIMEOUT,0);
+	}
+}
+
+/*Description :gate timer call back ,the time of the current gate state finished*/
+void changeGateState(void){
+	TRACE(TRACE_TIMER_EXPIRED,GATE_TIMER);
+	SCHEDULER_post(GATE_TASK,EV_GATE_TIMEOUT,FSM_getState(&g_gateFsm));
+}
+
+/*Description :progress timer call back ,a period of the current gate state passed*/
+void gateProgress(void){
+	SCHEDULER_post(GATE_TASK,EV_GATE_PROGRESS,FSM_getState(&g_gateFsm));
+}
+
+/*Description :ISR call back function when the motor current shows that the gate
+ * is obstructed ,the motor is already stopped*/
+void gateObstructed(void){
+	TRACE(TRACE_GATE_STALL,FSM_getState(&g_gateFsm));
+	SCHEDULER_post(GATE_TASK,EV_GATE_STALL,FSM_getState(&g_gateFsm));
 }
 
+/*Description :EEPROM write cycle finished ,write the next byte*/
+void storageTimeout(void){
+	SCHEDULER_post(STORAGE_TASK,EV_STORAGE_NEXT,0);
+}
+
+/*Description :no page of the user table for PROVISION_TIMEOUT_MS ,end the stream*/
+void provisionTimeout(void){
+	TRACE(TRACE_TIMER_EXPIRED,PROVISION_TIMER);
+	SCHEDULER_post(LINK_TASK,EV_PROVISION_TIMEOUT,0);
+}
@@ -0,0 +1,178 @@
+/******************************************************************************
+ *
+ * Module: ADC
+ *
+ * File Name: adc.c
+ *
+ * Description: Source file for the ATmega16 ADC driver
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+#include "adc.h"
+
+/*******************************************************************************
+ *                            GLOBAL VARIABLES                    *
+ *******************************************************************************/
+
+static void (*volatile g_callBackPtrAdc)(void) = NULL_PTR;
+
+/*the auto trigger source of the running configuration*/
+static volatile uint8 g_adcTrigger = ADC_NO_AUTO_TRIGGER;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/* clear the flag of the auto trigger source ,its next rising edge starts a conversion */
+static void ADC_clearTrigger(void);
+
+/*******************************************************************************
+ *                       Interrupt Service Routines                            *
+ *******************************************************************************/
+
+ISR(ADC_vect){
+
+	/* the ADC starts a conversion on the rising edge of the trigger flag,
+	 * if nobody clears that flag (its interrupt is disabled) no more edges
+	 * will come so clear it here to get the next trigger */
+	ADC_clearTrigger();
+
+	if(g_callBackPtrAdc != NULL_PTR)
+	{
+		/* Call the Call Back function in the application after the conversion is complete */
+		(*g_callBackPtrAdc)();
+	}
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description : initialize the ADC with the required reference, clock, channel
+ * 				 and trigger source, in case of auto trigger the first conversion
+ * 				 starts with the first event of the trigger source
+ */
+void ADC_init(const AdcConfigType * config_ptr){
+
+	g_adcTrigger = config_ptr->Trigger;
+
+	/* configure the channel pin as input */
+	CLEAR_BIT(DDRA,(config_ptr->Channel & 0x07));
+
+	/* ADMUX
+	 * 1. REFS1:0 reference selection
+	 * 2. ADLAR=0 right adjusted result
+	 * 3. MUX4:0 single ended channel
+	 */
+	ADMUX = ((config_ptr->Reference)<<REFS0) | (config_ptr->Channel & 0x07);
+
+	if(config_ptr->Trigger != ADC_NO_AUTO_TRIGGER){
+		/* select the trigger source ADTS2:0 */
+		SFIOR = (SFIOR & 0x1F) | ((config_ptr->Trigger)<<ADTS0);
+	}
+
+	/* ADCSRA
+	 * 1. ADEN=1 enable the ADC
+	 * 2. ADATE=1 in case of auto trigger
+	 * 3. ADIF=1 to clear any old complete flag
+	 * 4. ADIE if interrupt allowed
+	 * 5. ADPS2:0 clock prescaler
+	 */
+	HAL_WRITE(ADCSRA,(1<<ADEN) | (1<<ADIF) | ((config_ptr->Prescaler)&0x07));
+	if(config_ptr->Trigger != ADC_NO_AUTO_TRIGGER){
+		ADCSRA |= (1<<ADATE);
+	}
+	if(config_ptr->IntEnable){
+		ADCSRA |= (1<<ADIE);
+	}
+}
+
+/*
+ * Description : disable the ADC and its interrupt
+ */
+void ADC_deinit(void){
+
+	ADCSRA = 0;
+	ADMUX = 0;
+	/* clear the trigger source */
+	SFIOR &= 0x1F;
+	g_adcTrigger = ADC_NO_AUTO_TRIGGER;
+}
+
+/*
+ * Description : switch the ADC on ,the first conversion takes 25 ADC clocks
+ */
+void ADC_enable(void){
+	/* the trigger flag was set while the ADC was off ,without clearing it
+	 * no edge would start the first conversion */
+	ADC_clearTrigger();
+	SET_BIT(ADCSRA,ADEN);
+}
+
+/*
+ * Description : switch the ADC off ,a running conversion is stopped
+ */
+void ADC_disable(void){
+	CLEAR_BIT(ADCSRA,ADEN);
+}
+
+/*
+ * Description : start a single conversion on the required channel
+ * 				 and wait (polling) until it finishes then return the result
+ */
+uint16 ADC_readChannel(uint8 channel){
+
+	/* keep the reference and select the new channel */
+	ADMUX = (ADMUX & 0xE0) | (channel & 0x07);
+	/* start the conversion */
+	SET_BIT(ADCSRA,ADSC);
+	/* ADSC is cleared by hardware when the conversion completes */
+	while(BIT_IS_SET(ADCSRA,ADSC));
+	return ADC;
+}
+
+/*
+ * Description : return the result of the last conversion (for the call back)
+ */
+uint16 ADC_getResult(void){
+	return ADC;
+}
+
+/*
+ * Description: Function to set the Call Back function called at the end of every conversion
+ */
+void ADC_setCallBack(void(*a_ptr)(void)){
+	g_callBackPtrAdc = a_ptr ;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+static void ADC_clearTrigger(void){
+
+	switch (g_adcTrigger) {
+	case ADC_TIMER0_COMPARE:
+		HAL_WRITE(TIFR,(1<<OCF0));
+		break;
+	case ADC_TIMER0_OVERFLOW:
+		HAL_WRITE(TIFR,(1<<TOV0));
+		break;
+	case ADC_TIMER1_COMPARE_B:
+		HAL_WRITE(TIFR,(1<<OCF1B));
+		break;
+	case ADC_TIMER1_OVERFLOW:
+		HAL_WRITE(TIFR,(1<<TOV1));
+		break;
+	case ADC_TIMER1_CAPTURE:
+		HAL_WRITE(TIFR,(1<<ICF1));
+		break;
+	case ADC_EXTERNAL_INT0:
+		HAL_WRITE(GIFR,(1<<INTF0));
+		break;
+	default:
+		break;
+	}
+}
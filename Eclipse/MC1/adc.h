@@ -0,0 +1,91 @@
+/******************************************************************************
+ *
+ * Module: ADC
+ *
+ * File Name: adc.h
+ *
+ * Description: Header file for the ATmega16 ADC driver
+ * 				1- single conversion on any channel (polling)
+ * 				2- auto triggered conversions from a timer/external source
+ * 				   with a call back at the end of each conversion
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef ADC_H_
+#define ADC_H_
+
+#include "micro_config.h"
+#include "std_types.h"
+#include "common_macros.h"
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* voltage reference of the ADC (REFS1:0 bits) */
+typedef enum {
+	AREF_PIN,AVCC_PIN,INTERNAL_2_56V=3
+}AdcReference;
+
+/* ADC clock = F_CPU / prescaler (ADPS2:0 bits) */
+typedef enum {
+	ADC_F_CPU_2=1,ADC_F_CPU_4,ADC_F_CPU_8,ADC_F_CPU_16,ADC_F_CPU_32,ADC_F_CPU_64,ADC_F_CPU_128
+}AdcPrescaler;
+
+/* source that starts a conversion automatically (ADTS2:0 bits)
+ * NO_AUTO_TRIGGER means conversions are only started by software */
+typedef enum {
+	ADC_FREE_RUNNING,ADC_ANALOG_COMPARATOR,ADC_EXTERNAL_INT0,ADC_TIMER0_COMPARE,ADC_TIMER0_OVERFLOW,
+	ADC_TIMER1_COMPARE_B,ADC_TIMER1_OVERFLOW,ADC_TIMER1_CAPTURE,ADC_NO_AUTO_TRIGGER
+}AdcTriggerSource;
+
+typedef struct{
+	AdcReference Reference;
+	AdcPrescaler Prescaler;
+	AdcTriggerSource Trigger;
+	uint8 Channel;   /* ADC0..ADC7 (PA0..PA7) */
+	uint8 IntEnable; /* call the call back at the end of every conversion */
+}AdcConfigType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description : initialize the ADC with the required reference, clock, channel
+ * 				 and trigger source, in case of auto trigger the first conversion
+ * 				 starts with the first event of the trigger source
+ */
+void ADC_init(const AdcConfigType * config_ptr);
+
+/*
+ * Description : disable the ADC and its interrupt
+ */
+void ADC_deinit(void);
+
+/*
+ * Description : switch the ADC on and off keeping its configuration ,an
+ * 				 enabled ADC draws current even without conversions
+ */
+void ADC_enable(void);
+void ADC_disable(void);
+
+/*
+ * Description : start a single conversion on the required channel
+ * 				 and wait (polling) until it finishes then return the result
+ */
+uint16 ADC_readChannel(uint8 channel);
+
+/*
+ * Description : return the result of the last conversion (for the call back)
+ */
+uint16 ADC_getResult(void);
+
+/*
+ * Description: Function to set the Call Back function called at the end of every conversion
+ */
+void ADC_setCallBack(void(*a_ptr)(void));
+
+#endif /* ADC_H_ */
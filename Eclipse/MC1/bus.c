@@ -0,0 +1,129 @@
+ /******************************************************************************
+ *
+ * Module: Bus
+ *
+ * File Name: bus.c
+ *
+ * Description: the conversation is changed by the address frames of both
+ * 				directions ,the receive interrupt and the sender update it so
+ * 				the check of the conversation and the write of UDR are done
+ * 				with the interrupts off ,UDRE is waited for with them on (a
+ * 				frame takes 11 bits) and the check is done again after it
+ * 				the controller answers from a task ,the frames of another
+ * 				node may have reached the nodes (and moved their filter)
+ * 				before they are handled ,so after any frame received the
+ * 				next byte it sends starts with its address frame again
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#include "bus.h"
+#include "uart.h"
+
+/*******************************************************************************
+ *                            GLOBAL VARIABLES                    *
+ *******************************************************************************/
+
+static void (*volatile g_callBackPtrBus)(uint8 node,uint8 data) = NULL_PTR;
+
+/*address of this micro and the node of the current conversation*/
+static uint8 g_address;
+static volatile uint8 g_conversation = BUS_NO_CONVERSATION;
+
+/*(controller) a frame was received since the last byte sent*/
+static volatile uint8 g_received = FALSE;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/* UART receive interrupt call back */
+static void BUS_received(void);
+
+/* a new conversation ,a node receives the data frames of its own only */
+static void BUS_setConversation(uint8 node);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description : start the bus on a UART initialized with 9 data bits
+ */
+void BUS_init(uint8 address){
+
+	g_address = address;
+	BUS_setConversation(BUS_NO_CONVERSATION);
+	UART_setCallBack(BUS_received);
+}
+
+/*
+ * Description : set the call back of a received data frame
+ */
+void BUS_setCallBack(void(*a_ptr)(uint8 node,uint8 data)){
+	g_callBackPtrBus = a_ptr;
+}
+
+/*
+ * Description : send a data frame of the conversation of the node
+ */
+void BUS_sendByte(uint8 node,uint8 data){
+
+	uint8 sreg = SREG;
+
+	for(;;){
+		while(!UART_isSendReady()){}
+		cli();
+		if(g_conversation == node && !g_received){
+			break;
+		}
+		/*the address frame ,a frame received while the data frame waits
+		 * for UDRE sends it again*/
+		UART_sendAddress(node);
+		BUS_setConversation(node);
+		g_received = FALSE;
+		SREG = sreg;
+	}
+	UART_sendByte(data);
+	SREG = sreg;
+}
+
+/*
+ * Description : the next byte sent starts with its address frame
+ */
+void BUS_resync(void){
+
+	uint8 sreg = SREG;
+	cli();
+	BUS_setConversation(BUS_NO_CONVERSATION);
+	SREG = sreg;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+static void BUS_received(void){
+
+	/*the 9th bit before the data (UDR)*/
+	uint8 address = UART_isAddressReceived();
+	uint8 data = UART_recieveByte();
+
+	/*only the controller answers later than the frames it receives*/
+	g_received = (g_address == BUS_CONTROLLER);
+	if(address){
+		BUS_setConversation(data);
+	}else if(g_callBackPtrBus != NULL_PTR &&
+			(g_address == BUS_CONTROLLER || g_conversation == g_address)){
+		(*g_callBackPtrBus)(g_conversation,data);
+	}
+}
+
+static void BUS_setConversation(uint8 node){
+
+	g_conversation = node;
+	if(g_address != BUS_CONTROLLER){
+		UART_setMultiProcessorMode(node != g_address);
+	}
+}
@@ -1,28 +1,176 @@
 /******************************************************************************
  *
- * Module:
+ * Module: Buzzer
  *
  * File Name: buzzer.c
  *
- * Description:
+ * Description: buzzer pattern player (TIMER2 CTC toggle tone + system tick steps)
  *
  * Author: Ahmed Emad
  *
  *******************************************************************************/
 #include "buzzer.h"
+#include "timers.h"
+#include "systick.h"
+#include <avr/pgmspace.h>
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* one step of a pattern ,a step with duration 0 ends the pattern */
+typedef struct{
+	uint8 tone;      /* BUZZER_TONE(HZ) or BUZZER_SILENCE */
+	uint16 duration; /* in system ticks */
+}BuzzerStep;
+
+typedef struct{
+	const BuzzerStep * steps;
+	uint8 repeat;    /* start again after the last step */
+}BuzzerPatternInfo;
+
+/*******************************************************************************
+ *                      Patterns Tables (flash)                                *
+ *******************************************************************************/
+
+static const BuzzerStep g_alarmSiren[] PROGMEM = {
+		{BUZZER_TONE(800),SYSTICK_MS_TO_TICKS(250)},
+		{BUZZER_TONE(1200),SYSTICK_MS_TO_TICKS(250)},
+		{BUZZER_SILENCE,0}
+};
+
+static const BuzzerStep g_keyClick[] PROGMEM = {
+		{BUZZER_TONE(4000),SYSTICK_MS_TO_TICKS(10)},
+		{BUZZER_SILENCE,0}
+};
+
+static const BuzzerStep g_successChirp[] PROGMEM = {
+		{BUZZER_TONE(1000),SYSTICK_MS_TO_TICKS(60)},
+		{BUZZER_TONE(1500),SYSTICK_MS_TO_TICKS(60)},
+		{BUZZER_TONE(2000),SYSTICK_MS_TO_TICKS(100)},
+		{BUZZER_SILENCE,0}
+};
+
+static const BuzzerStep g_failureBeep[] PROGMEM = {
+		{BUZZER_TONE(300),SYSTICK_MS_TO_TICKS(150)},
+		{BUZZER_SILENCE,SYSTICK_MS_TO_TICKS(100)},
+		{BUZZER_TONE(300),SYSTICK_MS_TO_TICKS(400)},
+		{BUZZER_SILENCE,0}
+};
+
+/* indexed by BuzzerPattern */
+static const BuzzerPatternInfo g_patterns[BUZZER_PATTERNS_NUM] PROGMEM = {
+		{g_alarmSiren,TRUE},
+		{g_keyClick,FALSE},
+		{g_successChirp,FALSE},
+		{g_failureBeep,FALSE}
+};
+
+/*******************************************************************************
+ *                            GLOBAL VARIABLES                    *
+ *******************************************************************************/
+
+/*first step of the playing pattern and the step playing now*/
+static const BuzzerStep * volatile g_patternStart;
+static const BuzzerStep * volatile g_step;
+
+static volatile uint8 g_repeat;
+static volatile uint8 g_playing = FALSE;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/*Description : output the tone of g_step and start the step timer*/
+static void BUZZER_playStep(void);
+
+/*Description : system tick call back at the end of every step*/
+static void BUZZER_nextStep(void);
+
+/*Description : stop TIMER2 and keep the pin low*/
+static void BUZZER_silence(void);
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
  *******************************************************************************/
 
-/*Description : function to turn on buzzer */
-void buzzerOn(void){
-	/*TURN ON THE BUZZER*/
-	SET_BIT(PORTA,PA2);
+/*Description : function to initialize the buzzer pin (silent) */
+void BUZZER_init(void){
+	/* OC2 pin as output */
+	SET_BIT(DDRD,PD7);
+	BUZZER_silence();
 }
 
-/*Description : function to turn on buzzer */
-void buzzerOff(void){
-	/*TURN OFF THE BUZZER*/
-	CLEAR_BIT(PORTA,PA2);
+/*Description : function to start playing a pattern (stops the playing one)
+ * it returns immediately ,the alarm siren repeats until BUZZER_stop */
+void BUZZER_play(BuzzerPattern pattern){
+
+	BUZZER_stop();
+
+	g_patternStart = (const BuzzerStep *)pgm_read_ptr(&g_patterns[pattern].steps);
+	g_repeat = pgm_read_byte(&g_patterns[pattern].repeat);
+	g_step = g_patternStart;
+	g_playing = TRUE;
+
+	BUZZER_playStep();
+}
+
+/*Description : function to stop the playing pattern */
+void BUZZER_stop(void){
+
+	SYSTICK_stopTimer(BUZZER_TIMER);
+	g_playing = FALSE;
+	BUZZER_silence();
+}
+
+/*Description : function to check if a pattern is still playing */
+uint8 BUZZER_isPlaying(void){
+	return g_playing;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+static void BUZZER_playStep(void){
+
+	/* Create configuration structure for CTC mode timer2 toggling OC2 without interrupt */
+	TimersConfigType s_timer2Config = {COMPARE,BUZZER_TIMER_CLOCK,0,TIMER2 };
+	TimersCompareModeConfig s_cmpModeT2Config ={0,0,OCN_CONNECTED_TOGGLE,OCN_DISCONNECTED};
+
+	uint16 duration = pgm_read_word(&g_step->duration);
+	uint8 tone;
+
+	if(duration == 0){
+		if(!g_repeat){
+			g_playing = FALSE;
+			BUZZER_silence();
+			return;
+		}
+		g_step = g_patternStart;
+		duration = pgm_read_word(&g_step->duration);
+	}
+
+	tone = pgm_read_byte(&g_step->tone);
+	if(tone == BUZZER_SILENCE){
+		BUZZER_silence();
+	}else{
+		s_cmpModeT2Config.CompareRegValue1 = tone;
+		TIMERS_init(&s_timer2Config,&s_cmpModeT2Config);
+	}
+
+	SYSTICK_startTimer(BUZZER_TIMER,duration,FALSE,BUZZER_nextStep);
+}
+
+static void BUZZER_nextStep(void){
+
+	g_step++;
+	BUZZER_playStep();
+}
+
+static void BUZZER_silence(void){
+
+	/* disconnect OC2 from the timer then the pin follows PORTD7 */
+	TIMERS_deinit(TIMER2);
+	CLEAR_BIT(PORTD,PD7);
 }
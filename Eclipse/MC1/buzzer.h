@@ -2,6 +2,9 @@
  *  File name  buzzer.h
  *
  *	Description : providing API's to deal with the buzzer module
+ *				  the tone is generated by TIMER2 in compare (CTC) mode toggling
+ *				  OC2 (PD7) and the patterns (flash tables of tone/duration steps)
+ *				  are played in the back ground by a system tick software timer
  *
  *  Author: Ahmed Emad
  */
@@ -13,10 +16,49 @@
 #include "std_types.h"
 #include "common_macros.h"
 
-/*Description : function to turn on buzzer */
-void buzzerOn(void);
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
 
-/*Description : function to turn on buzzer */
-void buzzerOff(void);
+/* TIMER2 clock used for the tones is always 125 kHz */
+#if (F_CPU <= 2000000UL)
+#define BUZZER_TIMER_CLOCK F_CPU_8
+#elif (F_CPU <= 8000000UL)
+#define BUZZER_TIMER_CLOCK F_CPU_64
+#else
+#define BUZZER_TIMER_CLOCK F_CPU_T2_128
+#endif
+#define BUZZER_TIMER_FREQUENCY 125000UL
+
+/* OCR2 value of a tone ,the pin toggles on every compare match (245 Hz .. 62 kHz) */
+#define BUZZER_TONE(HZ) ((uint8)(BUZZER_TIMER_FREQUENCY/(2UL*(HZ)) - 1))
+
+/* step of a pattern without sound */
+#define BUZZER_SILENCE 0
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef enum {
+	BUZZER_ALARM_SIREN,BUZZER_KEY_CLICK,BUZZER_SUCCESS_CHIRP,BUZZER_FAILURE_BEEP,BUZZER_PATTERNS_NUM
+}BuzzerPattern;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*Description : function to initialize the buzzer pin (silent) */
+void BUZZER_init(void);
+
+/*Description : function to start playing a pattern (stops the playing one)
+ * it returns immediately ,the alarm siren repeats until BUZZER_stop */
+void BUZZER_play(BuzzerPattern pattern);
+
+/*Description : function to stop the playing pattern */
+void BUZZER_stop(void);
+
+/*Description : function to check if a pattern is still playing */
+uint8 BUZZER_isPlaying(void);
 
 #endif /* BUZZER_H_ */
@@ -13,14 +13,17 @@
 #ifndef COMMON_MACROS
 #define COMMON_MACROS
 
+/* registers are accessed through the HAL (the register itself on the micro) */
+#include "hal.h"
+
 /* Set a certain bit in any register */
-#define SET_BIT(REG,BIT) (REG|=(1<<BIT))
+#define SET_BIT(REG,BIT) HAL_WRITE(REG,HAL_READ(REG)|(1<<BIT))
 
 /* Clear a certain bit in any register */
-#define CLEAR_BIT(REG,BIT) (REG&=(~(1<<BIT)))
+#define CLEAR_BIT(REG,BIT) HAL_WRITE(REG,HAL_READ(REG)&(~(1<<BIT)))
 
 /* Toggle a certain bit in any register */
-#define TOGGLE_BIT(REG,BIT) (REG^=(1<<BIT))
+#define TOGGLE_BIT(REG,BIT) HAL_WRITE(REG,HAL_READ(REG)^(1<<BIT))
 
 /* Rotate right the register value with specific number of rotates */
 #define ROR(REG,num) ( REG= (REG>>num) | (REG<<(8-num)) )
@@ -29,9 +32,9 @@
 #define ROL(REG,num) ( REG= (REG<<num) | (REG>>(8-num)) )
 
 /* Check if a specific bit is set in any register and return true if yes */
-#define BIT_IS_SET(REG,BIT) ( REG & (1<<BIT) )
+#define BIT_IS_SET(REG,BIT) ( HAL_READ(REG) & (1<<BIT) )
 
 /* Check if a specific bit is cleared in any register and return true if yes */
-#define BIT_IS_CLEAR(REG,BIT) ( !(REG & (1<<BIT)) )
+#define BIT_IS_CLEAR(REG,BIT) ( !(HAL_READ(REG) & (1<<BIT)) )
 
 #endif
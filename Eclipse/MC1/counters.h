@@ -0,0 +1,110 @@
+/******************************************************************************
+ *
+ * Module: Counters
+ *
+ * File Name: counters.h
+ *
+ * Description: performance counters of the drivers (both micros)
+ * 				1- COUNTERS_INC(id) / COUNTERS_ADD(id,n) add to a 32 bits
+ * 				   counter in place (no call ,they are used in the ISRs) ,a
+ * 				   counter wraps around ,the host takes the difference of two
+ * 				   snapshots modulo 2^32
+ * 				2- a counter is changed either by the ISRs or by the tasks ,
+ * 				   never by both ,so the increments need no critical section
+ * 				3- the ids are fixed at compile time (COUNTERS_LIST) so the host
+ * 				   tools (host/counters_print.c ,cosim) use the same names
+ * 				4- COUNTERS_snapshot sends 'P' 'C' count ,the cycles since
+ * 				   SYSTICK_init (system tick resolution) then count counters ,
+ * 				   all little endian 32 bits
+ * 				   MC1 sends it to a node sending COUNTERS_REQUEST after logging
+ * 				   in with the password of the system (WRONG_PASSWORD otherwise)
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef COUNTERS_H_
+#define COUNTERS_H_
+
+#include "micro_config.h"
+#include "std_types.h"
+#include "common_macros.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* 0 removes all the counters from the build */
+#ifndef COUNTERS_ENABLE
+#define COUNTERS_ENABLE 1
+#endif
+
+/* byte received from a node asking for the snapshot (not used by the protocol with MC2) */
+#define COUNTERS_REQUEST 0XDE
+
+/* first 2 bytes of a snapshot */
+#define COUNTERS_MAGIC1 'P'
+#define COUNTERS_MAGIC2 'C'
+
+/* ids of the counters and what they count */
+#define COUNTERS_LIST(COUNTER) \
+	COUNTER(COUNTER_UART_RX_BYTES)        /* frames read from UDR                 */ \
+	COUNTER(COUNTER_UART_TX_BYTES)        /* frames written to UDR ,addresses too */ \
+	COUNTER(COUNTER_UART_FRAME_ERRORS)    /* frames received with FE set          */ \
+	COUNTER(COUNTER_UART_OVERRUNS)        /* frames received with DOR set         */ \
+	COUNTER(COUNTER_TWI_TRANSACTIONS)     /* START conditions (2 for a read)      */ \
+	COUNTER(COUNTER_TWI_NACKS)            /* address or data not acknowledged     */ \
+	COUNTER(COUNTER_TWI_RETRIES)          /* EEPROM addressed again (busy)        */ \
+	COUNTER(COUNTER_EEPROM_WRITE_CYCLES)  /* byte or page writes                  */ \
+	COUNTER(COUNTER_KEYPAD_EVENTS)        /* keys reported                        */ \
+	COUNTER(COUNTER_LCD_BYTES)            /* commands and characters              */ \
+	COUNTER(COUNTER_ISR_UART)             /* receive complete interrupts          */ \
+	COUNTER(COUNTER_ISR_TIMER)            /* TIMER0/1/2 interrupts                */ \
+	COUNTER(COUNTER_IDLE_CYCLES)          /* cycles asleep ,the tick running      */ \
+	COUNTER(COUNTER_BUS_DROPS)            /* bus bytes lost ,task queue full      */
+
+#define COUNTERS_ID(NAME) NAME,
+
+#if COUNTERS_ENABLE
+#define COUNTERS_ADD(ID,N) (g_counters[(ID)] += (N))
+#else
+#define COUNTERS_ADD(ID,N) ((void)0)
+#endif
+#define COUNTERS_INC(ID) COUNTERS_ADD(ID,1)
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef enum {
+	COUNTERS_LIST(COUNTERS_ID)
+	COUNTERS_NUM
+}CountersId;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* the counters ,changed in place by COUNTERS_ADD only */
+extern volatile uint32 g_counters[COUNTERS_NUM];
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description : send the cycles since SYSTICK_init and all the counters with
+ * 	the given function (blocking) ,the counters are copied with the
+ * 	interrupts disabled first
+ */
+void COUNTERS_snapshot(void(*a_sendByte)(uint8 data));
+
+/*
+ * Description : start and end of a sleep of the scheduler (interrupts
+ * 	disabled) ,the time between them is counted in COUNTER_IDLE_CYCLES ,the
+ * 	interrupt waking the CPU is counted with it
+ */
+void COUNTERS_idleBegin(void);
+void COUNTERS_idleEnd(void);
+
+#endif /* COUNTERS_H_ */
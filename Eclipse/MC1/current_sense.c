@@ -0,0 +1,162 @@
+/******************************************************************************
+ *
+ * Module: Current Sense
+ *
+ * File Name: current_sense.c
+ *
+ * Description: motor stall / gate obstruction detection
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+#include "current_sense.h"
+#include "adc.h"
+#include "motor.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* the filter output is kept with 4 fraction bits (1023<<4 still fits in sint16)*/
+#define FILTER_FRACTION_BITS 4
+
+/*******************************************************************************
+ *                            GLOBAL VARIABLES                    *
+ *******************************************************************************/
+
+static void (*volatile g_callBackPtrStall)(void) = NULL_PTR;
+
+/* number of samples above the trip level required to trip */
+static uint16 g_tripSamples;
+
+/* number of samples ignored after starting the motor */
+static uint16 g_blankingSamples;
+
+/* filter output in fixed point (FILTER_FRACTION_BITS fraction bits) */
+static volatile sint16 g_filtered;
+
+/* samples left of the blanking time */
+static volatile uint16 g_blankingCount;
+
+/* consecutive samples above the trip level */
+static volatile uint16 g_aboveCount;
+
+/* watching the current or not */
+static volatile uint8 g_active = FALSE;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/* ADC call back : runs once per PWM period */
+static void CURRENT_SENSE_newSample(void);
+
+/* convert a time to number of samples at the motor PWM frequency (rounded up, at least one) */
+static uint16 CURRENT_SENSE_msToSamples(uint16 time_ms);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description : initialize the ADC in auto trigger mode and set the trip time
+ * 	[in] tripTime_ms : time the filtered current must stay above the trip level
+ * 	[in] a_ptr : function called (from the ADC ISR) after the motor is stopped
+ */
+void CURRENT_SENSE_init(uint16 tripTime_ms,void(*a_ptr)(void)){
+
+	/* ADC clock must be 50-200 kHz for 10 bits accuracy ,
+	 * conversion start on every compare match B of the motor PWM timer */
+#if (F_CPU <= 1000000UL)
+	AdcConfigType s_adcConfig = {AVCC_PIN,ADC_F_CPU_8,ADC_TIMER1_COMPARE_B,CURRENT_SENSE_CHANNEL,1};
+#else
+	AdcConfigType s_adcConfig = {AVCC_PIN,ADC_F_CPU_64,ADC_TIMER1_COMPARE_B,CURRENT_SENSE_CHANNEL,1};
+#endif
+
+	g_callBackPtrStall = a_ptr;
+
+	g_tripSamples = CURRENT_SENSE_msToSamples(tripTime_ms);
+	g_blankingSamples = CURRENT_SENSE_msToSamples(CURRENT_SENSE_BLANKING_MS);
+
+	g_active = FALSE;
+	ADC_setCallBack(CURRENT_SENSE_newSample);
+	ADC_init(&s_adcConfig);
+	/* off until the motor moves */
+	ADC_disable();
+}
+
+/*
+ * Description : switch the ADC on and start watching the current
+ */
+void CURRENT_SENSE_start(void){
+
+	g_filtered = 0;
+	g_aboveCount = 0;
+	g_blankingCount = g_blankingSamples;
+	g_active = TRUE;
+	ADC_enable();
+}
+
+/*
+ * Description : stop watching the current and switch the ADC off
+ */
+void CURRENT_SENSE_stop(void){
+	g_active = FALSE;
+	ADC_disable();
+}
+
+/*
+ * Description : return the last filtered current reading (0..1023)
+ */
+uint16 CURRENT_SENSE_getFiltered(void){
+	return (uint16)(g_filtered>>FILTER_FRACTION_BITS);
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+static void CURRENT_SENSE_newSample(void){
+
+	sint16 sample = (sint16)(ADC_getResult()<<FILTER_FRACTION_BITS);
+
+	if(!g_active){
+		return;
+	}
+
+	/* first order IIR low pass  y = y + (x-y)/2^SHIFT
+	 * only shifts and adds ,no multiplication or division */
+	g_filtered += (sample - g_filtered)>>CURRENT_SENSE_FILTER_SHIFT;
+
+	/* ignore the inrush current of the motor start */
+	if(g_blankingCount){
+		g_blankingCount--;
+		return;
+	}
+
+	if(g_filtered >= (sint16)(CURRENT_SENSE_TRIP_LEVEL<<FILTER_FRACTION_BITS)){
+		g_aboveCount++;
+		if(g_aboveCount >= g_tripSamples){
+			/* the gate is blocked stop the motor immediately */
+			motor_stop();
+			g_active = FALSE;
+			ADC_disable();
+			if(g_callBackPtrStall != NULL_PTR){
+				(*g_callBackPtrStall)();
+			}
+		}
+	}else{
+		g_aboveCount = 0;
+	}
+}
+
+static uint16 CURRENT_SENSE_msToSamples(uint16 time_ms){
+
+	uint32 samples = ((uint32)time_ms*motor_getFrequency() + 999UL)/1000UL;
+	if(samples == 0){
+		samples = 1;
+	}else if(samples > 0xFFFF){
+		samples = 0xFFFF;
+	}
+	return (uint16)samples;
+}
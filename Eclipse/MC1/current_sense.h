@@ -0,0 +1,73 @@
+/******************************************************************************
+ *
+ * Module: Current Sense
+ *
+ * File Name: current_sense.h
+ *
+ * Description: motor stall / gate obstruction detection
+ * 				the motor current (voltage across the shunt resistor) is sampled
+ * 				by the ADC once every motor PWM period (triggered by the TIMER1
+ * 				compare match B in the middle of the on time),
+ * 				filtered by a fixed point IIR filter and when the filtered
+ * 				current stays above the trip level for the trip time
+ * 				the motor is stopped and the application is informed
+ * 				the ADC is switched on only while the current is watched
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef CURRENT_SENSE_H_
+#define CURRENT_SENSE_H_
+
+#include "micro_config.h"
+#include "std_types.h"
+#include "common_macros.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* ADC channel of the shunt resistor (ADC3/PA3) */
+#define CURRENT_SENSE_CHANNEL 3
+
+/* ADC reading (0..1023) of the stall current */
+#define CURRENT_SENSE_TRIP_LEVEL 600
+
+/* IIR filter y += (x-y)/2^SHIFT  ,2 --> alpha = 0.25 */
+#define CURRENT_SENSE_FILTER_SHIFT 2
+
+/* time after starting the motor in which the inrush current is ignored */
+#define CURRENT_SENSE_BLANKING_MS 200
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description : initialize the ADC in auto trigger mode (off until
+ * 				 CURRENT_SENSE_start) and set the trip time
+ * 				 (call it after motor_init as the sample rate is the PWM frequency)
+ * 	[in] tripTime_ms : time the filtered current must stay above the trip level
+ * 	[in] a_ptr : function called (from the ADC ISR) after the motor is stopped
+ */
+void CURRENT_SENSE_init(uint16 tripTime_ms,void(*a_ptr)(void));
+
+/*
+ * Description : switch the ADC on and start watching the current (call it
+ * 				 after starting the motor)
+ */
+void CURRENT_SENSE_start(void);
+
+/*
+ * Description : stop watching the current and switch the ADC off (call it
+ * 				 when the motor is stopped)
+ */
+void CURRENT_SENSE_stop(void);
+
+/*
+ * Description : return the last filtered current reading (0..1023)
+ */
+uint16 CURRENT_SENSE_getFiltered(void);
+
+#endif /* CURRENT_SENSE_H_ */
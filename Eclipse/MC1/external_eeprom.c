@@ -11,6 +11,15 @@
  *******************************************************************************/
 #include "i2c.h"
 #include "external_eeprom.h"
+#include "trace.h"
+#include "counters.h"
+
+/*tries of the acknowledge polling ,a try is about 12 TWI clocks so they last
+ * longer than the 10 ms write cycle at 50 kHz*/
+#define EEPROM_READY_TRIES 100
+
+/*Description : trace the TWI status of a failed transfer and return ERROR*/
+static uint8 EEPROM_fail(void);
 
 void EEPROM_init(void)
 {
@@ -24,72 +33,187 @@ void EEPROM_init(void)
 
 uint8 EEPROM_writeByte(uint16 u16addr, uint8 u8data)
 {
+	TRACE(TRACE_EEPROM_WRITE,u16addr);
+
 	/* Send the Start Bit */
     TWI_start();
     if (TWI_getStatus() != TW_START)
-        return ERROR;
+        return EEPROM_fail();
 		
     /* Send the device address, we need to get A8 A9 A10 address bits from the
      * memory location address and R/W=0 (write) */
     TWI_write((uint8)(0xA0 | ((u16addr & 0x0700)>>7)));
     if (TWI_getStatus() != TW_MT_SLA_W_ACK)
-        return ERROR; 
+        return EEPROM_fail(); 
 		 
     /* Send the required memory location address */
     TWI_write((uint8)(u16addr));
     if (TWI_getStatus() != TW_MT_DATA_ACK)
-        return ERROR;
+        return EEPROM_fail();
 		
     /* write byte to EEPROM */
     TWI_write(u8data);
     if (TWI_getStatus() != TW_MT_DATA_ACK)
-        return ERROR;
+        return EEPROM_fail();
 
-    /* Send the Stop Bit */
+    /* Send the Stop Bit ,the write cycle starts */
     TWI_stop();
+    COUNTERS_INC(COUNTER_EEPROM_WRITE_CYCLES);
 	
     return SUCCESS;
 }
 
 uint8 EEPROM_readByte(uint16 u16addr, uint8 *u8data_Ptr)
 {
+	TRACE(TRACE_EEPROM_READ,u16addr);
+
 	/* Send the Start Bit */
     TWI_start();
     if (TWI_getStatus() != TW_START)
-        return ERROR;
+        return EEPROM_fail();
 		
     /* Send the device address, we need to get A8 A9 A10 address bits from the
      * memory location address and R/W=0 (write) */
     TWI_write((uint8)((0xA0) | ((u16addr & 0x0700)>>7)));
     if (TWI_getStatus() != TW_MT_SLA_W_ACK)
-        return ERROR;
+        return EEPROM_fail();
 		
     /* Send the required memory location address */
     TWI_write((uint8)(u16addr));
     if (TWI_getStatus() != TW_MT_DATA_ACK)
-        return ERROR;
+        return EEPROM_fail();
 		
     /* Send the Repeated Start Bit */
     TWI_start();
     if (TWI_getStatus() != TW_REP_START)
-        return ERROR;
+        return EEPROM_fail();
 		
     /* Send the device address, we need to get A8 A9 A10 address bits from the
      * memory location address and R/W=1 (Read) */
     TWI_write((uint8)((0xA0) | ((u16addr & 0x0700)>>7) | 1));
     if (TWI_getStatus() != TW_MT_SLA_R_ACK)
-        return ERROR;
+        return EEPROM_fail();
 
     /* Read Byte from Memory without send ACK */
     *u8data_Ptr = TWI_readWithNACK();
     if (TWI_getStatus() != TW_MR_DATA_NACK)
-        return ERROR;
+        return EEPROM_fail();
+
+    /* Send the Stop Bit */
+    TWI_stop();
+    return SUCCESS;
+}
+
+/*Description : sequential read ,every byte but the last is acknowledged so
+ * the EEPROM sends the next one without a new address phase*/
+uint8 EEPROM_readBytes(uint16 u16addr,uint8 *u8data_Ptr,uint8 count)
+{
+	TRACE(TRACE_EEPROM_READ,u16addr);
+
+	/* Send the Start Bit */
+    TWI_start();
+    if (TWI_getStatus() != TW_START)
+        return EEPROM_fail();
+
+    /* Send the device address with the A8 A9 A10 bits and R/W=0 (write) */
+    TWI_write((uint8)((0xA0) | ((u16addr & 0x0700)>>7)));
+    if (TWI_getStatus() != TW_MT_SLA_W_ACK)
+        return EEPROM_fail();
+
+    /* Send the required memory location address */
+    TWI_write((uint8)(u16addr));
+    if (TWI_getStatus() != TW_MT_DATA_ACK)
+        return EEPROM_fail();
+
+    /* Send the Repeated Start Bit */
+    TWI_start();
+    if (TWI_getStatus() != TW_REP_START)
+        return EEPROM_fail();
+
+    /* Send the device address with R/W=1 (Read) */
+    TWI_write((uint8)((0xA0) | ((u16addr & 0x0700)>>7) | 1));
+    if (TWI_getStatus() != TW_MT_SLA_R_ACK)
+        return EEPROM_fail();
+
+    /* Read the bytes ,ACK for all of them but the last one */
+    while(count > 1)
+    {
+        *u8data_Ptr = TWI_readWithACK();
+        if (TWI_getStatus() != TW_MR_DATA_ACK)
+            return EEPROM_fail();
+        u8data_Ptr++;
+        count--;
+    }
+    *u8data_Ptr = TWI_readWithNACK();
+    if (TWI_getStatus() != TW_MR_DATA_NACK)
+        return EEPROM_fail();
 
     /* Send the Stop Bit */
     TWI_stop();
     return SUCCESS;
 }
 
+/*Description : page write ,the EEPROM keeps the bytes in its page buffer and
+ * writes them all in one write cycle after the STOP*/
+uint8 EEPROM_writePage(uint16 u16addr,const uint8 *u8data_Ptr,uint8 count)
+{
+	TRACE(TRACE_EEPROM_WRITE,u16addr);
+
+	/* Send the Start Bit */
+    TWI_start();
+    if (TWI_getStatus() != TW_START)
+        return EEPROM_fail();
+
+    /* Send the device address with the A8 A9 A10 bits and R/W=0 (write) */
+    TWI_write((uint8)(0xA0 | ((u16addr & 0x0700)>>7)));
+    if (TWI_getStatus() != TW_MT_SLA_W_ACK)
+        return EEPROM_fail();
+
+    /* Send the address of the first byte */
+    TWI_write((uint8)(u16addr));
+    if (TWI_getStatus() != TW_MT_DATA_ACK)
+        return EEPROM_fail();
+
+    /* the EEPROM moves to the next byte of the page after every byte */
+    while(count > 0)
+    {
+        TWI_write(*u8data_Ptr);
+        if (TWI_getStatus() != TW_MT_DATA_ACK)
+            return EEPROM_fail();
+        u8data_Ptr++;
+        count--;
+    }
+
+    /* Send the Stop Bit ,the write cycle starts */
+    TWI_stop();
+    COUNTERS_INC(COUNTER_EEPROM_WRITE_CYCLES);
+    return SUCCESS;
+}
+
+/*Description : the EEPROM does not acknowledge its address during a write
+ * cycle ,try again until it does*/
+uint8 EEPROM_waitReady(void)
+{
+	uint8 tries;
+
+	for(tries = 0; tries < EEPROM_READY_TRIES; tries++)
+	{
+		TWI_start();
+		if (TWI_getStatus() == TW_START)
+		{
+			TWI_write(0xA0);
+			if (TWI_getStatus() == TW_MT_SLA_W_ACK)
+			{
+				TWI_stop();
+				return SUCCESS;
+			}
+		}
+		TWI_stop();
+		COUNTERS_INC(COUNTER_TWI_RETRIES);
+	}
+	return EEPROM_fail();
+}
+
 /*Description : function to write string in EEPROM starts from address u16address*/
 void EEPROM_writeString(uint16 u16addr,uint8 *str){
 
@@ -116,19 +240,10 @@ void EEPROM_readString(uint16 u16addr,uint8 *str){
 
 }
 
+static uint8 EEPROM_fail(void){
 
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
+	TRACE(TRACE_TWI_ERROR,TWI_getStatus());
+	/* release the bus so the next transfer starts with a START (not a repeated START) */
+	TWI_stop();
+	return ERROR;
+}
@@ -22,12 +22,24 @@
 #define ERROR 0
 #define SUCCESS 1
 
+/*bytes of a page of the M24C16 ,a page write stays inside one page*/
+#define EEPROM_PAGE_SIZE 16
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 void EEPROM_init(void);
 uint8 EEPROM_writeByte(uint16 u16addr,uint8 u8data);
 uint8 EEPROM_readByte(uint16 u16addr,uint8 *u8data_Ptr);
+/*read count bytes from u16addr in one sequential read (one address phase) ,
+ * the address rolls over the whole memory*/
+uint8 EEPROM_readBytes(uint16 u16addr,uint8 *u8data_Ptr,uint8 count);
+/*write count bytes from u16addr in one transfer (one write cycle) ,the bytes
+ * must not cross the end of the page of u16addr*/
+uint8 EEPROM_writePage(uint16 u16addr,const uint8 *u8data_Ptr,uint8 count);
+/*acknowledge polling : wait until the EEPROM ends its write cycle and
+ * answers its address*/
+uint8 EEPROM_waitReady(void);
 
 void EEPROM_writeString(uint16 u16addr,uint8 *str);
 void EEPROM_readString(uint16 u16addr,uint8 *str);
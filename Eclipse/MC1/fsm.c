@@ -0,0 +1,94 @@
+/******************************************************************************
+ *
+ * Module: FSM
+ *
+ * File Name: fsm.c
+ *
+ * Description: table driven finite state machine
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+#include "fsm.h"
+#include <avr/pgmspace.h>
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/* call the entry (or exit) action of the current state from the flash table */
+static void FSM_callStateAction(FsmType * a_fsm,uint8 isEntry);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description : put the state machine in its initial state and call its entry action
+ */
+void FSM_start(FsmType * a_fsm,uint8 initialState){
+	a_fsm->state = initialState;
+	FSM_callStateAction(a_fsm,TRUE);
+}
+
+/*
+ * Description : run the transition of the event in the current state
+ * 	1. exit action of the current state (if the state changes)
+ * 	2. transition action
+ * 	3. entry action of the next state (if the state changes)
+ * 	4. dispatch the event returned by the transition action if any
+ */
+void FSM_dispatch(FsmType * a_fsm,uint8 event,uint8 data){
+
+	const FsmTransition * transition;
+	uint8 nextState;
+	FsmAction action;
+
+	while(event != FSM_NO_EVENT){
+
+		transition = &a_fsm->transitions[a_fsm->state * a_fsm->eventsNum + event];
+		nextState = pgm_read_byte(&transition->nextState);
+		action = (FsmAction)pgm_read_ptr(&transition->action);
+
+		if(nextState != FSM_NO_CHANGE){
+			FSM_callStateAction(a_fsm,FALSE);
+		}
+
+		event = FSM_NO_EVENT;
+		if(action != NULL_PTR){
+			event = (*action)(data);
+		}
+
+		if(nextState != FSM_NO_CHANGE){
+			a_fsm->state = nextState;
+			FSM_callStateAction(a_fsm,TRUE);
+		}
+	}
+}
+
+/*
+ * Description : return the current state
+ */
+uint8 FSM_getState(const FsmType * a_fsm){
+	return a_fsm->state;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+static void FSM_callStateAction(FsmType * a_fsm,uint8 isEntry){
+
+	const FsmStateActions * actions = &a_fsm->stateActions[a_fsm->state];
+	FsmStateAction stateAction;
+
+	if(isEntry){
+		stateAction = (FsmStateAction)pgm_read_ptr(&actions->entry);
+	}else{
+		stateAction = (FsmStateAction)pgm_read_ptr(&actions->exit);
+	}
+
+	if(stateAction != NULL_PTR){
+		(*stateAction)();
+	}
+}
@@ -0,0 +1,88 @@
+/******************************************************************************
+ *
+ * Module: FSM
+ *
+ * File Name: fsm.h
+ *
+ * Description: table driven finite state machine (same driver for MC1 and MC2)
+ * 				1- the transitions table is in flash [states][events] ,every
+ * 				   entry has the next state and the transition action
+ * 				2- entry and exit actions of every state are in flash too
+ * 				3- dispatch is one table index by (state,event) ,an action can
+ * 				   return an event which is dispatched next (used for guards)
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef FSM_H_
+#define FSM_H_
+
+#include "micro_config.h"
+#include "std_types.h"
+#include "common_macros.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* next state of an internal transition (no exit or entry action) */
+#define FSM_NO_CHANGE 0XFF
+
+/* returned by a transition action that does not raise an event */
+#define FSM_NO_EVENT 0XFF
+
+/* entry of the transitions table for an event ignored in a state */
+#define FSM_IGNORE {FSM_NO_CHANGE,NULL_PTR}
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* transition action : gets the data of the event ,returns FSM_NO_EVENT or the next event */
+typedef uint8 (*FsmAction)(uint8 data);
+
+/* entry or exit action of a state */
+typedef void (*FsmStateAction)(void);
+
+typedef struct{
+	uint8 nextState; /* FSM_NO_CHANGE for an internal transition */
+	FsmAction action;
+}FsmTransition;
+
+typedef struct{
+	FsmStateAction entry;
+	FsmStateAction exit;
+}FsmStateActions;
+
+typedef struct{
+	const FsmTransition * transitions;    /* flash table [states][eventsNum] */
+	const FsmStateActions * stateActions; /* flash table [states] */
+	uint8 eventsNum;
+	uint8 state;
+}FsmType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description : put the state machine in its initial state and call its entry action
+ */
+void FSM_start(FsmType * a_fsm,uint8 initialState);
+
+/*
+ * Description : run the transition of the event in the current state
+ * 	1. exit action of the current state (if the state changes)
+ * 	2. transition action
+ * 	3. entry action of the next state (if the state changes)
+ * 	4. dispatch the event returned by the transition action if any
+ */
+void FSM_dispatch(FsmType * a_fsm,uint8 event,uint8 data);
+
+/*
+ * Description : return the current state
+ */
+uint8 FSM_getState(const FsmType * a_fsm);
+
+#endif /* FSM_H_ */
@@ -0,0 +1,93 @@
+ /******************************************************************************
+ *
+ * Module: Gate Config
+ *
+ * File Name: gate_config.c
+ *
+ * Description: the image is shared with the host that builds it ,the times
+ * 				are converted to system ticks once when it is loaded
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#include "gate_config.h"
+#include "systick.h"
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/* 16 bits little endian of the image */
+static uint16 GATE_CONFIG_read16(const uint8 * a_image,uint8 offset);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description : check the image then convert it ,the defaults otherwise
+ */
+uint8 GATE_CONFIG_load(const uint8 * a_image,GateConfigType * a_config){
+
+	uint16 open_ms = GATE_CONFIG_read16(a_image,GATE_CONFIG_OPEN_MS);
+	uint16 hold_ms = GATE_CONFIG_read16(a_image,GATE_CONFIG_HOLD_MS);
+	uint16 close_ms = GATE_CONFIG_read16(a_image,GATE_CONFIG_CLOSE_MS);
+	uint8 sum = 0;
+	uint8 valid;
+	uint8 i;
+
+	for(i = 0; i < GATE_CONFIG_SIZE; i++){
+		sum += a_image[i];
+	}
+	valid = (sum == 0 && a_image[GATE_CONFIG_VERSION_BYTE] == GATE_CONFIG_VERSION &&
+			open_ms >= GATE_CONFIG_MOVE_MIN_MS && open_ms <= GATE_CONFIG_TIME_MAX_MS &&
+			close_ms >= GATE_CONFIG_MOVE_MIN_MS && close_ms <= GATE_CONFIG_TIME_MAX_MS &&
+			hold_ms <= GATE_CONFIG_TIME_MAX_MS &&
+			a_image[GATE_CONFIG_ALARM_S] >= GATE_CONFIG_ALARM_MIN_S &&
+			a_image[GATE_CONFIG_DUTY] >= GATE_CONFIG_DUTY_MIN && a_image[GATE_CONFIG_DUTY] <= GATE_CONFIG_DUTY_MAX);
+
+	if(!valid){
+		open_ms = GATE_CONFIG_DEFAULT_OPEN_MS;
+		hold_ms = GATE_CONFIG_DEFAULT_HOLD_MS;
+		close_ms = GATE_CONFIG_DEFAULT_CLOSE_MS;
+	}
+	/*the divisions are done here and not for every gate state*/
+	a_config->openTicks = SYSTICK_MS_TO_TICKS((uint32)open_ms);
+	a_config->holdTicks = SYSTICK_MS_TO_TICKS((uint32)hold_ms);
+	a_config->closeTicks = SYSTICK_MS_TO_TICKS((uint32)close_ms);
+	a_config->alarmSeconds = valid ? a_image[GATE_CONFIG_ALARM_S] : GATE_CONFIG_DEFAULT_ALARM_S;
+	a_config->dutyCycle = valid ? a_image[GATE_CONFIG_DUTY] : GATE_CONFIG_DEFAULT_DUTY;
+	return valid;
+}
+
+/*
+ * Description : image of a profile ,the check byte makes the sum 0
+ */
+void GATE_CONFIG_build(uint16 open_ms,uint16 hold_ms,uint16 close_ms,uint8 alarm_s,uint8 duty,uint8 * a_image){
+
+	uint8 sum = 0;
+	uint8 i;
+
+	a_image[GATE_CONFIG_OPEN_MS] = (uint8)open_ms;
+	a_image[GATE_CONFIG_OPEN_MS + 1] = (uint8)(open_ms >> 8);
+	a_image[GATE_CONFIG_HOLD_MS] = (uint8)hold_ms;
+	a_image[GATE_CONFIG_HOLD_MS + 1] = (uint8)(hold_ms >> 8);
+	a_image[GATE_CONFIG_CLOSE_MS] = (uint8)close_ms;
+	a_image[GATE_CONFIG_CLOSE_MS + 1] = (uint8)(close_ms >> 8);
+	a_image[GATE_CONFIG_ALARM_S] = alarm_s;
+	a_image[GATE_CONFIG_DUTY] = duty;
+	a_image[GATE_CONFIG_VERSION_BYTE] = GATE_CONFIG_VERSION;
+	for(i = 0; i < GATE_CONFIG_CHECK; i++){
+		sum += a_image[i];
+	}
+	a_image[GATE_CONFIG_CHECK] = (uint8)(0 - sum);
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+static uint16 GATE_CONFIG_read16(const uint8 * a_image,uint8 offset){
+	return (uint16)(a_image[offset] | ((uint16)a_image[offset + 1] << 8));
+}
@@ -0,0 +1,93 @@
+ /******************************************************************************
+ *
+ * Module: Gate Config
+ *
+ * File Name: gate_config.h
+ *
+ * Description: timing profile of the gate kept in the EEPROM after the wrong
+ * 				passwords counter ,every site sets the speed of its gate
+ * 				without a new firmware
+ * 				1- the image is GATE_CONFIG_SIZE bytes : the opening ,holding
+ * 				   and closing times in milli seconds (16 bits little endian)
+ * 				   ,the seconds of siren of a lock out ,the duty cycle of the
+ * 				   motor ,GATE_CONFIG_VERSION and a check byte (the sum of all
+ * 				   the bytes is 0)
+ * 				2- MC1 reads it once at boot (with its persistent state) and
+ * 				   keeps it in system ticks ,an erased ,old or wrong image
+ * 				   gives the defaults
+ * 				3- the image is sent by a node logged in with the password of
+ * 				   the system (option GATE_CONFIG ,system_states.h) ,it is
+ * 				   used at once and written to the EEPROM in the back ground
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef GATE_CONFIG_H_
+#define GATE_CONFIG_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* EEPROM address of the image (same page as the wrong passwords counter) */
+#define GATE_CONFIG_ADDRESS 0X0024
+#define GATE_CONFIG_VERSION 0X01
+
+/* bytes of the image */
+#define GATE_CONFIG_OPEN_MS  0
+#define GATE_CONFIG_HOLD_MS  2
+#define GATE_CONFIG_CLOSE_MS 4
+#define GATE_CONFIG_ALARM_S  6
+#define GATE_CONFIG_DUTY     7
+#define GATE_CONFIG_VERSION_BYTE 8
+#define GATE_CONFIG_CHECK    9
+#define GATE_CONFIG_SIZE     10
+
+/* defaults (the times before the profile) */
+#define GATE_CONFIG_DEFAULT_OPEN_MS  15000
+#define GATE_CONFIG_DEFAULT_HOLD_MS  3000
+#define GATE_CONFIG_DEFAULT_CLOSE_MS 15000
+#define GATE_CONFIG_DEFAULT_ALARM_S  60
+#define GATE_CONFIG_DEFAULT_DUTY     50
+
+/* limits of a profile */
+#define GATE_CONFIG_MOVE_MIN_MS 500
+#define GATE_CONFIG_TIME_MAX_MS 60000
+#define GATE_CONFIG_ALARM_MIN_S 1
+#define GATE_CONFIG_DUTY_MIN    10
+#define GATE_CONFIG_DUTY_MAX    100
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* the profile as it is used ,the times in system ticks */
+typedef struct{
+	uint16 openTicks;
+	uint16 holdTicks;
+	uint16 closeTicks;
+	uint8 alarmSeconds;
+	uint8 dutyCycle;     /* 0..100 % */
+}GateConfigType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description : the profile of an image ,return FALSE and give the defaults
+ * 	if the image is not a valid one
+ */
+uint8 GATE_CONFIG_load(const uint8 * a_image,GateConfigType * a_config);
+
+/*
+ * Description : image of a profile (with its version and check byte) ,the
+ * 	limits are checked by GATE_CONFIG_load only
+ * 	[out] a_image : GATE_CONFIG_SIZE bytes
+ */
+void GATE_CONFIG_build(uint16 open_ms,uint16 hold_ms,uint16 close_ms,uint8 alarm_s,uint8 duty,uint8 * a_image);
+
+#endif /* GATE_CONFIG_H_ */
@@ -11,6 +11,7 @@
  *******************************************************************************/
  
 #include "i2c.h"
+#include "counters.h"
 
 void TWI_init(TWI_configType *  TWI_config_Ptr)
 {
@@ -22,7 +23,7 @@ void TWI_init(TWI_configType *  TWI_config_Ptr)
 	/*setting the slave address of the device*/
 	TWAR = (TWI_config_Ptr->slaveAdress)<<1;
 	
-    TWCR = (1<<TWEN); /* enable TWI */
+    HAL_WRITE(TWCR,(1<<TWEN)); /* enable TWI */
 }
 
 void TWI_start(void)
@@ -32,7 +33,8 @@ void TWI_start(void)
 	 * send the start bit by TWSTA=1
 	 * Enable TWI Module TWEN=1 
 	 */
-    TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN);
+    HAL_WRITE(TWCR,(1 << TWINT) | (1 << TWSTA) | (1 << TWEN));
+    COUNTERS_INC(COUNTER_TWI_TRANSACTIONS);
     
     /* Wait for TWINT flag set in TWCR Register (start bit is send successfully) */
     while(BIT_IS_CLEAR(TWCR,TWINT));
@@ -45,7 +47,7 @@ void TWI_stop(void)
 	 * send the stop bit by TWSTO=1
 	 * Enable TWI Module TWEN=1 
 	 */
-    TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWEN);
+    HAL_WRITE(TWCR,(1 << TWINT) | (1 << TWSTO) | (1 << TWEN));
 }
 
 void TWI_write(uint8 data)
@@ -56,7 +58,7 @@ void TWI_write(uint8 data)
 	 * Clear the TWINT flag before sending the data TWINT=1
 	 * Enable TWI Module TWEN=1 
 	 */ 
-    TWCR = (1 << TWINT) | (1 << TWEN);
+    HAL_WRITE(TWCR,(1 << TWINT) | (1 << TWEN));
     /* Wait for TWINT flag set in TWCR Register(data is send successfully) */
     while(BIT_IS_CLEAR(TWCR,TWINT));
 }
@@ -68,7 +70,7 @@ uint8 TWI_readWithACK(void)
 	 * Enable sending ACK after reading or receiving data TWEA=1
 	 * Enable TWI Module TWEN=1 
 	 */ 
-    TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWEA);
+    HAL_WRITE(TWCR,(1 << TWINT) | (1 << TWEN) | (1 << TWEA));
     /* Wait for TWINT flag set in TWCR Register (data received successfully) */
     while(BIT_IS_CLEAR(TWCR,TWINT));
     /* Read Data */
@@ -81,7 +83,7 @@ uint8 TWI_readWithNACK(void)
 	 * Clear the TWINT flag before reading the data TWINT=1
 	 * Enable TWI Module TWEN=1 
 	 */
-    TWCR = (1 << TWINT) | (1 << TWEN);
+    HAL_WRITE(TWCR,(1 << TWINT) | (1 << TWEN));
     /* Wait for TWINT flag set in TWCR Register (data received successfully) */
     while(BIT_IS_CLEAR(TWCR,TWINT));
     /* Read Data */
@@ -93,5 +95,18 @@ uint8 TWI_getStatus(void)
     uint8 status;
     /* masking to eliminate first 3 bits and get the last 5 bits (status bits) */
     status = TWSR & 0xF8;
+    if(status == TW_MT_SLA_W_NACK || status == TW_MT_DATA_NACK || status == TW_MR_SLA_R_NACK)
+    {
+        COUNTERS_INC(COUNTER_TWI_NACKS);
+    }
     return status;
 }
+
+void TWI_disable(void)
+{
+    /* wait for the stop bit to be sent (TWSTO is cleared by the hardware) */
+    while(BIT_IS_SET(TWCR,TWSTO));
+
+    /* TWEN=0 switches the TWI off ,the bit rate is kept */
+    HAL_WRITE(TWCR,0);
+}
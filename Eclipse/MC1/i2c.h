@@ -29,6 +29,9 @@
 #define TW_MT_DATA_ACK   0x28 // Master transmit data and ACK has been received from Slave.
 #define TW_MR_DATA_ACK   0x50 // Master received data and send ACK to slave
 #define TW_MR_DATA_NACK  0x58 // Master received data but doesn't send ACK to slave
+#define TW_MT_SLA_W_NACK 0x20 // Master transmit ( slave address + Write request ) to slave + NACK received from slave
+#define TW_MT_DATA_NACK  0x30 // Master transmit data and NACK has been received from Slave.
+#define TW_MR_SLA_R_NACK 0x48 // Master transmit ( slave address + Read request ) to slave + NACK received from slave
 
 
 /*******************************************************************************
@@ -51,6 +54,7 @@ void TWI_write(uint8 data);
 uint8 TWI_readWithACK(void); //read with send Ack
 uint8 TWI_readWithNACK(void); //read without send Ack
 uint8 TWI_getStatus(void);
+void TWI_disable(void); //switch the TWI off between transfers (TWI_start switches it on)
 
 
 #endif /* I2C_H_ */
@@ -12,28 +12,50 @@
 #include "motor.h"
 #include "timers.h"
 
+/*******************************************************************************
+ *                            GLOBAL VARIABLES                    *
+ *******************************************************************************/
+
+/*running PWM frequency and duty cycle*/
+static uint16 g_pwmFrequency;
+static uint8 g_dutyCycle;
+
+/*TOP value of TIMER1 (ICR1) for the running frequency*/
+static uint16 g_pwmTop;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/*Description : start TIMER1 PWM with g_pwmFrequency and g_dutyCycle*/
+static void motor_startPwm(void);
 
+/*Description : convert g_dutyCycle to OCR1A value*/
+static uint16 motor_dutyToCompareValue(void);
+
+/*Description : mode of OC1A for g_dutyCycle*/
+static TimersPwmModeOCnMode motor_outputMode(void);
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
  *******************************************************************************/
 
 /*
- * Description : initialize the timer PWM mode without rotating the motor
+ * Description : initialize TIMER1 to generate the PWM signal on the enable pin
+ * 				 of the H-bridge (OC1A/PD5) without rotating the motor
  */
-void motor_init(void){
-
-	/* define configuration structure for  general settings for timer0 */
-	TimersConfigType s_timer0Config = {PWM,F_CPU_64,0 /*interrupt disable*/ ,TIMER0 };
-
-	/*define configuration structure for PWM mode timer0
-	 * to operate 490 kHZ the top value is 6120 and disconnect OCB*/
-	TimersPwmModeConfig s_pwmTimer0Config ={128,0 /*compare value OCR1B*/ ,0 ,NON_INVERTING,DISCONNECTED};
-	TIMERS_init(&s_timer0Config,&s_pwmTimer0Config);
+void motor_init(const MotorConfigType * config_ptr){
 
 	/*initially stop   the motor */
 	PORTA &= (~(1<<PA0));
 	PORTA &= (~(1<<PA1));
+	/*the enable pin is low while OC1A is disconnected (0 % duty)*/
+	PORTD &= (~(1<<PD5));
+
+	g_pwmFrequency = config_ptr->PwmFrequency;
+	g_dutyCycle = (config_ptr->DutyCycle > 100) ? 100 : config_ptr->DutyCycle;
+
+	motor_startPwm();
 }
 /*
  * Description : disable the timer PWM mode also stop the motor
@@ -41,7 +63,7 @@ void motor_init(void){
 void motor_deInit(void){
 
 	/*disable the PWM signal*/
-	TIMERS_deinit(TIMER0);
+	TIMERS_deinit(TIMER1);
 
 	// Stop the motor
 		PORTA &= (~(1<<PA0));
@@ -49,6 +71,37 @@ void motor_deInit(void){
 
 }
 
+/*
+ * Description : change the duty cycle (0..100 %) of the enable pin ,the speed of the motor
+ */
+void motor_setDutyCycle(uint8 dutyCycle){
+
+	uint16 compareValue;
+
+	g_dutyCycle = (dutyCycle > 100) ? 100 : dutyCycle;
+	compareValue = motor_dutyToCompareValue();
+
+	/* OCR1B in the middle of the on time triggers the current sense ADC */
+	TIMERS_setCompareValue(TIMER1,compareValue,compareValue/2);
+	TIMERS_setPwmOutput(TIMER1,motor_outputMode());
+}
+
+/*
+ * Description : change the PWM frequency keeping the same duty cycle
+ */
+void motor_setFrequency(uint16 frequency){
+
+	g_pwmFrequency = frequency;
+	motor_startPwm();
+}
+
+/*
+ * Description : return the current PWM frequency in Hz
+ */
+uint16 motor_getFrequency(void){
+	return g_pwmFrequency;
+}
+
 /*
  *Description :Rotate the motor  clock wise
  */
@@ -81,3 +134,68 @@ void motor_stop(void){
 	PORTA &= (~(1<<PA1));
 
 }
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+static void motor_startPwm(void){
+
+	/* TIMER1 prescalers from the best resolution to the lowest frequency */
+	static const TimerClock prescalerClock[5] = {F_CPU_CLOCK,F_CPU_8,F_CPU_64,F_CPU_256,F_CPU_1024};
+	static const uint16 prescalerValue[5] = {1,8,64,256,1024};
+
+	/* define configuration structure for  general settings for timer1 */
+	TimersConfigType s_timer1Config = {PWM,F_CPU_1024,0 /*interrupt disable*/ ,TIMER1 };
+
+	/*define configuration structure for fast PWM mode with TOP in ICR1 ,
+	 * OC1A is the enable pin and OC1B is not connected to its pin
+	 * (its compare match only triggers the current sense ADC)*/
+	TimersPwmModeConfig s_pwmTimer1Config ={0,0,0xFFFF,NON_INVERTING,DISCONNECTED};
+
+	uint32 counts = 0x10000UL;
+	uint8 index;
+
+	if(g_pwmFrequency == 0){
+		g_pwmFrequency = 1;
+	}
+
+	/* choose the smallest prescaler that makes the period fit in the 16 bits counter */
+	for (index = 0; index < 5; ++index) {
+		counts = F_CPU/((uint32)prescalerValue[index]*g_pwmFrequency);
+		if(counts <= 0x10000UL){
+			s_timer1Config.Clock = prescalerClock[index];
+			break;
+		}
+	}
+	if(counts > 0x10000UL){
+		counts = 0x10000UL;
+	}else if(counts < 2){
+		counts = 2;
+	}
+	g_pwmTop = (uint16)(counts - 1);
+
+	s_pwmTimer1Config.Timer1_Top = g_pwmTop;
+	s_pwmTimer1Config.CompareValue1 = motor_dutyToCompareValue();
+	s_pwmTimer1Config.Timer1_comparevalue2 = s_pwmTimer1Config.CompareValue1/2;
+	s_pwmTimer1Config.OCn_Mode = motor_outputMode();
+
+	TIMERS_init(&s_timer1Config,&s_pwmTimer1Config);
+}
+
+static uint16 motor_dutyToCompareValue(void){
+
+	/* the output is high from BOTTOM until TCNT1 matches OCR1A */
+	uint32 compareValue = ((uint32)g_pwmTop + 1)*g_dutyCycle/100;
+	if(compareValue > g_pwmTop){
+		compareValue = g_pwmTop;
+	}
+	return (uint16)compareValue;
+}
+
+static TimersPwmModeOCnMode motor_outputMode(void){
+
+	/* OCR1A = 0 still sets the pin at BOTTOM for one count ,so 0 % disconnects
+	 * OC1A and leaves the pin to PD5 (low) */
+	return (g_dutyCycle == 0) ? DISCONNECTED : NON_INVERTING;
+}
@@ -8,6 +8,8 @@
  * 				1- rotate clock-wise
  * 				2- rotate anti clock-wise
  * 				3- stop
+ * 				4- speed control by hardware PWM (TIMER1 fast PWM ,TOP in ICR1)
+ * 				   on the H-bridge enable pin OC1A ,the direction pins are PA0,PA1
  *
  * Author: Ahmed Emad
  *
@@ -22,16 +24,39 @@
 #include "std_types.h"
 #include "common_macros.h"
 
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
 
+typedef struct{
+	uint16 PwmFrequency; /* frequency of the enable pin PWM in Hz */
+	uint8 DutyCycle;     /* 0..100 % */
+}MotorConfigType;
 
 
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 /*
- * Description : initialize the timer PWM mode without rotating the motor
+ * Description : initialize TIMER1 to generate the PWM signal on the enable pin
+ * 				 of the H-bridge (OC1A/PD5) without rotating the motor
+ */
+void motor_init(const MotorConfigType * config_ptr);
+
+/*
+ * Description : change the duty cycle (0..100 %) of the enable pin ,the speed of the motor
+ */
+void motor_setDutyCycle(uint8 dutyCycle);
+
+/*
+ * Description : change the PWM frequency keeping the same duty cycle
+ */
+void motor_setFrequency(uint16 frequency);
+
+/*
+ * Description : return the current PWM frequency in Hz
  */
-void motor_init(void);
+uint16 motor_getFrequency(void);
 /*
  * Description : disable the timer PWM mode also stop the motor
  */
@@ -0,0 +1,164 @@
+ /******************************************************************************
+ *
+ * Module: Queue
+ *
+ * File Name: queue.h
+ *
+ * Description: single producer ,single consumer queue between an ISR and the
+ * 				tasks (or a task and an ISR) without disabling the interrupts
+ * 				1- QUEUE_DEFINE(NAME,TYPE,SIZE) generates the type NAME##Type
+ * 				   and its functions NAME##_push ,NAME##_pop ... ,SIZE is a
+ * 				   power of 2 from 2 to 128
+ * 				2- the head (next item to pop) is written by the consumer only
+ * 				   and the tail (next free item) by the producer only ,they
+ * 				   are 8 bits counting freely (the item is index & (SIZE-1))
+ * 				   so a load or a store of one is atomic on the AVR and
+ * 				   tail - head is the number of items
+ * 				3- an item is written before the tail that publishes it
+ * 				   (release) and read after the tail is read (acquire) ,the
+ * 				   same for the head and the freed items ,on the AVR these are
+ * 				   plain loads and stores that the compiler can not move ,on
+ * 				   the host they are the barriers the threads need
+ * 				4- push and pop never wait ,they return FALSE if the queue is
+ * 				   full (or empty) ,the batch functions move as many items as
+ * 				   they can and publish them once
+ * 				5- zero copy : the consumer takes the span of items that follow
+ * 				   each other in the array (up to its end) ,uses them in place
+ * 				   then releases them
+ * 				(the same file is used by both micros)
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef QUEUE_H_
+#define QUEUE_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/*
+ * Description : type and functions of a queue of SIZE items of TYPE
+ * 	NAME##_init      : empty the queue (before the producer and the consumer run)
+ * 	NAME##_count     : items waiting (the other side may change it at once)
+ * 	NAME##_push      : producer ,add an item ,return FALSE if the queue is full
+ * 	NAME##_pushBatch : producer ,add up to length items ,return the number added
+ * 	NAME##_pop       : consumer ,take the oldest item ,return FALSE if empty
+ * 	NAME##_popBatch  : consumer ,take up to length items ,return the number taken
+ * 	NAME##_peekSpan  : consumer ,*a_span points to the oldest item ,return the
+ * 	                   number of items that follow it in the array
+ * 	NAME##_release   : consumer ,free the first length items of the span
+ */
+#define QUEUE_DEFINE(NAME,TYPE,SIZE) \
+\
+typedef struct{ \
+	TYPE items[SIZE]; \
+	uint8 head; \
+	uint8 tail; \
+}NAME##Type; \
+\
+typedef char NAME##_sizeIsPowerOf2[((SIZE) >= 2 && (SIZE) <= 128 && ((SIZE) & ((SIZE) - 1)) == 0) ? 1 : -1]; \
+\
+static inline void NAME##_init(NAME##Type * a_queue){ \
+	a_queue->head = 0; \
+	QUEUE_publish(&a_queue->tail,0); \
+} \
+\
+static inline uint8 NAME##_count(NAME##Type * a_queue){ \
+	return (uint8)(QUEUE_load(&a_queue->tail) - QUEUE_load(&a_queue->head)); \
+} \
+\
+static inline uint8 NAME##_push(NAME##Type * a_queue,TYPE item){ \
+	uint8 tail = a_queue->tail; \
+	if((uint8)(tail - QUEUE_load(&a_queue->head)) == (SIZE)){ \
+		return FALSE; \
+	} \
+	a_queue->items[tail & ((SIZE) - 1)] = item; \
+	QUEUE_publish(&a_queue->tail,tail + 1); \
+	return TRUE; \
+} \
+\
+static inline uint8 NAME##_pushBatch(NAME##Type * a_queue,const TYPE * a_items,uint8 length){ \
+	uint8 tail = a_queue->tail; \
+	uint8 space = (uint8)((SIZE) - (uint8)(tail - QUEUE_load(&a_queue->head))); \
+	uint8 i; \
+	if(length > space){ \
+		length = space; \
+	} \
+	for(i = 0; i < length; i++){ \
+		a_queue->items[(uint8)(tail + i) & ((SIZE) - 1)] = a_items[i]; \
+	} \
+	QUEUE_publish(&a_queue->tail,tail + length); \
+	return length; \
+} \
+\
+static inline uint8 NAME##_pop(NAME##Type * a_queue,TYPE * a_item){ \
+	uint8 head = a_queue->head; \
+	if(head == QUEUE_load(&a_queue->tail)){ \
+		return FALSE; \
+	} \
+	*a_item = a_queue->items[head & ((SIZE) - 1)]; \
+	QUEUE_publish(&a_queue->head,head + 1); \
+	return TRUE; \
+} \
+\
+static inline uint8 NAME##_popBatch(NAME##Type * a_queue,TYPE * a_items,uint8 length){ \
+	uint8 head = a_queue->head; \
+	uint8 count = (uint8)(QUEUE_load(&a_queue->tail) - head); \
+	uint8 i; \
+	if(length > count){ \
+		length = count; \
+	} \
+	for(i = 0; i < length; i++){ \
+		a_items[i] = a_queue->items[(uint8)(head + i) & ((SIZE) - 1)]; \
+	} \
+	QUEUE_publish(&a_queue->head,head + length); \
+	return length; \
+} \
+\
+static inline uint8 NAME##_peekSpan(NAME##Type * a_queue,TYPE ** a_span){ \
+	uint8 head = a_queue->head; \
+	uint8 count = (uint8)(QUEUE_load(&a_queue->tail) - head); \
+	uint8 toEnd = (uint8)((SIZE) - (head & ((SIZE) - 1))); \
+	*a_span = &a_queue->items[head & ((SIZE) - 1)]; \
+	return (count < toEnd) ? count : toEnd; \
+} \
+\
+static inline void NAME##_release(NAME##Type * a_queue,uint8 length){ \
+	QUEUE_publish(&a_queue->head,a_queue->head + length); \
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description : an index of the other side read before its items (acquire)
+ * 	and an index published after its items (release)
+ */
+#ifdef __AVR__
+/* one core ,a byte access is atomic : only the compiler must keep the order */
+static inline uint8 QUEUE_load(const uint8 * a_index){
+	uint8 value = *(const volatile uint8 *)a_index;
+	__asm__ __volatile__("" ::: "memory");
+	return value;
+}
+
+static inline void QUEUE_publish(uint8 * a_index,uint8 value){
+	__asm__ __volatile__("" ::: "memory");
+	*(volatile uint8 *)a_index = value;
+}
+#else
+static inline uint8 QUEUE_load(const uint8 * a_index){
+	return __atomic_load_n(a_index,__ATOMIC_ACQUIRE);
+}
+
+static inline void QUEUE_publish(uint8 * a_index,uint8 value){
+	__atomic_store_n(a_index,value,__ATOMIC_RELEASE);
+}
+#endif
+
+#endif /* QUEUE_H_ */
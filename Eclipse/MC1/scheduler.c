@@ -0,0 +1,155 @@
+/******************************************************************************
+ *
+ * Module: Scheduler
+ *
+ * File Name: scheduler.c
+ *
+ * Description: cooperative run to completion scheduler
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+#include "scheduler.h"
+#include "counters.h"
+#include <avr/sleep.h>
+#include <avr/pgmspace.h>
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef struct{
+	uint8 event;
+	uint8 data;
+}SchedulerEvent;
+
+typedef struct{
+	SchedulerTask task;
+	SchedulerEvent queue[SCHEDULER_QUEUE_SIZE];
+	uint8 head; /* next event to run */
+	uint8 count; /* number of events waiting */
+}SchedulerTaskControl;
+
+/*******************************************************************************
+ *                            GLOBAL VARIABLES                    *
+ *******************************************************************************/
+
+static volatile SchedulerTaskControl g_tasks[SCHEDULER_TASKS_NUM];
+
+/* bit n set --> task n has events waiting */
+static volatile uint8 g_readyTasks = 0;
+
+/* index of the lowest set bit of a nibble (nibble 0 is not used) */
+static const uint8 g_lowestBit[16] PROGMEM = {0,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0};
+
+/* sleep mode when no task is ready */
+static volatile uint8 g_sleepMode = SLEEP_MODE_IDLE;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description : clear the task table and all event queues
+ */
+void SCHEDULER_init(void){
+
+	uint8 id;
+	for (id = 0; id < SCHEDULER_TASKS_NUM; ++id) {
+		g_tasks[id].task = NULL_PTR;
+		g_tasks[id].head = 0;
+		g_tasks[id].count = 0;
+	}
+	g_readyTasks = 0;
+}
+
+/*
+ * Description : put a task in the task table
+ */
+void SCHEDULER_addTask(SchedulerTaskId id,SchedulerTask task){
+	g_tasks[id].task = task;
+}
+
+/*
+ * Description : post an event to a task (safe to call from ISRs)
+ * 	return TRUE or FALSE if the queue of the task is full
+ */
+uint8 SCHEDULER_post(SchedulerTaskId id,uint8 event,uint8 data){
+
+	uint8 tail;
+	uint8 sreg = SREG;
+	cli();
+
+	if(g_tasks[id].count == SCHEDULER_QUEUE_SIZE){
+		SREG = sreg;
+		return FALSE;
+	}
+
+	tail = (g_tasks[id].head + g_tasks[id].count) & (SCHEDULER_QUEUE_SIZE-1);
+	g_tasks[id].queue[tail].event = event;
+	g_tasks[id].queue[tail].data = data;
+	g_tasks[id].count++;
+	g_readyTasks |= (1<<id);
+
+	SREG = sreg;
+	return TRUE;
+}
+
+/*
+ * Description : sleep mode used when no task is ready
+ */
+void SCHEDULER_setSleepMode(uint8 mode){
+	g_sleepMode = mode;
+}
+
+/*
+ * Description : run the ready tasks forever ,sleep when nothing is ready
+ */
+void SCHEDULER_run(void){
+
+	uint8 id;
+	uint8 event;
+	uint8 data;
+
+	while(1){
+
+		cli();
+
+		if(g_readyTasks == 0){
+			/* nothing to do: the instruction after sei is always executed so
+			 * no interrupt can post an event between the check and the sleep */
+			set_sleep_mode(g_sleepMode);
+			sleep_enable();
+			COUNTERS_idleBegin();
+			sei();
+			sleep_cpu();
+			sleep_disable();
+			cli();
+			COUNTERS_idleEnd();
+			continue;
+		}
+
+		/* highest priority ready task is the lowest set bit */
+		if(g_readyTasks & 0x0F){
+			id = pgm_read_byte(&g_lowestBit[g_readyTasks & 0x0F]);
+		}else{
+			id = 4 + pgm_read_byte(&g_lowestBit[g_readyTasks >> 4]);
+		}
+
+		/* take one event from the task queue */
+		event = g_tasks[id].queue[g_tasks[id].head].event;
+		data = g_tasks[id].queue[g_tasks[id].head].data;
+		g_tasks[id].head = (g_tasks[id].head + 1) & (SCHEDULER_QUEUE_SIZE-1);
+		g_tasks[id].count--;
+		if(g_tasks[id].count == 0){
+			g_readyTasks &= ~(1<<id);
+		}
+
+		sei();
+
+		/* run the task to completion with interrupts enabled */
+		if(g_tasks[id].task != NULL_PTR){
+			(*g_tasks[id].task)(event,data);
+		}
+	}
+}
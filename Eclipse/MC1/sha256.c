@@ -0,0 +1,258 @@
+ /******************************************************************************
+ *
+ * Module: SHA-256
+ *
+ * File Name: sha256.c
+ *
+ * Description: SHA-256 (FIPS 180-4) and HMAC-SHA256 (RFC 2104)
+ * 				the block is kept as 16 words ,a byte of the message is put
+ * 				directly in its place in the big endian word (the AVR and the
+ * 				host are little endian) ,then the same 16 words become the
+ * 				message schedule : W[t] replaces W[t-16] in the ring
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#include "sha256.h"
+#include <avr/pgmspace.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define ROTR(X,N) (((X) >> (N)) | ((X) << (32 - (N))))
+
+#define CH(X,Y,Z)  ((Z) ^ ((X) & ((Y) ^ (Z))))
+#define MAJ(X,Y,Z) (((X) & (Y)) | ((Z) & ((X) | (Y))))
+
+#define SIGMA0(X) (ROTR((X),2) ^ ROTR((X),13) ^ ROTR((X),22))
+#define SIGMA1(X) (ROTR((X),6) ^ ROTR((X),11) ^ ROTR((X),25))
+#define GAMMA0(X) (ROTR((X),7) ^ ROTR((X),18) ^ ((X) >> 3))
+#define GAMMA1(X) (ROTR((X),17) ^ ROTR((X),19) ^ ((X) >> 10))
+
+/* place of the byte number INDEX of the block in the little endian words */
+#define SHA256_BYTE(CONTEXT,INDEX) (((uint8 *)(CONTEXT)->block)[(INDEX) ^ 3])
+
+#if SHA256_UNROLL
+/* one round ,the caller rotates the names of the variables instead of moving them */
+#define SHA256_ROUND(A,B,C,D,E,F,G,H,T) do{ \
+		uint32 t1 = (H) + SIGMA1(E) + CH((E),(F),(G)) + \
+				pgm_read_dword(&g_roundConstants[T]) + SHA256_schedule(w,(T)); \
+		(D) += t1; \
+		(H) = t1 + SIGMA0(A) + MAJ((A),(B),(C)); \
+	}while(0)
+#endif
+
+#define HMAC_IPAD 0X36
+#define HMAC_OPAD 0X5C
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static const uint32 g_roundConstants[64] PROGMEM = {
+		0x428a2f98UL,0x71374491UL,0xb5c0fbcfUL,0xe9b5dba5UL,0x3956c25bUL,0x59f111f1UL,0x923f82a4UL,0xab1c5ed5UL,
+		0xd807aa98UL,0x12835b01UL,0x243185beUL,0x550c7dc3UL,0x72be5d74UL,0x80deb1feUL,0x9bdc06a7UL,0xc19bf174UL,
+		0xe49b69c1UL,0xefbe4786UL,0x0fc19dc6UL,0x240ca1ccUL,0x2de92c6fUL,0x4a7484aaUL,0x5cb0a9dcUL,0x76f988daUL,
+		0x983e5152UL,0xa831c66dUL,0xb00327c8UL,0xbf597fc7UL,0xc6e00bf3UL,0xd5a79147UL,0x06ca6351UL,0x14292967UL,
+		0x27b70a85UL,0x2e1b2138UL,0x4d2c6dfcUL,0x53380d13UL,0x650a7354UL,0x766a0abbUL,0x81c2c92eUL,0x92722c85UL,
+		0xa2bfe8a1UL,0xa81a664bUL,0xc24b8b70UL,0xc76c51a3UL,0xd192e819UL,0xd6990624UL,0xf40e3585UL,0x106aa070UL,
+		0x19a4c116UL,0x1e376c08UL,0x2748774cUL,0x34b0bcb5UL,0x391c0cb3UL,0x4ed8aa4aUL,0x5b9cca4fUL,0x682e6ff3UL,
+		0x748f82eeUL,0x78a5636fUL,0x84c87814UL,0x8cc70208UL,0x90befffaUL,0xa4506cebUL,0xbef9a3f7UL,0xc67178f2UL
+};
+
+static const uint32 g_initialState[8] PROGMEM = {
+		0x6a09e667UL,0xbb67ae85UL,0x3c6ef372UL,0xa54ff53aUL,0x510e527fUL,0x9b05688cUL,0x1f83d9abUL,0x5be0cd19UL
+};
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static uint32 SHA256_schedule(uint32 * w,uint8 t);
+static void SHA256_transform(Sha256ContextType * a_context);
+static void HMAC_SHA256_padKey(Sha256ContextType * a_context,const uint8 * a_key,uint8 length,uint8 pad);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description : start a new hash
+ */
+void SHA256_init(Sha256ContextType * a_context){
+
+	uint8 i;
+
+	for(i = 0; i < 8; i++){
+		a_context->state[i] = pgm_read_dword(&g_initialState[i]);
+	}
+	a_context->length = 0;
+}
+
+/*
+ * Description : hash more bytes of the message
+ */
+void SHA256_update(Sha256ContextType * a_context,const uint8 * a_data,uint16 length){
+
+	while(length--){
+		uint8 index = (uint8)(a_context->length & (SHA256_BLOCK_SIZE - 1));
+
+		SHA256_BYTE(a_context,index) = *a_data++;
+		a_context->length++;
+		if(index == SHA256_BLOCK_SIZE - 1){
+			SHA256_transform(a_context);
+		}
+	}
+}
+
+/*
+ * Description : pad the message and write the digest
+ */
+void SHA256_final(Sha256ContextType * a_context,uint8 * a_digest){
+
+	uint8 index = (uint8)(a_context->length & (SHA256_BLOCK_SIZE - 1));
+	uint8 i;
+
+	/* a one bit ,zeros up to the 64 bits length (in a new block if no room) */
+	SHA256_BYTE(a_context,index++) = 0X80;
+	if(index > SHA256_BLOCK_SIZE - 8){
+		while(index < SHA256_BLOCK_SIZE){
+			SHA256_BYTE(a_context,index++) = 0;
+		}
+		SHA256_transform(a_context);
+		index = 0;
+	}
+	while(index < SHA256_BLOCK_SIZE - 8){
+		SHA256_BYTE(a_context,index++) = 0;
+	}
+	a_context->block[14] = a_context->length >> 29;
+	a_context->block[15] = a_context->length << 3;
+	SHA256_transform(a_context);
+
+	for(i = 0; i < SHA256_DIGEST_SIZE; i++){
+		a_digest[i] = (uint8)(a_context->state[i >> 2] >> (24 - 8*(i & 3)));
+	}
+}
+
+/*
+ * Description : start a HMAC-SHA256
+ */
+void HMAC_SHA256_init(HmacSha256ContextType * a_context,const uint8 * a_key,uint8 length){
+
+	uint8 keyDigest[SHA256_DIGEST_SIZE];
+	uint8 i;
+
+	if(length > SHA256_BLOCK_SIZE){
+		SHA256_init(&a_context->inner);
+		SHA256_update(&a_context->inner,a_key,length);
+		SHA256_final(&a_context->inner,keyDigest);
+		a_key = keyDigest;
+		length = SHA256_DIGEST_SIZE;
+	}
+
+	/* only the state after the outer pad block is kept ,not the key */
+	HMAC_SHA256_padKey(&a_context->inner,a_key,length,HMAC_OPAD);
+	for(i = 0; i < 8; i++){
+		a_context->outer[i] = a_context->inner.state[i];
+	}
+	HMAC_SHA256_padKey(&a_context->inner,a_key,length,HMAC_IPAD);
+}
+
+/*
+ * Description : authenticate more bytes of the message
+ */
+void HMAC_SHA256_update(HmacSha256ContextType * a_context,const uint8 * a_data,uint16 length){
+	SHA256_update(&a_context->inner,a_data,length);
+}
+
+/*
+ * Description : write the HMAC
+ */
+void HMAC_SHA256_final(HmacSha256ContextType * a_context,uint8 * a_mac){
+
+	uint8 i;
+
+	/* the inner digest is kept in the output until it is hashed again */
+	SHA256_final(&a_context->inner,a_mac);
+	for(i = 0; i < 8; i++){
+		a_context->inner.state[i] = a_context->outer[i];
+	}
+	a_context->inner.length = SHA256_BLOCK_SIZE;
+	SHA256_update(&a_context->inner,a_mac,SHA256_DIGEST_SIZE);
+	SHA256_final(&a_context->inner,a_mac);
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+/* word t of the message schedule ,computed over the word t-16 of the ring */
+static uint32 SHA256_schedule(uint32 * w,uint8 t){
+
+	if(t >= 16){
+		w[t & 15] += GAMMA1(w[(t - 2) & 15]) + w[(t - 7) & 15] + GAMMA0(w[(t - 15) & 15]);
+	}
+	return w[t & 15];
+}
+
+static void SHA256_transform(Sha256ContextType * a_context){
+
+	uint32 * w = a_context->block;
+	uint8 t;
+#if SHA256_UNROLL
+	uint32 a = a_context->state[0],b = a_context->state[1];
+	uint32 c = a_context->state[2],d = a_context->state[3];
+	uint32 e = a_context->state[4],f = a_context->state[5];
+	uint32 g = a_context->state[6],h = a_context->state[7];
+
+	for(t = 0; t < 64; t += 8){
+		SHA256_ROUND(a,b,c,d,e,f,g,h,t);
+		SHA256_ROUND(h,a,b,c,d,e,f,g,t + 1);
+		SHA256_ROUND(g,h,a,b,c,d,e,f,t + 2);
+		SHA256_ROUND(f,g,h,a,b,c,d,e,t + 3);
+		SHA256_ROUND(e,f,g,h,a,b,c,d,t + 4);
+		SHA256_ROUND(d,e,f,g,h,a,b,c,t + 5);
+		SHA256_ROUND(c,d,e,f,g,h,a,b,t + 6);
+		SHA256_ROUND(b,c,d,e,f,g,h,a,t + 7);
+	}
+	a_context->state[0] += a; a_context->state[1] += b;
+	a_context->state[2] += c; a_context->state[3] += d;
+	a_context->state[4] += e; a_context->state[5] += f;
+	a_context->state[6] += g; a_context->state[7] += h;
+#else
+	uint32 v[8];
+	uint8 i;
+
+	for(i = 0; i < 8; i++){
+		v[i] = a_context->state[i];
+	}
+	for(t = 0; t < 64; t++){
+		uint32 t1 = v[7] + SIGMA1(v[4]) + CH(v[4],v[5],v[6]) +
+				pgm_read_dword(&g_roundConstants[t]) + SHA256_schedule(w,t);
+		uint32 t2 = SIGMA0(v[0]) + MAJ(v[0],v[1],v[2]);
+
+		for(i = 7; i > 0; i--){
+			v[i] = v[i - 1];
+		}
+		v[4] += t1;
+		v[0] = t1 + t2;
+	}
+	for(i = 0; i < 8; i++){
+		a_context->state[i] += v[i];
+	}
+#endif
+}
+
+/* hash the first block of a HMAC : the key (zero padded) xor the pad */
+static void HMAC_SHA256_padKey(Sha256ContextType * a_context,const uint8 * a_key,uint8 length,uint8 pad){
+
+	uint8 i;
+
+	SHA256_init(a_context);
+	for(i = 0; i < SHA256_BLOCK_SIZE; i++){
+		uint8 data = (uint8)(((i < length) ? a_key[i] : 0) ^ pad);
+		SHA256_update(a_context,&data,1);
+	}
+}
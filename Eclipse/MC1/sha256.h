@@ -0,0 +1,93 @@
+ /******************************************************************************
+ *
+ * Module: SHA-256
+ *
+ * File Name: sha256.h
+ *
+ * Description: small SHA-256 and HMAC-SHA256 for the MC1
+ * 				1- the 64 round constants are in the flash (PROGMEM)
+ * 				2- the message schedule is computed in place in the 64 bytes
+ * 				   block buffer (16 words ring) ,no 256 bytes W[64] array
+ * 				3- SHA256_UNROLL = 1 unrolls the rounds by 8 (no variables
+ * 				   rotation ,faster but bigger in flash)
+ * 				a context takes 100 bytes of SRAM ,a HMAC context 132 bytes
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef SHA256_H_
+#define SHA256_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* 0 : compact rounds loop ,1 : rounds unrolled by 8 */
+#ifndef SHA256_UNROLL
+#define SHA256_UNROLL 0
+#endif
+
+#define SHA256_BLOCK_SIZE  64
+#define SHA256_DIGEST_SIZE 32
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef struct{
+	uint32 state[8];
+	/* the block being filled ,also the message schedule while hashing it */
+	uint32 block[SHA256_BLOCK_SIZE/4];
+	uint32 length;  /* bytes hashed so far (messages below 512 MB) */
+}Sha256ContextType;
+
+typedef struct{
+	Sha256ContextType inner;
+	/* state after the (key ^ opad) block ,the outer hash starts from it */
+	uint32 outer[8];
+}HmacSha256ContextType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description : start a new hash
+ */
+void SHA256_init(Sha256ContextType * a_context);
+
+/*
+ * Description : hash more bytes of the message
+ * 	[in] a_data : bytes of the message
+ * 	[in] length : number of bytes
+ */
+void SHA256_update(Sha256ContextType * a_context,const uint8 * a_data,uint16 length);
+
+/*
+ * Description : pad the message and write the digest (the context is finished)
+ * 	[out] a_digest : SHA256_DIGEST_SIZE bytes
+ */
+void SHA256_final(Sha256ContextType * a_context,uint8 * a_digest);
+
+/*
+ * Description : start a HMAC-SHA256
+ * 	[in] a_key : the key ,a key longer than SHA256_BLOCK_SIZE is hashed first
+ * 	[in] length : number of bytes of the key
+ */
+void HMAC_SHA256_init(HmacSha256ContextType * a_context,const uint8 * a_key,uint8 length);
+
+/*
+ * Description : authenticate more bytes of the message
+ */
+void HMAC_SHA256_update(HmacSha256ContextType * a_context,const uint8 * a_data,uint16 length);
+
+/*
+ * Description : write the HMAC (the context is finished)
+ * 	[out] a_mac : SHA256_DIGEST_SIZE bytes
+ */
+void HMAC_SHA256_final(HmacSha256ContextType * a_context,uint8 * a_mac);
+
+#endif /* SHA256_H_ */
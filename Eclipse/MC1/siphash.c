@@ -0,0 +1,157 @@
+ /******************************************************************************
+ *
+ * Module: SipHash
+ *
+ * File Name: siphash.c
+ *
+ * Description: SipHash-2-4 on 32 bits halves
+ * 				1- a 64 bits rotation by n < 32 moves bits between the halves
+ * 				2- the rotation by 32 is only a swap of the halves
+ * 				3- the 64 bits addition is two 32 bits additions with carry
+ * 				one message block costs 2 rounds and the finalization 4 rounds
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#include "siphash.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* rotate a 64 bits word left by N (0 < N < 32) */
+#define SIPHASH_ROTL(W,N) do{ \
+		uint32 hi = (W).hi; \
+		(W).hi = ((W).hi << (N)) | ((W).lo >> (32 - (N))); \
+		(W).lo = ((W).lo << (N)) | (hi >> (32 - (N))); \
+	}while(0)
+
+/* rotate a 64 bits word left by 32 */
+#define SIPHASH_SWAP(W) do{ \
+		uint32 hi = (W).hi; \
+		(W).hi = (W).lo; \
+		(W).lo = hi; \
+	}while(0)
+
+/* A += B */
+#define SIPHASH_ADD(A,B) do{ \
+		(A).lo += (B).lo; \
+		(A).hi += (B).hi + ((A).lo < (B).lo); \
+	}while(0)
+
+/* A ^= B */
+#define SIPHASH_XOR(A,B) do{ \
+		(A).lo ^= (B).lo; \
+		(A).hi ^= (B).hi; \
+	}while(0)
+
+#define SIPHASH_C_ROUNDS 2
+#define SIPHASH_D_ROUNDS 4
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef struct{
+	uint32 lo;
+	uint32 hi;
+}SipWord;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void SIPHASH_rounds(SipWord * v,uint8 rounds);
+static void SIPHASH_load(SipWord * a_word,const uint8 * a_bytes);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description : SipHash-2-4 of a message
+ */
+void SIPHASH_hash(const uint8 * a_key,const uint8 * a_data,uint8 length,uint8 * a_tag){
+
+	SipWord v[4];
+	SipWord k0,k1,m;
+	uint8 last[8] = {0};
+	uint8 i;
+
+	SIPHASH_load(&k0,a_key);
+	SIPHASH_load(&k1,a_key + 8);
+
+	/* "somepseudorandomlygeneratedbytes" */
+	v[0].hi = k0.hi ^ 0x736f6d65UL; v[0].lo = k0.lo ^ 0x70736575UL;
+	v[1].hi = k1.hi ^ 0x646f7261UL; v[1].lo = k1.lo ^ 0x6e646f6dUL;
+	v[2].hi = k0.hi ^ 0x6c796765UL; v[2].lo = k0.lo ^ 0x6e657261UL;
+	v[3].hi = k1.hi ^ 0x74656462UL; v[3].lo = k1.lo ^ 0x79746573UL;
+
+	for(i = length; i >= 8; i -= 8){
+		SIPHASH_load(&m,a_data);
+		SIPHASH_XOR(v[3],m);
+		SIPHASH_rounds(v,SIPHASH_C_ROUNDS);
+		SIPHASH_XOR(v[0],m);
+		a_data += 8;
+	}
+
+	/* the last block : the remaining bytes and the length in the top byte */
+	for(; i > 0; i--){
+		last[i - 1] = a_data[i - 1];
+	}
+	last[7] = length;
+	SIPHASH_load(&m,last);
+	SIPHASH_XOR(v[3],m);
+	SIPHASH_rounds(v,SIPHASH_C_ROUNDS);
+	SIPHASH_XOR(v[0],m);
+
+	v[2].lo ^= 0xFF;
+	SIPHASH_rounds(v,SIPHASH_D_ROUNDS);
+
+	SIPHASH_XOR(v[0],v[1]);
+	SIPHASH_XOR(v[2],v[3]);
+	SIPHASH_XOR(v[0],v[2]);
+	for(i = 0; i < 4; i++){
+		a_tag[i] = (uint8)(v[0].lo >> (8*i));
+		a_tag[i + 4] = (uint8)(v[0].hi >> (8*i));
+	}
+}
+
+/*
+ * Description : compare two tags in a constant time
+ */
+uint8 SIPHASH_equal(const uint8 * a_tag1,const uint8 * a_tag2){
+
+	uint8 difference = 0;
+	uint8 i;
+
+	/* no early exit : a wrong byte must not be found by timing the compare */
+	for(i = 0; i < SIPHASH_TAG_SIZE; i++){
+		difference |= a_tag1[i] ^ a_tag2[i];
+	}
+	return (difference == 0);
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+static void SIPHASH_rounds(SipWord * v,uint8 rounds){
+
+	while(rounds--){
+		SIPHASH_ADD(v[0],v[1]); SIPHASH_ROTL(v[1],13); SIPHASH_XOR(v[1],v[0]); SIPHASH_SWAP(v[0]);
+		SIPHASH_ADD(v[2],v[3]); SIPHASH_ROTL(v[3],16); SIPHASH_XOR(v[3],v[2]);
+		SIPHASH_ADD(v[0],v[3]); SIPHASH_ROTL(v[3],21); SIPHASH_XOR(v[3],v[0]);
+		SIPHASH_ADD(v[2],v[1]); SIPHASH_ROTL(v[1],17); SIPHASH_XOR(v[1],v[2]); SIPHASH_SWAP(v[2]);
+	}
+}
+
+/* little endian 8 bytes to a 64 bits word */
+static void SIPHASH_load(SipWord * a_word,const uint8 * a_bytes){
+
+	a_word->lo = (uint32)a_bytes[0] | ((uint32)a_bytes[1] << 8) |
+			((uint32)a_bytes[2] << 16) | ((uint32)a_bytes[3] << 24);
+	a_word->hi = (uint32)a_bytes[4] | ((uint32)a_bytes[5] << 8) |
+			((uint32)a_bytes[6] << 16) | ((uint32)a_bytes[7] << 24);
+}
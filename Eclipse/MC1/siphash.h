@@ -0,0 +1,46 @@
+ /******************************************************************************
+ *
+ * Module: SipHash
+ *
+ * File Name: siphash.h
+ *
+ * Description: SipHash-2-4 keyed hash (64 bits tag) used to store the password
+ * 				as a salted digest ,the 64 bits words are kept as two 32 bits
+ * 				halves so the AVR never needs 64 bits shifts
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef SIPHASH_H_
+#define SIPHASH_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define SIPHASH_KEY_SIZE 16
+#define SIPHASH_TAG_SIZE 8
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description : SipHash-2-4 of a message
+ * 	[in] a_key : SIPHASH_KEY_SIZE bytes key (the salt)
+ * 	[in] a_data : message
+ * 	[in] length : number of bytes of the message
+ * 	[out] a_tag : SIPHASH_TAG_SIZE bytes ,little endian like the reference
+ */
+void SIPHASH_hash(const uint8 * a_key,const uint8 * a_data,uint8 length,uint8 * a_tag);
+
+/*
+ * Description : compare two tags in a time that does not depend on their
+ * 	content (every byte is compared) ,return TRUE if they are equal
+ */
+uint8 SIPHASH_equal(const uint8 * a_tag1,const uint8 * a_tag2);
+
+#endif /* SIPHASH_H_ */
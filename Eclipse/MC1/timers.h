@@ -154,6 +154,14 @@ uint16 TIMERS_getTimerValue(TimerNum timer);
 /*function to clear timer register*/
 void TIMERS_clearTimerValue(TimerNum timer);
 
+/*function to change the compare value(s) of a running timer in COMPARE or PWM mode
+ * compareValue2 is only used for TIMER1 (OCR1B)*/
+void TIMERS_setCompareValue(TimerNum timer,uint16 compareValue1,uint16 compareValue2);
+
+/*function to change the mode of OCn (OC1A for TIMER1) of a running timer in
+ * PWM mode ,DISCONNECTED gives the pin back to its PORT bit*/
+void TIMERS_setPwmOutput(TimerNum timer,TimersPwmModeOCnMode mode);
+
 /********************************************************/
 
 
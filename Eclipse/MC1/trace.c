@@ -0,0 +1,84 @@
+/******************************************************************************
+ *
+ * Module: Trace
+ *
+ * File Name: trace.c
+ *
+ * Description: SRAM ring buffer of the trace records
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+#include "trace.h"
+#include "systick.h"
+#include <avr/interrupt.h>
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef struct{
+	uint16 tick;
+	uint8 id;
+	uint8 arg;
+}TraceRecord;
+
+/*******************************************************************************
+ *                            GLOBAL VARIABLES                    *
+ *******************************************************************************/
+
+static TraceRecord g_records[TRACE_BUFFER_SIZE];
+
+/*next record to write and number of valid records*/
+static volatile uint8 g_head = 0;
+static volatile uint8 g_count = 0;
+
+/*records are not added during the dump*/
+static volatile uint8 g_frozen = FALSE;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void TRACE_record(TraceEventId id,uint8 arg){
+
+	uint8 sreg = SREG;
+	TraceRecord * record;
+
+	cli();
+	if(!g_frozen){
+		record = &g_records[g_head];
+		record->tick = SYSTICK_getTicks16();
+		record->id = id;
+		record->arg = arg;
+		g_head = (g_head + 1) & (TRACE_BUFFER_SIZE - 1);
+		if(g_count < TRACE_BUFFER_SIZE){
+			g_count++;
+		}
+	}
+	SREG = sreg;
+}
+
+void TRACE_dump(void(*a_sendByte)(uint8 data)){
+
+	uint8 index;
+	uint8 i;
+
+	g_frozen = TRUE;
+
+	(*a_sendByte)(TRACE_DUMP_MAGIC1);
+	(*a_sendByte)(TRACE_DUMP_MAGIC2);
+	(*a_sendByte)(g_count);
+
+	/*oldest record first*/
+	index = (g_head - g_count) & (TRACE_BUFFER_SIZE - 1);
+	for(i = 0; i < g_count; i++){
+		(*a_sendByte)((uint8)g_records[index].tick);
+		(*a_sendByte)((uint8)(g_records[index].tick >> 8));
+		(*a_sendByte)(g_records[index].id);
+		(*a_sendByte)(g_records[index].arg);
+		index = (index + 1) & (TRACE_BUFFER_SIZE - 1);
+	}
+
+	g_frozen = FALSE;
+}
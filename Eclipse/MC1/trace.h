@@ -0,0 +1,100 @@
+/******************************************************************************
+ *
+ * Module: Trace
+ *
+ * File Name: trace.h
+ *
+ * Description: compact binary trace of the firmware events
+ * 				1- TRACE(id,arg) writes a 4 bytes record (system tick low 16 bits,
+ * 				   id ,arg) in an SRAM ring buffer ,the oldest record is lost
+ * 				   when the buffer is full
+ * 				2- the ids are fixed at compile time (TRACE_EVENTS) so the host
+ * 				   decoder (host/trace_decode.c) uses the same names
+ * 				   the boot time stamps count the cycles since SYSTICK_init
+ * 				3- TRACE_dump sends the records ,oldest first : 'T' 'R' count
+ * 				   then count records (tick low ,tick high ,id ,arg)
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "micro_config.h"
+#include "std_types.h"
+#include "common_macros.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* 0 removes all TRACE call sites from the build */
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE 1
+#endif
+
+/* number of records in the ring buffer (power of 2 ,4 bytes each) */
+#define TRACE_BUFFER_SIZE 64
+
+/* byte received from a node asking for the dump (not used by the protocol with MC2)
+ * ,answered only to a node logged in with the password of the system */
+#define TRACE_DUMP_REQUEST 0XDD
+
+/* first 2 bytes of a dump */
+#define TRACE_DUMP_MAGIC1 'T'
+#define TRACE_DUMP_MAGIC2 'R'
+
+/* ids of the events and the meaning of their argument */
+#define TRACE_EVENTS(EVENT) \
+	EVENT(TRACE_BOOT)            /* arg : system state at boot          */ \
+	EVENT(TRACE_SYSTEM_STATE)    /* arg : new system state               */ \
+	EVENT(TRACE_GATE_STATE)      /* arg : new gate state                 */ \
+	EVENT(TRACE_PASSWORD_OK)     /* arg : 0                              */ \
+	EVENT(TRACE_PASSWORD_WRONG)  /* arg : wrong trials in a row          */ \
+	EVENT(TRACE_PASSWORD_CYCLES) /* arg : cycles of the check / 256      */ \
+	EVENT(TRACE_TIMER_EXPIRED)   /* arg : software timer id              */ \
+	EVENT(TRACE_GATE_STALL)      /* arg : gate state                     */ \
+	EVENT(TRACE_EEPROM_WRITE)    /* arg : address (low byte)             */ \
+	EVENT(TRACE_EEPROM_READ)     /* arg : address (low byte)             */ \
+	EVENT(TRACE_TWI_ERROR)       /* arg : TWI status                     */ \
+	EVENT(TRACE_BOOT_LOADED)     /* arg : cycles / 256 ,EEPROM read      */ \
+	EVENT(TRACE_BOOT_READY)      /* arg : cycles / 256 ,tasks ready      */ \
+	EVENT(TRACE_BOOT_LINKED)     /* arg : cycles / 256 ,first state sent */ \
+	EVENT(TRACE_USERS_STORED)    /* arg : user table pages read back wrong */ \
+	EVENT(TRACE_GATE_CONFIG)     /* arg : 1 gate profile used ,0 defaults */ \
+	EVENT(TRACE_STATE_LOST)      /* arg : reads of the persistent state failed */
+
+#define TRACE_EVENT_ID(NAME) NAME,
+
+#if TRACE_ENABLE
+#define TRACE(ID,ARG) TRACE_record((ID),(uint8)(ARG))
+#else
+#define TRACE(ID,ARG) ((void)0)
+#endif
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef enum {
+	TRACE_EVENTS(TRACE_EVENT_ID)
+	TRACE_EVENTS_NUM
+}TraceEventId;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description : add a record to the ring buffer (safe to call from ISRs)
+ */
+void TRACE_record(TraceEventId id,uint8 arg);
+
+/*
+ * Description : send all records with the given function (blocking) ,no
+ * 	record is added while sending
+ */
+void TRACE_dump(void(*a_sendByte)(uint8 data));
+
+#endif /* TRACE_H_ */
@@ -11,19 +11,36 @@
  *******************************************************************************/
 
 #include "uart.h"
+#include "counters.h"
 
 /*******************************************************************************
  *                      Preprocessor Macros                                    *
  *******************************************************************************/
 
-#define BAUD_PRESCALE(USART_BAUDRATE) (((F_CPU / ((USART_BAUDRATE) * 8UL))) - 1)
+/* rounded to the nearest like UART_DIVIDER of uart.h ,not truncated */
+#define BAUD_PRESCALE(USART_BAUDRATE) ((((F_CPU) + (USART_BAUDRATE) * 4UL) / ((USART_BAUDRATE) * 8UL)) - 1)
 
 
 /*******************************************************************************
  *                            GLOBAL VARIABLES                    *
  *******************************************************************************/
 
-static volatile void (*g_callBackPtrUart)(void) = NULL_PTR;
+static void (*volatile g_callBackPtrUart)(void) = NULL_PTR;
+
+/*******************************************************************************
+ *                       Interrupt Service Routines                            *
+ *******************************************************************************/
+
+/* receive complete interrupt (UART_RxInterrupt = 1) ,the call back must
+ * read the byte by UART_recieveByte to clear the RXC flag */
+ISR(USART_RXC_vect){
+	COUNTERS_INC(COUNTER_ISR_UART);
+	if(g_callBackPtrUart != NULL_PTR)
+	{
+		/* Call the Call Back function in the application after a byte is received */
+		(*g_callBackPtrUart)();
+	}
+}
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
@@ -132,9 +149,12 @@ void UART_sendByte(const uint8 data)
 	/* UDRE flag is set when the Tx buffer (UDR) is empty and ready for 
 	 * transmitting a new byte so wait until this flag is set to one */
 	while(BIT_IS_CLEAR(UCSRA,UDRE)){}
+	/* a data frame in 9 bits mode (TXB8 is not used by the other modes) */
+	CLEAR_BIT(UCSRB,TXB8);
+	COUNTERS_INC(COUNTER_UART_TX_BYTES);
 	/* Put the required data in the UDR register and it also clear the UDRE flag as 
 	 * the UDR register is not empty now */	 
-	UDR = data;
+	HAL_WRITE(UDR,data);
 	/************************* Another Method *************************
 	UDR = data;
 	while(BIT_IS_CLEAR(UCSRA,TXC)){} // Wait until the transimission is complete TXC = 1
@@ -144,14 +164,53 @@ void UART_sendByte(const uint8 data)
 
 }
 
+uint8 UART_isSendReady(void)
+{
+	return BIT_IS_SET(UCSRA,UDRE) ? TRUE : FALSE;
+}
+
 uint8 UART_recieveByte(void)
 {
 	/* RXC flag is set when the UART receive data so wait until this 
 	 * flag is set to one */
 	while(BIT_IS_CLEAR(UCSRA,RXC)){}
+	/* FE and DOR belong to the frame in UDR ,they must be read before UDR */
+	COUNTERS_INC(COUNTER_UART_RX_BYTES);
+	if(BIT_IS_SET(UCSRA,FE)){
+		COUNTERS_INC(COUNTER_UART_FRAME_ERRORS);
+	}
+	if(BIT_IS_SET(UCSRA,DOR)){
+		COUNTERS_INC(COUNTER_UART_OVERRUNS);
+	}
 	/* Read the received data from the Rx buffer (UDR) and the RXC flag 
 	   will be cleared after read this data */	 
-    return UDR;		
+    return HAL_READ(UDR);		
+}
+
+void UART_sendAddress(const uint8 address)
+{
+	while(BIT_IS_CLEAR(UCSRA,UDRE)){}
+	/* the 9th bit marks an address frame */
+	SET_BIT(UCSRB,TXB8);
+	COUNTERS_INC(COUNTER_UART_TX_BYTES);
+	HAL_WRITE(UDR,address);
+}
+
+uint8 UART_isAddressReceived(void)
+{
+	/* RXB8 belongs to the frame in UDR ,it must be read before UDR */
+	return BIT_IS_SET(UCSRB,RXB8) ? TRUE : FALSE;
+}
+
+void UART_setMultiProcessorMode(uint8 enable)
+{
+	/* with MPCM the receiver ignores the data frames (no RXC) ,only the
+	 * address frames are received */
+	if(enable){
+		SET_BIT(UCSRA,MPCM);
+	}else{
+		CLEAR_BIT(UCSRA,MPCM);
+	}
 }
 
 void UART_sendString(const uint8 *Str)
@@ -25,6 +25,34 @@
 /* UART Driver Baud Rate */
 //#define USART_BAUDRATE 9600
 
+/* compile time baud rate solver ,the macros below can be used in #if :
+ * UBRR + 1 is F_CPU / (samples * baud) rounded to the nearest ,with 16
+ * samples a bit (normal mode) or 8 (double speed mode ,U2X) ,the mode with
+ * the smaller error is chosen ,the normal mode if they are the same (its
+ * receiver takes more samples and tolerates a larger error)
+ * a build with a baud rate more than UART_BAUD_ERROR_MAX per mille away
+ * from the one of the UART must fail (#error) */
+#define UART_BAUD_ERROR_MAX 20
+#define UART_UBRR_MAX 4095
+
+#define UART_DIVIDER(BAUD,SAMPLES) \
+	((((F_CPU) + (SAMPLES)*(BAUD)/2) / ((SAMPLES)*(BAUD)) > 0) ? \
+	 (((F_CPU) + (SAMPLES)*(BAUD)/2) / ((SAMPLES)*(BAUD))) : 1)
+
+/* baud rate of the UART ,in clock cycles ,and its error in per mille (1000
+ * when UBRR does not fit its 12 bits) */
+#define UART_CYCLES(BAUD,SAMPLES) ((SAMPLES)*UART_DIVIDER(BAUD,SAMPLES))
+#define UART_ERROR_OF(BAUD,SAMPLES) \
+	((UART_DIVIDER(BAUD,SAMPLES) > UART_UBRR_MAX + 1) ? 1000ULL : \
+	 ((((F_CPU) > (BAUD)*UART_CYCLES(BAUD,SAMPLES)) ? \
+	   ((F_CPU) - (BAUD)*UART_CYCLES(BAUD,SAMPLES)) : \
+	   ((BAUD)*UART_CYCLES(BAUD,SAMPLES) - (F_CPU))) * 1000ULL / ((BAUD)*UART_CYCLES(BAUD,SAMPLES))))
+
+#define UART_DOUBLE_SPEED(BAUD) (UART_ERROR_OF(BAUD,8UL) < UART_ERROR_OF(BAUD,16UL))
+#define UART_BAUD_ERROR(BAUD) (UART_DOUBLE_SPEED(BAUD) ? UART_ERROR_OF(BAUD,8UL) : UART_ERROR_OF(BAUD,16UL))
+#define UART_OPERATING_MODE(BAUD) \
+	(UART_DOUBLE_SPEED(BAUD) ? ASYNCHRONOUS_DOUBLE_SPEED_MODE : ASYNCHRONOUS_NORMAL_MODE)
+
 /*******************************************************************************
  *                         Types Declaration                                   *
  *******************************************************************************/
@@ -38,7 +66,7 @@ typedef enum {
 
 
 typedef struct{
-	uint16 Uart_baudRate;
+	uint32 Uart_baudRate;
 	UartOperatingMode Uart_OperatingMode;
 	uint8 UART_dataBitsNum;
 	uint8 UART_stopBitsNum;
@@ -57,12 +85,27 @@ void UART_init(UartConfigType * uartConfig_Ptr );
 
 void UART_Deinit(void);
 
+/* call back of the receive complete interrupt ,it must read the byte */
 void UART_setCallBack(void(*a_ptr)(void));
 
 void UART_sendByte(const uint8 data);
 
+/* TRUE if UDR is empty (UDRE) ,UART_sendByte or UART_sendAddress write it
+ * without waiting */
+uint8 UART_isSendReady(void);
+
 uint8 UART_recieveByte(void);
 
+/* multi processor communication (9 data bits) : an address frame has its
+ * 9th bit set ,UART_sendByte sends data frames */
+void UART_sendAddress(const uint8 address);
+
+/* TRUE if the frame to be read by UART_recieveByte is an address frame */
+uint8 UART_isAddressReceived(void);
+
+/* MPCM : receive only the address frames (TRUE) or all the frames (FALSE) */
+void UART_setMultiProcessorMode(uint8 enable);
+
 void UART_sendString(const uint8 *Str);
 
 void UART_receiveString(uint8 *Str); // Receive until #
@@ -0,0 +1,78 @@
+ /******************************************************************************
+ *
+ * Module: User Table
+ *
+ * File Name: user_table.c
+ *
+ * Description: the hash is shared with the host that builds the table ,only
+ * 				the search reads the EEPROM
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#include "user_table.h"
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description : tag of a PIN ,returns its home bucket
+ */
+uint8 USER_TABLE_hash(const uint8 * a_key,const uint8 * a_pin,uint8 length,uint8 * a_tag){
+
+	uint8 digest[SIPHASH_TAG_SIZE];
+	uint8 empty = TRUE;
+	uint8 i;
+
+	SIPHASH_hash(a_key,a_pin,length,digest);
+	for(i = 0; i < USER_TABLE_TAG_SIZE; i++){
+		a_tag[i] = digest[i];
+		empty &= (digest[i] == 0XFF);
+	}
+	/*an erased slot is not a tag*/
+	if(empty){
+		a_tag[0] = 0XFE;
+	}
+	return digest[USER_TABLE_TAG_SIZE] % USER_TABLE_BUCKETS;
+}
+
+/*
+ * Description : search a PIN in the buckets of its tag
+ */
+uint8 USER_TABLE_find(const uint8 * a_key,const uint8 * a_pin,uint8 length){
+
+	uint8 tag[USER_TABLE_TAG_SIZE];
+	uint8 bucket[EEPROM_PAGE_SIZE];
+	uint8 index = USER_TABLE_hash(a_key,a_pin,length,tag);
+	uint8 probe,slot,i;
+	uint8 match,erased,empty;
+
+	for(probe = 0; probe < USER_TABLE_PROBES; probe++){
+		/*the storage task may be writing ,one burst per bucket*/
+		if(!EEPROM_waitReady() ||
+				!EEPROM_readBytes(USER_TABLE_PAGE_ADDRESS(1 + index),bucket,EEPROM_PAGE_SIZE)){
+			return FALSE;
+		}
+		empty = FALSE;
+		for(slot = 0; slot < EEPROM_PAGE_SIZE; slot += USER_TABLE_TAG_SIZE){
+			match = TRUE;
+			erased = TRUE;
+			for(i = 0; i < USER_TABLE_TAG_SIZE; i++){
+				match &= (bucket[slot + i] == tag[i]);
+				erased &= (bucket[slot + i] == 0XFF);
+			}
+			if(match){
+				return TRUE;
+			}
+			empty |= erased;
+		}
+		/*a bucket with a free slot never went on in the next one*/
+		if(empty){
+			return FALSE;
+		}
+		index = (index + 1) % USER_TABLE_BUCKETS;
+	}
+	return FALSE;
+}
@@ -0,0 +1,78 @@
+ /******************************************************************************
+ *
+ * Module: User Table
+ *
+ * File Name: user_table.h
+ *
+ * Description: PINs of up to USER_TABLE_USERS users in the EEPROM after the
+ * 				persistent state of MC1 ,they log in like the password but
+ * 				can not change it nor write the table
+ * 				1- a user is a tag : the first USER_TABLE_TAG_SIZE bytes of
+ * 				   the SipHash of its PIN keyed by the table key ,the next
+ * 				   byte chooses its home bucket
+ * 				2- a bucket is an EEPROM page of USER_TABLE_BUCKET_SLOTS tags ,
+ * 				   a full bucket goes on in the next one (USER_TABLE_PROBES
+ * 				   buckets at most) ,an empty slot is erased (0XFF)
+ * 				3- the table is built by the host (gateway.c) and streamed to
+ * 				   MC1 as the image of the EEPROM from USER_TABLE_KEY_ADDRESS :
+ * 				   the key page then the buckets ,one page at a time
+ * 				4- the table is used only while USER_TABLE_FLAG_ADDRESS holds
+ * 				   USER_TABLE_VALID ,the flag is cleared before a stream and
+ * 				   set when all its pages are read back right
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef USER_TABLE_H_
+#define USER_TABLE_H_
+
+#include "std_types.h"
+#include "external_eeprom.h"
+#include "siphash.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* EEPROM layout : the flag ,then the key page and the buckets up to the last
+ * 2 pages of the M24C16 (2 KB ,the second slot of the password of MC1) */
+#define USER_TABLE_FLAG_ADDRESS 0X002F
+#define USER_TABLE_KEY_ADDRESS  0X0030
+#define USER_TABLE_VALID        0XA5
+#define USER_TABLE_INVALID      0X00
+
+#define USER_TABLE_TAG_SIZE     4
+#define USER_TABLE_BUCKET_SLOTS (EEPROM_PAGE_SIZE / USER_TABLE_TAG_SIZE)
+#define USER_TABLE_BUCKETS      122
+#define USER_TABLE_PROBES       2
+
+/* pages of a stream (key page first) */
+#define USER_TABLE_PAGES (USER_TABLE_BUCKETS + 1)
+
+/* users a table takes (half of the slots ,the host draws a new key when a
+ * user finds no slot in USER_TABLE_PROBES buckets) */
+#define USER_TABLE_USERS 250
+
+/* EEPROM address of a page of the stream */
+#define USER_TABLE_PAGE_ADDRESS(PAGE) (USER_TABLE_KEY_ADDRESS + (uint16)(PAGE) * EEPROM_PAGE_SIZE)
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description : tag of a PIN (never an empty slot) ,returns its home bucket
+ * 	[in] a_key : SIPHASH_KEY_SIZE bytes table key
+ * 	[out] a_tag : USER_TABLE_TAG_SIZE bytes
+ */
+uint8 USER_TABLE_hash(const uint8 * a_key,const uint8 * a_pin,uint8 length,uint8 * a_tag);
+
+/*
+ * Description : search a PIN in the table of the EEPROM (USER_TABLE_PROBES
+ * 	page reads at most ,waiting for a write cycle in progress) ,return TRUE
+ * 	if it is a user
+ */
+uint8 USER_TABLE_find(const uint8 * a_key,const uint8 * a_pin,uint8 length);
+
+#endif /* USER_TABLE_H_ */
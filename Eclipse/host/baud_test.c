@@ -0,0 +1,150 @@
+/******************************************************************************
+ *
+ * Module: Baud Test
+ *
+ * File Name: baud_test.c
+ *
+ * Description: known answers of the compile time baud rate solver of uart.h
+ * 				and of the link baud rate (LINK_BAUD_FOR of system_states.h)
+ * 				1- the macros are evaluated for the clocks of the table of
+ * 				   system_states.h (1 ,8 and 16 MHz) ,F_CPU is the clock of
+ * 				   the case here and not the one of the build : UBRR ,U2X
+ * 				   and the error in per mille of the link rate ,and the next
+ * 				   standard rate must be over UART_BAUD_ERROR_MAX (the #error
+ * 				   of the micros)
+ * 				2- UART_init with the link rate of the build F_CPU on the
+ * 				   ATmega16 model : UBRRH:UBRRL and U2X written by the driver
+ * 				   are the ones of the table
+ * 				a wrong answer fails the run (exit code 1)
+ *
+ * 				usage : baud_test
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#include "uart.h"
+#include "system_states.h"
+#include "hal_host.h"
+#include <stdio.h>
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef struct{
+	uint32 clock;
+	uint32 baud;
+	uint8 accepted;  /* within UART_BAUD_ERROR_MAX ,the rate of the link */
+	uint8 u2x;       /* double speed mode */
+	uint16 ubrr;
+	uint16 error;    /* per mille */
+}BaudCase;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* clock of the build ,F_CPU is the clock of the case below */
+static const uint32 g_buildClock = F_CPU;
+
+/* clock the solver macros are evaluated for */
+static uint32 g_clock;
+
+static const BaudCase g_cases[] = {
+		{1000000UL,9600UL,1,1,12,1},
+		{1000000UL,19200UL,0,1,6,69},
+		{8000000UL,38400UL,1,0,12,1},
+		{8000000UL,57600UL,0,1,16,21},
+		{16000000UL,57600UL,1,1,34,7},
+		{16000000UL,115200UL,0,1,16,21},
+};
+
+#undef F_CPU
+#define F_CPU g_clock
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static int TEST_solver(const BaudCase * a_case);
+static int TEST_driver(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(void){
+
+	uint8 i;
+	int failed = 0;
+
+	for(i = 0; i < sizeof(g_cases)/sizeof(g_cases[0]); i++){
+		failed |= TEST_solver(&g_cases[i]);
+	}
+	failed |= TEST_driver();
+	return failed;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+static int TEST_solver(const BaudCase * a_case){
+
+	uint8 u2x;
+	uint16 ubrr;
+	uint16 error;
+	uint8 accepted;
+	int ok;
+
+	g_clock = a_case->clock;
+	u2x = UART_OPERATING_MODE(a_case->baud) == ASYNCHRONOUS_DOUBLE_SPEED_MODE;
+	ubrr = (uint16)(UART_DIVIDER(a_case->baud,u2x ? 8UL : 16UL) - 1);
+	error = (uint16)UART_BAUD_ERROR(a_case->baud);
+	accepted = error <= UART_BAUD_ERROR_MAX;
+
+	ok = u2x == a_case->u2x && ubrr == a_case->ubrr && error == a_case->error &&
+			accepted == a_case->accepted &&
+			(LINK_BAUD_FOR(a_case->clock) == a_case->baud) == a_case->accepted;
+
+	printf("%2lu MHz %6lu  %-6s UBRR %4u  error %3u/1000  %-8s %s\n",
+			(unsigned long)(a_case->clock / 1000000UL),(unsigned long)a_case->baud,
+			u2x ? "U2X" : "normal",ubrr,error,accepted ? "link" : "rejected",ok ? "ok" : "FAIL");
+	return !ok;
+}
+
+static int TEST_driver(void){
+
+	const BaudCase * link = NULL_PTR;
+	uint16 ubrr;
+	uint8 u2x;
+	uint8 i;
+	int ok;
+	UartConfigType config;
+
+	g_clock = g_buildClock;
+	for(i = 0; i < sizeof(g_cases)/sizeof(g_cases[0]); i++){
+		if(g_cases[i].clock == g_buildClock && g_cases[i].accepted){
+			link = &g_cases[i];
+		}
+	}
+	if(link == NULL_PTR){
+		printf("UART_init at %lu Hz : no known answer\n",(unsigned long)g_buildClock);
+		return 0;
+	}
+
+	/* the configuration of the micros */
+	config = (UartConfigType){LINK_BAUD,UART_OPERATING_MODE(LINK_BAUD),9,1,NO_PARITY,1,0,0};
+	HAL_HOST_reset(g_buildClock);
+	UART_init(&config);
+	ubrr = (uint16)(((UBRRH & 0x0F) << 8) | UBRRL);
+	u2x = (UCSRA & (1<<U2X)) != 0;
+	ok = ubrr == link->ubrr && u2x == link->u2x;
+
+	printf("UART_init %2lu MHz %6lu  %-6s UBRR %4u  %s\n",
+			(unsigned long)(g_buildClock / 1000000UL),(unsigned long)LINK_BAUD,
+			u2x ? "U2X" : "normal",ubrr,ok ? "ok" : "FAIL");
+	UART_Deinit();
+	return !ok;
+}
@@ -0,0 +1,1286 @@
+/******************************************************************************
+ *
+ * Module: Co-simulation
+ *
+ * File Name: cosim.c
+ *
+ * Description: runs the MC1 and INTERFACING_MICRO firmware together on the
+ * 				ATmega16 model and reports the cost of the main user scenarios
+ * 				1- every firmware is a shared object with its own copy of the
+ * 				   model (loaded RTLD_LOCAL) ,its main runs as a coroutine
+ * 				2- the 2 micros run in lock step ,COSIM_QUANTUM cycles each ,
+ * 				   the UART bytes are moved between them after every quantum
+ * 				3- the M24C16 is on the TWI bus of MC1 ,the HD44780 on PORTC/
+ * 				   PORTD and a scripted 4x4 keypad on PORTA of the HMI micro
+ * 				4- a script of key presses and expected LCD screens is divided
+ * 				   in phases ,cycles and wall time of every phase are reported
+ * 				5- a session can be recorded to a trace (every key ,UART byte ,
+ * 				   TWI event and stable LCD screen with its cycle) and replayed
+ * 				   against other firmware images ,every key is replayed at the
+ * 				   same delay after the same screen so a slower build shows as
+ * 				   longer phases ,a phase slower than the tolerance fails
+ * 				6- the UI latency : time from a key pressed to the first
+ * 				   character written to the LCD while the key is held ,the
+ * 				   keys pressed while the HMI is powered down are also
+ * 				   reported alone (wake up to first key)
+ * 				7- the cycles of every power state of both micros give an
+ * 				   estimate of their average supply current in every phase
+ * 				8- every reset is reported : first byte sent by the HMI and by
+ * 				   MC1 and the first screen ,a screen later than
+ * 				   COSIM_BOOT_BUDGET_MS or a write the busy LCD ignored fails
+ * 				   the run
+ * 				9- the bus : up to COSIM_NODES_MAX HMI micros (copies of the
+ * 				   HMI image) share the UART of MC1 ,every frame sent reaches
+ * 				   all the other micros ,the script uses node 1 and the other
+ * 				   nodes stay at their first screen ,the frames ,the load of
+ * 				   the line and the receive interrupts of every node with the
+ * 				   frames its MPCM filter skipped are reported
+ * 				10- --counters writes the snapshot of the performance counters
+ * 				   (counters.h) of MC1 and of the HMI (node 1) at the end to
+ * 				   prefix.MC1 and prefix.HMI for counters_print
+ * 				11- --gate writes a gate profile (gate_config.h) "open,hold,
+ * 				   close,siren,duty" to the EEPROM of MC1 before the first boot
+ * 				   ,the defaults of the firmware are used otherwise
+ * 				12- the motor current of MC1 (ADC reading of its shunt) is
+ * 				   set by the script to obstruct the gate
+ *
+ * 				usage : cosim [--record trace | --replay trace [--tolerance %]]
+ * 				              [--nodes n] [--counters prefix] [--gate profile]
+ * 				              [mc1 image] [hmi image]
+ *
+ * 				trace : one event per line "cycle source event argument"
+ * 				        source MC1 ,HMI (node 1) ,N2..N8 or ALL
+ * 				        PHASE name ,REBOOT ,END             (harness)
+ * 				        KEY xx 1|0     key code in hex ,pressed or released
+ * 				        CURRENT n      ADC reading of the motor current (harness)
+ * 				        UART xx        data frame sent by the source
+ * 				        ADDR xx        address frame sent by the source
+ * 				        TWI S|P|W xx|R xx
+ * 				        LCD line1|line2  a custom character is the digit of
+ * 				                         its lit dot columns (progress bar)
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#define _GNU_SOURCE
+#include "gate_config.h"
+#include "system_states.h"
+#include <dlfcn.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#ifndef COSIM_F_CPU
+#define COSIM_F_CPU 1000000UL
+#endif
+
+/* cycles every micro runs before switching to the other one */
+#define COSIM_QUANTUM 100
+
+#define COSIM_STACK_SIZE (256 * 1024)
+#define COSIM_EEPROM_SIZE 2048
+
+#define COSIM_MS_TO_CYCLES(MS) ((uint64_t)(MS) * (COSIM_F_CPU / 1000UL))
+
+/* a key is held then released for this time (the keypad is scanned every 10 ms) */
+#define COSIM_KEY_PRESS_MS   40
+#define COSIM_KEY_RELEASE_MS 40
+
+/* a screen that does not appear in this time fails the phase */
+#define COSIM_WAIT_TIMEOUT_MS 120000
+
+/* a screen is recorded when it did not change for this time */
+#define COSIM_LCD_SETTLE_MS 20
+
+/* reset to first screen (the screen is shown when written ,before it settles) */
+#define COSIM_BOOT_BUDGET_MS 50
+#define COSIM_BOOTS_MAX 8
+
+/* HMI micros on the bus ,the other nodes leave their reset later one after
+ * the other (their first bytes would collide) */
+#define COSIM_NODES_MAX 8
+#define COSIM_NODE_STAGGER_MS 5
+
+/* frames of the bus : the link baud rate of the clock (system_states.h)
+ * ,start ,9 data bits and stop */
+#define COSIM_BAUD LINK_BAUD_FOR(COSIM_F_CPU)
+#define COSIM_FRAME_BITS 11
+#define COSIM_FRAME_CYCLES (COSIM_FRAME_BITS * (COSIM_F_CPU / COSIM_BAUD))
+
+/* 9th bit of a frame (address frame) */
+#define COSIM_FRAME_ADDRESS 0x100
+
+/* default slow down allowed for a replayed phase (percent) */
+#define COSIM_TOLERANCE 5.0
+
+#define COSIM_TEXT_SIZE 40
+#define COSIM_PHASES_MAX 16
+
+/* wiring of the HMI micro (lcd.h ,keypad.h) */
+#define COSIM_PORTA 0
+#define COSIM_PORTC 2
+#define COSIM_PORTD 3
+#define COSIM_LCD_RS 4
+#define COSIM_LCD_E  6
+#define COSIM_KEYPAD_FIRST_COLUMN 4
+#define COSIM_KEYPAD_ROWS 4
+
+/* ADC channel of the motor current shunt of MC1 (current_sense.h) */
+#define COSIM_CURRENT_CHANNEL 3
+
+/* the keypad rows are wired to INT2 (PB2) through diodes (power.h) */
+#define COSIM_PORTB 1
+#define COSIM_WAKE_PIN 2
+
+/* power counters of the model (hal_host.h) */
+#define COSIM_POWER_ACTIVE     0
+#define COSIM_POWER_IDLE       1
+#define COSIM_POWER_DOWN       2
+#define COSIM_POWER_ADC_ON     3
+#define COSIM_POWER_LOST_BYTES 4
+#define COSIM_POWER_RX_FRAMES  5
+#define COSIM_POWER_FILTERED   6
+#define COSIM_POWER_COUNTERS   7
+
+#define COSIM_AWAKE 0xFF
+#define COSIM_SLEEP_MODE_IDLE 0x00
+
+/* supply current estimate from the ATmega16L datasheet typical values (3 V ,
+ * 25 C) : active 1.1 mA and idle 0.35 mA at 1 MHz (scaled with the clock) ,
+ * power down below 1 uA ,an enabled ADC adds about 0.3 mA */
+#define COSIM_ACTIVE_UA_PER_MHZ 1100.0
+#define COSIM_IDLE_UA_PER_MHZ   350.0
+#define COSIM_POWER_DOWN_UA     1.0
+#define COSIM_ADC_UA            300.0
+
+/* events of the model (hal_host.h) */
+#define COSIM_EVENT_UART_TX   0
+#define COSIM_EVENT_TWI_START 1
+#define COSIM_EVENT_TWI_WRITE 2
+#define COSIM_EVENT_TWI_READ  3
+#define COSIM_EVENT_TWI_STOP  4
+#define COSIM_EVENT_LCD_DATA  5
+#define COSIM_EVENT_UART_ADDRESS 6
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* one firmware image and the model inside it */
+typedef struct{
+	const char * name;
+	const char * path;
+	void * handle;
+	int (*main)(void);
+	void (*reset)(uint32_t cpuFrequency);
+	void (*setSyncHook)(void (*a_hook)(void),uint32_t period);
+	void (*setEventHook)(void (*a_hook)(uint8_t event,uint8_t data));
+	uint64_t (*getCycles)(void);
+	uint8_t (*uartInject)(uint16_t frame);
+	uint8_t (*uartTake)(uint16_t * a_frame);
+	void (*connectPins)(uint8_t port,uint8_t pin1,uint8_t pin2,uint8_t connected);
+	uint8_t * (*eepromMemory)(void);
+	void (*lcdAttach)(uint8_t ctrlPort,uint8_t rsPin,uint8_t enablePin,uint8_t dataPort);
+	const char * (*lcdLine)(uint8_t row);
+	void (*setPin)(uint8_t port,uint8_t pin,uint8_t level);
+	uint8_t (*getPin)(uint8_t port,uint8_t pin);
+	uint8_t (*getSleepMode)(void);
+	uint64_t (*getPowerCount)(uint8_t counter);
+	uint32_t (*lcdIgnored)(void);
+	void (*setAdcInput)(uint8_t channel,uint16_t value);
+	void (*countersSnapshot)(void (*a_sendByte)(uint8_t data));   /* NULL : image without counters */
+	void (*gateConfigBuild)(uint16_t open_ms,uint16_t hold_ms,uint16_t close_ms,uint8_t alarm_s,
+			uint8_t duty,uint8_t * a_image);                       /* NULL : image without a gate profile */
+	uint64_t powerBase[COSIM_POWER_COUNTERS];   /* counts of the images before the last reset */
+	ucontext_t context;
+	uint8_t * stack;
+	uint8_t halted;
+	uint64_t bootTime;   /* lock step time of the last reset */
+	uint8_t address;     /* node address of an HMI (0 : MC1) */
+	uint64_t framesSent;
+	uint64_t addressesSent;
+}CosimMcu;
+
+typedef enum{
+	STEP_PHASE,   /* start measuring a phase */
+	STEP_REBOOT,  /* reset both micros ,the EEPROM keeps its data */
+	STEP_KEYS,    /* press and release every key of the text */
+	STEP_WAIT,    /* wait until the stable first LCD line starts with the text */
+	STEP_DELAY,   /* let the milli seconds of the text pass without any key */
+	STEP_CURRENT, /* set the motor current of MC1 to the ADC reading of the text */
+	STEP_END      /* end of the script */
+}CosimStepType;
+
+typedef struct{
+	CosimStepType type;
+	const char * text;
+}CosimStep;
+
+/* one line of a trace */
+typedef struct{
+	uint64_t time;
+	char source[4];
+	char event[8];
+	char argument[COSIM_TEXT_SIZE];
+}CosimEvent;
+
+typedef struct{
+	char name[COSIM_TEXT_SIZE];
+	uint64_t cycles;
+	double wall;
+	uint8_t done;
+	uint64_t power[2][COSIM_POWER_COUNTERS];   /* MC1 ,HMI : counts at the start then in the phase */
+}CosimPhase;
+
+/* times of a reset ,of the first byte of the HMI and of MC1 and of the first
+ * screen (0 : not yet) */
+typedef struct{
+	uint64_t start;
+	uint64_t link;
+	uint64_t answer;
+	uint64_t screen;
+}CosimBoot;
+
+/* key press to LCD update times */
+typedef struct{
+	uint64_t pressTime;
+	uint8_t pending;     /* the key is held and the LCD was not written yet */
+	uint8_t wakeUp;      /* the key was pressed while the HMI was powered down */
+	uint32_t keys;
+	uint64_t sum;
+	uint64_t min;
+	uint64_t max;
+}CosimLatency;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static CosimMcu g_mc1 = {"MC1"};
+static CosimMcu g_hmi = {"HMI"};
+
+/* HMI nodes 2..g_nodesNum and all the micros on the bus */
+static CosimMcu g_nodes[COSIM_NODES_MAX - 1];
+static char g_nodeNames[COSIM_NODES_MAX - 1][4];
+static uint8_t g_nodesNum = 1;
+static CosimMcu * g_mcus[COSIM_NODES_MAX + 1];
+static uint8_t g_mcusNum;
+
+static ucontext_t g_harness;
+static CosimMcu * g_current;
+
+/* lock step time in cycles */
+static uint64_t g_time;
+
+/* keys on the keypad ,row by row (keypad.c) */
+static const char g_keypadLayout[] = "789%456*123-\r0=+";
+
+/* address jumpers of the HMI (PORTB to ground) ,the node address is 1 + jumpers */
+static const uint8_t g_nodeJumperPins[3] = {0,1,3};
+
+static const CosimStep g_script[] = {
+		{STEP_PHASE,"boot"},
+		{STEP_WAIT,"EnterNewPASSWORD"},
+		{STEP_PHASE,"first-time setup"},
+		{STEP_KEYS,"123456\r"},
+		{STEP_WAIT,"CONFIRM PASSWORD"},
+		{STEP_KEYS,"123456\r"},
+		{STEP_WAIT,"0-->OPEN GATE"},
+		{STEP_PHASE,"gate cycle"},
+		{STEP_KEYS,"0"},
+		{STEP_WAIT,"UNLOCKING"},
+		{STEP_WAIT,"GATE OPEN"},
+		{STEP_WAIT,"LOCKING"},
+		{STEP_WAIT,"0-->OPEN GATE"},
+		{STEP_PHASE,"reboot"},
+		{STEP_REBOOT,NULL},
+		{STEP_WAIT,"ENTER PASSWORD"},
+		{STEP_PHASE,"login"},
+		{STEP_KEYS,"1279--3456\r"},
+		{STEP_WAIT,"0-->OPEN GATE"},
+		{STEP_PHASE,"wrong-password lockout"},
+		{STEP_KEYS,"1"},
+		{STEP_WAIT,"ENTER PASSWORD"},
+		{STEP_KEYS,"00*000000\r"},
+		{STEP_WAIT,"WRONG PASSWORD!!"},
+		{STEP_WAIT,"ENTER PASSWORD"},
+		{STEP_KEYS,"000000\r"},
+		{STEP_WAIT,"WRONG PASSWORD!!"},
+		{STEP_WAIT,"ENTER PASSWORD"},
+		{STEP_KEYS,"000000\r"},
+		{STEP_WAIT,"thief!!!"},
+		{STEP_PHASE,"lockout power cycle"},
+		{STEP_REBOOT,NULL},
+		{STEP_WAIT,"thief!!!"},
+		{STEP_WAIT,"ENTER PASSWORD"},
+		{STEP_PHASE,"login after lockout"},
+		{STEP_KEYS,"123456\r"},
+		{STEP_WAIT,"0-->OPEN GATE"},
+		{STEP_PHASE,"power down and wake up"},
+		{STEP_KEYS,"1"},
+		{STEP_WAIT,"ENTER PASSWORD"},
+		{STEP_DELAY,"40000"},
+		{STEP_KEYS,"123456\r"},
+		{STEP_WAIT,"EnterNewPASSWORD"},
+		{STEP_KEYS,"123456\r"},
+		{STEP_WAIT,"CONFIRM PASSWORD"},
+		{STEP_KEYS,"123456\r"},
+		{STEP_WAIT,"0-->OPEN GATE"},
+		{STEP_PHASE,"gate obstructed"},
+		{STEP_KEYS,"0"},
+		{STEP_WAIT,"UNLOCKING"},
+		{STEP_WAIT,"GATE OPEN"},
+		{STEP_WAIT,"LOCKING"},
+		{STEP_CURRENT,"900"},
+		{STEP_WAIT,"GATE OBSTRUCTED"},
+		{STEP_CURRENT,"0"},
+		{STEP_WAIT,"LOCKING"},
+		{STEP_WAIT,"0-->OPEN GATE"},
+		{STEP_PHASE,"gate blocked"},
+		{STEP_KEYS,"0"},
+		{STEP_WAIT,"UNLOCKING"},
+		{STEP_CURRENT,"900"},
+		{STEP_WAIT,"GATE BLOCKED"},
+		{STEP_CURRENT,"0"},
+		{STEP_WAIT,"0-->OPEN GATE"},
+		{STEP_END,NULL}
+};
+
+/* trace being recorded */
+static FILE * g_traceOut = NULL;
+
+/* snapshot of the counters being written */
+static FILE * g_countersOut = NULL;
+
+/* LCD screen shown now ,since when ,and the last recorded one */
+static char g_screen[COSIM_TEXT_SIZE];
+static uint64_t g_screenTime;
+static char g_screenRecorded[COSIM_TEXT_SIZE];
+
+/* replay : the recorded trace ,next recorded screen to match and the replay
+ * time of every matched screen */
+static CosimEvent * g_trace = NULL;
+static uint32_t g_traceLength;
+static uint32_t g_nextScreen;
+static uint64_t * g_screenMatched = NULL;
+
+/* measured phases and the phases of the replayed trace */
+static CosimPhase g_phases[COSIM_PHASES_MAX];
+static uint8_t g_phasesNum;
+static CosimPhase g_recordedPhases[COSIM_PHASES_MAX];
+static uint8_t g_recordedPhasesNum;
+
+static CosimLatency g_keyLatency = {0,0,0,0,0,UINT64_MAX,0};
+static CosimLatency g_wakeLatency = {0,0,0,0,0,UINT64_MAX,0};
+
+static CosimBoot g_boots[COSIM_BOOTS_MAX];
+static uint8_t g_bootsNum;
+
+/* LCD writes ignored by the images before the last reset */
+static uint32_t g_lcdIgnored;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static int COSIM_load(CosimMcu * mcu);
+static void * COSIM_openCopy(const char * path);
+static void COSIM_unload(CosimMcu * mcu);
+static int COSIM_boot(uint8_t reload);
+static void COSIM_entry(void);
+static void COSIM_sync(void);
+static void COSIM_modelEvent(uint8_t event,uint8_t data);
+static void COSIM_record(uint64_t time,const char * source,const char * event,const char * argument);
+static void COSIM_round(void);
+static void COSIM_observeScreen(void);
+static void COSIM_driveWakeLine(void);
+static void COSIM_latencySample(CosimLatency * a_latency,uint64_t time);
+static void COSIM_printLatency(const char * name,const CosimLatency * a_latency);
+static uint64_t COSIM_powerCount(const CosimMcu * mcu,uint8_t counter);
+static void COSIM_printPower(void);
+static int COSIM_printBoots(void);
+static void COSIM_printBus(void);
+static void COSIM_run(uint64_t cycles);
+static void COSIM_runUntil(uint64_t time);
+static int COSIM_wait(const char * text);
+static int COSIM_setKey(uint8_t key,uint8_t pressed);
+static int COSIM_pressKey(char key);
+static void COSIM_setCurrent(uint16_t value);
+static void COSIM_phase(const char * name);
+static int COSIM_runScript(void);
+static int COSIM_loadTrace(const char * path);
+static int COSIM_replay(void);
+static int COSIM_report(uint8_t replay,double tolerance);
+static int COSIM_writeCounters(const char * prefix);
+static int COSIM_writeGateProfile(const char * profile);
+static void COSIM_countersByte(uint8_t data);
+static double COSIM_wallMs(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(int argc,char * argv[]){
+
+	const char * recordPath = NULL;
+	const char * replayPath = NULL;
+	const char * countersPrefix = NULL;
+	const char * gateProfile = NULL;
+	double tolerance = COSIM_TOLERANCE;
+	int images = 0;
+	int failed;
+	int i;
+
+	g_mc1.path = COSIM_MC1_IMAGE;
+	g_hmi.path = COSIM_HMI_IMAGE;
+	g_hmi.address = 1;
+
+	for(i = 1; i < argc; i++){
+		if(strcmp(argv[i],"--record") == 0 && i + 1 < argc){
+			recordPath = argv[++i];
+		}else if(strcmp(argv[i],"--replay") == 0 && i + 1 < argc){
+			replayPath = argv[++i];
+		}else if(strcmp(argv[i],"--tolerance") == 0 && i + 1 < argc){
+			tolerance = atof(argv[++i]);
+		}else if(strcmp(argv[i],"--counters") == 0 && i + 1 < argc){
+			countersPrefix = argv[++i];
+		}else if(strcmp(argv[i],"--gate") == 0 && i + 1 < argc){
+			gateProfile = argv[++i];
+		}else if(strcmp(argv[i],"--nodes") == 0 && i + 1 < argc){
+			g_nodesNum = (uint8_t)atoi(argv[++i]);
+			if(g_nodesNum < 1 || g_nodesNum > COSIM_NODES_MAX){
+				fprintf(stderr,"--nodes : 1 to %u\n",COSIM_NODES_MAX);
+				return 1;
+			}
+		}else if(images == 0){
+			g_mc1.path = argv[i];
+			images++;
+		}else{
+			g_hmi.path = argv[i];
+		}
+	}
+
+	g_mcus[g_mcusNum++] = &g_mc1;
+	g_mcus[g_mcusNum++] = &g_hmi;
+	for(i = 0; i < g_nodesNum - 1; i++){
+		snprintf(g_nodeNames[i],sizeof(g_nodeNames[i]),"N%d",i + 2);
+		g_nodes[i].name = g_nodeNames[i];
+		g_nodes[i].path = g_hmi.path;
+		g_nodes[i].address = (uint8_t)(i + 2);
+		g_mcus[g_mcusNum++] = &g_nodes[i];
+	}
+
+	if(recordPath != NULL){
+		g_traceOut = fopen(recordPath,"w");
+		if(g_traceOut == NULL){
+			perror(recordPath);
+			return 1;
+		}
+		fprintf(g_traceOut,"# cosim trace ,%lu Hz ,quantum %u cycles ,%u nodes\n",COSIM_F_CPU,
+				COSIM_QUANTUM,g_nodesNum);
+	}
+	if(replayPath != NULL && COSIM_loadTrace(replayPath) != 0){
+		return 1;
+	}
+
+	if(COSIM_boot(0) != 0){
+		return 1;
+	}
+	if(gateProfile != NULL && COSIM_writeGateProfile(gateProfile) != 0){
+		return 1;
+	}
+	failed = (replayPath != NULL) ? COSIM_replay() : COSIM_runScript();
+	failed |= COSIM_report(replayPath != NULL,tolerance);
+	if(countersPrefix != NULL){
+		failed |= COSIM_writeCounters(countersPrefix);
+	}
+
+	if(g_traceOut != NULL){
+		fclose(g_traceOut);
+	}
+	for(i = 0; i < g_mcusNum; i++){
+		COSIM_unload(g_mcus[i]);
+	}
+	free(g_trace);
+	free(g_screenMatched);
+	return failed;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+/* open a firmware image with its own copy of all globals */
+static int COSIM_load(CosimMcu * mcu){
+
+	/* the other nodes are copies of the HMI image ,a second dlopen of the
+	 * same file would share its globals */
+	mcu->handle = (mcu->address > 1) ? COSIM_openCopy(mcu->path) : dlopen(mcu->path,RTLD_NOW | RTLD_LOCAL);
+	if(mcu->handle == NULL){
+		fprintf(stderr,"%s : %s\n",mcu->name,dlerror());
+		return -1;
+	}
+
+	*(void **)&mcu->main = dlsym(mcu->handle,"main");
+	*(void **)&mcu->reset = dlsym(mcu->handle,"HAL_HOST_reset");
+	*(void **)&mcu->setSyncHook = dlsym(mcu->handle,"HAL_HOST_setSyncHook");
+	*(void **)&mcu->setEventHook = dlsym(mcu->handle,"HAL_HOST_setEventHook");
+	*(void **)&mcu->getCycles = dlsym(mcu->handle,"HAL_HOST_getCycles");
+	*(void **)&mcu->uartInject = dlsym(mcu->handle,"HAL_HOST_uartInject");
+	*(void **)&mcu->uartTake = dlsym(mcu->handle,"HAL_HOST_uartTake");
+	*(void **)&mcu->connectPins = dlsym(mcu->handle,"HAL_HOST_connectPins");
+	*(void **)&mcu->eepromMemory = dlsym(mcu->handle,"HAL_HOST_eepromMemory");
+	*(void **)&mcu->lcdAttach = dlsym(mcu->handle,"HAL_HOST_lcdAttach");
+	*(void **)&mcu->lcdLine = dlsym(mcu->handle,"HAL_HOST_lcdLine");
+	*(void **)&mcu->setPin = dlsym(mcu->handle,"HAL_HOST_setPin");
+	*(void **)&mcu->getPin = dlsym(mcu->handle,"HAL_HOST_getPin");
+	*(void **)&mcu->getSleepMode = dlsym(mcu->handle,"HAL_HOST_getSleepMode");
+	*(void **)&mcu->getPowerCount = dlsym(mcu->handle,"HAL_HOST_getPowerCount");
+	*(void **)&mcu->lcdIgnored = dlsym(mcu->handle,"HAL_HOST_lcdIgnored");
+	*(void **)&mcu->setAdcInput = dlsym(mcu->handle,"HAL_HOST_setAdcInput");
+	*(void **)&mcu->countersSnapshot = dlsym(mcu->handle,"COUNTERS_snapshot");
+	*(void **)&mcu->gateConfigBuild = dlsym(mcu->handle,"GATE_CONFIG_build");
+
+	if(mcu->main == NULL || mcu->reset == NULL || mcu->setSyncHook == NULL ||
+			mcu->setEventHook == NULL || mcu->uartInject == NULL || mcu->uartTake == NULL ||
+			mcu->getPowerCount == NULL || mcu->getSleepMode == NULL || mcu->lcdIgnored == NULL ||
+			mcu->setAdcInput == NULL){
+		fprintf(stderr,"%s : %s is not a firmware image of the host build\n",mcu->name,mcu->path);
+		return -1;
+	}
+
+	mcu->stack = malloc(COSIM_STACK_SIZE);
+	mcu->halted = 0;
+	return (mcu->stack == NULL) ? -1 : 0;
+}
+
+static void * COSIM_openCopy(const char * path){
+
+	char copy[] = "/tmp/cosim_node_XXXXXX.so";
+	FILE * in = fopen(path,"rb");
+	FILE * out;
+	char buffer[4096];
+	size_t length;
+	void * handle = NULL;
+	int fd = mkstemps(copy,3);
+
+	if(in == NULL || fd < 0){
+		if(in != NULL){
+			fclose(in);
+		}
+		return NULL;
+	}
+	out = fdopen(fd,"wb");
+	while((length = fread(buffer,1,sizeof(buffer),in)) > 0){
+		fwrite(buffer,1,length,out);
+	}
+	fclose(in);
+	fclose(out);
+	handle = dlopen(copy,RTLD_NOW | RTLD_LOCAL);
+	/* mapped ,the file is not needed any more */
+	unlink(copy);
+	return handle;
+}
+
+static void COSIM_unload(CosimMcu * mcu){
+
+	if(mcu->handle != NULL){
+		dlclose(mcu->handle);
+		mcu->handle = NULL;
+	}
+	free(mcu->stack);
+	mcu->stack = NULL;
+}
+
+/* (re)load the images ,reset the models ,wire the peripherals and prepare
+ * the 2 main functions ,the EEPROM keeps its data */
+static int COSIM_boot(uint8_t reload){
+
+	uint8_t eeprom[COSIM_EEPROM_SIZE];
+	uint8_t i,j;
+
+	if(reload){
+		memcpy(eeprom,g_mc1.eepromMemory(),sizeof(eeprom));
+		for(i = 0; i < g_mcusNum; i++){
+			for(j = 0; j < COSIM_POWER_COUNTERS; j++){
+				g_mcus[i]->powerBase[j] += g_mcus[i]->getPowerCount(j);
+			}
+		}
+		g_lcdIgnored += g_hmi.lcdIgnored();
+		for(i = 0; i < g_mcusNum; i++){
+			COSIM_unload(g_mcus[i]);
+		}
+	}
+	for(i = 0; i < g_mcusNum; i++){
+		if(COSIM_load(g_mcus[i]) != 0){
+			return -1;
+		}
+	}
+	if(reload){
+		memcpy(g_mc1.eepromMemory(),eeprom,sizeof(eeprom));
+	}
+
+	for(i = 0; i < g_mcusNum; i++){
+		CosimMcu * mcu = g_mcus[i];
+		mcu->reset(COSIM_F_CPU);
+		mcu->bootTime = g_time;
+		if(mcu->address > 1){
+			mcu->bootTime += COSIM_MS_TO_CYCLES(COSIM_NODE_STAGGER_MS * (mcu->address - 1));
+			mcu->lcdAttach(COSIM_PORTD,COSIM_LCD_RS,COSIM_LCD_E,COSIM_PORTC);
+			/* a closed jumper is a low pin */
+			for(j = 0; j < sizeof(g_nodeJumperPins); j++){
+				if((mcu->address - 1) & (1 << j)){
+					mcu->setPin(COSIM_PORTB,g_nodeJumperPins[j],0);
+				}
+			}
+		}
+		mcu->setSyncHook(COSIM_sync,COSIM_QUANTUM);
+		mcu->setEventHook(COSIM_modelEvent);
+		getcontext(&mcu->context);
+		mcu->context.uc_stack.ss_sp = mcu->stack;
+		mcu->context.uc_stack.ss_size = COSIM_STACK_SIZE;
+		mcu->context.uc_link = &g_harness;
+		makecontext(&mcu->context,COSIM_entry,0);
+	}
+	g_hmi.lcdAttach(COSIM_PORTD,COSIM_LCD_RS,COSIM_LCD_E,COSIM_PORTC);
+
+	if(g_bootsNum < COSIM_BOOTS_MAX){
+		memset(&g_boots[g_bootsNum],0,sizeof(CosimBoot));
+		g_boots[g_bootsNum].start = g_time;
+		g_bootsNum++;
+	}
+	return 0;
+}
+
+static void COSIM_entry(void){
+
+	g_current->main();
+	/* the firmware returned from main ,it stays halted */
+	g_current->halted = 1;
+}
+
+/* end of a quantum ,go back to the harness */
+static void COSIM_sync(void){
+	swapcontext(&g_current->context,&g_harness);
+}
+
+/* UART and TWI events of the running micro at its own cycle */
+static void COSIM_modelEvent(uint8_t event,uint8_t data){
+
+	static const char * const s_twi[] = {"","S","W","R","P"};
+	char argument[8];
+	uint64_t time = g_current->bootTime + g_current->getCycles();
+
+	if(event == COSIM_EVENT_UART_ADDRESS){
+		g_current->addressesSent++;
+		snprintf(argument,sizeof(argument),"%02x",data);
+		COSIM_record(time,g_current->name,"ADDR",argument);
+		return;
+	}
+	if(event == COSIM_EVENT_LCD_DATA){
+		if(g_current == &g_hmi && g_keyLatency.pending){
+			if(g_keyLatency.wakeUp){
+				g_wakeLatency.pressTime = g_keyLatency.pressTime;
+				COSIM_latencySample(&g_wakeLatency,time);
+			}
+			COSIM_latencySample(&g_keyLatency,time);
+		}
+		return;
+	}
+	if(event == COSIM_EVENT_UART_TX && g_bootsNum > 0 && (g_current == &g_hmi || g_current == &g_mc1)){
+		CosimBoot * boot = &g_boots[g_bootsNum - 1];
+		uint64_t * first = (g_current == &g_hmi) ? &boot->link : &boot->answer;
+		if(*first == 0){
+			*first = time;
+		}
+	}
+	if(g_traceOut == NULL){
+		return;
+	}
+	if(event == COSIM_EVENT_UART_TX){
+		snprintf(argument,sizeof(argument),"%02x",data);
+		COSIM_record(time,g_current->name,"UART",argument);
+	}else if(event == COSIM_EVENT_TWI_WRITE || event == COSIM_EVENT_TWI_READ){
+		snprintf(argument,sizeof(argument),"%s %02x",s_twi[event],data);
+		COSIM_record(time,g_current->name,"TWI",argument);
+	}else if(event <= COSIM_EVENT_TWI_STOP){
+		COSIM_record(time,g_current->name,"TWI",s_twi[event]);
+	}
+}
+
+static void COSIM_record(uint64_t time,const char * source,const char * event,const char * argument){
+
+	if(g_traceOut != NULL){
+		fprintf(g_traceOut,"%llu %s %s %s\n",(unsigned long long)time,source,event,argument);
+	}
+}
+
+/* one quantum of all the micros then move the UART frames on the bus ,every
+ * frame reaches all the other micros */
+static void COSIM_round(void){
+
+	uint8_t i,j;
+	uint16_t frame;
+
+	COSIM_driveWakeLine();
+	for(i = 0; i < g_mcusNum; i++){
+		/* a node still in reset does not run */
+		if(!g_mcus[i]->halted && g_time >= g_mcus[i]->bootTime){
+			g_current = g_mcus[i];
+			swapcontext(&g_harness,&g_mcus[i]->context);
+		}
+	}
+	for(i = 0; i < g_mcusNum; i++){
+		while(g_mcus[i]->uartTake(&frame)){
+			g_mcus[i]->framesSent++;
+			for(j = 0; j < g_mcusNum; j++){
+				if(j != i && g_time >= g_mcus[j]->bootTime){
+					g_mcus[j]->uartInject(frame);
+				}
+			}
+		}
+	}
+	g_time += COSIM_QUANTUM;
+
+	COSIM_observeScreen();
+}
+
+/* record a screen once it is stable ,in replay match it with the trace */
+static void COSIM_observeScreen(void){
+
+	char screen[COSIM_TEXT_SIZE];
+
+	snprintf(screen,sizeof(screen),"%s|",g_hmi.lcdLine(0));
+	strncat(screen,g_hmi.lcdLine(1),sizeof(screen) - strlen(screen) - 1);
+
+	if(strcmp(screen,g_screen) != 0){
+		strcpy(g_screen,screen);
+		g_screenTime = g_time;
+		return;
+	}
+	if(strcmp(g_screen,g_screenRecorded) == 0 ||
+			g_time - g_screenTime < COSIM_MS_TO_CYCLES(COSIM_LCD_SETTLE_MS)){
+		return;
+	}
+	strcpy(g_screenRecorded,g_screen);
+	COSIM_record(g_screenTime,"HMI","LCD",g_screen);
+
+	/* the blank screen of the power on is not the first one */
+	if(g_bootsNum > 0 && g_boots[g_bootsNum - 1].screen == 0 && g_screen[strspn(g_screen," |")] != '\0'){
+		g_boots[g_bootsNum - 1].screen = g_screenTime;
+	}
+
+	/* the next recorded screen ,any other screen is not matched */
+	while(g_trace != NULL && g_nextScreen < g_traceLength &&
+			strcmp(g_trace[g_nextScreen].event,"LCD") != 0){
+		g_nextScreen++;
+	}
+	if(g_trace != NULL && g_nextScreen < g_traceLength &&
+			strcmp(g_trace[g_nextScreen].argument,g_screen) == 0){
+		g_screenMatched[g_nextScreen] = g_screenTime;
+		g_nextScreen++;
+	}
+}
+
+/* the diodes pull INT2 low when any row of the keypad is low */
+static void COSIM_driveWakeLine(void){
+
+	uint8_t row;
+	uint8_t level = 1;
+
+	for(row = 0; row < COSIM_KEYPAD_ROWS; row++){
+		level &= g_hmi.getPin(COSIM_PORTA,row);
+	}
+	g_hmi.setPin(COSIM_PORTB,COSIM_WAKE_PIN,level ? 2 : 0);
+}
+
+static void COSIM_latencySample(CosimLatency * a_latency,uint64_t time){
+
+	uint64_t latency = time - a_latency->pressTime;
+
+	a_latency->pending = 0;
+	a_latency->keys++;
+	a_latency->sum += latency;
+	a_latency->min = (latency < a_latency->min) ? latency : a_latency->min;
+	a_latency->max = (latency > a_latency->max) ? latency : a_latency->max;
+}
+
+static void COSIM_run(uint64_t cycles){
+	COSIM_runUntil(g_time + cycles);
+}
+
+static void COSIM_runUntil(uint64_t time){
+
+	while(g_time < time){
+		COSIM_round();
+	}
+}
+
+/* the screens are compared once stable (as recorded in a trace) */
+static int COSIM_wait(const char * text){
+
+	uint64_t end = g_time + COSIM_MS_TO_CYCLES(COSIM_WAIT_TIMEOUT_MS);
+
+	while(strncmp(g_screenRecorded,text,strlen(text)) != 0){
+		if(g_time >= end){
+			return 1;
+		}
+		COSIM_round();
+	}
+	return 0;
+}
+
+/* close or open the switch between the row and the column of the key */
+static int COSIM_setKey(uint8_t key,uint8_t pressed){
+
+	const char * position = (key == 0) ? NULL : strchr(g_keypadLayout,key);
+	uint8_t row,column;
+	char argument[8];
+
+	if(position == NULL){
+		return 1;
+	}
+	row = (uint8_t)((position - g_keypadLayout) / 4);
+	column = (uint8_t)(COSIM_KEYPAD_FIRST_COLUMN + (position - g_keypadLayout) % 4);
+
+	snprintf(argument,sizeof(argument),"%02x %u",key,pressed);
+	COSIM_record(g_time,"HMI","KEY",argument);
+	g_hmi.connectPins(COSIM_PORTA,row,column,pressed);
+	/* a key that changes the LCD only later (enter) is not a sample */
+	g_keyLatency.pressTime = g_time;
+	g_keyLatency.pending = pressed;
+	g_keyLatency.wakeUp = pressed && g_hmi.getSleepMode() != COSIM_AWAKE &&
+			g_hmi.getSleepMode() != COSIM_SLEEP_MODE_IDLE;
+	return 0;
+}
+
+static int COSIM_pressKey(char key){
+
+	if(COSIM_setKey((uint8_t)key,1) != 0){
+		return 1;
+	}
+	COSIM_run(COSIM_MS_TO_CYCLES(COSIM_KEY_PRESS_MS));
+	COSIM_setKey((uint8_t)key,0);
+	COSIM_run(COSIM_MS_TO_CYCLES(COSIM_KEY_RELEASE_MS));
+	return 0;
+}
+
+static void COSIM_setCurrent(uint16_t value){
+
+	char argument[8];
+
+	snprintf(argument,sizeof(argument),"%u",value);
+	COSIM_record(g_time,"ALL","CURRENT",argument);
+	g_mc1.setAdcInput(COSIM_CURRENT_CHANNEL,value);
+}
+
+/* end the running phase (if any) and start a new one (name NULL at the end) */
+static void COSIM_phase(const char * name){
+
+	static uint64_t s_start;
+	static double s_wall;
+	CosimMcu * mcus[2] = {&g_mc1,&g_hmi};
+	uint8_t i,counter;
+
+	if(g_phasesNum > 0){
+		CosimPhase * phase = &g_phases[g_phasesNum - 1];
+
+		phase->cycles = g_time - s_start;
+		phase->wall = COSIM_wallMs() - s_wall;
+		phase->done = 1;
+		for(i = 0; i < 2; i++){
+			for(counter = 0; counter < COSIM_POWER_COUNTERS; counter++){
+				phase->power[i][counter] = COSIM_powerCount(mcus[i],counter) - phase->power[i][counter];
+			}
+		}
+	}
+	COSIM_record(g_time,"ALL",(name != NULL) ? "PHASE" : "END",(name != NULL) ? name : "");
+	if(name == NULL || g_phasesNum == COSIM_PHASES_MAX){
+		return;
+	}
+	snprintf(g_phases[g_phasesNum].name,COSIM_TEXT_SIZE,"%s",name);
+	for(i = 0; i < 2; i++){
+		for(counter = 0; counter < COSIM_POWER_COUNTERS; counter++){
+			g_phases[g_phasesNum].power[i][counter] = COSIM_powerCount(mcus[i],counter);
+		}
+	}
+	g_phasesNum++;
+	s_start = g_time;
+	s_wall = COSIM_wallMs();
+}
+
+static int COSIM_runScript(void){
+
+	const CosimStep * step;
+	const char * key;
+
+	for(step = g_script; step->type != STEP_END; step++){
+		switch(step->type){
+		case STEP_PHASE:
+			COSIM_phase(step->text);
+			break;
+		case STEP_REBOOT:
+			COSIM_record(g_time,"ALL","REBOOT","");
+			if(COSIM_boot(1) != 0){
+				return 1;
+			}
+			break;
+		case STEP_KEYS:
+			for(key = step->text; *key != '\0'; key++){
+				if(COSIM_pressKey(*key) != 0){
+					return 1;
+				}
+			}
+			break;
+		case STEP_WAIT:
+			if(COSIM_wait(step->text) != 0){
+				printf("failed waiting for \"%s\" ,LCD [%s]\n",step->text,g_screen);
+				return 1;
+			}
+			break;
+		case STEP_DELAY:
+			COSIM_run(COSIM_MS_TO_CYCLES(atoi(step->text)));
+			break;
+		case STEP_CURRENT:
+			COSIM_setCurrent((uint16_t)atoi(step->text));
+			break;
+		default:
+			break;
+		}
+	}
+	COSIM_phase(NULL);
+	return 0;
+}
+
+static int COSIM_loadTrace(const char * path){
+
+	FILE * file = fopen(path,"r");
+	char line[128];
+	uint32_t size = 0;
+	uint32_t i;
+	uint64_t start = 0;
+
+	if(file == NULL){
+		perror(path);
+		return -1;
+	}
+	while(fgets(line,sizeof(line),file) != NULL){
+		CosimEvent * event;
+		unsigned long long time;
+		int used = 0;
+
+		if(line[0] == '#'){
+			continue;
+		}
+		if(g_traceLength == size){
+			size = (size == 0) ? 1024 : size * 2;
+			g_trace = realloc(g_trace,size * sizeof(CosimEvent));
+			if(g_trace == NULL){
+				fclose(file);
+				return -1;
+			}
+		}
+		event = &g_trace[g_traceLength];
+		memset(event,0,sizeof(*event));
+		if(sscanf(line,"%llu %3s %7s %n",&time,event->source,event->event,&used) < 3){
+			continue;
+		}
+		event->time = time;
+		line[strcspn(line,"\n")] = '\0';
+		snprintf(event->argument,sizeof(event->argument),"%s",line + used);
+		g_traceLength++;
+	}
+	fclose(file);
+
+	/* cycles of the recorded phases */
+	for(i = 0; i < g_traceLength; i++){
+		const CosimEvent * event = &g_trace[i];
+		uint8_t phase = (strcmp(event->event,"PHASE") == 0);
+		if(!phase && strcmp(event->event,"END") != 0){
+			continue;
+		}
+		if(g_recordedPhasesNum > 0 && !g_recordedPhases[g_recordedPhasesNum - 1].done){
+			g_recordedPhases[g_recordedPhasesNum - 1].cycles = event->time - start;
+			g_recordedPhases[g_recordedPhasesNum - 1].done = 1;
+		}
+		if(phase && g_recordedPhasesNum < COSIM_PHASES_MAX){
+			snprintf(g_recordedPhases[g_recordedPhasesNum].name,COSIM_TEXT_SIZE,"%s",event->argument);
+			g_recordedPhasesNum++;
+			start = event->time;
+		}
+	}
+
+	g_screenMatched = calloc(g_traceLength + 1,sizeof(uint64_t));
+	return (g_screenMatched == NULL) ? -1 : 0;
+}
+
+/*
+ * replay the harness events of the trace (keys ,reboots ,motor currents and phases) ,every one
+ * at the same delay after the last screen before it in the trace
+ */
+static int COSIM_replay(void){
+
+	int32_t anchor = -1;
+	uint32_t i;
+
+	for(i = 0; i < g_traceLength; i++){
+		const CosimEvent * event = &g_trace[i];
+		uint64_t start;
+		unsigned int key,pressed;
+
+		if(strcmp(event->event,"LCD") == 0){
+			anchor = (int32_t)i;
+			continue;
+		}
+		if(strcmp(event->source,"ALL") != 0 && strcmp(event->event,"KEY") != 0){
+			continue;
+		}
+
+		/* wait for the screen then for the same delay */
+		if(anchor >= 0){
+			uint64_t end = g_time + COSIM_MS_TO_CYCLES(COSIM_WAIT_TIMEOUT_MS);
+			while(g_nextScreen <= (uint32_t)anchor){
+				if(g_time >= end){
+					printf("screen [%s] never shown ,LCD [%s]\n",g_trace[anchor].argument,g_screen);
+					return 1;
+				}
+				COSIM_round();
+			}
+			start = g_screenMatched[anchor];
+			COSIM_runUntil(start + (event->time - g_trace[anchor].time));
+		}else{
+			COSIM_runUntil(event->time);
+		}
+
+		if(strcmp(event->event,"PHASE") == 0){
+			COSIM_phase(event->argument);
+		}else if(strcmp(event->event,"END") == 0){
+			COSIM_phase(NULL);
+			return 0;
+		}else if(strcmp(event->event,"REBOOT") == 0){
+			if(COSIM_boot(1) != 0){
+				return 1;
+			}
+		}else if(strcmp(event->event,"CURRENT") == 0){
+			COSIM_setCurrent((uint16_t)atoi(event->argument));
+		}else if(sscanf(event->argument,"%x %u",&key,&pressed) == 2){
+			COSIM_setKey((uint8_t)key,(uint8_t)pressed);
+		}
+	}
+	printf("the trace has no END\n");
+	return 1;
+}
+
+static int COSIM_report(uint8_t replay,double tolerance){
+
+	uint8_t i;
+	int failed = 0;
+
+	COSIM_printLatency("key to LCD",&g_keyLatency);
+	COSIM_printLatency("wake to LCD",&g_wakeLatency);
+	failed |= COSIM_printBoots();
+
+	if(!replay){
+		printf("%-24s %14s %12s\n","phase","cycles","wall ms");
+		for(i = 0; i < g_phasesNum; i++){
+			printf("%-24s %14llu %12.1f\n",g_phases[i].name,
+					(unsigned long long)g_phases[i].cycles,g_phases[i].wall);
+		}
+		COSIM_printPower();
+		COSIM_printBus();
+		return failed;
+	}
+
+	printf("%-24s %14s %14s %9s\n","phase","recorded","replayed","delta");
+	for(i = 0; i < g_recordedPhasesNum; i++){
+		const CosimPhase * recorded = &g_recordedPhases[i];
+		const CosimPhase * replayed = &g_phases[i];
+		double delta;
+
+		if(i >= g_phasesNum || !replayed->done){
+			printf("%-24s %14llu %14s %9s  FAIL\n",recorded->name,
+					(unsigned long long)recorded->cycles,"-","-");
+			failed = 1;
+			continue;
+		}
+		delta = (recorded->cycles == 0) ? 0.0 :
+				100.0 * ((double)replayed->cycles - (double)recorded->cycles) / (double)recorded->cycles;
+		printf("%-24s %14llu %14llu %+8.2f%%%s\n",recorded->name,
+				(unsigned long long)recorded->cycles,(unsigned long long)replayed->cycles,
+				delta,(delta > tolerance) ? "  FAIL" : "");
+		failed |= (delta > tolerance);
+	}
+	return failed;
+}
+
+/* the snapshots are sent by the firmware as to a node asking for them */
+static int COSIM_writeCounters(const char * prefix){
+
+	CosimMcu * mcus[2] = {&g_mc1,&g_hmi};
+	char path[PATH_MAX];
+	uint8_t i;
+
+	for(i = 0; i < 2; i++){
+		if(mcus[i]->countersSnapshot == NULL){
+			printf("%s : no counters in %s\n",mcus[i]->name,mcus[i]->path);
+			continue;
+		}
+		snprintf(path,sizeof(path),"%s.%s",prefix,mcus[i]->name);
+		g_countersOut = fopen(path,"wb");
+		if(g_countersOut == NULL){
+			perror(path);
+			return 1;
+		}
+		mcus[i]->countersSnapshot(COSIM_countersByte);
+		fclose(g_countersOut);
+		g_countersOut = NULL;
+		printf("%s : counters since the last reset in %s\n",mcus[i]->name,path);
+	}
+	return 0;
+}
+
+static void COSIM_countersByte(uint8_t data){
+	fputc(data,g_countersOut);
+}
+
+/* the image of the profile where MC1 reads it at boot (checked by MC1) */
+static int COSIM_writeGateProfile(const char * profile){
+
+	unsigned int values[5];
+	char end;
+
+	if(sscanf(profile,"%u,%u,%u,%u,%u%c",&values[0],&values[1],&values[2],&values[3],&values[4],&end) != 5 ||
+			values[0] > 0xFFFF || values[1] > 0xFFFF || values[2] > 0xFFFF || values[3] > 0xFF || values[4] > 0xFF){
+		fprintf(stderr,"--gate : open,hold,close,siren,duty in ms ,ms ,ms ,s and %%\n");
+		return -1;
+	}
+	if(g_mc1.gateConfigBuild == NULL){
+		fprintf(stderr,"MC1 : no gate profile in %s\n",g_mc1.path);
+		return -1;
+	}
+	g_mc1.gateConfigBuild((uint16_t)values[0],(uint16_t)values[1],(uint16_t)values[2],(uint8_t)values[3],
+			(uint8_t)values[4],g_mc1.eepromMemory() + GATE_CONFIG_ADDRESS);
+	return 0;
+}
+
+static void COSIM_printLatency(const char * name,const CosimLatency * a_latency){
+
+	if(a_latency->keys > 0){
+		printf("%s : %u keys ,min %.2f ms ,avg %.2f ms ,max %.2f ms\n",name,a_latency->keys,
+				a_latency->min * 1000.0 / COSIM_F_CPU,
+				a_latency->sum * 1000.0 / COSIM_F_CPU / a_latency->keys,
+				a_latency->max * 1000.0 / COSIM_F_CPU);
+	}
+}
+
+static uint64_t COSIM_powerCount(const CosimMcu * mcu,uint8_t counter){
+	return mcu->powerBase[counter] + mcu->getPowerCount(counter);
+}
+
+/* time asleep ,powered down and the average current of every phase */
+static void COSIM_printPower(void){
+
+	const double mhz = COSIM_F_CPU / 1000000.0;
+	uint32_t lost = 0;
+	uint8_t i,mcu;
+
+	printf("%-24s %9s %8s %9s %9s %8s\n","power estimate","MC1 sleep","MC1 uA",
+			"HMI sleep","HMI down","HMI uA");
+	for(i = 0; i < g_phasesNum; i++){
+		double sleep[2],down[2],current[2];
+
+		if(!g_phases[i].done){
+			continue;
+		}
+		for(mcu = 0; mcu < 2; mcu++){
+			const uint64_t * count = g_phases[i].power[mcu];
+			double total = (double)(count[COSIM_POWER_ACTIVE] + count[COSIM_POWER_IDLE] +
+					count[COSIM_POWER_DOWN]);
+
+			if(total == 0){
+				total = 1;
+			}
+			sleep[mcu] = 100.0 * (count[COSIM_POWER_IDLE] + count[COSIM_POWER_DOWN]) / total;
+			down[mcu] = 100.0 * count[COSIM_POWER_DOWN] / total;
+			current[mcu] = (count[COSIM_POWER_ACTIVE] * COSIM_ACTIVE_UA_PER_MHZ * mhz +
+					count[COSIM_POWER_IDLE] * COSIM_IDLE_UA_PER_MHZ * mhz +
+					count[COSIM_POWER_DOWN] * COSIM_POWER_DOWN_UA +
+					count[COSIM_POWER_ADC_ON] * COSIM_ADC_UA) / total;
+			lost += (uint32_t)count[COSIM_POWER_LOST_BYTES];
+		}
+		printf("%-24s %8.1f%% %8.1f %8.1f%% %8.1f%% %8.1f\n",g_phases[i].name,
+				sleep[0],current[0],sleep[1],down[1],current[1]);
+	}
+	if(lost != 0){
+		printf("%u UART bytes lost while a micro was powered down\n",lost);
+	}
+}
+
+/* time from every reset to the first bytes and the first screen */
+static int COSIM_printBoots(void){
+
+	const double msPerCycle = 1000.0 / COSIM_F_CPU;
+	uint32_t ignored = g_lcdIgnored + g_hmi.lcdIgnored();
+	int failed = 0;
+	uint8_t i;
+
+	printf("%-24s %9s %9s %9s\n","boot (ms after reset)","HMI link","MC1 ready","screen");
+	for(i = 0; i < g_bootsNum; i++){
+		const CosimBoot * boot = &g_boots[i];
+		double screen = (boot->screen - boot->start) * msPerCycle;
+		uint8_t over = (boot->screen == 0) || (screen > COSIM_BOOT_BUDGET_MS);
+
+		printf("reset %-18u %9.2f %9.2f %9.2f%s\n",i,
+				(boot->link == 0) ? 0.0 : (boot->link - boot->start) * msPerCycle,
+				(boot->answer == 0) ? 0.0 : (boot->answer - boot->start) * msPerCycle,
+				(boot->screen == 0) ? 0.0 : screen,over ? "  OVER BUDGET" : "");
+		failed |= over;
+	}
+	if(ignored != 0){
+		printf("%u LCD writes ignored (the LCD was busy)\n",ignored);
+		failed = 1;
+	}
+	return failed;
+}
+
+/* frames on the line and the receive interrupts of every micro */
+static void COSIM_printBus(void){
+
+	uint64_t frames = 0;
+	uint64_t addresses = 0;
+	uint8_t i;
+
+	for(i = 0; i < g_mcusNum; i++){
+		frames += g_mcus[i]->framesSent;
+		addresses += g_mcus[i]->addressesSent;
+	}
+	printf("bus : %u nodes ,%llu frames (%llu address) ,line busy %.2f%%\n",g_nodesNum,
+			(unsigned long long)frames,(unsigned long long)addresses,
+			(g_time == 0) ? 0.0 : 100.0 * frames * COSIM_FRAME_CYCLES / g_time);
+	printf("%-24s %9s %9s %9s %11s\n","micro","sent","rx irq","skipped","irq no MPCM");
+	for(i = 0; i < g_mcusNum; i++){
+		uint64_t received = COSIM_powerCount(g_mcus[i],COSIM_POWER_RX_FRAMES);
+		uint64_t skipped = COSIM_powerCount(g_mcus[i],COSIM_POWER_FILTERED);
+
+		printf("%-24s %9llu %9llu %9llu %11llu\n",g_mcus[i]->name,
+				(unsigned long long)g_mcus[i]->framesSent,(unsigned long long)received,
+				(unsigned long long)skipped,(unsigned long long)(received + skipped));
+	}
+}
+
+static double COSIM_wallMs(void){
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
@@ -0,0 +1,167 @@
+/******************************************************************************
+ *
+ * Module: Counters Printer
+ *
+ * File Name: counters_print.c
+ *
+ * Description: prints a snapshot of the performance counters (counters.h)
+ * 				or the difference of two snapshots of the same micro ,with
+ * 				the rate of every counter and the idle time of the CPU
+ * 				the snapshot of MC1 is pulled from a door by the counters
+ * 				job of the gateway (gateway.c) ,the bytes before the
+ * 				snapshot header are skipped
+ *
+ * 				usage : counters_print snapshot [later snapshot]
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#include "counters.h"
+#include <stdio.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define COUNTERS_NAME(NAME) #NAME,
+
+/* names are printed without it */
+#define COUNTERS_PREFIX_LENGTH (sizeof("COUNTER_") - 1)
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef struct{
+	uint32 cycles;
+	uint8 count;     /* counters in the snapshot (an other firmware may have less) */
+	uint32 counters[COUNTERS_NUM];
+}CountersSnapshot;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static const char * const g_counterNames[COUNTERS_NUM] = {
+		COUNTERS_LIST(COUNTERS_NAME)
+};
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static int PRINT_load(const char * path,CountersSnapshot * a_snapshot);
+static uint32 PRINT_read32(FILE * file,int * a_ok);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(int argc,char * argv[]){
+
+	CountersSnapshot first;
+	CountersSnapshot last;
+	uint32 cycles;
+	double seconds;
+	uint8 count;
+	uint8 i;
+
+	if(argc < 2 || argc > 3){
+		fprintf(stderr,"usage : counters_print snapshot [later snapshot]\n");
+		return 1;
+	}
+	if(PRINT_load(argv[1],&last) != 0){
+		return 1;
+	}
+	if(argc == 3){
+		first = last;
+		if(PRINT_load(argv[2],&last) != 0){
+			return 1;
+		}
+	}else{
+		/* since SYSTICK_init */
+		memset(&first,0,sizeof(first));
+		first.count = last.count;
+	}
+
+	/* the counters wrap around ,unsigned differences are right for one wrap */
+	cycles = last.cycles - first.cycles;
+	seconds = (double)cycles / F_CPU;
+	count = (first.count < last.count) ? first.count : last.count;
+	printf("%u counters over %.3f s (%lu cycles at %lu Hz)\n",count,seconds,(unsigned long)cycles,F_CPU);
+	printf("%-28s %12s %12s\n","counter","count","per second");
+	for(i = 0; i < count; i++){
+		uint32 value = last.counters[i] - first.counters[i];
+
+		if(i == COUNTER_IDLE_CYCLES){
+			printf("%-28s %12lu %11.1f%%\n",g_counterNames[i] + COUNTERS_PREFIX_LENGTH,(unsigned long)value,
+					(cycles == 0) ? 0.0 : 100.0 * value / cycles);
+		}else{
+			printf("%-28s %12lu %12.1f%s\n",g_counterNames[i] + COUNTERS_PREFIX_LENGTH,(unsigned long)value,
+					(seconds > 0) ? value / seconds : 0.0,
+					(value != 0 && (i == COUNTER_UART_FRAME_ERRORS || i == COUNTER_UART_OVERRUNS ||
+							i == COUNTER_TWI_NACKS)) ? "  CHECK" : "");
+		}
+	}
+	if(first.count != last.count){
+		printf("the snapshots have %u and %u counters (other firmware)\n",first.count,last.count);
+	}
+	return 0;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+/* skip to the header ,then the cycles and the counters this build knows */
+static int PRINT_load(const char * path,CountersSnapshot * a_snapshot){
+
+	FILE * file = fopen(path,"rb");
+	int previous = 0;
+	int data;
+	int ok = 1;
+	uint8 i;
+
+	if(file == NULL){
+		perror(path);
+		return -1;
+	}
+	while((data = fgetc(file)) != EOF && !(previous == COUNTERS_MAGIC1 && data == COUNTERS_MAGIC2)){
+		previous = data;
+	}
+	data = fgetc(file);
+	if(data == EOF){
+		fprintf(stderr,"%s : no counters snapshot\n",path);
+		fclose(file);
+		return -1;
+	}
+	a_snapshot->count = (data < COUNTERS_NUM) ? (uint8)data : COUNTERS_NUM;
+	a_snapshot->cycles = PRINT_read32(file,&ok);
+	for(i = 0; i < a_snapshot->count; i++){
+		a_snapshot->counters[i] = PRINT_read32(file,&ok);
+	}
+	fclose(file);
+	if(!ok){
+		fprintf(stderr,"%s : snapshot cut short\n",path);
+		return -1;
+	}
+	return 0;
+}
+
+static uint32 PRINT_read32(FILE * file,int * a_ok){
+
+	uint32 value = 0;
+	uint8 i;
+
+	for(i = 0; i < 4; i++){
+		int data = fgetc(file);
+		if(data == EOF){
+			*a_ok = 0;
+			return 0;
+		}
+		value |= (uint32)data << (8 * i);
+	}
+	return value;
+}
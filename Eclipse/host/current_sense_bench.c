@@ -0,0 +1,237 @@
+/******************************************************************************
+ *
+ * Module: Current Sense Benchmark
+ *
+ * File Name: current_sense_bench.c
+ *
+ * Description: step response and cost of the MC1 stall detection (current_sense.h)
+ * 				the ADC and the motor are replaced by this file ,every sample
+ * 				is given to the ADC call back of the module
+ * 				1- the filter against the ideal first order low pass
+ * 				   y += (x-y)/2^SHIFT in floating point ,the fixed point
+ * 				   output may only lose its truncations (BENCH_MAX_ERROR) ,
+ * 				   then the samples to 50 % and 90 % of the step are printed
+ * 				2- a step above the trip level trips once at the expected
+ * 				   sample and stops the motor ,a step under it and an inrush
+ * 				   within the blanking time never trip
+ * 				   a wrong answer fails the run (exit code 1)
+ * 				3- then the time per sample of the call back is measured (on
+ * 				   the host ,the AVR cycles are not known here)
+ *
+ * 				usage : current_sense_bench [samples]
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#define _GNU_SOURCE
+#include "current_sense.h"
+#include "adc.h"
+#include "motor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define BENCH_DEFAULT_SAMPLES 10000000UL
+
+/* motor PWM frequency and trip time of MC1 (MC1.c) */
+#define BENCH_PWM_FREQUENCY 500
+#define BENCH_TRIP_MS 100
+
+/* samples of the blanking and trip times at BENCH_PWM_FREQUENCY */
+#define BENCH_BLANKING_SAMPLES ((CURRENT_SENSE_BLANKING_MS * BENCH_PWM_FREQUENCY + 999UL) / 1000UL)
+#define BENCH_TRIP_SAMPLES ((BENCH_TRIP_MS * BENCH_PWM_FREQUENCY + 999UL) / 1000UL)
+
+/* fraction bits of the filter output (current_sense.c) ,the output read
+ * drops them (1 reading) and every update drops the bits shifted out */
+#define BENCH_FRACTION_BITS 4
+#define BENCH_MAX_ERROR (1.0 + (double)((1 << CURRENT_SENSE_FILTER_SHIFT) - 1) / (1 << BENCH_FRACTION_BITS))
+
+/* samples of the step response checked */
+#define BENCH_STEP_SAMPLES 64
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* ADC call back of the module and the reading it gets */
+static void (*g_adcCallBack)(void) = NULL_PTR;
+static uint16 g_adcResult;
+static uint8 g_adcEnabled;
+
+static uint32 g_motorStops;
+static uint32 g_stalls;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static uint32 BENCH_feed(uint16 reading,uint32 samples);
+static int BENCH_stepResponse(uint16 reading);
+static int BENCH_trip(const char * name,uint16 reading,uint32 samples,uint32 expected);
+static void BENCH_stall(void);
+static double BENCH_nowNs(void);
+
+/*******************************************************************************
+ *                   ADC and motor of the module                               *
+ *******************************************************************************/
+
+void ADC_init(const AdcConfigType * config_ptr){
+	(void)config_ptr;
+}
+
+void ADC_enable(void){
+	g_adcEnabled = TRUE;
+}
+
+void ADC_disable(void){
+	g_adcEnabled = FALSE;
+}
+
+uint16 ADC_getResult(void){
+	return g_adcResult;
+}
+
+void ADC_setCallBack(void(*a_ptr)(void)){
+	g_adcCallBack = a_ptr;
+}
+
+void motor_stop(void){
+	g_motorStops++;
+}
+
+uint16 motor_getFrequency(void){
+	return BENCH_PWM_FREQUENCY;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(int argc,char * argv[]){
+
+	uint32 samples = (argc > 1) ? (uint32)strtoul(argv[1],NULL,0) : BENCH_DEFAULT_SAMPLES;
+	uint32 i;
+	int failed = 0;
+	double start,ns;
+
+	CURRENT_SENSE_init(BENCH_TRIP_MS,BENCH_stall);
+
+	failed |= BENCH_stepResponse(CURRENT_SENSE_TRIP_LEVEL - 100);
+	failed |= BENCH_stepResponse(1023);
+	/* the filter reaches the trip level after some samples then must stay
+	 * above it for the trip time */
+	failed |= BENCH_trip("trip 900",900,BENCH_BLANKING_SAMPLES + 200,
+			BENCH_BLANKING_SAMPLES + BENCH_TRIP_SAMPLES);
+	failed |= BENCH_trip("under trip 590",CURRENT_SENSE_TRIP_LEVEL - 10,BENCH_BLANKING_SAMPLES + 1000,0);
+	failed |= BENCH_trip("inrush 1023",1023,BENCH_BLANKING_SAMPLES,0);
+	if(failed || samples == 0){
+		return failed;
+	}
+
+	/* cost of a sample while watching ,never tripping */
+	CURRENT_SENSE_start();
+	start = BENCH_nowNs();
+	for(i = 0; i < samples; i++){
+		g_adcResult = (uint16)((i & 0xFF) + 200);
+		(*g_adcCallBack)();
+	}
+	ns = BENCH_nowNs() - start;
+	CURRENT_SENSE_stop();
+
+	printf("%lu samples  %.2f ns/sample  (%lu stalls)\n",(unsigned long)samples,ns/samples,
+			(unsigned long)g_stalls);
+	return 0;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+/* give the reading for the samples while the ADC is on ,return the samples
+ * taken before it was switched off (0 if it stayed on) */
+static uint32 BENCH_feed(uint16 reading,uint32 samples){
+
+	uint32 i;
+
+	g_adcResult = reading;
+	for(i = 1; i <= samples; i++){
+		if(!g_adcEnabled){
+			return i - 1;
+		}
+		(*g_adcCallBack)();
+	}
+	return g_adcEnabled ? 0 : samples;
+}
+
+static int BENCH_stepResponse(uint16 reading){
+
+	double ideal = 0.0;
+	double alpha = 1.0 / (1 << CURRENT_SENSE_FILTER_SHIFT);
+	double error = 0.0;
+	uint32 half = 0,ninety = 0;
+	uint32 i;
+	int ok;
+
+	CURRENT_SENSE_start();
+	for(i = 1; i <= BENCH_STEP_SAMPLES; i++){
+		uint16 filtered;
+
+		BENCH_feed(reading,1);
+		ideal += (reading - ideal) * alpha;
+		filtered = CURRENT_SENSE_getFiltered();
+		if(fabs(filtered - ideal) > error){
+			error = fabs(filtered - ideal);
+		}
+		if(half == 0 && filtered * 2 >= reading){
+			half = i;
+		}
+		if(ninety == 0 && filtered * 10 >= reading * 9){
+			ninety = i;
+		}
+	}
+	CURRENT_SENSE_stop();
+
+	ok = (error <= BENCH_MAX_ERROR) && half != 0 && ninety != 0;
+	printf("step %-4u 50%% %2lu samples  90%% %2lu samples  max error %.2f  %s\n",reading,
+			(unsigned long)half,(unsigned long)ninety,error,ok ? "ok" : "FAIL");
+	return !ok;
+}
+
+static int BENCH_trip(const char * name,uint16 reading,uint32 samples,uint32 expected){
+
+	uint32 stalls = g_stalls;
+	uint32 stops = g_motorStops;
+	uint32 tripped;
+	int ok;
+
+	CURRENT_SENSE_start();
+	tripped = BENCH_feed(reading,samples);
+	CURRENT_SENSE_stop();
+
+	if(expected == 0){
+		ok = (tripped == 0) && g_stalls == stalls && g_motorStops == stops;
+	}else{
+		/* the samples to reach the trip level are added to the trip time */
+		ok = (tripped >= expected) && (tripped < expected + BENCH_STEP_SAMPLES) &&
+				g_stalls == stalls + 1 && g_motorStops == stops + 1;
+	}
+	printf("%-16s tripped at %4lu  %s\n",name,(unsigned long)tripped,ok ? "ok" : "FAIL");
+	return !ok;
+}
+
+static void BENCH_stall(void){
+	g_stalls++;
+}
+
+static double BENCH_nowNs(void){
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return now.tv_sec*1e9 + now.tv_nsec;
+}
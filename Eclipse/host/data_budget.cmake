@@ -0,0 +1,19 @@
+# fails if the .data section of an AVR image is larger than its budget
+#
+#   cmake -DELF=image.elf -DSIZE=avr-size -DBUDGET=bytes -P data_budget.cmake
+
+execute_process(COMMAND ${SIZE} -A ${ELF} OUTPUT_VARIABLE SECTIONS RESULT_VARIABLE RESULT)
+if(NOT RESULT EQUAL 0)
+	message(FATAL_ERROR "${SIZE} failed on ${ELF}")
+endif()
+
+if(SECTIONS MATCHES "\n\\.data[ \t]+([0-9]+)")
+	set(DATA ${CMAKE_MATCH_1})
+else()
+	set(DATA 0)
+endif()
+
+if(DATA GREATER BUDGET)
+	message(FATAL_ERROR "${ELF} : .data is ${DATA} bytes ,over its budget of ${BUDGET} bytes")
+endif()
+message(STATUS "${ELF} : .data ${DATA} of ${BUDGET} bytes")
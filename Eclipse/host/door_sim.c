@@ -0,0 +1,416 @@
+/******************************************************************************
+ *
+ * Module: Door Simulator
+ *
+ * File Name: door_sim.c
+ *
+ * Description: simulated doors for the gateway (gateway.c) ,every door is a
+ * 				copy of the MC1 firmware image on the ATmega16 model with its
+ * 				own EEPROM (erased : the door starts in the first-time setup)
+ * 				1- the UART of every door is a pseudo terminal ,its frames are
+ * 				   written to the master side in the serial link encoding
+ * 				   (serial_link.h) ,the gateway opens the slave side
+ * 				2- the doors run in lock step ,DOOR_QUANTUM cycles each ,the
+ * 				   simulation is held back to the wall clock (--speed 0 :
+ * 				   as fast as the host can) so the timeouts of the gateway
+ * 				   and the baud rate of the model mean the same time
+ * 				   the model sends a frame at once ,the frames of a door
+ * 				   wait for its line (DOOR_FRAME_CYCLES each) before they
+ * 				   are written to its link
+ * 				3- the slave of every door is printed (and linked in a
+ * 				   directory with --link) ,the simulation ends after the
+ * 				   seconds given or on SIGINT / SIGTERM with the frames of
+ * 				   every door and the real time factor reached
+ *
+ * 				usage : door_sim [--doors n] [--seconds s] [--speed x]
+ * 				                 [--link dir] [mc1 image]
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#define _GNU_SOURCE
+#include "serial_link.h"
+#include "system_states.h"
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#ifndef DOOR_F_CPU
+#define DOOR_F_CPU 1000000UL
+#endif
+
+/* cycles run by every door before the links are served (1 ms) */
+#define DOOR_QUANTUM 1000
+
+#define DOOR_STACK_SIZE (256 * 1024)
+#define DOORS_MAX 64
+
+/* bytes read from a link at once */
+#define DOOR_READ_SIZE 256
+
+/* a frame on the line : start ,9 data bits and stop at the link baud rate
+ * of the clock (system_states.h) */
+#define DOOR_BAUD LINK_BAUD_FOR(DOOR_F_CPU)
+#define DOOR_FRAME_BITS 11
+#define DOOR_FRAME_CYCLES (DOOR_FRAME_BITS * DOOR_F_CPU / DOOR_BAUD)
+
+/* frames sent by a door waiting for its line */
+#define DOOR_PENDING_SIZE 1024
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* one door : the firmware image ,its model and its link */
+typedef struct{
+	char name[8];
+	void * handle;
+	int (*main)(void);
+	void (*reset)(uint32_t cpuFrequency);
+	void (*setSyncHook)(void (*a_hook)(void),uint32_t period);
+	uint8_t (*uartInject)(uint16_t frame);
+	uint8_t (*uartTake)(uint16_t * a_frame);
+	ucontext_t context;
+	uint8_t * stack;
+	uint8_t halted;
+	int master;
+	int slave;
+	char slavePath[PATH_MAX];
+	SerialLinkDecoder decoder;
+	uint16_t pending[DOOR_PENDING_SIZE];
+	uint16_t pendingHead;
+	uint16_t pendingCount;
+	uint64_t lineFree;   /* end of the last frame on the line */
+	uint64_t framesIn;
+	uint64_t framesOut;
+	uint64_t framesLost;
+}DoorSim;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static DoorSim g_doors[DOORS_MAX];
+static uint8_t g_doorsNum = 8;
+
+static ucontext_t g_harness;
+static DoorSim * g_current;
+
+/* lock step time in cycles */
+static uint64_t g_time;
+
+static volatile sig_atomic_t g_stop = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static int DOOR_load(DoorSim * door,const char * path,uint8_t copy);
+static void * DOOR_openCopy(const char * path);
+static int DOOR_openLink(DoorSim * door,const char * linkDir);
+static void DOOR_entry(void);
+static void DOOR_sync(void);
+static void DOOR_round(void);
+static void DOOR_serve(struct pollfd * fds,int timeoutMs);
+static void DOOR_stop(int signal);
+static double DOOR_wallSeconds(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(int argc,char * argv[]){
+
+	const char * path = DOOR_MC1_IMAGE;
+	const char * linkDir = NULL;
+	double seconds = 0;
+	double speed = 1.0;
+	double start,wall,simulated;
+	struct pollfd fds[DOORS_MAX];
+	uint8_t i;
+	int arg;
+
+	for(arg = 1; arg < argc; arg++){
+		if(strcmp(argv[arg],"--doors") == 0 && arg + 1 < argc){
+			int doors = atoi(argv[++arg]);
+			if(doors < 1 || doors > DOORS_MAX){
+				fprintf(stderr,"--doors : 1 to %u\n",DOORS_MAX);
+				return 1;
+			}
+			g_doorsNum = (uint8_t)doors;
+		}else if(strcmp(argv[arg],"--seconds") == 0 && arg + 1 < argc){
+			seconds = atof(argv[++arg]);
+		}else if(strcmp(argv[arg],"--speed") == 0 && arg + 1 < argc){
+			speed = atof(argv[++arg]);
+		}else if(strcmp(argv[arg],"--link") == 0 && arg + 1 < argc){
+			linkDir = argv[++arg];
+		}else{
+			path = argv[arg];
+		}
+	}
+
+	for(i = 0; i < g_doorsNum; i++){
+		DoorSim * door = &g_doors[i];
+
+		snprintf(door->name,sizeof(door->name),"door%u",i + 1);
+		/* a second dlopen of the same file would share its globals */
+		if(DOOR_load(door,path,i > 0) != 0 || DOOR_openLink(door,linkDir) != 0){
+			return 1;
+		}
+		fds[i].fd = door->master;
+		fds[i].events = POLLIN;
+		printf("%s %s\n",door->name,door->slavePath);
+	}
+	fflush(stdout);
+
+	signal(SIGINT,DOOR_stop);
+	signal(SIGTERM,DOOR_stop);
+
+	start = DOOR_wallSeconds();
+	while(!g_stop && (seconds <= 0 || g_time < (uint64_t)(seconds * DOOR_F_CPU))){
+		DOOR_round();
+
+		/* ahead of the wall clock : wait for the gateway (or the time) */
+		wall = DOOR_wallSeconds() - start;
+		simulated = (double)g_time / DOOR_F_CPU;
+		if(speed > 0 && simulated / speed > wall){
+			DOOR_serve(fds,(int)((simulated / speed - wall) * 1000.0));
+		}else{
+			DOOR_serve(fds,0);
+		}
+	}
+	wall = DOOR_wallSeconds() - start;
+	simulated = (double)g_time / DOOR_F_CPU;
+
+	printf("%u doors ,%.2f s simulated in %.2f s ,real time factor %.2f\n",g_doorsNum,simulated,
+			wall,(wall > 0) ? simulated / wall : 0.0);
+	printf("door          frames in  frames out  lost\n");
+	for(i = 0; i < g_doorsNum; i++){
+		printf("%-12s %10llu %11llu %5llu\n",g_doors[i].name,(unsigned long long)g_doors[i].framesIn,
+				(unsigned long long)g_doors[i].framesOut,(unsigned long long)g_doors[i].framesLost);
+		if(linkDir != NULL){
+			char link[PATH_MAX];
+			snprintf(link,sizeof(link),"%s/%s",linkDir,g_doors[i].name);
+			unlink(link);
+		}
+		close(g_doors[i].master);
+		close(g_doors[i].slave);
+		dlclose(g_doors[i].handle);
+		free(g_doors[i].stack);
+	}
+	return 0;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+/* open a copy of the image ,reset its model and prepare its main */
+static int DOOR_load(DoorSim * door,const char * path,uint8_t copy){
+
+	door->handle = copy ? DOOR_openCopy(path) : dlopen(path,RTLD_NOW | RTLD_LOCAL);
+	if(door->handle == NULL){
+		fprintf(stderr,"%s : %s\n",door->name,dlerror());
+		return -1;
+	}
+
+	*(void **)&door->main = dlsym(door->handle,"main");
+	*(void **)&door->reset = dlsym(door->handle,"HAL_HOST_reset");
+	*(void **)&door->setSyncHook = dlsym(door->handle,"HAL_HOST_setSyncHook");
+	*(void **)&door->uartInject = dlsym(door->handle,"HAL_HOST_uartInject");
+	*(void **)&door->uartTake = dlsym(door->handle,"HAL_HOST_uartTake");
+	if(door->main == NULL || door->reset == NULL || door->setSyncHook == NULL ||
+			door->uartInject == NULL || door->uartTake == NULL){
+		fprintf(stderr,"%s : %s is not a firmware image of the host build\n",door->name,path);
+		return -1;
+	}
+
+	door->stack = malloc(DOOR_STACK_SIZE);
+	if(door->stack == NULL){
+		return -1;
+	}
+	door->reset(DOOR_F_CPU);
+	door->setSyncHook(DOOR_sync,DOOR_QUANTUM);
+	getcontext(&door->context);
+	door->context.uc_stack.ss_sp = door->stack;
+	door->context.uc_stack.ss_size = DOOR_STACK_SIZE;
+	door->context.uc_link = &g_harness;
+	makecontext(&door->context,DOOR_entry,0);
+	return 0;
+}
+
+static void * DOOR_openCopy(const char * path){
+
+	char copy[] = "/tmp/door_sim_XXXXXX.so";
+	FILE * in = fopen(path,"rb");
+	FILE * out;
+	char buffer[4096];
+	size_t length;
+	void * handle = NULL;
+	int fd = mkstemps(copy,3);
+
+	if(in == NULL || fd < 0){
+		if(in != NULL){
+			fclose(in);
+		}
+		return NULL;
+	}
+	out = fdopen(fd,"wb");
+	while((length = fread(buffer,1,sizeof(buffer),in)) > 0){
+		fwrite(buffer,1,length,out);
+	}
+	fclose(in);
+	fclose(out);
+	handle = dlopen(copy,RTLD_NOW | RTLD_LOCAL);
+	/* mapped ,the file is not needed any more */
+	unlink(copy);
+	return handle;
+}
+
+/* a pseudo terminal ,the slave is raw and kept open so the master never
+ * reads an end of file while the gateway is not connected */
+static int DOOR_openLink(DoorSim * door,const char * linkDir){
+
+	struct termios tty;
+
+	door->master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if(door->master < 0 || grantpt(door->master) != 0 || unlockpt(door->master) != 0 ||
+			ptsname_r(door->master,door->slavePath,sizeof(door->slavePath)) != 0){
+		perror("posix_openpt");
+		return -1;
+	}
+	door->slave = open(door->slavePath,O_RDWR | O_NOCTTY);
+	if(door->slave < 0){
+		perror(door->slavePath);
+		return -1;
+	}
+	tcgetattr(door->slave,&tty);
+	cfmakeraw(&tty);
+	tcsetattr(door->slave,TCSANOW,&tty);
+
+	if(linkDir != NULL){
+		char link[PATH_MAX];
+		snprintf(link,sizeof(link),"%s/%s",linkDir,door->name);
+		unlink(link);
+		if(symlink(door->slavePath,link) != 0){
+			perror(link);
+			return -1;
+		}
+		snprintf(door->slavePath,sizeof(door->slavePath),"%s",link);
+	}
+	return 0;
+}
+
+static void DOOR_entry(void){
+
+	g_current->main();
+	/* the firmware returned from main ,it stays halted */
+	g_current->halted = 1;
+}
+
+/* end of a quantum ,go back to the harness */
+static void DOOR_sync(void){
+	swapcontext(&g_current->context,&g_harness);
+}
+
+/* one quantum of every door then its frames are written to its link */
+static void DOOR_round(void){
+
+	uint8_t bytes[DOOR_READ_SIZE];
+	uint16_t frame;
+	uint16_t length;
+	uint8_t i;
+
+	for(i = 0; i < g_doorsNum; i++){
+		DoorSim * door = &g_doors[i];
+
+		if(!door->halted){
+			g_current = door;
+			swapcontext(&g_harness,&door->context);
+		}
+		while(door->uartTake(&frame)){
+			/* an idle line starts with this frame */
+			if(door->pendingCount == 0 && door->lineFree < g_time){
+				door->lineFree = g_time;
+			}
+			if(door->pendingCount == DOOR_PENDING_SIZE){
+				door->framesLost++;
+			}else{
+				door->pending[(door->pendingHead + door->pendingCount) % DOOR_PENDING_SIZE] = frame;
+				door->pendingCount++;
+			}
+		}
+
+		/* the frames ending in this quantum */
+		length = 0;
+		while(door->pendingCount > 0 && door->lineFree + DOOR_FRAME_CYCLES <= g_time + DOOR_QUANTUM &&
+				length + SERIAL_LINK_FRAME_MAX <= sizeof(bytes)){
+			length += SERIAL_LINK_encode(door->pending[door->pendingHead],&bytes[length]);
+			door->pendingHead = (door->pendingHead + 1) % DOOR_PENDING_SIZE;
+			door->pendingCount--;
+			door->lineFree += DOOR_FRAME_CYCLES;
+			door->framesOut++;
+		}
+		/* nobody reading a full link : the frames are lost like on a wire */
+		if(length > 0 && write(door->master,bytes,length) != length){
+			door->framesLost++;
+		}
+	}
+	g_time += DOOR_QUANTUM;
+}
+
+/* frames from the gateway to the UART of the doors */
+static void DOOR_serve(struct pollfd * fds,int timeoutMs){
+
+	uint8_t bytes[DOOR_READ_SIZE];
+	uint16_t frame;
+	ssize_t length,j;
+	uint8_t i;
+
+	if(poll(fds,g_doorsNum,timeoutMs) <= 0){
+		return;
+	}
+	for(i = 0; i < g_doorsNum; i++){
+		DoorSim * door = &g_doors[i];
+
+		if(!(fds[i].revents & POLLIN)){
+			continue;
+		}
+		length = read(door->master,bytes,sizeof(bytes));
+		for(j = 0; j < length; j++){
+			if(SERIAL_LINK_decode(&door->decoder,bytes[j],&frame)){
+				door->framesIn++;
+				if(!door->uartInject(frame)){
+					door->framesLost++;
+				}
+			}
+		}
+	}
+}
+
+static void DOOR_stop(int signal){
+	g_stop = 1;
+}
+
+static double DOOR_wallSeconds(void){
+
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
@@ -0,0 +1,542 @@
+/******************************************************************************
+ *
+ * Module: FSM Test
+ *
+ * File Name: fsm_test.c
+ *
+ * Description: transitions and dispatch cost of the flash state machines
+ * 				(fsm.h) of a firmware ,the firmware source is included here
+ * 				(its main renamed) so its tables are read as they are built
+ * 				fsm_test_mc1 : system states and gate of MC1.c
+ * 				fsm_test_hmi : screens of INTERFACING_MICRO.c
+ * 				1- every (state,event) entry of a table against the switch
+ * 				   the table replaced (TEST_*Switch ,one case per state like
+ * 				   the old code ,with the states added since) : same next
+ * 				   state ,same action
+ * 				2- every (state,event) dispatched by FSM_dispatch on a copy
+ * 				   of the table with recording actions : exit ,action then
+ * 				   entry ,only when the state changes ,the state after it
+ * 				   and an event returned by the action dispatched next
+ * 				a wrong answer fails the run (exit code 1)
+ * 				3- then the time per dispatch of random (state,event) is
+ * 				   measured for the table and for the switch (on the host ,
+ * 				   the AVR cycles are not known here)
+ *
+ * 				usage : fsm_test_mc1 [dispatches] ,fsm_test_hmi [dispatches]
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#define _GNU_SOURCE
+#define main FIRMWARE_main
+#ifdef FSM_TEST_HMI
+#include "INTERFACING_MICRO.c"
+#else
+#include "MC1.c"
+#endif
+#undef main
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define TEST_DEFAULT_DISPATCHES 10000000UL
+
+/* entry of a switch */
+#define TEST_TRANSITION(NEXT,ACTION) return (FsmTransition){(NEXT),(ACTION)}
+#define TEST_IGNORE TEST_TRANSITION(FSM_NO_CHANGE,NULL_PTR)
+
+/* largest table of the firmware and longest record of one dispatch */
+#define TEST_STATES_MAX 16
+#define TEST_EVENTS_MAX 16
+#define TEST_LOG_MAX 8
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* transition of a (state,event) as the switch code took it */
+typedef FsmTransition (*TestSwitch)(uint8 state,uint8 event);
+
+typedef struct{
+	const char * name;
+	const FsmTransition * transitions;    /* flash table of the firmware */
+	const FsmStateActions * stateActions; /* flash table of the firmware */
+	uint8 statesNum;
+	uint8 eventsNum;
+	TestSwitch reference;
+}TestMachine;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static int TEST_table(const TestMachine * a_machine);
+static int TEST_dispatch(const TestMachine * a_machine);
+static void TEST_cost(const TestMachine * a_machine,uint32 dispatches);
+static void TEST_copy(const TestMachine * a_machine);
+static void TEST_switchDispatch(const TestMachine * a_machine,uint8 * a_state,uint8 event,uint8 data);
+static uint8 TEST_action(uint8 data);
+static void TEST_entry(void);
+static void TEST_exit(void);
+static double TEST_nowNs(void);
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* copy of the table under test with the recording actions */
+static FsmTransition g_probeTransitions[TEST_STATES_MAX * TEST_EVENTS_MAX];
+static FsmStateActions g_probeStateActions[TEST_STATES_MAX];
+
+/* what a dispatch called ('X' exit ,'A' action ,'N' entry) */
+static char g_log[TEST_LOG_MAX + 1];
+static uint8 g_logLength;
+
+/* event returned by the next call of TEST_action */
+static uint8 g_chainEvent = FSM_NO_EVENT;
+
+/*******************************************************************************
+ *                      Switches the tables replaced                           *
+ *******************************************************************************/
+
+#ifdef FSM_TEST_HMI
+
+static FsmTransition TEST_uiSwitch(uint8 state,uint8 event){
+
+	switch(state){
+	case UI_WAIT_STATE:
+		switch(event){
+		case UI_EV_BYTE:         TEST_TRANSITION(FSM_NO_CHANGE,uiStateReceived);
+		case UI_EV_NEW_PASSWORD: TEST_TRANSITION(UI_ENTER_NEW_PASSWORD,NULL_PTR);
+		case UI_EV_PASSWORD:     TEST_TRANSITION(UI_ENTER_PASSWORD,NULL_PTR);
+		case UI_EV_OPTIONS:      TEST_TRANSITION(UI_OPTIONS,NULL_PTR);
+		case UI_EV_GATE:         TEST_TRANSITION(UI_GATE,NULL_PTR);
+		case UI_EV_ALARM:        TEST_TRANSITION(UI_LOCKOUT,NULL_PTR);
+		case UI_EV_RESYNC:       TEST_TRANSITION(UI_WAIT_STATE,NULL_PTR);
+		}
+		break;
+	case UI_ENTER_NEW_PASSWORD:
+		switch(event){
+		case UI_EV_MC1_READY:    TEST_TRANSITION(FSM_NO_CHANGE,uiMc1Ready);
+		case UI_EV_KEY:          TEST_TRANSITION(FSM_NO_CHANGE,uiPasswordKey);
+		case UI_EV_DONE:         TEST_TRANSITION(UI_CONFIRM_PASSWORD,uiKeepNewPassword);
+		case UI_EV_PIN_TIMEOUT:  TEST_TRANSITION(FSM_NO_CHANGE,uiPinTimeout);
+		case UI_EV_IDLE:         TEST_TRANSITION(FSM_NO_CHANGE,uiPowerDown);
+		case UI_EV_RESYNC:       TEST_TRANSITION(UI_WAIT_STATE,NULL_PTR);
+		}
+		break;
+	case UI_CONFIRM_PASSWORD:
+		switch(event){
+		case UI_EV_MC1_READY:    TEST_TRANSITION(FSM_NO_CHANGE,uiMc1Ready);
+		case UI_EV_KEY:          TEST_TRANSITION(FSM_NO_CHANGE,uiConfirmKey);
+		case UI_EV_DONE:         TEST_TRANSITION(UI_WAIT_MC1,uiSavePassword);
+		case UI_EV_FAIL:         TEST_TRANSITION(UI_MESSAGE,uiShowMismatch);
+		case UI_EV_PIN_TIMEOUT:  TEST_TRANSITION(UI_ENTER_NEW_PASSWORD,NULL_PTR);
+		case UI_EV_IDLE:         TEST_TRANSITION(FSM_NO_CHANGE,uiPowerDown);
+		case UI_EV_RESYNC:       TEST_TRANSITION(UI_WAIT_STATE,NULL_PTR);
+		}
+		break;
+	case UI_ENTER_PASSWORD:
+		switch(event){
+		case UI_EV_MC1_READY:    TEST_TRANSITION(FSM_NO_CHANGE,uiMc1Ready);
+		case UI_EV_KEY:          TEST_TRANSITION(FSM_NO_CHANGE,uiPasswordKey);
+		case UI_EV_DONE:         TEST_TRANSITION(UI_WAIT_MC1,uiReadyToSend);
+		case UI_EV_PIN_TIMEOUT:  TEST_TRANSITION(FSM_NO_CHANGE,uiPinTimeout);
+		case UI_EV_IDLE:         TEST_TRANSITION(FSM_NO_CHANGE,uiPowerDown);
+		case UI_EV_RESYNC:       TEST_TRANSITION(UI_WAIT_STATE,NULL_PTR);
+		}
+		break;
+	case UI_WAIT_MC1:
+		switch(event){
+		case UI_EV_MC1_READY:    TEST_TRANSITION(FSM_NO_CHANGE,uiSend);
+		case UI_EV_DONE:         TEST_TRANSITION(UI_WAIT_STATE,NULL_PTR);
+		case UI_EV_WAIT_RESULT:  TEST_TRANSITION(UI_WAIT_RESULT,NULL_PTR);
+		case UI_EV_RESYNC:       TEST_TRANSITION(UI_WAIT_STATE,NULL_PTR);
+		}
+		break;
+	case UI_WAIT_RESULT:
+		switch(event){
+		case UI_EV_BYTE:         TEST_TRANSITION(FSM_NO_CHANGE,uiResult);
+		case UI_EV_DONE:         TEST_TRANSITION(UI_WAIT_STATE,NULL_PTR);
+		case UI_EV_FAIL:         TEST_TRANSITION(UI_MESSAGE,uiShowWrong);
+		case UI_EV_RESYNC:       TEST_TRANSITION(UI_WAIT_STATE,NULL_PTR);
+		}
+		break;
+	case UI_OPTIONS:
+		switch(event){
+		case UI_EV_MC1_READY:    TEST_TRANSITION(FSM_NO_CHANGE,uiMc1Ready);
+		case UI_EV_KEY:          TEST_TRANSITION(FSM_NO_CHANGE,uiOptionKey);
+		case UI_EV_DONE:         TEST_TRANSITION(UI_WAIT_MC1,uiReadyToSend);
+		case UI_EV_IDLE:         TEST_TRANSITION(FSM_NO_CHANGE,uiPowerDown);
+		case UI_EV_RESYNC:       TEST_TRANSITION(UI_WAIT_STATE,NULL_PTR);
+		}
+		break;
+	case UI_GATE:
+		switch(event){
+		case UI_EV_BYTE:         TEST_TRANSITION(FSM_NO_CHANGE,uiGateStatus);
+		case UI_EV_DONE:         TEST_TRANSITION(UI_WAIT_STATE,NULL_PTR);
+		case UI_EV_FAIL:         TEST_TRANSITION(UI_MESSAGE,NULL_PTR);
+		}
+		break;
+	case UI_MESSAGE:
+		switch(event){
+		case UI_EV_MESSAGE_END:  TEST_TRANSITION(FSM_NO_CHANGE,uiMessageEnd);
+		case UI_EV_NEW_PASSWORD: TEST_TRANSITION(UI_ENTER_NEW_PASSWORD,NULL_PTR);
+		case UI_EV_DONE:         TEST_TRANSITION(UI_WAIT_STATE,NULL_PTR);
+		case UI_EV_RESYNC:       TEST_TRANSITION(UI_WAIT_STATE,NULL_PTR);
+		}
+		break;
+	case UI_LOCKOUT:
+		switch(event){
+		case UI_EV_BYTE:         TEST_TRANSITION(FSM_NO_CHANGE,uiLockoutByte);
+		case UI_EV_DONE:         TEST_TRANSITION(UI_WAIT_STATE,NULL_PTR);
+		case UI_EV_SECOND:       TEST_TRANSITION(FSM_NO_CHANGE,uiLockoutSecond);
+		}
+		break;
+	}
+	TEST_IGNORE;
+}
+
+static const TestMachine g_machines[] = {
+		{"screens",&g_uiTransitions[0][0],g_uiStateActions,UI_STATES_NUM,UI_EVENTS_NUM,TEST_uiSwitch},
+};
+
+#else
+
+static FsmTransition TEST_systemSwitch(uint8 state,uint8 event){
+
+	switch(state){
+	case NEW_PASSWORD:
+		switch(event){
+		case SYS_EV_PASSWORD_RECEIVED:   TEST_TRANSITION(VIEW_OPTIONS,storePassword);
+		}
+		break;
+	case CHECK_PASSWORD_TO_LOG_IN:
+		switch(event){
+		case SYS_EV_PASSWORD_RECEIVED:   TEST_TRANSITION(FSM_NO_CHANGE,checkPassword);
+		case SYS_EV_PASSWORD_CORRECT:    TEST_TRANSITION(VIEW_OPTIONS,NULL_PTR);
+		case SYS_EV_TOO_MANY_TRIALS:     TEST_TRANSITION(BUZZER_ON,NULL_PTR);
+		}
+		break;
+	case CHECK_PASSWORD_FOR_NEW_PASSWORD:
+		switch(event){
+		case SYS_EV_PASSWORD_RECEIVED:   TEST_TRANSITION(FSM_NO_CHANGE,checkPassword);
+		case SYS_EV_PASSWORD_CORRECT:    TEST_TRANSITION(NEW_PASSWORD,NULL_PTR);
+		case SYS_EV_TOO_MANY_TRIALS:     TEST_TRANSITION(BUZZER_ON,NULL_PTR);
+		}
+		break;
+	case VIEW_OPTIONS:
+		switch(event){
+		case SYS_EV_OPTION_RECEIVED:     TEST_TRANSITION(FSM_NO_CHANGE,optionReceived);
+		case SYS_EV_GATE_OPTION:         TEST_TRANSITION(OPENING_GATE,NULL_PTR);
+		case SYS_EV_NEW_PASSWORD_OPTION: TEST_TRANSITION(CHECK_PASSWORD_FOR_NEW_PASSWORD,NULL_PTR);
+		}
+		break;
+	case OPENING_GATE:
+		switch(event){
+		case SYS_EV_GATE_DONE:           TEST_TRANSITION(VIEW_OPTIONS,NULL_PTR);
+		}
+		break;
+	case BUZZER_ON:
+		switch(event){
+		case SYS_EV_ALARM_TIMEOUT:       TEST_TRANSITION(CHECK_PASSWORD_TO_LOG_IN,NULL_PTR);
+		}
+		break;
+	}
+	TEST_IGNORE;
+}
+
+static FsmTransition TEST_gateSwitch(uint8 state,uint8 event){
+
+	switch(state){
+	case CLOSED:
+	case GATE_BLOCKED:
+		switch(event){
+		case GATE_EV_START:     TEST_TRANSITION(FSM_NO_CHANGE,gateInit);
+		case GATE_EV_HMI_READY: TEST_TRANSITION(FSM_NO_CHANGE,gateHmiReady);
+		case GATE_EV_NEXT:      TEST_TRANSITION(GATE_OPENING,NULL_PTR);
+		}
+		break;
+	case GATE_OPENING:
+		switch(event){
+		case GATE_EV_HMI_READY: TEST_TRANSITION(FSM_NO_CHANGE,gateHmiReady);
+		case GATE_EV_PHASE_END: TEST_TRANSITION(FSM_NO_CHANGE,gatePhaseEnd);
+		case GATE_EV_NEXT:      TEST_TRANSITION(OPENED,NULL_PTR);
+		case GATE_EV_STALL:     TEST_TRANSITION(GATE_OBSTRUCTED,gateStalled);
+		case GATE_EV_BLOCKED:   TEST_TRANSITION(GATE_BLOCKED,gateBlocked);
+		}
+		break;
+	case OPENED:
+		switch(event){
+		case GATE_EV_HMI_READY: TEST_TRANSITION(FSM_NO_CHANGE,gateHmiReady);
+		case GATE_EV_PHASE_END: TEST_TRANSITION(FSM_NO_CHANGE,gatePhaseEnd);
+		case GATE_EV_NEXT:      TEST_TRANSITION(GATE_CLOSING,NULL_PTR);
+		}
+		break;
+	case GATE_CLOSING:
+		switch(event){
+		case GATE_EV_PHASE_END: TEST_TRANSITION(CLOSED,gateFinish);
+		case GATE_EV_STALL:     TEST_TRANSITION(GATE_OBSTRUCTED,gateStalled);
+		case GATE_EV_BLOCKED:   TEST_TRANSITION(GATE_BLOCKED,gateBlocked);
+		}
+		break;
+	case GATE_OBSTRUCTED:
+		switch(event){
+		case GATE_EV_HMI_READY: TEST_TRANSITION(FSM_NO_CHANGE,gateHmiReady);
+		case GATE_EV_PHASE_END: TEST_TRANSITION(FSM_NO_CHANGE,gatePhaseEnd);
+		case GATE_EV_NEXT:      TEST_TRANSITION(GATE_CLOSING,NULL_PTR);
+		}
+		break;
+	}
+	TEST_IGNORE;
+}
+
+static const TestMachine g_machines[] = {
+		{"system states",&g_systemTransitions[0][0],g_systemStateActions,SYSTEM_STATES_NUM,SYS_EVENTS_NUM,TEST_systemSwitch},
+		{"gate",&g_gateTransitions[0][0],g_gateStateActions,GATE_STATES_NUM,GATE_EVENTS_NUM,TEST_gateSwitch},
+};
+
+#endif
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(int argc,char * argv[]){
+
+	uint32 dispatches = (argc > 1) ? (uint32)strtoul(argv[1],NULL,0) : TEST_DEFAULT_DISPATCHES;
+	uint8 i;
+	int failed = 0;
+
+	for(i = 0; i < sizeof(g_machines)/sizeof(g_machines[0]); i++){
+		if(g_machines[i].statesNum > TEST_STATES_MAX || g_machines[i].eventsNum > TEST_EVENTS_MAX){
+			printf("%s : table larger than the copy  FAIL\n",g_machines[i].name);
+			return 1;
+		}
+		failed |= TEST_table(&g_machines[i]);
+		failed |= TEST_dispatch(&g_machines[i]);
+	}
+	if(failed || dispatches == 0){
+		return failed;
+	}
+
+	printf("%-14s %10s %12s %12s\n","dispatch","count","table ns","switch ns");
+	for(i = 0; i < sizeof(g_machines)/sizeof(g_machines[0]); i++){
+		TEST_cost(&g_machines[i],dispatches);
+	}
+	return 0;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+/* the flash table against the switch ,every (state,event) */
+static int TEST_table(const TestMachine * a_machine){
+
+	uint8 state,event;
+	uint16 wrong = 0,taken = 0;
+
+	for(state = 0; state < a_machine->statesNum; state++){
+		for(event = 0; event < a_machine->eventsNum; event++){
+			const FsmTransition * entry = &a_machine->transitions[state * a_machine->eventsNum + event];
+			FsmTransition expected = (*a_machine->reference)(state,event);
+
+			if(entry->nextState != expected.nextState || entry->action != expected.action){
+				printf("%s : state %u event %u -> %u %p ,the switch %u %p  FAIL\n",a_machine->name,
+						state,event,entry->nextState,(void *)entry->action,
+						expected.nextState,(void *)expected.action);
+				wrong++;
+			}
+			if(expected.nextState != FSM_NO_CHANGE || expected.action != NULL_PTR){
+				taken++;
+			}
+		}
+	}
+	printf("%-14s %2u states x %2u events  %3u taken  table %s\n",a_machine->name,
+			a_machine->statesNum,a_machine->eventsNum,taken,wrong ? "FAIL" : "ok");
+	return wrong != 0;
+}
+
+/* every (state,event) through FSM_dispatch ,the calls and the state after it */
+static int TEST_dispatch(const TestMachine * a_machine){
+
+	FsmType fsm = {g_probeTransitions,g_probeStateActions,a_machine->eventsNum,0};
+	uint8 state,event;
+	uint16 wrong = 0;
+
+	TEST_copy(a_machine);
+	for(state = 0; state < a_machine->statesNum; state++){
+		for(event = 0; event < a_machine->eventsNum; event++){
+			FsmTransition expected = (*a_machine->reference)(state,event);
+			uint8 next = (expected.nextState == FSM_NO_CHANGE) ? state : expected.nextState;
+			char log[TEST_LOG_MAX + 1] = "";
+
+			if(expected.nextState != FSM_NO_CHANGE && a_machine->stateActions[state].exit != NULL_PTR){
+				strcat(log,"X");
+			}
+			if(expected.action != NULL_PTR){
+				strcat(log,"A");
+			}
+			if(expected.nextState != FSM_NO_CHANGE && a_machine->stateActions[next].entry != NULL_PTR){
+				strcat(log,"N");
+			}
+
+			fsm.state = state;
+			g_logLength = 0;
+			g_log[0] = '\0';
+			FSM_dispatch(&fsm,event,0);
+			if(FSM_getState(&fsm) != next || strcmp(g_log,log) != 0){
+				printf("%s : state %u event %u -> %u \"%s\" ,the switch %u \"%s\"  FAIL\n",
+						a_machine->name,state,event,FSM_getState(&fsm),g_log,next,log);
+				wrong++;
+			}
+		}
+	}
+
+	/* an event returned by an action is dispatched in the next state */
+	for(state = 0; state < a_machine->statesNum; state++){
+		for(event = 0; event < a_machine->eventsNum; event++){
+			FsmTransition first = (*a_machine->reference)(state,event);
+			uint8 next = (first.nextState == FSM_NO_CHANGE) ? state : first.nextState;
+			uint8 chained;
+
+			if(first.action == NULL_PTR){
+				continue;
+			}
+			for(chained = 0; chained < a_machine->eventsNum; chained++){
+				FsmTransition second = (*a_machine->reference)(next,chained);
+				uint8 last = (second.nextState == FSM_NO_CHANGE) ? next : second.nextState;
+
+				fsm.state = state;
+				g_chainEvent = chained;
+				FSM_dispatch(&fsm,event,0);
+				if(FSM_getState(&fsm) != last){
+					printf("%s : state %u event %u then %u -> %u ,the switch %u  FAIL\n",
+							a_machine->name,state,event,chained,FSM_getState(&fsm),last);
+					wrong++;
+				}
+			}
+		}
+	}
+	g_chainEvent = FSM_NO_EVENT;
+
+	printf("%-14s dispatch %s\n",a_machine->name,wrong ? "FAIL" : "ok");
+	return wrong != 0;
+}
+
+/* time per dispatch of random (state,event) ,table against switch */
+static void TEST_cost(const TestMachine * a_machine,uint32 dispatches){
+
+	FsmType fsm = {g_probeTransitions,g_probeStateActions,a_machine->eventsNum,0};
+	uint8 * pairs = malloc(2 * (size_t)dispatches);
+	uint8 state = 0;
+	double start,tableNs,switchNs;
+	uint32 i;
+
+	TEST_copy(a_machine);
+	srand(1);
+	for(i = 0; i < dispatches; i++){
+		pairs[2*i] = (uint8)(rand() % a_machine->statesNum);
+		pairs[2*i + 1] = (uint8)(rand() % a_machine->eventsNum);
+	}
+
+	start = TEST_nowNs();
+	for(i = 0; i < dispatches; i++){
+		fsm.state = pairs[2*i];
+		g_logLength = 0;
+		FSM_dispatch(&fsm,pairs[2*i + 1],0);
+	}
+	tableNs = TEST_nowNs() - start;
+
+	start = TEST_nowNs();
+	for(i = 0; i < dispatches; i++){
+		state = pairs[2*i];
+		g_logLength = 0;
+		TEST_switchDispatch(a_machine,&state,pairs[2*i + 1],0);
+	}
+	switchNs = TEST_nowNs() - start;
+
+	printf("%-14s %10lu %12.2f %12.2f\n",a_machine->name,(unsigned long)dispatches,
+			tableNs/dispatches,switchNs/dispatches);
+	free(pairs);
+}
+
+/* the table under test with the recording actions in place of the firmware ones */
+static void TEST_copy(const TestMachine * a_machine){
+
+	uint16 i;
+
+	for(i = 0; i < a_machine->statesNum * a_machine->eventsNum; i++){
+		g_probeTransitions[i].nextState = a_machine->transitions[i].nextState;
+		g_probeTransitions[i].action = (a_machine->transitions[i].action != NULL_PTR) ? TEST_action : NULL_PTR;
+	}
+	for(i = 0; i < a_machine->statesNum; i++){
+		g_probeStateActions[i].entry = (a_machine->stateActions[i].entry != NULL_PTR) ? TEST_entry : NULL_PTR;
+		g_probeStateActions[i].exit = (a_machine->stateActions[i].exit != NULL_PTR) ? TEST_exit : NULL_PTR;
+	}
+}
+
+/* dispatch of the switch code : the case of the state and event ,then the
+ * same exit ,action and entry calls */
+static void TEST_switchDispatch(const TestMachine * a_machine,uint8 * a_state,uint8 event,uint8 data){
+
+	while(event != FSM_NO_EVENT){
+
+		FsmTransition transition = (*a_machine->reference)(*a_state,event);
+
+		if(transition.nextState != FSM_NO_CHANGE && g_probeStateActions[*a_state].exit != NULL_PTR){
+			TEST_exit();
+		}
+		event = FSM_NO_EVENT;
+		if(transition.action != NULL_PTR){
+			event = TEST_action(data);
+		}
+		if(transition.nextState != FSM_NO_CHANGE){
+			*a_state = transition.nextState;
+			if(g_probeStateActions[*a_state].entry != NULL_PTR){
+				TEST_entry();
+			}
+		}
+	}
+}
+
+/* recording actions ,the transition action returns the chained event once */
+static uint8 TEST_action(uint8 data){
+
+	uint8 event = g_chainEvent;
+
+	g_chainEvent = FSM_NO_EVENT;
+	if(g_logLength < TEST_LOG_MAX){
+		g_log[g_logLength++] = 'A';
+		g_log[g_logLength] = '\0';
+	}
+	return event;
+}
+
+static void TEST_entry(void){
+	if(g_logLength < TEST_LOG_MAX){
+		g_log[g_logLength++] = 'N';
+		g_log[g_logLength] = '\0';
+	}
+}
+
+static void TEST_exit(void){
+	if(g_logLength < TEST_LOG_MAX){
+		g_log[g_logLength++] = 'X';
+		g_log[g_logLength] = '\0';
+	}
+}
+
+static double TEST_nowNs(void){
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return now.tv_sec*1e9 + now.tv_nsec;
+}
@@ -0,0 +1,1085 @@
+/******************************************************************************
+ *
+ * Module: Gateway
+ *
+ * File Name: gateway.c
+ *
+ * Description: fleet management of the doors from a Linux host ,the gateway
+ * 				is a node of the bus of every door (GATEWAY_NODE unless
+ * 				--node) and talks to its MC1 with the protocol of the HMI
+ * 				1- the links of all the doors are served together by one
+ * 				   epoll loop ,the jobs of a door run one after the other in
+ * 				   the order of the batch
+ * 				2- jobs : status
+ * 				          provision pin      first-time setup
+ * 				          rotate old new     log in ,new password option ,
+ * 				                             old PIN again then the new one
+ * 				          audit pin file     log in ,trace dump of MC1 to
+ * 				                             the file (trace_decode)
+ * 				          counters pin file  log in ,counters snapshot of
+ * 				                             MC1 to the file (counters_print)
+ * 				          config pin profile log in ,the gate profile
+ * 				                             (gate_config.h) "open,hold,
+ * 				                             close,siren,duty" in ms ,ms ,
+ * 				                             ms ,s and % is used and stored
+ * 				          users pin file     log in ,the PINs of the file
+ * 				                             (one per line) become the user
+ * 				                             table of the door (user_table.h)
+ * 				   a PIN is sent at once with its '#' and the M_READY asking
+ * 				   for the answer
+ * 				3- the state cache (--cache) keeps for every door its last
+ * 				   system state and if MC1 waits for a password or an option
+ * 				   from the gateway : M_READY is never sent then ,MC1 would
+ * 				   take it as the state asked again
+ * 				   a door cut in the middle of a conversation is UNKNOWN ,it
+ * 				   gets only audit and counters jobs until its line is removed
+ * 				   (MC1 answers them only if the gateway is still logged in) ,
+ * 				   a door not in the cache is taken as just powered up
+ * 				4- a wrong PIN ends the job ,it is never tried again (every
+ * 				   wrong PIN counts for the lock out of the door)
+ * 				5- every job is printed with its time ,then the doors per
+ * 				   second of the batch
+ * 				the PIN of a provision or a rotate is in the EEPROM of the
+ * 				door about 0.3 s after the job (written in the back ground)
+ * 				the user table is built here with a random key (a new one
+ * 				while a user finds no slot) and streamed page by page ,MC1
+ * 				sends M_READY for every page it can take
+ *
+ * 				links : a pseudo terminal (door_sim) carries the frames in
+ * 				the serial link encoding (serial_link.h) ,a serial port is
+ * 				set to space parity with PARMRK so it gives the same bytes
+ * 				and an address frame is sent with mark parity
+ *
+ * 				usage : gateway [--node n] [--timeout ms] [--baud b]
+ * 				                [--cache file] batch
+ * 				batch : one job per line "device job arguments" ,# starts
+ * 				        a comment
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#define _GNU_SOURCE
+#include "bus.h"
+#include "trace.h"
+#include "system_states.h"
+#include "serial_link.h"
+#include "user_table.h"
+#include "counters.h"
+#include "gate_config.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* address of the gateway on the bus of a door (the HMI is node 1) */
+#define GATEWAY_NODE BUS_NODES_MAX
+
+/* silence of a door ending a job (milli seconds) */
+#define GATEWAY_TIMEOUT_MS 2000
+
+#define GATEWAY_DOORS_MAX 256
+#define GATEWAY_DOOR_JOBS 8
+#define GATEWAY_CACHE_MAX 1024
+#define GATEWAY_DEVICE_SIZE 128
+#define GATEWAY_LINE_SIZE 512
+
+/* bytes of a trace dump : header ,count and 4 bytes per record */
+#define GATEWAY_DUMP_HEADER 3
+
+/* a counters snapshot has the same header ,then the cycles and 4 bytes per
+ * counter (kept in the buffer of the dump) */
+#define GATEWAY_COUNTERS_LENGTH(COUNT) (GATEWAY_DUMP_HEADER + 4 + 4 * (COUNT))
+#define GATEWAY_DUMP_MAX GATEWAY_COUNTERS_LENGTH(255)
+
+/* bytes read from a link at once */
+#define GATEWAY_READ_SIZE 256
+
+/* frames sent at once : the address and a page of the user table (longer
+ * than a PIN ,'#' and M_READY) */
+#define GATEWAY_SEND_FRAMES (EEPROM_PAGE_SIZE + 1)
+
+/* keys drawn for a user table before giving up */
+#define GATEWAY_TABLE_KEYS 64
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef enum{
+	JOB_STATUS,JOB_PROVISION,JOB_ROTATE,JOB_AUDIT,JOB_USERS,JOB_COUNTERS,JOB_CONFIG,JOB_TYPES_NUM
+}GatewayJobType;
+
+typedef struct{
+	GatewayJobType type;
+	uint8 pin[PASSWORD_MAX_LENGTH];
+	uint8 pinLength;
+	uint8 newPin[PASSWORD_MAX_LENGTH];
+	uint8 newPinLength;
+	char * file;
+	uint8 * table;       /* EEPROM image of the user table (USER_TABLE_PAGES pages) */
+	uint16 users;
+	uint8 config[GATE_CONFIG_SIZE];  /* image of the gate profile */
+}GatewayJob;
+
+/* what is expected from MC1 */
+typedef enum{
+	EXPECT_NOTHING,
+	EXPECT_STATE,         /* system state after M_READY */
+	EXPECT_LOCKOUT_HIGH,  /* seconds left after BUZZER_ON */
+	EXPECT_LOCKOUT_LOW,
+	EXPECT_INPUT_READY,   /* M_READY after a state waiting for a password or an option */
+	EXPECT_RESULT,        /* CORRECT_PASSWORD (a new PIN too) or WRONG_PASSWORD */
+	EXPECT_CREDIT,        /* M_READY for a page ,then the result of the user table */
+	EXPECT_CONFIG,        /* M_READY for the gate profile ,then its result */
+	EXPECT_DUMP,          /* trace dump */
+	EXPECT_COUNTERS       /* counters snapshot */
+}GatewayExpect;
+
+/* what the gateway knows of a door between two runs */
+typedef struct{
+	char device[GATEWAY_DEVICE_SIZE];
+	uint8 known;       /* FALSE : a conversation was cut ,MC1 may wait for anything */
+	uint8 state;       /* last system state */
+	uint8 waitsInput;  /* MC1 waits for a password or an option from the gateway */
+	long lockoutEnd;   /* end of the last lock out (unix time) */
+}GatewayCacheEntry;
+
+typedef struct{
+	GatewayCacheEntry * cache;
+	int fd;
+	uint8 serialPort;   /* a real UART : the 9th bit is the parity bit */
+	GatewayJob jobs[GATEWAY_DOOR_JOBS];
+	uint8 jobsNum;
+	uint8 job;          /* current job */
+	uint8 expect;
+	uint8 conversation;
+	SerialLinkDecoder decoder;
+	/* progress of the current job */
+	uint8 pinSent;
+	uint8 optionSent;
+	uint8 verified;
+	uint8 page;         /* next page of the user table */
+	double streamStart;
+	uint16 lockout;
+	uint8 dump[GATEWAY_DUMP_MAX];
+	uint16 dumpLength;
+	double jobStart;
+	double deadline;    /* 0 : nothing expected */
+	uint8 failed;
+}GatewayDoor;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static const char * const g_jobNames[JOB_TYPES_NUM] = {
+		"status","provision","rotate","audit","users","counters","config"
+};
+
+static const char * const g_systemStates[SYSTEM_STATES_NUM] = {
+		"NEW_PASSWORD","CHECK_PASSWORD_TO_LOG_IN","CHECK_PASSWORD_FOR_NEW_PASSWORD",
+		"VIEW_OPTIONS","OPENING_GATE","BUZZER_ON"
+};
+
+static GatewayDoor g_doors[GATEWAY_DOORS_MAX];
+static uint16 g_doorsNum;
+
+static GatewayCacheEntry g_cache[GATEWAY_CACHE_MAX];
+static uint16 g_cacheNum;
+
+static uint8 g_node = GATEWAY_NODE;
+static int g_timeoutMs = GATEWAY_TIMEOUT_MS;
+
+/* doors with jobs left ,jobs done and failed */
+static uint16 g_doorsBusy;
+static uint32 g_jobsDone;
+static uint32 g_jobsFailed;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static int GATEWAY_loadBatch(const char * path);
+static int GATEWAY_parsePin(const char * text,uint8 * a_pin,uint8 * a_length);
+static int GATEWAY_buildTable(GatewayJob * job,const char * path);
+static int GATEWAY_parseConfig(const char * text,uint8 * a_image);
+static int GATEWAY_placeUser(uint8 * a_table,const uint8 * a_pin,uint8 length);
+static GatewayCacheEntry * GATEWAY_cacheEntry(const char * device);
+static void GATEWAY_loadCache(const char * path);
+static int GATEWAY_storeCache(const char * path);
+static int GATEWAY_openLink(GatewayDoor * door,speed_t baud);
+static void GATEWAY_setParity(GatewayDoor * door,uint8 mark);
+static void GATEWAY_send(GatewayDoor * door,const uint8 * a_data,uint8 length);
+static void GATEWAY_sendPin(GatewayDoor * door,const uint8 * a_pin,uint8 length);
+static void GATEWAY_ask(GatewayDoor * door,uint8 data,uint8 expect);
+static void GATEWAY_startJob(GatewayDoor * door);
+static void GATEWAY_endJob(GatewayDoor * door,uint8 ok,const char * format,...);
+static void GATEWAY_receive(GatewayDoor * door);
+static void GATEWAY_answer(GatewayDoor * door,uint8 data);
+static void GATEWAY_stateKnown(GatewayDoor * door);
+static void GATEWAY_writeDump(GatewayDoor * door);
+static double GATEWAY_nowMs(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(int argc,char * argv[]){
+
+	const char * batchPath = NULL;
+	const char * cachePath = NULL;
+	speed_t baud = B9600;
+	struct epoll_event events[GATEWAY_DOORS_MAX];
+	struct epoll_event event;
+	double start,elapsed;
+	uint16 doorsDone = 0;
+	int epoll;
+	int ready;
+	int i;
+
+	for(i = 1; i < argc; i++){
+		if(strcmp(argv[i],"--node") == 0 && i + 1 < argc){
+			int node = atoi(argv[++i]);
+			if(node < 1 || node > BUS_NODES_MAX){
+				fprintf(stderr,"--node : 1 to %u\n",BUS_NODES_MAX);
+				return 1;
+			}
+			g_node = (uint8)node;
+		}else if(strcmp(argv[i],"--timeout") == 0 && i + 1 < argc){
+			g_timeoutMs = atoi(argv[++i]);
+		}else if(strcmp(argv[i],"--baud") == 0 && i + 1 < argc){
+			/* the speeds of the ATmega16 UART examples ,the doors use
+			 * LINK_BAUD of their clock (system_states.h) */
+			switch(atoi(argv[++i])){
+			case 2400:  baud = B2400;  break;
+			case 4800:  baud = B4800;  break;
+			case 9600:  baud = B9600;  break;
+			case 19200: baud = B19200; break;
+			case 38400: baud = B38400; break;
+			case 57600: baud = B57600; break;
+			default:
+				fprintf(stderr,"--baud : 2400 ,4800 ,9600 ,19200 ,38400 or 57600\n");
+				return 1;
+			}
+		}else if(strcmp(argv[i],"--cache") == 0 && i + 1 < argc){
+			cachePath = argv[++i];
+		}else{
+			batchPath = argv[i];
+		}
+	}
+	if(batchPath == NULL){
+		fprintf(stderr,"usage : gateway [--node n] [--timeout ms] [--baud b] [--cache file] batch\n");
+		return 1;
+	}
+
+	if(cachePath != NULL){
+		GATEWAY_loadCache(cachePath);
+	}
+	if(GATEWAY_loadBatch(batchPath) != 0){
+		return 1;
+	}
+
+	epoll = epoll_create1(0);
+	if(epoll < 0){
+		perror("epoll_create1");
+		return 1;
+	}
+	for(i = 0; i < g_doorsNum; i++){
+		if(GATEWAY_openLink(&g_doors[i],baud) != 0){
+			return 1;
+		}
+		event.events = EPOLLIN;
+		event.data.ptr = &g_doors[i];
+		epoll_ctl(epoll,EPOLL_CTL_ADD,g_doors[i].fd,&event);
+	}
+
+	start = GATEWAY_nowMs();
+	g_doorsBusy = g_doorsNum;
+	for(i = 0; i < g_doorsNum; i++){
+		GATEWAY_startJob(&g_doors[i]);
+	}
+
+	while(g_doorsBusy > 0){
+		/* wait for a link or the first deadline */
+		double now = GATEWAY_nowMs();
+		double first = 0;
+		int timeout;
+
+		for(i = 0; i < g_doorsNum; i++){
+			if(g_doors[i].deadline != 0 && (first == 0 || g_doors[i].deadline < first)){
+				first = g_doors[i].deadline;
+			}
+		}
+		timeout = (first == 0) ? -1 : (first > now) ? (int)(first - now) + 1 : 0;
+
+		ready = epoll_wait(epoll,events,GATEWAY_DOORS_MAX,timeout);
+		for(i = 0; i < ready; i++){
+			GATEWAY_receive((GatewayDoor *)events[i].data.ptr);
+		}
+
+		now = GATEWAY_nowMs();
+		for(i = 0; i < g_doorsNum; i++){
+			GatewayDoor * door = &g_doors[i];
+			if(door->deadline != 0 && now >= door->deadline){
+				/* MC1 may still be in the middle of the conversation */
+				door->cache->known = FALSE;
+				GATEWAY_endJob(door,FALSE,"no answer ,state unknown");
+			}
+		}
+	}
+	elapsed = (GATEWAY_nowMs() - start) / 1000.0;
+
+	for(i = 0; i < g_doorsNum; i++){
+		doorsDone += !g_doors[i].failed;
+		close(g_doors[i].fd);
+	}
+	/* a door counts when all its jobs are done */
+	printf("%u doors (%u done) ,%u jobs done ,%u failed in %.3f s ,%.1f jobs/s ,%.1f doors/s\n",
+			g_doorsNum,doorsDone,g_jobsDone,g_jobsFailed,elapsed,
+			(elapsed > 0) ? g_jobsDone / elapsed : 0.0,(elapsed > 0) ? doorsDone / elapsed : 0.0);
+	close(epoll);
+	if(cachePath != NULL && GATEWAY_storeCache(cachePath) != 0){
+		return 1;
+	}
+	return (g_jobsFailed > 0) ? 2 : 0;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+/* the jobs of every door in the order of the batch */
+static int GATEWAY_loadBatch(const char * path){
+
+	FILE * batch = fopen(path,"r");
+	char line[GATEWAY_LINE_SIZE];
+	uint32 number = 0;
+
+	if(batch == NULL){
+		perror(path);
+		return -1;
+	}
+	while(fgets(line,sizeof(line),batch) != NULL){
+		char * device;
+		char * type;
+		char * argument1;
+		char * argument2;
+		GatewayDoor * door = NULL;
+		GatewayJob * job;
+		uint16 i;
+		uint8 ok;
+
+		number++;
+		*strchrnul(line,'#') = '\0';
+		device = strtok(line," \t\r\n");
+		type = strtok(NULL," \t\r\n");
+		argument1 = strtok(NULL," \t\r\n");
+		argument2 = strtok(NULL," \t\r\n");
+		if(device == NULL){
+			continue;
+		}
+
+		for(i = 0; i < g_doorsNum; i++){
+			if(strcmp(g_doors[i].cache->device,device) == 0){
+				door = &g_doors[i];
+			}
+		}
+		if(door == NULL){
+			if(g_doorsNum == GATEWAY_DOORS_MAX){
+				fprintf(stderr,"%s:%u : more than %u doors\n",path,number,GATEWAY_DOORS_MAX);
+				fclose(batch);
+				return -1;
+			}
+			door = &g_doors[g_doorsNum++];
+			door->cache = GATEWAY_cacheEntry(device);
+			if(door->cache == NULL){
+				fprintf(stderr,"%s:%u : more than %u doors in the cache\n",path,number,GATEWAY_CACHE_MAX);
+				fclose(batch);
+				return -1;
+			}
+		}
+		if(door->jobsNum == GATEWAY_DOOR_JOBS){
+			fprintf(stderr,"%s:%u : more than %u jobs for %s\n",path,number,GATEWAY_DOOR_JOBS,device);
+			fclose(batch);
+			return -1;
+		}
+
+		job = &door->jobs[door->jobsNum];
+		memset(job,0,sizeof(GatewayJob));
+		if(type == NULL){
+			ok = FALSE;
+		}else if(strcmp(type,"status") == 0){
+			job->type = JOB_STATUS;
+			ok = TRUE;
+		}else if(strcmp(type,"provision") == 0){
+			job->type = JOB_PROVISION;
+			ok = GATEWAY_parsePin(argument1,job->pin,&job->pinLength);
+		}else if(strcmp(type,"rotate") == 0){
+			job->type = JOB_ROTATE;
+			ok = GATEWAY_parsePin(argument1,job->pin,&job->pinLength) &&
+					GATEWAY_parsePin(argument2,job->newPin,&job->newPinLength);
+		}else if(strcmp(type,"audit") == 0 && argument2 != NULL){
+			job->type = JOB_AUDIT;
+			ok = GATEWAY_parsePin(argument1,job->pin,&job->pinLength);
+			job->file = strdup(argument2);
+		}else if(strcmp(type,"counters") == 0 && argument2 != NULL){
+			job->type = JOB_COUNTERS;
+			ok = GATEWAY_parsePin(argument1,job->pin,&job->pinLength);
+			job->file = strdup(argument2);
+		}else if(strcmp(type,"config") == 0){
+			job->type = JOB_CONFIG;
+			ok = GATEWAY_parsePin(argument1,job->pin,&job->pinLength) &&
+					GATEWAY_parseConfig(argument2,job->config);
+		}else if(strcmp(type,"users") == 0 && argument2 != NULL){
+			job->type = JOB_USERS;
+			ok = GATEWAY_parsePin(argument1,job->pin,&job->pinLength);
+			if(ok && GATEWAY_buildTable(job,argument2) != 0){
+				fclose(batch);
+				return -1;
+			}
+		}else{
+			ok = FALSE;
+		}
+		if(!ok){
+			fprintf(stderr,"%s:%u : expected status ,provision pin ,rotate old new ,audit pin file ,counters pin file"
+					" ,users pin file or config pin open,hold,close,siren,duty"
+					" (PIN of %u to %u digits)\n",path,number,PASSWORD_MIN_LENGTH,PASSWORD_MAX_LENGTH);
+			fclose(batch);
+			return -1;
+		}
+		door->jobsNum++;
+	}
+	fclose(batch);
+	return 0;
+}
+
+/* the digits of a PIN are sent as their key values */
+static int GATEWAY_parsePin(const char * text,uint8 * a_pin,uint8 * a_length){
+
+	uint8 i;
+
+	if(text == NULL || strlen(text) < PASSWORD_MIN_LENGTH || strlen(text) > PASSWORD_MAX_LENGTH){
+		return FALSE;
+	}
+	for(i = 0; text[i] != '\0'; i++){
+		if(text[i] < '0' || text[i] > '9'){
+			return FALSE;
+		}
+		a_pin[i] = (uint8)(text[i] - '0');
+	}
+	*a_length = i;
+	return TRUE;
+}
+
+/* image of a gate profile "open,hold,close,siren,duty" ,in the limits of MC1 */
+static int GATEWAY_parseConfig(const char * text,uint8 * a_image){
+
+	GateConfigType config;
+	unsigned int values[5];
+	char end;
+
+	if(text == NULL || sscanf(text,"%u,%u,%u,%u,%u%c",&values[0],&values[1],&values[2],
+			&values[3],&values[4],&end) != 5 || values[0] > 0xFFFF || values[1] > 0xFFFF ||
+			values[2] > 0xFFFF || values[3] > 0xFF || values[4] > 0xFF){
+		return FALSE;
+	}
+	GATE_CONFIG_build((uint16)values[0],(uint16)values[1],(uint16)values[2],(uint8)values[3],
+			(uint8)values[4],a_image);
+	if(!GATE_CONFIG_load(a_image,&config)){
+		fprintf(stderr,"%s : moves of %u to %u ms ,hold up to %u ms ,siren from %u s ,duty %u to %u %%\n",
+				text,GATE_CONFIG_MOVE_MIN_MS,GATE_CONFIG_TIME_MAX_MS,GATE_CONFIG_TIME_MAX_MS,
+				GATE_CONFIG_ALARM_MIN_S,GATE_CONFIG_DUTY_MIN,GATE_CONFIG_DUTY_MAX);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/* EEPROM image of the user table of the PINs of a file ,with a new key
+ * until every PIN has a slot */
+static int GATEWAY_buildTable(GatewayJob * job,const char * path){
+
+	uint8 pins[USER_TABLE_USERS][PASSWORD_MAX_LENGTH];
+	uint8 lengths[USER_TABLE_USERS];
+	uint16 pinsNum = 0;
+	char line[GATEWAY_LINE_SIZE];
+	FILE * file = fopen(path,"r");
+	FILE * random;
+	uint8 keys;
+	uint16 i;
+
+	if(file == NULL){
+		perror(path);
+		return -1;
+	}
+	while(fgets(line,sizeof(line),file) != NULL){
+		char * text;
+
+		*strchrnul(line,'#') = '\0';
+		text = strtok(line," \t\r\n");
+		if(text == NULL){
+			continue;
+		}
+		if(pinsNum == USER_TABLE_USERS){
+			fprintf(stderr,"%s : more than %u users\n",path,USER_TABLE_USERS);
+			fclose(file);
+			return -1;
+		}
+		if(!GATEWAY_parsePin(text,pins[pinsNum],&lengths[pinsNum])){
+			fprintf(stderr,"%s : %s is not a PIN of %u to %u digits\n",path,text,
+					PASSWORD_MIN_LENGTH,PASSWORD_MAX_LENGTH);
+			fclose(file);
+			return -1;
+		}
+		pinsNum++;
+	}
+	fclose(file);
+
+	random = fopen("/dev/urandom","rb");
+	if(random == NULL){
+		perror("/dev/urandom");
+		return -1;
+	}
+	job->table = malloc(USER_TABLE_PAGES * EEPROM_PAGE_SIZE);
+	for(keys = 0; keys < GATEWAY_TABLE_KEYS; keys++){
+		/* the key is the first page ,an empty slot is erased */
+		memset(job->table,0xFF,USER_TABLE_PAGES * EEPROM_PAGE_SIZE);
+		if(fread(job->table,1,SIPHASH_KEY_SIZE,random) != SIPHASH_KEY_SIZE){
+			break;
+		}
+		job->users = 0;
+		for(i = 0; i < pinsNum; i++){
+			int placed = GATEWAY_placeUser(job->table,pins[i],lengths[i]);
+			if(placed < 0){
+				break;
+			}
+			job->users += placed;
+		}
+		if(i == pinsNum){
+			fclose(random);
+			return 0;
+		}
+	}
+	fclose(random);
+	fprintf(stderr,"%s : no user table found for %u PINs\n",path,pinsNum);
+	return -1;
+}
+
+/* a tag in its home bucket or the next ones ,returns 1 ,0 if it is already
+ * there (the same PIN twice) or -1 if the buckets are full */
+static int GATEWAY_placeUser(uint8 * a_table,const uint8 * a_pin,uint8 length){
+
+	uint8 tag[USER_TABLE_TAG_SIZE];
+	uint8 empty[USER_TABLE_TAG_SIZE];
+	uint8 bucket = USER_TABLE_hash(a_table,a_pin,length,tag);
+	uint8 probe,slot;
+
+	memset(empty,0xFF,sizeof(empty));
+	for(probe = 0; probe < USER_TABLE_PROBES; probe++){
+		uint8 * page = &a_table[(1 + bucket) * EEPROM_PAGE_SIZE];
+
+		for(slot = 0; slot < EEPROM_PAGE_SIZE; slot += USER_TABLE_TAG_SIZE){
+			if(memcmp(&page[slot],tag,USER_TABLE_TAG_SIZE) == 0){
+				return 0;
+			}
+			if(memcmp(&page[slot],empty,USER_TABLE_TAG_SIZE) == 0){
+				memcpy(&page[slot],tag,USER_TABLE_TAG_SIZE);
+				return 1;
+			}
+		}
+		bucket = (bucket + 1) % USER_TABLE_BUCKETS;
+	}
+	return -1;
+}
+
+/* a door not in the cache was just powered up : MC1 waits for M_READY */
+static GatewayCacheEntry * GATEWAY_cacheEntry(const char * device){
+
+	GatewayCacheEntry * entry;
+	uint16 i;
+
+	for(i = 0; i < g_cacheNum; i++){
+		if(strcmp(g_cache[i].device,device) == 0){
+			return &g_cache[i];
+		}
+	}
+	if(g_cacheNum == GATEWAY_CACHE_MAX){
+		return NULL;
+	}
+	entry = &g_cache[g_cacheNum++];
+	snprintf(entry->device,sizeof(entry->device),"%s",device);
+	entry->known = TRUE;
+	entry->state = NEW_PASSWORD;
+	entry->waitsInput = FALSE;
+	entry->lockoutEnd = 0;
+	return entry;
+}
+
+/* one door per line "device state waits_input lockout_end" */
+static void GATEWAY_loadCache(const char * path){
+
+	FILE * file = fopen(path,"r");
+	char device[GATEWAY_DEVICE_SIZE];
+	char state[40];
+	unsigned waitsInput;
+	long lockoutEnd;
+	uint8 i;
+
+	if(file == NULL){
+		/* first run */
+		return;
+	}
+	while(fscanf(file,"%127s %39s %u %ld",device,state,&waitsInput,&lockoutEnd) == 4){
+		GatewayCacheEntry * entry = GATEWAY_cacheEntry(device);
+		if(entry == NULL){
+			break;
+		}
+		entry->known = FALSE;
+		for(i = 0; i < SYSTEM_STATES_NUM; i++){
+			if(strcmp(state,g_systemStates[i]) == 0){
+				entry->known = TRUE;
+				entry->state = i;
+			}
+		}
+		entry->waitsInput = (uint8)waitsInput;
+		entry->lockoutEnd = lockoutEnd;
+	}
+	fclose(file);
+}
+
+static int GATEWAY_storeCache(const char * path){
+
+	FILE * file = fopen(path,"w");
+	uint16 i;
+
+	if(file == NULL){
+		perror(path);
+		return -1;
+	}
+	for(i = 0; i < g_cacheNum; i++){
+		fprintf(file,"%s %s %u %ld\n",g_cache[i].device,
+				g_cache[i].known ? g_systemStates[g_cache[i].state] : "UNKNOWN",
+				g_cache[i].waitsInput,g_cache[i].lockoutEnd);
+	}
+	fclose(file);
+	return 0;
+}
+
+/* raw link ,a serial port receives the address frames as parity errors */
+static int GATEWAY_openLink(GatewayDoor * door,speed_t baud){
+
+	char device[PATH_MAX];
+	struct termios tty;
+
+	door->fd = open(door->cache->device,O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if(door->fd < 0){
+		perror(door->cache->device);
+		return -1;
+	}
+	door->serialPort = (realpath(door->cache->device,device) != NULL &&
+			strncmp(device,"/dev/pts/",9) != 0);
+	door->conversation = BUS_NO_CONVERSATION;
+
+	tcgetattr(door->fd,&tty);
+	cfmakeraw(&tty);
+	if(door->serialPort){
+		cfsetispeed(&tty,baud);
+		cfsetospeed(&tty,baud);
+		tty.c_cflag |= CLOCAL | CREAD | PARENB | CMSPAR;
+		tty.c_cflag &= ~(PARODD | CSTOPB);
+		tty.c_iflag |= INPCK | PARMRK;
+		tty.c_iflag &= ~(IGNPAR | ISTRIP);
+	}
+	tcsetattr(door->fd,TCSANOW,&tty);
+	tcflush(door->fd,TCIOFLUSH);
+	return 0;
+}
+
+/* mark parity sends the 9th bit set ,space parity cleared */
+static void GATEWAY_setParity(GatewayDoor * door,uint8 mark){
+
+	struct termios tty;
+
+	tcdrain(door->fd);
+	tcgetattr(door->fd,&tty);
+	if(mark){
+		tty.c_cflag |= PARODD;
+	}else{
+		tty.c_cflag &= ~PARODD;
+	}
+	tcsetattr(door->fd,TCSANOW,&tty);
+}
+
+/* data frames of the gateway ,preceded by its address frame when the
+ * conversation changed (as BUS_sendByte of a node) */
+static void GATEWAY_send(GatewayDoor * door,const uint8 * a_data,uint8 length){
+
+	uint8 bytes[SERIAL_LINK_FRAME_MAX * GATEWAY_SEND_FRAMES];
+	uint8 count = 0;
+	uint8 ok = TRUE;
+	uint8 i;
+
+	if(door->serialPort){
+		if(door->conversation != g_node){
+			GATEWAY_setParity(door,TRUE);
+			ok = (write(door->fd,&g_node,1) == 1);
+			GATEWAY_setParity(door,FALSE);
+		}
+		ok &= (write(door->fd,a_data,length) == length);
+	}else{
+		if(door->conversation != g_node){
+			count = SERIAL_LINK_encode(SERIAL_LINK_BIT8 | g_node,bytes);
+		}
+		for(i = 0; i < length; i++){
+			count += SERIAL_LINK_encode(a_data[i],&bytes[count]);
+		}
+		ok = (write(door->fd,bytes,count) == count);
+	}
+	if(!ok){
+		perror(door->cache->device);
+	}
+	door->conversation = g_node;
+}
+
+/* the digits ,'#' and M_READY for the answer */
+static void GATEWAY_sendPin(GatewayDoor * door,const uint8 * a_pin,uint8 length){
+
+	uint8 bytes[PASSWORD_MAX_LENGTH + 2];
+
+	memcpy(bytes,a_pin,length);
+	bytes[length] = '#';
+	bytes[length + 1] = M_READY;
+	GATEWAY_send(door,bytes,length + 2);
+	door->cache->waitsInput = FALSE;
+}
+
+static void GATEWAY_ask(GatewayDoor * door,uint8 data,uint8 expect){
+
+	GATEWAY_send(door,&data,1);
+	door->expect = expect;
+	door->deadline = GATEWAY_nowMs() + g_timeoutMs;
+}
+
+static void GATEWAY_startJob(GatewayDoor * door){
+
+	GatewayJob * job = &door->jobs[door->job];
+	GatewayCacheEntry * cache = door->cache;
+	long lockout = cache->lockoutEnd - (long)time(NULL);
+
+	door->jobStart = GATEWAY_nowMs();
+	door->pinSent = FALSE;
+	door->optionSent = FALSE;
+	door->verified = FALSE;
+	door->page = 0;
+	door->dumpLength = 0;
+
+	if(job->type == JOB_AUDIT && !cache->known){
+		/*answered only if the gateway is still logged in*/
+		GATEWAY_ask(door,TRACE_DUMP_REQUEST,EXPECT_DUMP);
+	}else if(job->type == JOB_COUNTERS && !cache->known){
+		GATEWAY_ask(door,COUNTERS_REQUEST,EXPECT_COUNTERS);
+	}else if(!cache->known){
+		GATEWAY_endJob(door,FALSE,"state unknown (cache)");
+	}else if(cache->state == BUZZER_ON && lockout > 0){
+		GATEWAY_endJob(door,FALSE,"locked out ,%ld s left",lockout);
+	}else if(cache->waitsInput){
+		/* M_READY would be taken as input */
+		GATEWAY_stateKnown(door);
+	}else{
+		GATEWAY_ask(door,M_READY,EXPECT_STATE);
+	}
+}
+
+/* print the job and start the next one of the door */
+static void GATEWAY_endJob(GatewayDoor * door,uint8 ok,const char * format,...){
+
+	GatewayJob * job = &door->jobs[door->job];
+	va_list arguments;
+
+	printf("%-20s %-9s %-6s %8.1f ms  ",door->cache->device,g_jobNames[job->type],
+			ok ? "OK" : "FAILED",GATEWAY_nowMs() - door->jobStart);
+	va_start(arguments,format);
+	vprintf(format,arguments);
+	va_end(arguments);
+	printf("\n");
+
+	if(ok){
+		g_jobsDone++;
+	}else{
+		g_jobsFailed++;
+		door->failed = TRUE;
+	}
+	door->expect = EXPECT_NOTHING;
+	door->deadline = 0;
+	door->job++;
+	if(door->job < door->jobsNum){
+		GATEWAY_startJob(door);
+	}else{
+		g_doorsBusy--;
+	}
+}
+
+static void GATEWAY_receive(GatewayDoor * door){
+
+	uint8 bytes[GATEWAY_READ_SIZE];
+	uint16 frame;
+	ssize_t length = read(door->fd,bytes,sizeof(bytes));
+	ssize_t i;
+
+	for(i = 0; i < length; i++){
+		if(!SERIAL_LINK_decode(&door->decoder,bytes[i],&frame)){
+			continue;
+		}
+		if(frame & SERIAL_LINK_BIT8){
+			door->conversation = (uint8)frame;
+		}else if(door->conversation == g_node && door->job < door->jobsNum){
+			/* MC1 speaks to the gateway */
+			GATEWAY_answer(door,(uint8)frame);
+		}
+	}
+}
+
+/* a byte of MC1 in the conversation with the gateway */
+static void GATEWAY_answer(GatewayDoor * door,uint8 data){
+
+	GatewayCacheEntry * cache = door->cache;
+	GatewayJob * job = &door->jobs[door->job];
+	uint8 expect = door->expect;
+
+	door->deadline = GATEWAY_nowMs() + g_timeoutMs;
+	/* the first PIN was set up from another node ,MC1 waits for M_READY */
+	if(data == STATE_CHANGED && expect != EXPECT_DUMP && expect != EXPECT_COUNTERS){
+		cache->waitsInput = FALSE;
+		GATEWAY_ask(door,M_READY,EXPECT_STATE);
+		return;
+	}
+	switch(expect){
+	case EXPECT_STATE:
+		if(data >= SYSTEM_STATES_NUM){
+			break;
+		}
+		cache->state = data;
+		if(data == BUZZER_ON){
+			door->expect = EXPECT_LOCKOUT_HIGH;
+		}else if(data == OPENING_GATE){
+			/* never asked by the gateway ,the gate states would follow */
+			cache->known = FALSE;
+			GATEWAY_endJob(door,FALSE,"gate opening ,state unknown");
+		}else{
+			door->expect = EXPECT_INPUT_READY;
+		}
+		return;
+	case EXPECT_LOCKOUT_HIGH:
+		door->lockout = (uint16)(data << LOCKOUT_BYTE_BITS);
+		door->expect = EXPECT_LOCKOUT_LOW;
+		return;
+	case EXPECT_LOCKOUT_LOW:
+		door->lockout |= data;
+		cache->lockoutEnd = (long)time(NULL) + door->lockout;
+		/* MC1 answers again at the end of the lock out */
+		GATEWAY_endJob(door,FALSE,"locked out ,%u s left",door->lockout);
+		return;
+	case EXPECT_INPUT_READY:
+		if(data != M_READY){
+			break;
+		}
+		cache->waitsInput = TRUE;
+		door->expect = EXPECT_NOTHING;
+		GATEWAY_stateKnown(door);
+		return;
+	case EXPECT_RESULT:
+		if(data == CORRECT_PASSWORD){
+			if(cache->state == CHECK_PASSWORD_FOR_NEW_PASSWORD){
+				door->verified = TRUE;
+			}
+			GATEWAY_ask(door,M_READY,EXPECT_STATE);
+		}else if(data == WRONG_PASSWORD){
+			GATEWAY_endJob(door,FALSE,"wrong PIN ,not tried again");
+		}else{
+			break;
+		}
+		return;
+	case EXPECT_CREDIT:
+		if(data == M_READY && door->page < USER_TABLE_PAGES){
+			GATEWAY_send(door,&job->table[door->page * EEPROM_PAGE_SIZE],EEPROM_PAGE_SIZE);
+			door->page++;
+		}else if(data == CORRECT_PASSWORD && door->page == USER_TABLE_PAGES){
+			door->verified = TRUE;
+			door->streamStart = GATEWAY_nowMs() - door->streamStart;
+			GATEWAY_ask(door,M_READY,EXPECT_STATE);
+		}else if(data == WRONG_PASSWORD){
+			/* MC1 waits for M_READY again */
+			GATEWAY_endJob(door,FALSE,(door->page == 0) ? "refused (not the PIN of the system)" :
+					"user table not stored (%u pages sent)",door->page);
+		}else{
+			break;
+		}
+		return;
+	case EXPECT_CONFIG:
+		/* the profile is the only page */
+		if(data == M_READY && door->page == 0){
+			GATEWAY_send(door,job->config,GATE_CONFIG_SIZE);
+			door->page++;
+		}else if(data == CORRECT_PASSWORD && door->page == 1){
+			door->verified = TRUE;
+			GATEWAY_ask(door,M_READY,EXPECT_STATE);
+		}else if(data == WRONG_PASSWORD){
+			GATEWAY_endJob(door,FALSE,(door->page == 0) ? "refused (not the PIN of the system)" :
+					"gate profile not valid");
+		}else{
+			break;
+		}
+		return;
+	case EXPECT_DUMP:
+		if(door->dumpLength == 0 && data == WRONG_PASSWORD){
+			/* the link state of MC1 is not changed */
+			GATEWAY_endJob(door,FALSE,"refused (not logged in with the PIN of the system)");
+			return;
+		}
+		door->dump[door->dumpLength++] = data;
+		if(door->dumpLength == 2 && (door->dump[0] != TRACE_DUMP_MAGIC1 || data != TRACE_DUMP_MAGIC2)){
+			break;
+		}
+		if(door->dumpLength >= GATEWAY_DUMP_HEADER &&
+				door->dumpLength == GATEWAY_DUMP_HEADER + 4 * door->dump[2]){
+			GATEWAY_writeDump(door);
+		}
+		return;
+	case EXPECT_COUNTERS:
+		if(door->dumpLength == 0 && data == WRONG_PASSWORD){
+			/* the link state of MC1 is not changed */
+			GATEWAY_endJob(door,FALSE,"refused (not logged in with the PIN of the system)");
+			return;
+		}
+		door->dump[door->dumpLength++] = data;
+		if(door->dumpLength == 2 && (door->dump[0] != COUNTERS_MAGIC1 || data != COUNTERS_MAGIC2)){
+			break;
+		}
+		if(door->dumpLength >= GATEWAY_DUMP_HEADER &&
+				door->dumpLength == GATEWAY_COUNTERS_LENGTH(door->dump[2])){
+			GATEWAY_writeDump(door);
+		}
+		return;
+	default:
+		/* not asked */
+		break;
+	}
+	cache->known = FALSE;
+	GATEWAY_endJob(door,FALSE,"unexpected byte 0x%02X ,state unknown",data);
+}
+
+/* the system state is known and MC1 waits for the input of the gateway */
+static void GATEWAY_stateKnown(GatewayDoor * door){
+
+	GatewayJob * job = &door->jobs[door->job];
+	uint8 state = door->cache->state;
+	uint8 option[2] = {CREATE_NEW_PASSWORD,M_READY};
+	uint8 provision = PROVISION_USERS;
+	uint8 config = GATE_CONFIG;
+
+	if(job->type == JOB_STATUS){
+		GATEWAY_endJob(door,TRUE,"%s",g_systemStates[state]);
+	}else if(job->type == JOB_PROVISION){
+		if(state == NEW_PASSWORD && !door->pinSent){
+			GATEWAY_sendPin(door,job->pin,job->pinLength);
+			door->pinSent = TRUE;
+			door->expect = EXPECT_RESULT;
+			door->deadline = GATEWAY_nowMs() + g_timeoutMs;
+		}else if(state == VIEW_OPTIONS && door->pinSent){
+			GATEWAY_endJob(door,TRUE,"PIN of %u digits set",job->pinLength);
+		}else{
+			GATEWAY_endJob(door,FALSE,"not in first-time setup (%s)",g_systemStates[state]);
+		}
+	}else if(job->type == JOB_USERS && state == VIEW_OPTIONS && !door->optionSent){
+		GATEWAY_send(door,&provision,1);
+		door->cache->waitsInput = FALSE;
+		door->optionSent = TRUE;
+		door->streamStart = GATEWAY_nowMs();
+		door->expect = EXPECT_CREDIT;
+		door->deadline = GATEWAY_nowMs() + g_timeoutMs;
+	}else if(job->type == JOB_USERS && state == VIEW_OPTIONS && door->verified){
+		GATEWAY_endJob(door,TRUE,"%u users ,%u pages in %.3f s ,%.1f users/s",job->users,
+				USER_TABLE_PAGES,door->streamStart / 1000.0,job->users * 1000.0 / door->streamStart);
+	}else if(job->type == JOB_CONFIG && state == VIEW_OPTIONS && !door->optionSent){
+		GATEWAY_send(door,&config,1);
+		door->cache->waitsInput = FALSE;
+		door->optionSent = TRUE;
+		door->expect = EXPECT_CONFIG;
+		door->deadline = GATEWAY_nowMs() + g_timeoutMs;
+	}else if(job->type == JOB_CONFIG && state == VIEW_OPTIONS && door->verified){
+		GATEWAY_endJob(door,TRUE,"gate %u/%u/%u ms ,siren %u s ,duty %u %%",
+				job->config[GATE_CONFIG_OPEN_MS] | (job->config[GATE_CONFIG_OPEN_MS + 1] << 8),
+				job->config[GATE_CONFIG_HOLD_MS] | (job->config[GATE_CONFIG_HOLD_MS + 1] << 8),
+				job->config[GATE_CONFIG_CLOSE_MS] | (job->config[GATE_CONFIG_CLOSE_MS + 1] << 8),
+				job->config[GATE_CONFIG_ALARM_S],job->config[GATE_CONFIG_DUTY]);
+	}else if(job->type == JOB_AUDIT && state == VIEW_OPTIONS){
+		/* MC1 still waits for an option after the dump */
+		GATEWAY_ask(door,TRACE_DUMP_REQUEST,EXPECT_DUMP);
+	}else if(job->type == JOB_COUNTERS && state == VIEW_OPTIONS){
+		GATEWAY_ask(door,COUNTERS_REQUEST,EXPECT_COUNTERS);
+	}else if(state == CHECK_PASSWORD_TO_LOG_IN && !door->optionSent){
+		/*rotate ,users ,config ,audit ,counters : log in*/
+		GATEWAY_sendPin(door,job->pin,job->pinLength);
+		door->expect = EXPECT_RESULT;
+		door->deadline = GATEWAY_nowMs() + g_timeoutMs;
+	}else if(state == VIEW_OPTIONS && !door->optionSent){
+		GATEWAY_send(door,option,sizeof(option));
+		door->cache->waitsInput = FALSE;
+		door->optionSent = TRUE;
+		door->expect = EXPECT_STATE;
+		door->deadline = GATEWAY_nowMs() + g_timeoutMs;
+	}else if(job->type == JOB_USERS){
+		GATEWAY_endJob(door,FALSE,"can not stream users in %s",g_systemStates[state]);
+	}else if(job->type == JOB_CONFIG){
+		GATEWAY_endJob(door,FALSE,"can not set the gate profile in %s",g_systemStates[state]);
+	}else if(job->type == JOB_AUDIT || job->type == JOB_COUNTERS){
+		GATEWAY_endJob(door,FALSE,"can not log in from %s",g_systemStates[state]);
+	}else if(state == CHECK_PASSWORD_FOR_NEW_PASSWORD && !door->verified){
+		GATEWAY_sendPin(door,job->pin,job->pinLength);
+		door->expect = EXPECT_RESULT;
+		door->deadline = GATEWAY_nowMs() + g_timeoutMs;
+	}else if(state == NEW_PASSWORD && door->verified && !door->pinSent){
+		GATEWAY_sendPin(door,job->newPin,job->newPinLength);
+		door->pinSent = TRUE;
+		door->expect = EXPECT_RESULT;
+		door->deadline = GATEWAY_nowMs() + g_timeoutMs;
+	}else if(state == VIEW_OPTIONS && door->pinSent){
+		GATEWAY_endJob(door,TRUE,"PIN of %u digits set",job->newPinLength);
+	}else{
+		GATEWAY_endJob(door,FALSE,"can not rotate in %s",g_systemStates[state]);
+	}
+}
+
+static void GATEWAY_writeDump(GatewayDoor * door){
+
+	GatewayJob * job = &door->jobs[door->job];
+	FILE * file = fopen(job->file,"wb");
+
+	if(file == NULL || fwrite(door->dump,1,door->dumpLength,file) != door->dumpLength){
+		GATEWAY_endJob(door,FALSE,"can not write %s",job->file);
+	}else{
+		GATEWAY_endJob(door,TRUE,"%u %s to %s",door->dump[2],
+				(job->type == JOB_COUNTERS) ? "counters" : "records",job->file);
+	}
+	if(file != NULL){
+		fclose(file);
+	}
+}
+
+static double GATEWAY_nowMs(void){
+
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+}
@@ -0,0 +1,1165 @@
+/******************************************************************************
+ *
+ * Module: Host Build
+ *
+ * File Name: hal_host.c
+ *
+ * Description: software model of the ATmega16 peripherals (see hal_host.h)
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#include <avr/io.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define HAL_HOST_WEAK __attribute__((weak))
+
+#define IO_INDEX(REG) ((uint8_t)(&(REG) - HAL_HOST_io))
+
+#define UART_QUEUE_SIZE 1024
+
+/* M24C16 : device code 1010 ,block select in bits 3..1 ,16 bytes pages */
+#define EEPROM_DEVICE_CODE 0xA0
+#define EEPROM_PAGE_SIZE   16
+#define EEPROM_WRITE_MS    5
+
+/* SCL periods of a START or STOP condition and of a byte with its acknowledge */
+#define TWI_CONDITION_BITS 1
+#define TWI_BYTE_BITS      9
+
+/* TWI status codes of a master */
+#define TW_START         0x08
+#define TW_REP_START     0x10
+#define TW_MT_SLA_ACK    0x18
+#define TW_MT_SLA_NACK   0x20
+#define TW_MT_DATA_ACK   0x28
+#define TW_MT_DATA_NACK  0x30
+#define TW_MR_SLA_ACK    0x40
+#define TW_MR_SLA_NACK   0x48
+#define TW_MR_DATA_ACK   0x50
+#define TW_MR_DATA_NACK  0x58
+#define TW_NO_INFO       0xF8
+
+#define GPIO_CONNECTIONS_NUM 8
+#define GPIO_RELEASED        2
+
+/* what a sleep mode stops : idle only the CPU ,ADC noise reduction the I/O
+ * clock (timers ,USART ,TWI bit rate) ,power down and the others the ADC too */
+#define SLEEP_LEVEL_IDLE       0
+#define SLEEP_LEVEL_ADC        1
+#define SLEEP_LEVEL_POWER_DOWN 2
+
+/* SM2:0 bits of MCUCR */
+#define SLEEP_MODE_MASK 0xB0
+#define SLEEP_MODE_ADC  0x10
+
+/* start up time from power down of the internal RC oscillator (6 CK) */
+#define SLEEP_WAKE_UP_CYCLES 6
+
+/* external interrupts : INT0 (PD2) ,INT1 (PD3) ,INT2 (PB2) */
+#define EXT_INTERRUPTS_NUM 3
+
+#define LCD_DDRAM_SIZE 0x68
+#define LCD_CGRAM_SIZE 64
+
+/* HD44780 busy times (270 kHz oscillator) : internal reset after power on ,
+ * clear display and return home ,the other instructions and a data write */
+#define LCD_POWER_ON_US  15000UL
+#define LCD_CLEAR_US     1520UL
+#define LCD_EXECUTION_US 37UL
+#define LCD_WRITE_US     41UL
+
+#define US_TO_CYCLES(US) ((uint64_t)g_cpuFrequency * (US) / 1000000UL)
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef struct{
+	uint16_t data[UART_QUEUE_SIZE];   /* frames ,bit 8 is the 9th data bit */
+	uint16_t head;
+	uint16_t count;
+}UartQueue;
+
+typedef struct{
+	uint8_t port;
+	uint8_t pin1;
+	uint8_t pin2;
+	uint8_t connected;
+}PinConnection;
+
+typedef struct{
+	volatile uint8_t * flags;
+	uint8_t flagBit;
+	volatile uint8_t * enable;
+	uint8_t enableBit;
+	uint8_t autoClear;   /* the flag is cleared when the vector is executed */
+	uint8_t wakeLevel;   /* deepest SLEEP_LEVEL_xxx it wakes the CPU up from */
+	void (*vector)(void);
+}InterruptSource;
+
+/*******************************************************************************
+ *                            GLOBAL VARIABLES                    *
+ *******************************************************************************/
+
+volatile uint8_t HAL_HOST_io[HAL_HOST_IO_SIZE];
+
+static uint32_t g_cpuFrequency = 1000000UL;
+static uint64_t g_cycles;
+static uint32_t g_serviced;
+static void (*g_idleHook)(void) = NULL;
+static void (*g_syncHook)(void) = NULL;
+static uint32_t g_syncPeriod;
+static uint32_t g_syncCount;
+static void (*g_eventHook)(uint8_t event,uint8_t data) = NULL;
+
+/* sleep mode running (HAL_HOST_AWAKE if none) ,its level and the power counters */
+static uint8_t g_sleepMode;
+static uint8_t g_sleepLevel;
+static uint64_t g_powerCount[HAL_HOST_POWER_COUNTERS];
+
+/* external interrupts enabled and the last level of their pins */
+static uint8_t g_extEnabled;
+static uint8_t g_extLevel[EXT_INTERRUPTS_NUM];
+
+/* PORTx addresses of ports A..D (DDRx = PORTx-1 ,PINx = PORTx-2) */
+static const uint8_t g_portIndex[4] = {0x3B,0x38,0x35,0x32};
+
+/* UART ,cycles left of the frame being received (0 : the line is idle) */
+static UartQueue g_rxQueue;
+static UartQueue g_txQueue;
+static uint32_t g_rxRemaining;
+
+/* timers */
+static uint16_t g_prescaleCount[3];
+static uint8_t g_countDown[3];
+
+/* ADC */
+static uint16_t g_adcInput[8];
+static uint32_t g_adcRemaining;
+
+/* GPIO */
+static PinConnection g_connections[GPIO_CONNECTIONS_NUM];
+static uint8_t g_external[4][8];
+
+/* M24C16 and the TWI bus */
+static uint8_t g_eeprom[HAL_HOST_EEPROM_SIZE];
+static uint8_t g_eepromReady = 0;
+static uint8_t g_eepromPage[EEPROM_PAGE_SIZE];
+static uint8_t g_eepromPageUsed[EEPROM_PAGE_SIZE];
+static uint16_t g_eepromAddress;
+static uint8_t g_eepromAddressBytes;
+static uint8_t g_eepromWriting;
+static uint32_t g_eepromBusy;
+static uint8_t g_twiStarted;
+static uint8_t g_twiRead;
+static uint8_t g_twiSelected;
+static uint32_t g_twiRemaining;   /* cycles until the running bus operation ends */
+static uint8_t g_twiStatus;       /* TWSR status at its end */
+static uint8_t g_twiStopping;     /* it is a STOP (TWSTO is cleared at its end) */
+
+/* LCD */
+static uint8_t g_lcdAttached = 0;
+static uint8_t g_lcdCtrl,g_lcdRs,g_lcdE,g_lcdData;
+static uint8_t g_lcdDdram[LCD_DDRAM_SIZE];
+static uint8_t g_lcdCgram[LCD_CGRAM_SIZE];
+static uint8_t g_lcdAddress;
+static uint8_t g_lcdCgramMode;
+static uint8_t g_lcdIncrement;
+static uint64_t g_lcdBusyUntil;
+static uint32_t g_lcdIgnored;
+static char g_lcdLine[HAL_HOST_LCD_COLUMNS + 1];
+
+/* interrupt vectors ordered by priority */
+static const InterruptSource g_sources[] = {
+		{&GIFR,INTF0,&GICR,INT0,1,SLEEP_LEVEL_POWER_DOWN,INT0_vect},
+		{&GIFR,INTF1,&GICR,INT1,1,SLEEP_LEVEL_POWER_DOWN,INT1_vect},
+		{&TIFR,OCF2,&TIMSK,OCIE2,1,SLEEP_LEVEL_IDLE,TIMER2_COMP_vect},
+		{&TIFR,TOV2,&TIMSK,TOIE2,1,SLEEP_LEVEL_IDLE,TIMER2_OVF_vect},
+		{&TIFR,ICF1,&TIMSK,TICIE1,1,SLEEP_LEVEL_IDLE,TIMER1_CAPT_vect},
+		{&TIFR,OCF1A,&TIMSK,OCIE1A,1,SLEEP_LEVEL_IDLE,TIMER1_COMPA_vect},
+		{&TIFR,OCF1B,&TIMSK,OCIE1B,1,SLEEP_LEVEL_IDLE,TIMER1_COMPB_vect},
+		{&TIFR,TOV1,&TIMSK,TOIE1,1,SLEEP_LEVEL_IDLE,TIMER1_OVF_vect},
+		{&TIFR,TOV0,&TIMSK,TOIE0,1,SLEEP_LEVEL_IDLE,TIMER0_OVF_vect},
+		{&UCSRA,RXC,&UCSRB,RXCIE,0,SLEEP_LEVEL_IDLE,USART_RXC_vect},
+		{&UCSRA,UDRE,&UCSRB,UDRIE,0,SLEEP_LEVEL_IDLE,USART_UDRE_vect},
+		{&UCSRA,TXC,&UCSRB,TXCIE,1,SLEEP_LEVEL_IDLE,USART_TXC_vect},
+		{&ADCSRA,ADIF,&ADCSRA,ADIE,1,SLEEP_LEVEL_ADC,ADC_vect},
+		{&TWCR,TWINT,&TWCR,TWIE,0,SLEEP_LEVEL_POWER_DOWN,TWI_vect},
+		{&GIFR,INTF2,&GICR,INT2,1,SLEEP_LEVEL_POWER_DOWN,INT2_vect},
+		{&TIFR,OCF0,&TIMSK,OCIE0,1,SLEEP_LEVEL_IDLE,TIMER0_COMP_vect}
+};
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void HAL_HOST_step(void);
+static void HAL_HOST_interrupts(void);
+static void HAL_HOST_externalInterrupts(void);
+static void HAL_HOST_setTimerFlag(uint8_t bit);
+static void HAL_HOST_timer8(uint8_t timer);
+static void HAL_HOST_timer1(void);
+static void HAL_HOST_adcStart(void);
+static void HAL_HOST_adcTrigger(uint8_t source);
+static void HAL_HOST_twi(uint8_t control);
+static void HAL_HOST_twiDone(void);
+static void HAL_HOST_eepromCommit(void);
+static uint8_t HAL_HOST_pinLevel(uint8_t port,uint8_t pin);
+static uint8_t HAL_HOST_portOf(uint8_t index,uint8_t offset);
+static void HAL_HOST_lcdLatch(uint8_t rs,uint8_t data);
+static uint8_t HAL_HOST_queuePush(UartQueue * queue,uint16_t frame);
+static uint8_t HAL_HOST_queuePop(UartQueue * queue,uint16_t * a_frame);
+static uint32_t HAL_HOST_uartFrameCycles(void);
+static void HAL_HOST_uartReceive(void);
+static void HAL_HOST_eepromInit(void);
+static void HAL_HOST_event(uint8_t event,uint8_t data);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void HAL_HOST_reset(uint32_t cpuFrequency){
+
+	memset((void *)HAL_HOST_io,0,sizeof(HAL_HOST_io));
+	UCSRA = (1<<UDRE);
+	UCSRC = (1<<UCSZ1) | (1<<UCSZ0);
+	TWSR = TW_NO_INFO;
+	TWBR = 0;
+
+	g_cpuFrequency = cpuFrequency;
+	g_cycles = 0;
+	g_serviced = 0;
+	g_sleepMode = HAL_HOST_AWAKE;
+	g_sleepLevel = SLEEP_LEVEL_IDLE;
+	memset(g_powerCount,0,sizeof(g_powerCount));
+	g_extEnabled = 0;
+	memset(&g_rxQueue,0,sizeof(g_rxQueue));
+	memset(&g_txQueue,0,sizeof(g_txQueue));
+	g_rxRemaining = 0;
+	memset(g_prescaleCount,0,sizeof(g_prescaleCount));
+	memset(g_countDown,0,sizeof(g_countDown));
+	g_adcRemaining = 0;
+	memset(g_connections,0,sizeof(g_connections));
+	memset(g_external,GPIO_RELEASED,sizeof(g_external));
+
+	HAL_HOST_eepromInit();
+	g_eepromWriting = 0;
+	g_eepromBusy = 0;
+	g_twiStarted = 0;
+	g_twiSelected = 0;
+	g_twiRemaining = 0;
+	g_twiStopping = 0;
+
+	g_lcdAttached = 0;
+}
+
+uint32_t HAL_HOST_read(const volatile void * reg,uint8_t size){
+
+	uintptr_t address = (uintptr_t)reg;
+	uintptr_t start = (uintptr_t)HAL_HOST_io;
+	uint32_t value = 0;
+	uint8_t index;
+	uint8_t port;
+
+	if(address < start || address >= start + HAL_HOST_IO_SIZE){
+		memcpy(&value,(const void *)reg,size);
+		return value;
+	}
+
+	HAL_HOST_advance(1);
+	index = (uint8_t)(address - start);
+
+	if(index == IO_INDEX(UDR)){
+		/* the next frame is moved to UDR when it is completely received */
+		UCSRA &= ~(1<<RXC);
+	}
+	for(port = 0; port < 4; port++){
+		if(index == g_portIndex[port] - 2){
+			uint8_t pin,level = 0;
+			for(pin = 0; pin < 8; pin++){
+				level |= (uint8_t)(HAL_HOST_pinLevel(port,pin) << pin);
+			}
+			HAL_HOST_io[index] = level;
+		}
+	}
+	UCSRA |= (1<<UDRE);
+
+	memcpy(&value,(const void *)reg,size);
+	return value;
+}
+
+void HAL_HOST_write(volatile void * reg,uint32_t value,uint8_t size){
+
+	uintptr_t address = (uintptr_t)reg;
+	uintptr_t start = (uintptr_t)HAL_HOST_io;
+	uint8_t index;
+	uint8_t byte = (uint8_t)value;
+
+	if(address < start || address >= start + HAL_HOST_IO_SIZE){
+		memcpy((void *)reg,&value,size);
+		return;
+	}
+
+	HAL_HOST_advance(1);
+	index = (uint8_t)(address - start);
+
+	if(index == IO_INDEX(UDR)){
+		/* transmit is instant : the frame (with TXB8 as its 9th bit) is
+		 * queued and TXC is set at once */
+		if(UCSRB & (1<<TXEN)){
+			uint8_t address = (uint8_t)(UCSRB & (1<<TXB8));
+			HAL_HOST_queuePush(&g_txQueue,(uint16_t)(byte | (address ? HAL_HOST_UART_BIT8 : 0)));
+			HAL_HOST_event(address ? HAL_HOST_EVENT_UART_ADDRESS : HAL_HOST_EVENT_UART_TX,byte);
+			UCSRA |= (1<<TXC);
+		}
+	}else if(index == IO_INDEX(UCSRA)){
+		/* TXC is cleared by writing 1 ,the other status bits are read only */
+		uint8_t status = UCSRA & (uint8_t)~((1<<U2X) | (1<<MPCM));
+		if(byte & (1<<TXC)){
+			status &= (uint8_t)~(1<<TXC);
+		}
+		UCSRA = (uint8_t)(status | (byte & ((1<<U2X) | (1<<MPCM))) | (1<<UDRE));
+	}else if(index == IO_INDEX(UCSRB)){
+		/* RXB8 is read only */
+		UCSRB = (uint8_t)((byte & ~(1<<RXB8)) | (UCSRB & (1<<RXB8)));
+	}else if(index == IO_INDEX(TIFR) || index == IO_INDEX(GIFR)){
+		HAL_HOST_io[index] &= (uint8_t)~byte;
+	}else if(index == IO_INDEX(ADCSRA)){
+		uint8_t flag = ADCSRA & (1<<ADIF);
+		if(byte & (1<<ADIF)){
+			flag = 0;
+		}
+		ADCSRA = (uint8_t)((byte & ~(1<<ADIF)) | flag);
+		if((byte & (1<<ADSC)) && (byte & (1<<ADEN)) && g_adcRemaining == 0){
+			HAL_HOST_adcStart();
+		}else if(!(byte & (1<<ADEN))){
+			g_adcRemaining = 0;
+			ADCSRA &= ~(1<<ADSC);
+		}
+	}else if(index == IO_INDEX(TWCR)){
+		HAL_HOST_twi(byte);
+	}else if(g_lcdAttached && index == g_portIndex[g_lcdCtrl]){
+		uint8_t old = HAL_HOST_io[index];
+		HAL_HOST_io[index] = byte;
+		if((old & (1<<g_lcdE)) && !(byte & (1<<g_lcdE))){
+			HAL_HOST_lcdLatch((uint8_t)(byte & (1<<g_lcdRs)),HAL_HOST_io[g_portIndex[g_lcdData]]);
+		}
+	}else{
+		memcpy((void *)reg,&value,size);
+	}
+}
+
+void HAL_HOST_setInterrupts(uint8_t enable){
+
+	if(enable){
+		SREG |= 0x80;
+	}else{
+		SREG &= 0x7F;
+	}
+}
+
+void HAL_HOST_advance(uint32_t cycles){
+
+	while(cycles--){
+		HAL_HOST_step();
+		HAL_HOST_interrupts();
+	}
+}
+
+void HAL_HOST_sleep(void){
+
+	uint32_t serviced = g_serviced;
+	uint8_t mode = MCUCR & SLEEP_MODE_MASK;
+
+	if(!(MCUCR & (1<<SE))){
+		HAL_HOST_advance(1);
+		return;
+	}
+	g_sleepMode = mode;
+	g_sleepLevel = (mode == 0) ? SLEEP_LEVEL_IDLE :
+			(mode == SLEEP_MODE_ADC) ? SLEEP_LEVEL_ADC : SLEEP_LEVEL_POWER_DOWN;
+
+	while(g_serviced == serviced){
+		if(g_idleHook != NULL){
+			g_idleHook();
+		}
+		HAL_HOST_advance(1);
+	}
+
+	g_sleepMode = HAL_HOST_AWAKE;
+	if(g_sleepLevel == SLEEP_LEVEL_POWER_DOWN){
+		/* the oscillator starts again (after the ISR here ,the order does not
+		 * change the timing of the application) */
+		HAL_HOST_advance(SLEEP_WAKE_UP_CYCLES);
+	}
+	g_sleepLevel = SLEEP_LEVEL_IDLE;
+}
+
+void HAL_HOST_setIdleHook(void (*a_hook)(void)){
+	g_idleHook = a_hook;
+}
+
+uint8_t HAL_HOST_getSleepMode(void){
+	return g_sleepMode;
+}
+
+uint64_t HAL_HOST_getPowerCount(uint8_t counter){
+	return (counter < HAL_HOST_POWER_COUNTERS) ? g_powerCount[counter] : 0;
+}
+
+void HAL_HOST_setSyncHook(void (*a_hook)(void),uint32_t period){
+
+	g_syncHook = a_hook;
+	g_syncPeriod = period;
+	g_syncCount = 0;
+}
+
+void HAL_HOST_setEventHook(void (*a_hook)(uint8_t event,uint8_t data)){
+	g_eventHook = a_hook;
+}
+
+uint64_t HAL_HOST_getCycles(void){
+	return g_cycles;
+}
+
+uint8_t HAL_HOST_uartInject(uint16_t frame){
+
+	/* the receiver has no clock ,the frame passes on the line */
+	if(g_sleepMode != HAL_HOST_AWAKE && g_sleepLevel != SLEEP_LEVEL_IDLE){
+		g_powerCount[HAL_HOST_POWER_LOST_BYTES]++;
+		return 1;
+	}
+	if(!HAL_HOST_queuePush(&g_rxQueue,frame)){
+		return 0;
+	}
+	if(g_rxRemaining == 0){
+		g_rxRemaining = HAL_HOST_uartFrameCycles();
+	}
+	return 1;
+}
+
+uint8_t HAL_HOST_uartTake(uint16_t * a_frame){
+	return HAL_HOST_queuePop(&g_txQueue,a_frame);
+}
+
+void HAL_HOST_setPin(uint8_t port,uint8_t pin,uint8_t level){
+	g_external[port & 3][pin & 7] = level;
+}
+
+void HAL_HOST_connectPins(uint8_t port,uint8_t pin1,uint8_t pin2,uint8_t connected){
+
+	uint8_t i;
+	PinConnection * free = NULL;
+
+	for(i = 0; i < GPIO_CONNECTIONS_NUM; i++){
+		PinConnection * c = &g_connections[i];
+		if(c->connected && c->port == port &&
+				((c->pin1 == pin1 && c->pin2 == pin2) || (c->pin1 == pin2 && c->pin2 == pin1))){
+			c->connected = connected;
+			return;
+		}
+		if(!c->connected && free == NULL){
+			free = c;
+		}
+	}
+	if(connected && free != NULL){
+		free->port = port;
+		free->pin1 = pin1;
+		free->pin2 = pin2;
+		free->connected = 1;
+	}
+}
+
+uint8_t HAL_HOST_getPin(uint8_t port,uint8_t pin){
+	return HAL_HOST_pinLevel(port & 3,pin & 7);
+}
+
+void HAL_HOST_setAdcInput(uint8_t channel,uint16_t value){
+	g_adcInput[channel & 7] = value & 0x3FF;
+}
+
+uint8_t * HAL_HOST_eepromMemory(void){
+
+	HAL_HOST_eepromInit();
+	return g_eeprom;
+}
+
+void HAL_HOST_lcdAttach(uint8_t ctrlPort,uint8_t rsPin,uint8_t enablePin,uint8_t dataPort){
+
+	g_lcdCtrl = ctrlPort & 3;
+	g_lcdRs = rsPin & 7;
+	g_lcdE = enablePin & 7;
+	g_lcdData = dataPort & 3;
+	memset(g_lcdDdram,' ',sizeof(g_lcdDdram));
+	memset(g_lcdCgram,0,sizeof(g_lcdCgram));
+	g_lcdAddress = 0;
+	g_lcdCgramMode = 0;
+	g_lcdIncrement = 1;
+	g_lcdBusyUntil = g_cycles + US_TO_CYCLES(LCD_POWER_ON_US);
+	g_lcdIgnored = 0;
+	g_lcdAttached = 1;
+}
+
+const char * HAL_HOST_lcdLine(uint8_t row){
+
+	uint8_t column,dotRow;
+
+	memcpy(g_lcdLine,&g_lcdDdram[(row & 1) * 0x40],HAL_HOST_LCD_COLUMNS);
+	g_lcdLine[HAL_HOST_LCD_COLUMNS] = '\0';
+	/* a CGRAM character (0x00..0x0F ,8 bytes per code modulo 8) is shown by
+	 * its number of dot columns lit on any row */
+	for(column = 0; column < HAL_HOST_LCD_COLUMNS; column++){
+		uint8_t code = (uint8_t)g_lcdLine[column];
+		uint8_t dots = 0;
+		if(code >= 0x10){
+			continue;
+		}
+		for(dotRow = 0; dotRow < 8; dotRow++){
+			dots |= g_lcdCgram[(code & 7) * 8 + dotRow];
+		}
+		g_lcdLine[column] = '0';
+		for(; dots != 0; dots >>= 1){
+			g_lcdLine[column] = (char)(g_lcdLine[column] + (dots & 1));
+		}
+	}
+	return g_lcdLine;
+}
+
+const uint8_t * HAL_HOST_lcdCgram(void){
+	return g_lcdCgram;
+}
+
+uint32_t HAL_HOST_lcdIgnored(void){
+	return g_lcdIgnored;
+}
+
+char * itoa(int value,char * str,int radix){
+
+	char buffer[8 * sizeof(int) + 1];
+	uint8_t length = 0;
+	uint8_t i = 0;
+	unsigned int number = (unsigned int)value;
+
+	if(radix < 2 || radix > 36){
+		str[0] = '\0';
+		return str;
+	}
+	if(radix == 10 && value < 0){
+		str[i++] = '-';
+		number = 0U - number;
+	}
+	do{
+		uint8_t digit = (uint8_t)(number % (unsigned int)radix);
+		buffer[length++] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+		number /= (unsigned int)radix;
+	}while(number != 0);
+	while(length > 0){
+		str[i++] = buffer[--length];
+	}
+	str[i] = '\0';
+	return str;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+/* one CPU cycle of the peripherals */
+static void HAL_HOST_step(void){
+
+	uint8_t clockStopped = (g_sleepMode != HAL_HOST_AWAKE && g_sleepLevel != SLEEP_LEVEL_IDLE);
+
+	g_cycles++;
+
+	if(g_sleepMode == HAL_HOST_AWAKE){
+		g_powerCount[HAL_HOST_POWER_ACTIVE]++;
+	}else{
+		g_powerCount[clockStopped ? HAL_HOST_POWER_DOWN : HAL_HOST_POWER_IDLE]++;
+	}
+	if(ADCSRA & (1<<ADEN)){
+		g_powerCount[HAL_HOST_POWER_ADC_ON]++;
+	}
+
+	if(!clockStopped){
+		HAL_HOST_timer8(0);
+		HAL_HOST_timer1();
+		HAL_HOST_timer8(2);
+		if(g_twiRemaining != 0 && --g_twiRemaining == 0){
+			HAL_HOST_twiDone();
+		}
+		if(g_rxRemaining != 0 && --g_rxRemaining == 0){
+			HAL_HOST_uartReceive();
+		}
+	}
+
+	if(g_sleepLevel != SLEEP_LEVEL_POWER_DOWN && g_adcRemaining != 0 && --g_adcRemaining == 0){
+		uint16_t result = g_adcInput[ADMUX & 0x07];
+		if(ADMUX & (1<<ADLAR)){
+			result = (uint16_t)(result << 6);
+		}
+		ADC = result;
+		ADCSRA = (uint8_t)((ADCSRA & ~(1<<ADSC)) | (1<<ADIF));
+		if((ADCSRA & (1<<ADATE)) && (SFIOR >> 5) == 0){
+			HAL_HOST_adcStart();
+		}
+	}
+
+	if(g_eepromBusy != 0){
+		g_eepromBusy--;
+	}
+
+	if(GICR & ((1<<INT0) | (1<<INT1) | (1<<INT2))){
+		HAL_HOST_externalInterrupts();
+	}else{
+		g_extEnabled = 0;
+	}
+
+	if(g_syncHook != NULL && ++g_syncCount >= g_syncPeriod){
+		g_syncCount = 0;
+		g_syncHook();
+	}
+}
+
+/* execute the highest priority pending interrupt */
+static void HAL_HOST_interrupts(void){
+
+	uint8_t i;
+
+	if(!(SREG & 0x80)){
+		return;
+	}
+	for(i = 0; i < sizeof(g_sources)/sizeof(g_sources[0]); i++){
+		const InterruptSource * s = &g_sources[i];
+		if((*s->flags & (1<<s->flagBit)) && (*s->enable & (1<<s->enableBit)) &&
+				(g_sleepMode == HAL_HOST_AWAKE || s->wakeLevel >= g_sleepLevel)){
+			if(s->autoClear){
+				*s->flags &= (uint8_t)~(1<<s->flagBit);
+			}
+			SREG &= 0x7F;
+			g_serviced++;
+			s->vector();
+			SREG |= 0x80;
+			return;
+		}
+	}
+}
+
+/* edges and low levels of the INT0 ,INT1 and INT2 pins ,a pin is watched from
+ * the cycle its interrupt is enabled */
+static void HAL_HOST_externalInterrupts(void){
+
+	static const uint8_t s_ports[EXT_INTERRUPTS_NUM] = {HAL_HOST_PORTD,HAL_HOST_PORTD,HAL_HOST_PORTB};
+	static const uint8_t s_pins[EXT_INTERRUPTS_NUM] = {2,3,2};
+	static const uint8_t s_bits[EXT_INTERRUPTS_NUM] = {INT0,INT1,INT2};
+	uint8_t i;
+
+	for(i = 0; i < EXT_INTERRUPTS_NUM; i++){
+		uint8_t level,sense,trigger;
+
+		if(!(GICR & (1<<s_bits[i]))){
+			g_extEnabled &= (uint8_t)~(1<<i);
+			continue;
+		}
+		level = HAL_HOST_pinLevel(s_ports[i],s_pins[i]);
+		if(!(g_extEnabled & (1<<i))){
+			g_extEnabled |= (uint8_t)(1<<i);
+			g_extLevel[i] = level;
+		}
+		/* ISCn1:0 : 0 low level ,1 any change ,2 falling ,3 rising edge ,
+		 * INT2 has only ISC2 (0 falling ,1 rising) */
+		if(i < 2){
+			sense = (MCUCR >> (2*i)) & 3;
+		}else{
+			sense = (MCUCSR & (1<<ISC2)) ? 3 : 2;
+		}
+		switch(sense){
+		case 0:  trigger = !level; break;
+		case 1:  trigger = (level != g_extLevel[i]); break;
+		case 2:  trigger = g_extLevel[i] && !level; break;
+		default: trigger = !g_extLevel[i] && level; break;
+		}
+		g_extLevel[i] = level;
+		/* the flags of GIFR have the same bit numbers as the enables of GICR */
+		if(trigger){
+			GIFR |= (uint8_t)(1<<s_bits[i]);
+		}
+	}
+}
+
+/* set a TIFR flag ,a rising flag can trigger the ADC */
+static void HAL_HOST_setTimerFlag(uint8_t bit){
+
+	if(TIFR & (1<<bit)){
+		return;
+	}
+	TIFR |= (uint8_t)(1<<bit);
+	switch(bit){
+	case OCF0:  HAL_HOST_adcTrigger(3); break;
+	case TOV0:  HAL_HOST_adcTrigger(4); break;
+	case OCF1B: HAL_HOST_adcTrigger(5); break;
+	case TOV1:  HAL_HOST_adcTrigger(6); break;
+	case ICF1:  HAL_HOST_adcTrigger(7); break;
+	default: break;
+	}
+}
+
+/* TIMER0 or TIMER2 : normal ,phase correct PWM ,CTC and fast PWM modes */
+static void HAL_HOST_timer8(uint8_t timer){
+
+	static const uint16_t s_prescalers0[8] = {0,1,8,64,256,1024,0,0};
+	static const uint16_t s_prescalers2[8] = {0,1,8,32,64,128,256,1024};
+	volatile uint8_t * control = (timer == 0) ? &TCCR0 : &TCCR2;
+	volatile uint8_t * counter = (timer == 0) ? &TCNT0 : &TCNT2;
+	uint8_t compare = (timer == 0) ? OCR0 : OCR2;
+	uint8_t compareFlag = (timer == 0) ? OCF0 : OCF2;
+	uint8_t overflowFlag = (timer == 0) ? TOV0 : TOV2;
+	uint16_t prescaler = (timer == 0) ? s_prescalers0[*control & 7] : s_prescalers2[*control & 7];
+	uint8_t mode;
+
+	/* external clock sources of TIMER0 are not modeled */
+	if(prescaler == 0 || ++g_prescaleCount[timer] < prescaler){
+		return;
+	}
+	g_prescaleCount[timer] = 0;
+
+	mode = (uint8_t)(((*control >> 6) & 1) | (((*control >> 3) & 1) << 1));
+
+	if(mode == 1){
+		/* phase correct : up to 0xFF ,down to 0 */
+		if(!g_countDown[timer]){
+			if(*counter == 0xFF){
+				g_countDown[timer] = 1;
+				(*counter)--;
+			}else{
+				(*counter)++;
+			}
+		}else{
+			if(*counter == 0){
+				g_countDown[timer] = 0;
+				HAL_HOST_setTimerFlag(overflowFlag);
+				(*counter)++;
+			}else{
+				(*counter)--;
+			}
+		}
+	}else{
+		uint8_t top = (mode == 2) ? compare : 0xFF;
+		if(*counter == top){
+			*counter = 0;
+			if(mode != 2 || top == 0xFF){
+				HAL_HOST_setTimerFlag(overflowFlag);
+			}
+		}else{
+			(*counter)++;
+		}
+	}
+	if(*counter == compare){
+		HAL_HOST_setTimerFlag(compareFlag);
+	}
+}
+
+/* TIMER1 : all 16 waveform generation modes */
+static void HAL_HOST_timer1(void){
+
+	static const uint16_t s_prescalers[8] = {0,1,8,64,256,1024,0,0};
+	uint16_t prescaler = s_prescalers[TCCR1B & 7];
+	uint8_t mode = (uint8_t)((TCCR1A & 3) | (((TCCR1B >> WGM12) & 3) << 2));
+	uint16_t counter = TCNT1;
+	uint16_t top;
+	uint8_t phaseCorrect;
+
+	if(prescaler == 0 || ++g_prescaleCount[1] < prescaler){
+		return;
+	}
+	g_prescaleCount[1] = 0;
+
+	switch(mode){
+	case 1: case 5: top = 0x00FF; break;
+	case 2: case 6: top = 0x01FF; break;
+	case 3: case 7: top = 0x03FF; break;
+	case 4: case 9: case 11: case 15: top = OCR1A; break;
+	case 8: case 10: case 12: case 14: top = ICR1; break;
+	default: top = 0xFFFF; break;
+	}
+	phaseCorrect = (mode >= 1 && mode <= 3) || (mode >= 8 && mode <= 11);
+
+	if(phaseCorrect){
+		if(!g_countDown[1]){
+			if(counter >= top){
+				g_countDown[1] = 1;
+				counter--;
+				if(mode == 8 || mode == 10){
+					HAL_HOST_setTimerFlag(ICF1);
+				}
+			}else{
+				counter++;
+			}
+		}else{
+			if(counter == 0){
+				g_countDown[1] = 0;
+				HAL_HOST_setTimerFlag(TOV1);
+				counter++;
+			}else{
+				counter--;
+			}
+		}
+	}else{
+		if(counter == top){
+			counter = 0;
+			/* CTC modes overflow only at 0xFFFF */
+			if((mode != 4 && mode != 12) || top == 0xFFFF){
+				HAL_HOST_setTimerFlag(TOV1);
+			}
+			if(mode == 12 || mode == 14){
+				HAL_HOST_setTimerFlag(ICF1);
+			}
+		}else{
+			counter++;
+		}
+	}
+	TCNT1 = counter;
+	if(counter == OCR1A){
+		HAL_HOST_setTimerFlag(OCF1A);
+	}
+	if(counter == OCR1B){
+		HAL_HOST_setTimerFlag(OCF1B);
+	}
+}
+
+/* a conversion takes 13 ADC clocks */
+static void HAL_HOST_adcStart(void){
+
+	static const uint8_t s_prescalers[8] = {2,2,4,8,16,32,64,128};
+
+	g_adcRemaining = 13UL * s_prescalers[ADCSRA & 7];
+	ADCSRA |= (1<<ADSC);
+}
+
+static void HAL_HOST_adcTrigger(uint8_t source){
+
+	if((ADCSRA & (1<<ADEN)) && (ADCSRA & (1<<ADATE)) &&
+			(SFIOR >> 5) == source && g_adcRemaining == 0){
+		HAL_HOST_adcStart();
+	}
+}
+
+/* TWI master with the M24C16 as the only slave ,an operation ends (TWINT set
+ * or TWSTO cleared) after its SCL periods */
+static void HAL_HOST_twi(uint8_t control){
+
+	uint8_t status = TW_NO_INFO;
+	uint32_t period = 16UL + 2UL * TWBR * (1UL << (2 * (TWSR & 0x03)));
+
+	/* an operation started before the last one ended waits for it */
+	if(g_twiRemaining != 0){
+		g_twiRemaining = 0;
+		HAL_HOST_twiDone();
+	}
+
+	/* TWINT is cleared by writing 1 ,nothing happens without it */
+	TWCR = (uint8_t)(control & ~(1<<TWINT));
+	if(!(control & (1<<TWINT)) || !(control & (1<<TWEN))){
+		return;
+	}
+
+	if(control & (1<<TWSTO)){
+		if(g_twiSelected && !g_twiRead && g_eepromWriting){
+			HAL_HOST_eepromCommit();
+		}
+		g_twiStarted = 0;
+		g_twiSelected = 0;
+		HAL_HOST_event(HAL_HOST_EVENT_TWI_STOP,0);
+		g_twiStopping = 1;
+		g_twiRemaining = TWI_CONDITION_BITS * period;
+		return;
+	}
+
+	if(control & (1<<TWSTA)){
+		if(g_twiSelected && !g_twiRead && g_eepromWriting){
+			HAL_HOST_eepromCommit();
+		}
+		status = g_twiStarted ? TW_REP_START : TW_START;
+		HAL_HOST_event(HAL_HOST_EVENT_TWI_START,0);
+		g_twiStarted = 1;
+		g_twiSelected = 0;
+		g_twiRead = 0;
+		g_twiStatus = status;
+		g_twiRemaining = TWI_CONDITION_BITS * period;
+		return;
+	}else if(g_twiStarted && !g_twiSelected && !g_twiRead){
+		/* address byte */
+		uint8_t sla = TWDR;
+		HAL_HOST_event(HAL_HOST_EVENT_TWI_WRITE,sla);
+		uint8_t ack = ((sla & 0xF0) == EEPROM_DEVICE_CODE) && g_eepromBusy == 0;
+		g_twiRead = sla & 1;
+		if(!ack){
+			status = g_twiRead ? TW_MR_SLA_NACK : TW_MT_SLA_NACK;
+			g_twiRead = 0;
+		}else{
+			g_twiSelected = 1;
+			/* the block bits are the high bits of the address */
+			g_eepromAddress = (uint16_t)(((sla & 0x0E) << 7) | (g_eepromAddress & 0xFF));
+			g_eepromAddressBytes = 0;
+			g_eepromWriting = 0;
+			status = g_twiRead ? TW_MR_SLA_ACK : TW_MT_SLA_ACK;
+		}
+	}else if(g_twiSelected && !g_twiRead){
+		/* data byte from the master : word address then data */
+		uint8_t data = TWDR;
+		HAL_HOST_event(HAL_HOST_EVENT_TWI_WRITE,data);
+		if(g_eepromAddressBytes == 0){
+			g_eepromAddress = (uint16_t)((g_eepromAddress & 0x700) | data);
+			g_eepromAddressBytes = 1;
+			memset(g_eepromPageUsed,0,sizeof(g_eepromPageUsed));
+		}else{
+			uint8_t offset = g_eepromAddress % EEPROM_PAGE_SIZE;
+			g_eepromPage[offset] = data;
+			g_eepromPageUsed[offset] = 1;
+			g_eepromWriting = 1;
+			/* the address rolls over inside the page */
+			g_eepromAddress = (uint16_t)((g_eepromAddress & ~(EEPROM_PAGE_SIZE - 1)) |
+					((offset + 1) % EEPROM_PAGE_SIZE));
+		}
+		status = TW_MT_DATA_ACK;
+	}else if(g_twiSelected && g_twiRead){
+		/* data byte to the master ,the address rolls over the whole memory */
+		TWDR = g_eeprom[g_eepromAddress];
+		HAL_HOST_event(HAL_HOST_EVENT_TWI_READ,TWDR);
+		g_eepromAddress = (uint16_t)((g_eepromAddress + 1) % HAL_HOST_EEPROM_SIZE);
+		status = (control & (1<<TWEA)) ? TW_MR_DATA_ACK : TW_MR_DATA_NACK;
+	}
+
+	g_twiStatus = status;
+	g_twiRemaining = TWI_BYTE_BITS * period;
+}
+
+/* end of the running bus operation */
+static void HAL_HOST_twiDone(void){
+
+	if(g_twiStopping){
+		g_twiStopping = 0;
+		TWCR &= ~(1<<TWSTO);
+		TWSR = (uint8_t)((TWSR & 0x03) | TW_NO_INFO);
+	}else{
+		TWSR = (uint8_t)((TWSR & 0x03) | g_twiStatus);
+		TWCR |= (1<<TWINT);
+	}
+}
+
+/* the write cycle starts at the STOP condition */
+static void HAL_HOST_eepromCommit(void){
+
+	uint16_t page = (uint16_t)(g_eepromAddress & ~(EEPROM_PAGE_SIZE - 1));
+	uint8_t i;
+
+	for(i = 0; i < EEPROM_PAGE_SIZE; i++){
+		if(g_eepromPageUsed[i]){
+			g_eeprom[page + i] = g_eepromPage[i];
+		}
+	}
+	g_eepromWriting = 0;
+	g_eepromBusy = (uint32_t)((uint64_t)g_cpuFrequency * EEPROM_WRITE_MS / 1000UL);
+}
+
+static void HAL_HOST_eepromInit(void){
+
+	if(!g_eepromReady){
+		memset(g_eeprom,0xFF,sizeof(g_eeprom));
+		g_eepromReady = 1;
+	}
+}
+
+/* level of a pin : output ,switch to an output ,external level ,pull up */
+static uint8_t HAL_HOST_pinLevel(uint8_t port,uint8_t pin){
+
+	uint8_t ddr = HAL_HOST_portOf(port,1);
+	uint8_t out = HAL_HOST_portOf(port,0);
+	uint8_t pullUp = !(SFIOR & (1<<PUD));
+	uint8_t i;
+
+	if(ddr & (1<<pin)){
+		return (out >> pin) & 1;
+	}
+	for(i = 0; i < GPIO_CONNECTIONS_NUM; i++){
+		PinConnection * c = &g_connections[i];
+		uint8_t other;
+		if(!c->connected || c->port != port || (c->pin1 != pin && c->pin2 != pin)){
+			continue;
+		}
+		other = (c->pin1 == pin) ? c->pin2 : c->pin1;
+		if(ddr & (1<<other)){
+			return (out >> other) & 1;
+		}
+	}
+	if(g_external[port][pin] != GPIO_RELEASED){
+		return g_external[port][pin];
+	}
+	return pullUp && (out & (1<<pin));
+}
+
+/* offset 0 : PORTx ,1 : DDRx ,2 : PINx */
+static uint8_t HAL_HOST_portOf(uint8_t index,uint8_t offset){
+	return HAL_HOST_io[g_portIndex[index] - offset];
+}
+
+/* HD44780 in 8 bits mode ,2 lines of 40 characters */
+static void HAL_HOST_lcdLatch(uint8_t rs,uint8_t data){
+
+	if(g_cycles < g_lcdBusyUntil){
+		g_lcdIgnored++;
+		return;
+	}
+	g_lcdBusyUntil = g_cycles + US_TO_CYCLES(rs ? LCD_WRITE_US :
+			(data == 0x01 || (data & 0xFE) == 0x02) ? LCD_CLEAR_US : LCD_EXECUTION_US);
+
+	if(rs){
+		if(g_lcdCgramMode){
+			g_lcdCgram[g_lcdAddress & 0x3F] = data & 0x1F;
+			g_lcdAddress = (uint8_t)((g_lcdAddress + 1) & 0x3F);
+		}else{
+			g_lcdDdram[g_lcdAddress] = data;
+			HAL_HOST_event(HAL_HOST_EVENT_LCD_DATA,data);
+			if(g_lcdIncrement){
+				g_lcdAddress++;
+				if(g_lcdAddress == 0x28){
+					g_lcdAddress = 0x40;
+				}else if(g_lcdAddress == 0x68){
+					g_lcdAddress = 0x00;
+				}
+			}else{
+				g_lcdAddress = (g_lcdAddress == 0x00) ? 0x67 :
+						(g_lcdAddress == 0x40) ? 0x27 : (uint8_t)(g_lcdAddress - 1);
+			}
+		}
+		return;
+	}
+
+	if(data & 0x80){
+		g_lcdAddress = data & 0x7F;
+		if(g_lcdAddress >= LCD_DDRAM_SIZE || (g_lcdAddress >= 0x28 && g_lcdAddress < 0x40)){
+			g_lcdAddress = 0;
+		}
+		g_lcdCgramMode = 0;
+	}else if(data & 0x40){
+		g_lcdAddress = data & 0x3F;
+		g_lcdCgramMode = 1;
+	}else if(data & 0x20){
+		/* function set : only 8 bits mode is modeled */
+	}else if(data & 0x10){
+		/* cursor shift */
+		if(!(data & 0x08)){
+			g_lcdAddress = (data & 0x04) ? (uint8_t)((g_lcdAddress + 1) % LCD_DDRAM_SIZE) :
+					(uint8_t)((g_lcdAddress + LCD_DDRAM_SIZE - 1) % LCD_DDRAM_SIZE);
+		}
+	}else if(data & 0x08){
+		/* display on/off control */
+	}else if(data & 0x04){
+		g_lcdIncrement = (data >> 1) & 1;
+	}else if(data & 0x02){
+		g_lcdAddress = 0;
+		g_lcdCgramMode = 0;
+	}else if(data & 0x01){
+		memset(g_lcdDdram,' ',sizeof(g_lcdDdram));
+		g_lcdAddress = 0;
+		g_lcdCgramMode = 0;
+		g_lcdIncrement = 1;
+	}
+}
+
+static void HAL_HOST_event(uint8_t event,uint8_t data){
+
+	if(g_eventHook != NULL){
+		g_eventHook(event,data);
+	}
+}
+
+static uint8_t HAL_HOST_queuePush(UartQueue * queue,uint16_t frame){
+
+	if(queue->count == UART_QUEUE_SIZE){
+		return 0;
+	}
+	queue->data[(queue->head + queue->count) % UART_QUEUE_SIZE] = frame;
+	queue->count++;
+	return 1;
+}
+
+static uint8_t HAL_HOST_queuePop(UartQueue * queue,uint16_t * a_frame){
+
+	if(queue->count == 0){
+		return 0;
+	}
+	*a_frame = queue->data[queue->head];
+	queue->head = (uint16_t)((queue->head + 1) % UART_QUEUE_SIZE);
+	queue->count--;
+	return 1;
+}
+
+/* start bit ,data bits ,parity and stop bits at the baud rate of UBRR */
+static uint32_t HAL_HOST_uartFrameCycles(void){
+
+	uint16_t ubrr = (uint16_t)(((UBRRH & 0x0F) << 8) | UBRRL);
+	uint8_t bits = (uint8_t)(1 + 5 + ((UCSRC >> UCSZ0) & 3) + ((UCSRB & (1<<UCSZ2)) ? 1 : 0) +
+			((UCSRC & (1<<UPM1)) ? 1 : 0) + ((UCSRC & (1<<USBS)) ? 2 : 1));
+
+	return (uint32_t)bits * ((UCSRA & (1<<U2X)) ? 8 : 16) * (ubrr + 1);
+}
+
+/* the frame on the line is complete : to UDR ,or skipped by the multi
+ * processor filter (MPCM) when its 9th bit is clear */
+static void HAL_HOST_uartReceive(void){
+
+	uint16_t frame;
+
+	if(UCSRA & (1<<RXC)){
+		/* UDR not read yet ,the frame waits (overrun is not modeled) */
+		g_rxRemaining = 1;
+		return;
+	}
+	if(!HAL_HOST_queuePop(&g_rxQueue,&frame)){
+		return;
+	}
+	if(!(UCSRB & (1<<RXEN))){
+		/* receiver off ,the frame is not seen */
+	}else if((UCSRA & (1<<MPCM)) && !(frame & HAL_HOST_UART_BIT8)){
+		g_powerCount[HAL_HOST_POWER_FILTERED]++;
+	}else{
+		UDR = (uint8_t)frame;
+		UCSRB = (uint8_t)((UCSRB & ~(1<<RXB8)) | ((frame & HAL_HOST_UART_BIT8) ? (1<<RXB8) : 0));
+		UCSRA |= (1<<RXC);
+		g_powerCount[HAL_HOST_POWER_RX_FRAMES]++;
+	}
+	if(g_rxQueue.count != 0){
+		g_rxRemaining = HAL_HOST_uartFrameCycles();
+	}
+}
+
+/*******************************************************************************
+ *                  Default (empty) Interrupt Service Routines                 *
+ *******************************************************************************/
+
+HAL_HOST_WEAK void INT0_vect(void){}
+HAL_HOST_WEAK void INT1_vect(void){}
+HAL_HOST_WEAK void TIMER2_COMP_vect(void){}
+HAL_HOST_WEAK void TIMER2_OVF_vect(void){}
+HAL_HOST_WEAK void TIMER1_CAPT_vect(void){}
+HAL_HOST_WEAK void TIMER1_COMPA_vect(void){}
+HAL_HOST_WEAK void TIMER1_COMPB_vect(void){}
+HAL_HOST_WEAK void TIMER1_OVF_vect(void){}
+HAL_HOST_WEAK void TIMER0_OVF_vect(void){}
+HAL_HOST_WEAK void SPI_STC_vect(void){}
+HAL_HOST_WEAK void USART_RXC_vect(void){}
+HAL_HOST_WEAK void USART_UDRE_vect(void){}
+HAL_HOST_WEAK void USART_TXC_vect(void){}
+HAL_HOST_WEAK void ADC_vect(void){}
+HAL_HOST_WEAK void EE_RDY_vect(void){}
+HAL_HOST_WEAK void ANA_COMP_vect(void){}
+HAL_HOST_WEAK void TWI_vect(void){}
+HAL_HOST_WEAK void INT2_vect(void){}
+HAL_HOST_WEAK void TIMER0_COMP_vect(void){}
+HAL_HOST_WEAK void SPM_RDY_vect(void){}
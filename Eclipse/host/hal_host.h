@@ -0,0 +1,199 @@
+/******************************************************************************
+ *
+ * Module: Host Build
+ *
+ * File Name: hal_host.h
+ *
+ * Description: software model of the ATmega16 peripherals used by the host
+ * 				(Linux) build of the drivers
+ * 				1- the registers are bytes of HAL_HOST_io[] (see avr/io.h)
+ * 				2- HAL_READ/HAL_WRITE of hal.h call HAL_HOST_read/HAL_HOST_write
+ * 				   which run the side effects of the register and let one CPU
+ * 				   cycle pass (so busy waits on a flag finish)
+ * 				3- modeled : timers 0/1/2 (counting ,compare ,overflow ,flags
+ * 				   and interrupts) ,USART (instant transmit ,every frame
+ * 				   received in the time of its bits at the baud rate ,9 bits
+ * 				   frames and the multi processor filter MPCM) ,
+ * 				   TWI master with an M24C16 EEPROM on the bus (every START ,
+ * 				   byte and STOP takes its SCL periods) ,ADC ,GPIO pins
+ * 				   (pull ups ,switches between 2 pins) ,external interrupts
+ * 				   INT0/1/2 and an HD44780 LCD in 8 bits mode on any 2 ports
+ * 				   (busy after power on and after every write ,a write while
+ * 				   it is busy is ignored and counted)
+ * 				4- sleep modes : idle stops only the CPU ,ADC noise reduction
+ * 				   also the timers and the USART ,the other modes the ADC too
+ * 				   (TIMER2 has no asynchronous clock) ,only the interrupts
+ * 				   allowed by the mode wake up the CPU ,a byte received while
+ * 				   the USART is stopped is lost
+ * 				5- the cycles of every power state are counted to estimate
+ * 				   the supply current
+ * 				6- output compare pins and the prescaler reset are not modeled
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef HAL_HOST_H_
+#define HAL_HOST_H_
+
+#include <stdint.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* data memory addresses 0x00..0x5F are the registers ,UCSRC is kept after them */
+#define HAL_HOST_UCSRC_INDEX 0x60
+#define HAL_HOST_IO_SIZE     0x61
+
+/* ports for the GPIO and LCD functions */
+#define HAL_HOST_PORTA 0
+#define HAL_HOST_PORTB 1
+#define HAL_HOST_PORTC 2
+#define HAL_HOST_PORTD 3
+
+/* size of the M24C16 memory */
+#define HAL_HOST_EEPROM_SIZE 2048
+
+/* events reported to the event hook */
+#define HAL_HOST_EVENT_UART_TX   0   /* data : transmitted byte */
+#define HAL_HOST_EVENT_TWI_START 1
+#define HAL_HOST_EVENT_TWI_WRITE 2   /* data : address or data byte from the master */
+#define HAL_HOST_EVENT_TWI_READ  3   /* data : byte read by the master */
+#define HAL_HOST_EVENT_TWI_STOP  4
+#define HAL_HOST_EVENT_LCD_DATA  5   /* data : character written to the LCD display memory */
+#define HAL_HOST_EVENT_UART_ADDRESS 6   /* data : transmitted frame with its 9th bit set (TXB8) */
+
+/* counters of HAL_HOST_getPowerCount */
+#define HAL_HOST_POWER_ACTIVE     0   /* cycles running code */
+#define HAL_HOST_POWER_IDLE       1   /* cycles in idle mode */
+#define HAL_HOST_POWER_DOWN       2   /* cycles in a mode stopping the I/O clock */
+#define HAL_HOST_POWER_ADC_ON     3   /* cycles with the ADC enabled (ADEN) */
+#define HAL_HOST_POWER_LOST_BYTES 4   /* UART bytes received while the USART was stopped */
+#define HAL_HOST_POWER_RX_FRAMES  5   /* UART frames put in UDR (one RXC each) */
+#define HAL_HOST_POWER_FILTERED   6   /* UART data frames skipped by the MPCM filter */
+#define HAL_HOST_POWER_COUNTERS   7
+
+/* 9th bit of a UART frame (TXB8 ,RXB8) */
+#define HAL_HOST_UART_BIT8 0x100
+
+/* HAL_HOST_getSleepMode while the CPU runs */
+#define HAL_HOST_AWAKE 0xFF
+
+/* characters of an LCD line returned by HAL_HOST_lcdLine */
+#define HAL_HOST_LCD_COLUMNS 16
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+extern volatile uint8_t HAL_HOST_io[HAL_HOST_IO_SIZE];
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description : put all registers and peripherals in their reset state
+ * 	(the EEPROM memory keeps its data) and set the CPU clock used for the
+ * 	EEPROM write cycle time
+ */
+void HAL_HOST_reset(uint32_t cpuFrequency);
+
+/*
+ * Description : access a register through the model (used by hal.h) ,any other
+ * 	address is read or written as a normal variable
+ */
+uint32_t HAL_HOST_read(const volatile void * reg,uint8_t size);
+void HAL_HOST_write(volatile void * reg,uint32_t value,uint8_t size);
+
+/*
+ * Description : set or clear the I bit of SREG (sei/cli)
+ */
+void HAL_HOST_setInterrupts(uint8_t enable);
+
+/*
+ * Description : let CPU cycles pass ,the peripherals run and the enabled
+ * 	interrupts are serviced (one per cycle)
+ */
+void HAL_HOST_advance(uint32_t cycles);
+
+/*
+ * Description : sleep_cpu ,if the SE bit is set run in the mode of MCUCR until
+ * 	an interrupt is serviced ,the idle hook (if any) is called every cycle
+ * 	while sleeping (a test can stop there)
+ */
+void HAL_HOST_sleep(void);
+void HAL_HOST_setIdleHook(void (*a_hook)(void));
+
+/*
+ * Description : SM2:0 bits of the running sleep mode (SLEEP_MODE_xxx) or
+ * 	HAL_HOST_AWAKE ,and the power counters since the last reset
+ */
+uint8_t HAL_HOST_getSleepMode(void);
+uint64_t HAL_HOST_getPowerCount(uint8_t counter);
+
+/*
+ * Description : call a hook every period cycles (a co-simulation switches
+ * 	to the other micro there)
+ */
+void HAL_HOST_setSyncHook(void (*a_hook)(void),uint32_t period);
+
+/*
+ * Description : call a hook for every UART byte sent and TWI bus event
+ * 	(used to record traces)
+ */
+void HAL_HOST_setEventHook(void (*a_hook)(uint8_t event,uint8_t data));
+
+/*
+ * Description : number of CPU cycles since the last reset
+ */
+uint64_t HAL_HOST_getCycles(void);
+
+/*
+ * Description : USART ,put a frame on the receive line (return 0 if the
+ * 	queue is full) and take the next transmitted frame (return 0 if nothing
+ * 	was sent) ,HAL_HOST_UART_BIT8 is the 9th bit
+ */
+uint8_t HAL_HOST_uartInject(uint16_t frame);
+uint8_t HAL_HOST_uartTake(uint16_t * a_frame);
+
+/*
+ * Description : GPIO ,drive an input pin from outside (level 0 or 1 ,
+ * 	2 to release it) ,connect 2 pins of a port (a pressed switch) and read
+ * 	the level of a pin
+ */
+void HAL_HOST_setPin(uint8_t port,uint8_t pin,uint8_t level);
+void HAL_HOST_connectPins(uint8_t port,uint8_t pin1,uint8_t pin2,uint8_t connected);
+uint8_t HAL_HOST_getPin(uint8_t port,uint8_t pin);
+
+/*
+ * Description : ADC ,value (0..1023) converted on a channel
+ */
+void HAL_HOST_setAdcInput(uint8_t channel,uint16_t value);
+
+/*
+ * Description : the memory of the M24C16 on the TWI bus
+ */
+uint8_t * HAL_HOST_eepromMemory(void);
+
+/*
+ * Description : LCD ,connect the model to the control pins RS ,E and the data
+ * 	port then read the characters of a line (the returned string is
+ * 	overwritten by the next call ,a CGRAM character is shown as the digit
+ * 	of its lit dot columns) or the CGRAM (64 bytes)
+ */
+void HAL_HOST_lcdAttach(uint8_t ctrlPort,uint8_t rsPin,uint8_t enablePin,uint8_t dataPort);
+const char * HAL_HOST_lcdLine(uint8_t row);
+const uint8_t * HAL_HOST_lcdCgram(void);
+
+/*
+ * Description : LCD ,number of writes ignored because the controller was
+ * 	still busy (power on or the execution of the previous write)
+ */
+uint32_t HAL_HOST_lcdIgnored(void);
+
+/* avr-libc extension of stdlib.h used by the LCD driver */
+char * itoa(int value,char * str,int radix);
+
+#endif /* HAL_HOST_H_ */
@@ -0,0 +1,161 @@
+/******************************************************************************
+ *
+ * Module: Hash Benchmark
+ *
+ * File Name: hash_bench.c
+ *
+ * Description: known answers and speed of the MC1 SHA-256 (sha256.h)
+ * 				1- the FIPS 180-4 and RFC 4231 vectors are checked first ,a
+ * 				   wrong answer fails the run (exit code 1)
+ * 				2- then the time per 64 bytes block is measured
+ * 				the tool is built for both variants (hash_bench and
+ * 				hash_bench_unrolled) ,on the host the ratio of the 2 times
+ * 				tells what the unrolling gains ,not the AVR cycles
+ *
+ * 				usage : hash_bench [blocks]
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#define _GNU_SOURCE
+#include "sha256.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define BENCH_DEFAULT_BLOCKS 200000
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef struct{
+	const char * name;
+	const char * key;      /* NULL for a plain SHA-256 */
+	uint8 keyRepeat;       /* key is one byte repeated ,0 for a string key */
+	const char * message;
+	uint32 repeat;         /* times the message is hashed */
+	const char * digest;   /* hex */
+}KnownAnswer;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static const KnownAnswer g_knownAnswers[] = {
+		{"sha256 empty",NULL,0,"",1,
+				"e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+		{"sha256 abc",NULL,0,"abc",1,
+				"ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+		{"sha256 2 blocks",NULL,0,"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",1,
+				"248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+		{"sha256 million a",NULL,0,"a",1000000,
+				"cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"},
+		{"hmac rfc4231 1","\x0b",20,"Hi There",1,
+				"b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7"},
+		{"hmac rfc4231 2","Jefe",0,"what do ya want for nothing?",1,
+				"5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"},
+		{"hmac rfc4231 6","\xaa",131,"Test Using Larger Than Block-Size Key - Hash Key First",1,
+				"60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54"},
+};
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static int BENCH_check(const KnownAnswer * a_answer);
+static double BENCH_nowNs(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(int argc,char * argv[]){
+
+	uint32 blocks = (argc > 1) ? (uint32)strtoul(argv[1],NULL,0) : BENCH_DEFAULT_BLOCKS;
+	Sha256ContextType context;
+	uint8 block[SHA256_BLOCK_SIZE];
+	uint8 digest[SHA256_DIGEST_SIZE];
+	uint32 i;
+	int failed = 0;
+	double start,ns;
+
+	printf("variant %s\n",SHA256_UNROLL ? "unrolled" : "compact");
+	for(i = 0; i < sizeof(g_knownAnswers)/sizeof(g_knownAnswers[0]); i++){
+		int ok = BENCH_check(&g_knownAnswers[i]);
+		printf("%-20s %s\n",g_knownAnswers[i].name,ok ? "ok" : "FAIL");
+		failed |= !ok;
+	}
+	if(failed || blocks == 0){
+		return failed;
+	}
+
+	memset(block,0X5A,sizeof(block));
+	SHA256_init(&context);
+	start = BENCH_nowNs();
+	for(i = 0; i < blocks; i++){
+		SHA256_update(&context,block,sizeof(block));
+	}
+	SHA256_final(&context,digest);
+	ns = BENCH_nowNs() - start;
+
+	printf("%lu blocks  %.1f ns/block  %.2f MB/s\n",(unsigned long)blocks,ns/blocks,
+			blocks*(double)SHA256_BLOCK_SIZE*1000.0/ns);
+	return 0;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+static int BENCH_check(const KnownAnswer * a_answer){
+
+	uint8 digest[SHA256_DIGEST_SIZE];
+	char hex[2*SHA256_DIGEST_SIZE + 1];
+	uint16 length = (uint16)strlen(a_answer->message);
+	uint32 i;
+
+	if(a_answer->key == NULL){
+		Sha256ContextType context;
+
+		SHA256_init(&context);
+		for(i = 0; i < a_answer->repeat; i++){
+			SHA256_update(&context,(const uint8 *)a_answer->message,length);
+		}
+		SHA256_final(&context,digest);
+	}else{
+		HmacSha256ContextType context;
+		uint8 key[255];
+		uint8 keyLength = a_answer->keyRepeat;
+
+		if(keyLength == 0){
+			keyLength = (uint8)strlen(a_answer->key);
+			memcpy(key,a_answer->key,keyLength);
+		}else{
+			memset(key,a_answer->key[0],keyLength);
+		}
+		HMAC_SHA256_init(&context,key,keyLength);
+		for(i = 0; i < a_answer->repeat; i++){
+			HMAC_SHA256_update(&context,(const uint8 *)a_answer->message,length);
+		}
+		HMAC_SHA256_final(&context,digest);
+	}
+
+	for(i = 0; i < SHA256_DIGEST_SIZE; i++){
+		sprintf(&hex[2*i],"%02x",digest[i]);
+	}
+	return strcmp(hex,a_answer->digest) == 0;
+}
+
+static double BENCH_nowNs(void){
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return now.tv_sec*1e9 + now.tv_nsec;
+}
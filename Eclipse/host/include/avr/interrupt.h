@@ -0,0 +1,24 @@
+/******************************************************************************
+ *
+ * Module: Host Build
+ *
+ * File Name: avr/interrupt.h
+ *
+ * Description: interrupts for the host build ,the I bit is the bit 7 of the
+ * 				modeled SREG and an ISR is called by the peripherals model
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef HOST_AVR_INTERRUPT_H_
+#define HOST_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+#define ISR(VECTOR) void VECTOR(void)
+
+#define sei() HAL_HOST_setInterrupts(1)
+#define cli() HAL_HOST_setInterrupts(0)
+
+#endif /* HOST_AVR_INTERRUPT_H_ */
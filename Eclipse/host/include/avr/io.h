@@ -0,0 +1,319 @@
+/******************************************************************************
+ *
+ * Module: Host Build
+ *
+ * File Name: avr/io.h
+ *
+ * Description: ATmega16 registers for the host build ,every register is a byte
+ * 				of HAL_HOST_io[] at its data memory address (I/O address + 0x20)
+ * 				so the drivers compile unchanged and the peripherals model in
+ * 				hal_host.c sees the same memory
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef HOST_AVR_IO_H_
+#define HOST_AVR_IO_H_
+
+#include <stdint.h>
+#include "hal_host.h"
+
+#define _SFR_IO8(ADDRESS)  (HAL_HOST_io[(ADDRESS) + 0x20])
+#define _SFR_IO16(ADDRESS) (*(volatile uint16_t *)&HAL_HOST_io[(ADDRESS) + 0x20])
+
+/*******************************************************************************
+ *                              Registers                                      *
+ *******************************************************************************/
+
+#define TWBR    _SFR_IO8(0x00)
+#define TWSR    _SFR_IO8(0x01)
+#define TWAR    _SFR_IO8(0x02)
+#define TWDR    _SFR_IO8(0x03)
+#define ADCL    _SFR_IO8(0x04)
+#define ADCH    _SFR_IO8(0x05)
+#define ADCSRA  _SFR_IO8(0x06)
+#define ADMUX   _SFR_IO8(0x07)
+#define ACSR    _SFR_IO8(0x08)
+#define UBRRL   _SFR_IO8(0x09)
+#define UCSRB   _SFR_IO8(0x0A)
+#define UCSRA   _SFR_IO8(0x0B)
+#define UDR     _SFR_IO8(0x0C)
+#define SPCR    _SFR_IO8(0x0D)
+#define SPSR    _SFR_IO8(0x0E)
+#define SPDR    _SFR_IO8(0x0F)
+#define PIND    _SFR_IO8(0x10)
+#define DDRD    _SFR_IO8(0x11)
+#define PORTD   _SFR_IO8(0x12)
+#define PINC    _SFR_IO8(0x13)
+#define DDRC    _SFR_IO8(0x14)
+#define PORTC   _SFR_IO8(0x15)
+#define PINB    _SFR_IO8(0x16)
+#define DDRB    _SFR_IO8(0x17)
+#define PORTB   _SFR_IO8(0x18)
+#define PINA    _SFR_IO8(0x19)
+#define DDRA    _SFR_IO8(0x1A)
+#define PORTA   _SFR_IO8(0x1B)
+#define EECR    _SFR_IO8(0x1C)
+#define EEDR    _SFR_IO8(0x1D)
+#define EEARL   _SFR_IO8(0x1E)
+#define EEARH   _SFR_IO8(0x1F)
+#define UBRRH   _SFR_IO8(0x20)
+#define WDTCR   _SFR_IO8(0x21)
+#define ASSR    _SFR_IO8(0x22)
+#define OCR2    _SFR_IO8(0x23)
+#define TCNT2   _SFR_IO8(0x24)
+#define TCCR2   _SFR_IO8(0x25)
+#define ICR1L   _SFR_IO8(0x26)
+#define ICR1H   _SFR_IO8(0x27)
+#define OCR1BL  _SFR_IO8(0x28)
+#define OCR1BH  _SFR_IO8(0x29)
+#define OCR1AL  _SFR_IO8(0x2A)
+#define OCR1AH  _SFR_IO8(0x2B)
+#define TCNT1L  _SFR_IO8(0x2C)
+#define TCNT1H  _SFR_IO8(0x2D)
+#define TCCR1B  _SFR_IO8(0x2E)
+#define TCCR1A  _SFR_IO8(0x2F)
+#define SFIOR   _SFR_IO8(0x30)
+#define OSCCAL  _SFR_IO8(0x31)
+#define TCNT0   _SFR_IO8(0x32)
+#define TCCR0   _SFR_IO8(0x33)
+#define MCUCSR  _SFR_IO8(0x34)
+#define MCUCR   _SFR_IO8(0x35)
+#define TWCR    _SFR_IO8(0x36)
+#define SPMCR   _SFR_IO8(0x37)
+#define TIFR    _SFR_IO8(0x38)
+#define TIMSK   _SFR_IO8(0x39)
+#define GIFR    _SFR_IO8(0x3A)
+#define GICR    _SFR_IO8(0x3B)
+#define OCR0    _SFR_IO8(0x3C)
+#define SPL     _SFR_IO8(0x3D)
+#define SPH     _SFR_IO8(0x3E)
+#define SREG    _SFR_IO8(0x3F)
+
+/* UCSRC shares its address with UBRRH on the device (selected by URSEL) ,
+ * the model keeps it in a byte of its own after the I/O space */
+#define UCSRC   (HAL_HOST_io[HAL_HOST_UCSRC_INDEX])
+
+/* 16 bits registers (low byte at the lower address as on the device) */
+#define ADC     _SFR_IO16(0x04)
+#define ADCW    _SFR_IO16(0x04)
+#define EEAR    _SFR_IO16(0x1E)
+#define ICR1    _SFR_IO16(0x26)
+#define OCR1B   _SFR_IO16(0x28)
+#define OCR1A   _SFR_IO16(0x2A)
+#define TCNT1   _SFR_IO16(0x2C)
+#define SP      _SFR_IO16(0x3D)
+
+/*******************************************************************************
+ *                                 Bits                                        *
+ *******************************************************************************/
+
+#define OCIE2 7
+#define TOIE2 6
+#define TICIE1 5
+#define OCIE1A 4
+#define OCIE1B 3
+#define TOIE1 2
+#define OCIE0 1
+#define TOIE0 0
+#define OCF2 7
+#define TOV2 6
+#define ICF1 5
+#define OCF1A 4
+#define OCF1B 3
+#define TOV1 2
+#define OCF0 1
+#define TOV0 0
+#define FOC0 7
+#define WGM00 6
+#define COM01 5
+#define COM00 4
+#define WGM01 3
+#define CS02 2
+#define CS01 1
+#define CS00 0
+#define FOC2 7
+#define WGM20 6
+#define COM21 5
+#define COM20 4
+#define WGM21 3
+#define CS22 2
+#define CS21 1
+#define CS20 0
+#define COM1A1 7
+#define COM1A0 6
+#define COM1B1 5
+#define COM1B0 4
+#define FOC1A 3
+#define FOC1B 2
+#define WGM11 1
+#define WGM10 0
+#define ICNC1 7
+#define ICES1 6
+#define WGM13 4
+#define WGM12 3
+#define CS12 2
+#define CS11 1
+#define CS10 0
+#define RXC 7
+#define TXC 6
+#define UDRE 5
+#define FE 4
+#define DOR 3
+#define PE 2
+#define U2X 1
+#define MPCM 0
+#define RXCIE 7
+#define TXCIE 6
+#define UDRIE 5
+#define RXEN 4
+#define TXEN 3
+#define UCSZ2 2
+#define RXB8 1
+#define TXB8 0
+#define URSEL 7
+#define UMSEL 6
+#define UPM1 5
+#define UPM0 4
+#define USBS 3
+#define UCSZ1 2
+#define UCSZ0 1
+#define UCPOL 0
+#define TWINT 7
+#define TWEA 6
+#define TWSTA 5
+#define TWSTO 4
+#define TWWC 3
+#define TWEN 2
+#define TWIE 0
+#define TWS7 7
+#define TWS6 6
+#define TWS5 5
+#define TWS4 4
+#define TWS3 3
+#define TWPS1 1
+#define TWPS0 0
+#define REFS1 7
+#define REFS0 6
+#define ADLAR 5
+#define MUX4 4
+#define MUX3 3
+#define MUX2 2
+#define MUX1 1
+#define MUX0 0
+#define ADEN 7
+#define ADSC 6
+#define ADATE 5
+#define ADIF 4
+#define ADIE 3
+#define ADPS2 2
+#define ADPS1 1
+#define ADPS0 0
+#define ADTS2 7
+#define ADTS1 6
+#define ADTS0 5
+#define ACME 3
+#define PUD 2
+#define PSR2 1
+#define PSR10 0
+#define SM2 7
+#define SE 6
+#define SM1 5
+#define SM0 4
+#define ISC11 3
+#define ISC10 2
+#define ISC01 1
+#define ISC00 0
+#define INT1 7
+#define INT0 6
+#define INT2 5
+#define IVSEL 1
+#define IVCE 0
+#define INTF1 7
+#define INTF0 6
+#define INTF2 5
+#define JTD 7
+#define ISC2 6
+#define JTRF 4
+#define WDRF 3
+#define BORF 2
+#define EXTRF 1
+#define PORF 0
+#define ACD 7
+#define ACBG 6
+#define ACO 5
+#define ACI 4
+#define ACIE 3
+#define ACIC 2
+#define ACIS1 1
+#define ACIS0 0
+#define SPIE 7
+#define SPE 6
+#define DORD 5
+#define MSTR 4
+#define CPOL 3
+#define CPHA 2
+#define SPR1 1
+#define SPR0 0
+#define PA0 0
+#define PA1 1
+#define PA2 2
+#define PA3 3
+#define PA4 4
+#define PA5 5
+#define PA6 6
+#define PA7 7
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PC6 6
+#define PC7 7
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+
+/*******************************************************************************
+ *                          Interrupt Vectors                                  *
+ *******************************************************************************/
+
+/* an ISR is a normal function called by the model ,vectors not defined by the
+ * drivers have an empty weak definition in hal_host.c */
+void INT0_vect(void);
+void INT1_vect(void);
+void TIMER2_COMP_vect(void);
+void TIMER2_OVF_vect(void);
+void TIMER1_CAPT_vect(void);
+void TIMER1_COMPA_vect(void);
+void TIMER1_COMPB_vect(void);
+void TIMER1_OVF_vect(void);
+void TIMER0_OVF_vect(void);
+void SPI_STC_vect(void);
+void USART_RXC_vect(void);
+void USART_UDRE_vect(void);
+void USART_TXC_vect(void);
+void ADC_vect(void);
+void EE_RDY_vect(void);
+void ANA_COMP_vect(void);
+void TWI_vect(void);
+void INT2_vect(void);
+void TIMER0_COMP_vect(void);
+void SPM_RDY_vect(void);
+
+#endif /* HOST_AVR_IO_H_ */
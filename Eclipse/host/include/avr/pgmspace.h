@@ -0,0 +1,32 @@
+/******************************************************************************
+ *
+ * Module: Host Build
+ *
+ * File Name: avr/pgmspace.h
+ *
+ * Description: flash access for the host build ,flash tables are normal
+ * 				constant data
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef HOST_AVR_PGMSPACE_H_
+#define HOST_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(STR) (STR)
+
+#define pgm_read_byte(ADDRESS)  (*(const uint8_t *)(ADDRESS))
+#define pgm_read_word(ADDRESS)  (*(const uint16_t *)(ADDRESS))
+#define pgm_read_dword(ADDRESS) (*(const uint32_t *)(ADDRESS))
+#define pgm_read_ptr(ADDRESS)   (*(void * const *)(ADDRESS))
+
+#define memcpy_P(DEST,SRC,SIZE) memcpy((DEST),(SRC),(SIZE))
+#define strlen_P(STR)           strlen(STR)
+
+#endif /* HOST_AVR_PGMSPACE_H_ */
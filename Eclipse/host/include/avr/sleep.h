@@ -0,0 +1,33 @@
+/******************************************************************************
+ *
+ * Module: Host Build
+ *
+ * File Name: avr/sleep.h
+ *
+ * Description: sleep modes for the host build ,sleeping runs the peripherals
+ * 				model until an interrupt is serviced
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef HOST_AVR_SLEEP_H_
+#define HOST_AVR_SLEEP_H_
+
+#include <avr/io.h>
+
+/* SM2:0 values in MCUCR */
+#define SLEEP_MODE_IDLE         0x00
+#define SLEEP_MODE_ADC          0x10
+#define SLEEP_MODE_PWR_DOWN     0x20
+#define SLEEP_MODE_PWR_SAVE     0x30
+#define SLEEP_MODE_STANDBY      0xA0
+#define SLEEP_MODE_EXT_STANDBY  0xB0
+
+#define set_sleep_mode(MODE) (MCUCR = (MCUCR & 0x4F) | (MODE))
+#define sleep_enable()       (MCUCR |= (1<<SE))
+#define sleep_disable()      (MCUCR &= ~(1<<SE))
+#define sleep_cpu()          HAL_HOST_sleep()
+#define sleep_mode()         do{ sleep_enable(); sleep_cpu(); sleep_disable(); }while(0)
+
+#endif /* HOST_AVR_SLEEP_H_ */
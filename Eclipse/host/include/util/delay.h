@@ -0,0 +1,26 @@
+/******************************************************************************
+ *
+ * Module: Host Build
+ *
+ * File Name: util/delay.h
+ *
+ * Description: busy waits for the host build ,the time passes in the
+ * 				peripherals model (timers run ,interrupts are serviced)
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef HOST_UTIL_DELAY_H_
+#define HOST_UTIL_DELAY_H_
+
+#include <avr/io.h>
+
+#ifndef F_CPU
+#error "F_CPU must be defined before util/delay.h"
+#endif
+
+#define _delay_ms(MS) HAL_HOST_advance((uint32_t)((double)(F_CPU) * (MS) / 1000.0))
+#define _delay_us(US) HAL_HOST_advance((uint32_t)((double)(F_CPU) * (US) / 1000000.0))
+
+#endif /* HOST_UTIL_DELAY_H_ */
@@ -0,0 +1,224 @@
+/******************************************************************************
+ *
+ * Module: LCD Benchmark
+ *
+ * File Name: lcd_bench.c
+ *
+ * Description: known answers and cost of the LCD formatter (LCD_printf_P of
+ * 				lcd.h) on the HD44780 of the ATmega16 model
+ * 				1- every 16 bits value is printed by %5u and %6d and the line
+ * 				   of the LCD is compared with the host printf ,then the
+ * 				   widths ,flags ,%x ,%s ,%c and %% ,a wrong answer fails the
+ * 				   run (exit code 1)
+ * 				2- then LCD_printf_P "%d" is compared with itoa and
+ * 				   LCD_displayString (the old LCD_intgerToString) and with
+ * 				   sprintf to a buffer and LCD_displayString : LCD bytes ,LCD
+ * 				   bus time (us) and host time per value
+ * 				the bus time is the LCD delays and the register accesses of
+ * 				the model ,so it is the same for all the paths printing the
+ * 				same bytes ,it is not the time of the conversion ,on the host
+ * 				the ratio of the times tells what the conversion costs
+ * 				the flash size and the AVR cycles are not measured here (the
+ * 				host sprintf is not the one of avr-libc) ,they need an AVR
+ * 				build : avr-size of MC2 with each path and the cycles of the
+ * 				simulator of the ATmega16
+ *
+ * 				usage : lcd_bench [loops]
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#define _GNU_SOURCE
+#include "lcd.h"
+#include "counters.h"
+#include "hal_host.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define BENCH_DEFAULT_LOOPS 20000
+
+/* wiring of the LCD (lcd.h) : control on PORTD ,data on PORTC */
+#define BENCH_PORTC 2
+#define BENCH_PORTD 3
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef struct{
+	const char * format;
+	int value;
+	const char * expected;
+}KnownAnswer;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static const char g_name[] PROGMEM = "GATE";
+
+static const KnownAnswer g_knownAnswers[] = {
+		{"%u",0,"0"},
+		{"%02u:%02u",7,"07:07"},
+		{"%3u|",12345,"12345|"},
+		{"%d",-1,"-1"},
+		{"%5d|",-42,"  -42|"},
+		{"%05d|",-42,"-0042|"},
+		{"%d",-32768,"-32768"},
+		{"%x",0,"0"},
+		{"%x",0xBEEF,"beef"},
+		{"%04x",0x2A,"002a"},
+		{"%6s|",0,"GATE  |"},
+		{"%s|",0,"GATE|"},
+		{"%c%c",'A',"AA"},
+		{"100%%",0,"100%"},
+		{"end%",0,"end"},
+};
+
+/* values of the cost comparison */
+static const int g_values[] = {7,255,12345,-32768};
+
+/* paths of the cost comparison */
+static const char * const g_paths[] = {"LCD_printf_P","itoa+display","sprintf+display"};
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static int BENCH_checkAll(const char * format,int first,int last);
+static int BENCH_check(const KnownAnswer * a_answer);
+static const char * BENCH_line(uint8 length);
+static void BENCH_itoa(int value);
+static void BENCH_sprintf(int value);
+static double BENCH_nowNs(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(int argc,char * argv[]){
+
+	uint32 loops = (argc > 1) ? (uint32)strtoul(argv[1],NULL,0) : BENCH_DEFAULT_LOOPS;
+	int failed = 0;
+	uint32 i,j;
+
+	HAL_HOST_reset(F_CPU);
+	HAL_HOST_lcdAttach(BENCH_PORTD,RS,E,BENCH_PORTC);
+	LCD_init();
+
+	failed |= BENCH_checkAll("%5u",0,65535);
+	failed |= BENCH_checkAll("%6d",-32768,32767);
+	for(i = 0; i < sizeof(g_knownAnswers)/sizeof(g_knownAnswers[0]); i++){
+		int ok = BENCH_check(&g_knownAnswers[i]);
+		printf("%-20s %s\n",g_knownAnswers[i].format,ok ? "ok" : "FAIL");
+		failed |= !ok;
+	}
+	if(failed || loops == 0){
+		return failed;
+	}
+
+	printf("%-8s %-16s %9s %10s %12s\n","value","path","LCD bytes","LCD bus us","host ns");
+	for(i = 0; i < sizeof(g_values)/sizeof(g_values[0]); i++){
+		uint8 path;
+
+		for(path = 0; path < sizeof(g_paths)/sizeof(g_paths[0]); path++){
+			uint32 bytes = g_counters[COUNTER_LCD_BYTES];
+			uint64_t cycles = HAL_HOST_getCycles();
+			double start = BENCH_nowNs();
+
+			for(j = 0; j < loops; j++){
+				LCD_goToRowColumn(0,0);
+				if(path == 0){
+					LCD_printf_P(PSTR("%d"),g_values[i]);
+				}else if(path == 1){
+					BENCH_itoa(g_values[i]);
+				}else{
+					BENCH_sprintf(g_values[i]);
+				}
+			}
+			printf("%-8d %-16s %9.1f %10.1f %12.1f\n",g_values[i],g_paths[path],
+					(double)(g_counters[COUNTER_LCD_BYTES] - bytes) / loops,
+					(double)(HAL_HOST_getCycles() - cycles) * 1e6 / F_CPU / loops,
+					(BENCH_nowNs() - start) / loops);
+		}
+	}
+	return 0;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+/* every value of a range in a fixed width ,the same width is always written
+ * so the line needs no clear */
+static int BENCH_checkAll(const char * format,int first,int last){
+
+	char expected[16];
+	int value;
+
+	for(value = first; value <= last; value++){
+		LCD_goToRowColumn(0,0);
+		LCD_printf_P(format,value);
+		snprintf(expected,sizeof(expected),format,value);
+		if(strcmp(BENCH_line((uint8)strlen(expected)),expected) != 0){
+			printf("%-20s FAIL at %d : [%s]\n",format,value,BENCH_line((uint8)strlen(expected)));
+			return 1;
+		}
+	}
+	printf("%-20s ok (%d values)\n",format,last - first + 1);
+	return 0;
+}
+
+static int BENCH_check(const KnownAnswer * a_answer){
+
+	LCD_clearScreen();
+	if(strchr(a_answer->format,'s') != NULL){
+		LCD_printf_P(a_answer->format,g_name);
+	}else{
+		/* the same value for every conversion of the format */
+		LCD_printf_P(a_answer->format,a_answer->value,a_answer->value);
+	}
+	return strcmp(BENCH_line((uint8)strlen(a_answer->expected)),a_answer->expected) == 0;
+}
+
+/* the first characters of the first line */
+static const char * BENCH_line(uint8 length){
+
+	static char s_line[HAL_HOST_LCD_COLUMNS + 1];
+
+	memcpy(s_line,HAL_HOST_lcdLine(0),HAL_HOST_LCD_COLUMNS);
+	s_line[(length < HAL_HOST_LCD_COLUMNS) ? length : HAL_HOST_LCD_COLUMNS] = '\0';
+	return s_line;
+}
+
+/* LCD_intgerToString before the formatter */
+static void BENCH_itoa(int value){
+
+	char buff[16];
+
+	itoa(value,buff,10);
+	LCD_displayString(buff);
+}
+
+/* the line formatted to SRAM first ,then written */
+static void BENCH_sprintf(int value){
+
+	char buff[HAL_HOST_LCD_COLUMNS + 1];
+
+	snprintf(buff,sizeof(buff),"%d",value);
+	LCD_displayString(buff);
+}
+
+static double BENCH_nowNs(void){
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return now.tv_sec*1e9 + now.tv_nsec;
+}
@@ -0,0 +1,175 @@
+/******************************************************************************
+ *
+ * Module: Motor Test
+ *
+ * File Name: motor_test.c
+ *
+ * Description: registers and output of the MC1 motor PWM (motor.h) on the
+ * 				TIMER1 of the ATmega16 model
+ * 				1- after motor_init and motor_setDutyCycle : fast PWM mode 14
+ * 				   (WGM13:0) ,the prescaler ,ICR1 (TOP) ,OCR1A ,OCR1B and
+ * 				   the COM1A bits for 0 % ,mid and 100 % duty
+ * 				2- the model runs one PWM period and the enable pin (OC1A
+ * 				   set at BOTTOM and cleared after the match ,or PD5 when OC1A
+ * 				   is disconnected) is counted high : 0 % never ,100 % always
+ * 				   ,mid within one count
+ * 				a wrong answer fails the run (exit code 1)
+ *
+ * 				usage : motor_test
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#include "motor.h"
+#include "hal_host.h"
+#include <stdio.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* 500 Hz fits the counter without prescaler ,10 Hz needs F_CPU/8 or F_CPU/64 */
+#define TEST_FAST_FREQUENCY 500
+#define TEST_SLOW_FREQUENCY 10
+#if (F_CPU / TEST_SLOW_FREQUENCY / 8UL <= 0x10000UL)
+#define TEST_SLOW_PRESCALER 8UL
+#define TEST_SLOW_CS 2
+#else
+#define TEST_SLOW_PRESCALER 64UL
+#define TEST_SLOW_CS 3
+#endif
+
+#define TEST_FAST_TOP (F_CPU / TEST_FAST_FREQUENCY - 1)
+#define TEST_SLOW_TOP (F_CPU / TEST_SLOW_PRESCALER / TEST_SLOW_FREQUENCY - 1)
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef struct{
+	uint16 frequency;
+	uint8 init;        /* duty of motor_init */
+	uint8 duty;        /* duty of motor_setDutyCycle (same as init : not called) */
+	uint8 clockSelect; /* CS12:0 */
+	uint16 top;        /* ICR1 */
+}PwmCase;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static const PwmCase g_cases[] = {
+		{TEST_FAST_FREQUENCY,0,0,1,TEST_FAST_TOP},
+		{TEST_FAST_FREQUENCY,50,50,1,TEST_FAST_TOP},
+		{TEST_FAST_FREQUENCY,100,100,1,TEST_FAST_TOP},
+		{TEST_FAST_FREQUENCY,50,0,1,TEST_FAST_TOP},
+		{TEST_FAST_FREQUENCY,0,100,1,TEST_FAST_TOP},
+		{TEST_FAST_FREQUENCY,100,37,1,TEST_FAST_TOP},
+		{TEST_SLOW_FREQUENCY,25,25,TEST_SLOW_CS,TEST_SLOW_TOP},
+};
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static int TEST_case(const PwmCase * a_case);
+static uint32 TEST_highCounts(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(void){
+
+	uint8 i;
+	int failed = 0;
+
+	for(i = 0; i < sizeof(g_cases)/sizeof(g_cases[0]); i++){
+		failed |= TEST_case(&g_cases[i]);
+	}
+	return failed;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+static int TEST_case(const PwmCase * a_case){
+
+	MotorConfigType config = {a_case->frequency,a_case->init};
+	uint32 period = (uint32)a_case->top + 1;
+	uint32 compare = period * a_case->duty / 100;
+	uint32 expected,high;
+	uint8 mode14,connected;
+	int ok;
+
+	HAL_HOST_reset(F_CPU);
+	motor_init(&config);
+	if(a_case->duty != a_case->init){
+		motor_setDutyCycle(a_case->duty);
+	}
+	if(compare > a_case->top){
+		compare = a_case->top;
+	}
+
+	mode14 = (TCCR1A & 0x03) == (1<<WGM11) && (TCCR1B & 0x18) == ((1<<WGM13) | (1<<WGM12));
+	connected = (TCCR1A & ((1<<COM1A1) | (1<<COM1A0))) == (1<<COM1A1);
+	ok = mode14 && (TCCR1B & 0x07) == a_case->clockSelect && ICR1 == a_case->top &&
+			OCR1A == compare && OCR1B == compare/2 && (DDRD & (1<<PD5)) &&
+			connected == (a_case->duty != 0);
+
+	/* the pin over one period of the model */
+	high = TEST_highCounts();
+	if(a_case->duty == 0){
+		expected = 0;
+		ok = ok && high == 0;
+	}else if(a_case->duty == 100){
+		expected = period;
+		ok = ok && high == period;
+	}else{
+		expected = period * a_case->duty / 100;
+		ok = ok && high + 1 >= expected && high <= expected + 1;
+	}
+
+	printf("%4u Hz %3u%% -> %3u%%  ICR1 %5u  OCR1A %5u  COM1A %u%u  high %5lu/%lu (%lu)  %s\n",
+			a_case->frequency,a_case->init,a_case->duty,ICR1,OCR1A,
+			(TCCR1A>>COM1A1) & 1,(TCCR1A>>COM1A0) & 1,(unsigned long)high,(unsigned long)period,
+			(unsigned long)expected,ok ? "ok" : "FAIL");
+	motor_deInit();
+	return !ok;
+}
+
+/* counts of one period the enable pin is high ,fast PWM non inverting sets
+ * OC1A at BOTTOM and clears it at the count after TCNT1 == OCR1A */
+static uint32 TEST_highCounts(void){
+
+	uint32 counts = (uint32)ICR1 + 1;
+	uint32 high = 0;
+	uint32 i;
+	uint16 last;
+
+	/* start of a period */
+	while(TCNT1 != 0){
+		HAL_HOST_advance(1);
+	}
+	for(i = 0; i < counts; i++){
+		uint8 level;
+
+		if(TCCR1A & (1<<COM1A1)){
+			level = (TCNT1 <= OCR1A);
+		}else{
+			level = (PORTD >> PD5) & 1;
+		}
+		high += level;
+		last = TCNT1;
+		while(TCNT1 == last){
+			HAL_HOST_advance(1);
+		}
+		if(TCNT1 != last + 1 && !(last == ICR1 && TCNT1 == 0)){
+			/* not counting up to ICR1 ,no PWM period */
+			return 0xFFFFFFFFUL;
+		}
+	}
+	return high;
+}
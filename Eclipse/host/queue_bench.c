@@ -0,0 +1,252 @@
+/******************************************************************************
+ *
+ * Module: Queue Benchmark
+ *
+ * File Name: queue_bench.c
+ *
+ * Description: stress of the single producer ,single consumer queue
+ * 				(queue.h) ,2 threads stand for the ISR and the task
+ * 				1- the producer pushes a counting sequence with push and
+ * 				   pushBatch ,the consumer takes it with pop ,popBatch and
+ * 				   peekSpan then release ,in an order that changes with the
+ * 				   items ,every item must come once and in order ,a lost ,
+ * 				   repeated or torn item fails the run (exit code 1)
+ * 				2- the queues of 2 ,16 and 128 items are used (the smallest
+ * 				   is full or empty most of the time ,the largest wraps its 8
+ * 				   bits indices every 2 turns)
+ * 				3- the time per item of every queue is printed ,on the
+ * 				   host it shows the cost of the barriers and of the thread
+ * 				   switches (a full or empty queue yields) ,not the AVR cycles
+ *
+ * 				usage : queue_bench [items]
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#define _GNU_SOURCE
+#include "queue.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define BENCH_DEFAULT_ITEMS 2000000UL
+
+/* longest batch of the producer and of the consumer */
+#define BENCH_BATCH_MAX 7
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* an item is the sequence number and its complement ,a torn item does not
+ * match */
+typedef struct{
+	uint32 sequence;
+	uint32 check;
+}BenchItem;
+
+QUEUE_DEFINE(SmallQueue,BenchItem,2)
+QUEUE_DEFINE(MediumQueue,BenchItem,16)
+QUEUE_DEFINE(LargeQueue,BenchItem,128)
+
+/* one run : the generated functions of a queue and the items to move */
+typedef struct{
+	const char * name;
+	void * queue;
+	uint8 (*push)(void * a_queue,BenchItem item);
+	uint8 (*pushBatch)(void * a_queue,const BenchItem * a_items,uint8 length);
+	uint8 (*pop)(void * a_queue,BenchItem * a_item);
+	uint8 (*popBatch)(void * a_queue,BenchItem * a_items,uint8 length);
+	uint8 (*peekSpan)(void * a_queue,BenchItem ** a_span);
+	void (*release)(void * a_queue,uint8 length);
+	uint32 items;
+	uint32 errors;
+}BenchRun;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static SmallQueueType g_small;
+static MediumQueueType g_medium;
+static LargeQueueType g_large;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void * BENCH_producer(void * a_run);
+static void * BENCH_consumer(void * a_run);
+static uint32 BENCH_check(BenchRun * a_run,const BenchItem * a_item,uint32 expected);
+static double BENCH_nowNs(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/* the generated functions of a queue behind pointers of the same type */
+#define BENCH_ADAPT(NAME) \
+	static uint8 NAME##_benchPush(void * a_queue,BenchItem item){ \
+		return NAME##_push(a_queue,item); \
+	} \
+	static uint8 NAME##_benchPushBatch(void * a_queue,const BenchItem * a_items,uint8 length){ \
+		return NAME##_pushBatch(a_queue,a_items,length); \
+	} \
+	static uint8 NAME##_benchPop(void * a_queue,BenchItem * a_item){ \
+		return NAME##_pop(a_queue,a_item); \
+	} \
+	static uint8 NAME##_benchPopBatch(void * a_queue,BenchItem * a_items,uint8 length){ \
+		return NAME##_popBatch(a_queue,a_items,length); \
+	} \
+	static uint8 NAME##_benchPeekSpan(void * a_queue,BenchItem ** a_span){ \
+		return NAME##_peekSpan(a_queue,a_span); \
+	} \
+	static void NAME##_benchRelease(void * a_queue,uint8 length){ \
+		NAME##_release(a_queue,length); \
+	}
+
+#define BENCH_RUN(NAME,QUEUE,ITEMS) \
+	{#NAME,&(QUEUE),NAME##_benchPush,NAME##_benchPushBatch,NAME##_benchPop, \
+	 NAME##_benchPopBatch,NAME##_benchPeekSpan,NAME##_benchRelease,(ITEMS),0}
+
+BENCH_ADAPT(SmallQueue)
+BENCH_ADAPT(MediumQueue)
+BENCH_ADAPT(LargeQueue)
+
+int main(int argc,char * argv[]){
+
+	uint32 items = (argc > 1) ? (uint32)strtoul(argv[1],NULL,0) : BENCH_DEFAULT_ITEMS;
+	BenchRun runs[] = {
+			BENCH_RUN(SmallQueue,g_small,items),
+			BENCH_RUN(MediumQueue,g_medium,items),
+			BENCH_RUN(LargeQueue,g_large,items)
+	};
+	int failed = 0;
+	uint8 i;
+
+	SmallQueue_init(&g_small);
+	MediumQueue_init(&g_medium);
+	LargeQueue_init(&g_large);
+
+	for(i = 0; i < sizeof(runs)/sizeof(runs[0]); i++){
+		pthread_t producer,consumer;
+		double start = BENCH_nowNs();
+		double ns;
+
+		pthread_create(&consumer,NULL,BENCH_consumer,&runs[i]);
+		pthread_create(&producer,NULL,BENCH_producer,&runs[i]);
+		pthread_join(producer,NULL);
+		pthread_join(consumer,NULL);
+		ns = BENCH_nowNs() - start;
+
+		printf("%-12s %10lu items  %6.1f ns/item  %s\n",runs[i].name,(unsigned long)runs[i].items,
+				ns / runs[i].items,(runs[i].errors == 0) ? "ok" : "FAIL");
+		if(runs[i].errors != 0){
+			printf("%-12s %lu items lost ,repeated ,out of order or torn\n",runs[i].name,
+					(unsigned long)runs[i].errors);
+			failed = 1;
+		}
+	}
+	return failed;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+/* the ISR : single items and batches ,a full queue is tried again */
+static void * BENCH_producer(void * a_run){
+
+	BenchRun * run = a_run;
+	BenchItem batch[BENCH_BATCH_MAX];
+	uint32 next = 0;
+
+	while(next < run->items){
+		uint8 length = (uint8)(1 + next % BENCH_BATCH_MAX);
+		uint8 i;
+
+		if(length > run->items - next){
+			length = (uint8)(run->items - next);
+		}
+		for(i = 0; i < length; i++){
+			batch[i].sequence = next + i;
+			batch[i].check = ~(next + i);
+		}
+		if(length == 1){
+			length = run->push(run->queue,batch[0]);
+		}else{
+			length = run->pushBatch(run->queue,batch,length);
+		}
+		if(length == 0){
+			/* full : let the consumer run (the host may have one core) */
+			sched_yield();
+		}
+		next += length;
+	}
+	return NULL;
+}
+
+/* the task : pop ,batches and spans used in place */
+static void * BENCH_consumer(void * a_run){
+
+	BenchRun * run = a_run;
+	BenchItem batch[BENCH_BATCH_MAX];
+	BenchItem * span;
+	uint32 expected = 0;
+	uint8 length,i;
+
+	while(expected < run->items){
+		uint32 before = expected;
+
+		switch(expected % 3){
+		case 0:
+			if(run->pop(run->queue,&batch[0])){
+				expected = BENCH_check(run,&batch[0],expected);
+			}
+			break;
+		case 1:
+			length = run->popBatch(run->queue,batch,BENCH_BATCH_MAX);
+			for(i = 0; i < length; i++){
+				expected = BENCH_check(run,&batch[i],expected);
+			}
+			break;
+		default:
+			length = run->peekSpan(run->queue,&span);
+			for(i = 0; i < length; i++){
+				expected = BENCH_check(run,&span[i],expected);
+			}
+			run->release(run->queue,length);
+			break;
+		}
+		if(expected == before){
+			/* empty : let the producer run */
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+/* the next sequence number expected after this item */
+static uint32 BENCH_check(BenchRun * a_run,const BenchItem * a_item,uint32 expected){
+
+	if(a_item->sequence != expected || a_item->check != ~expected){
+		a_run->errors++;
+		/* go on from this item if it is a whole one */
+		return (a_item->check == ~a_item->sequence) ? a_item->sequence + 1 : expected + 1;
+	}
+	return expected + 1;
+}
+
+static double BENCH_nowNs(void){
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return now.tv_sec*1e9 + now.tv_nsec;
+}
@@ -0,0 +1,213 @@
+/******************************************************************************
+ *
+ * Module: Scheduler Benchmark
+ *
+ * File Name: scheduler_bench.c
+ *
+ * Description: post to run latency of the MC1 scheduler (scheduler.h) on the
+ * 				ATmega16 model ,from SCHEDULER_post to the first line of the
+ * 				task the event was posted to
+ * 				1- task to task : the lowest priority task posts to the
+ * 				   highest one ,with the middle one kept ready (its events
+ * 				   wait behind the higher priority)
+ * 				2- ISR to task : a TIMER0 compare interrupt posts while the
+ * 				   scheduler sleeps in idle mode (wake up ,ISR return ,pick
+ * 				   and dispatch)
+ * 				every event must run once ,in the order of the priorities ,a
+ * 				lost or reordered event fails the run (exit code 1)
+ * 				only the host time is printed ,it tells the cost of the C
+ * 				code ,the model has no cost per instruction so the AVR cycles
+ * 				of the dispatch are not measured here
+ *
+ * 				usage : scheduler_bench [events]
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#define _GNU_SOURCE
+#include "scheduler.h"
+#include "timers.h"
+#include "hal_host.h"
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define BENCH_DEFAULT_EVENTS 100000UL
+
+/* TIMER0 compare period of the ISR case (F_CPU/8 counts) */
+#define BENCH_TIMER0_COMPARE 100
+
+/* events of the benchmark */
+#define BENCH_EV_PING 1
+#define BENCH_EV_BUSY 2
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef struct{
+	const char * name;
+	uint32 samples;
+	double nsSum,nsMin,nsMax;
+}BenchLatency;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static jmp_buf g_exit;
+
+/* time of the last post ,events left of the run */
+static double g_postNs;
+static uint32 g_left;
+static uint32 g_errors;
+
+/* the middle task ran since the last ping (it must wait for the pings) */
+static uint8 g_busyRan;
+
+static BenchLatency g_taskLatency = {"task to task"};
+static BenchLatency g_isrLatency = {"ISR to task"};
+static BenchLatency * g_latency;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void BENCH_run(BenchLatency * a_latency,uint32 events,uint8 fromIsr);
+static void BENCH_post(SchedulerTaskId id,uint8 event);
+static void BENCH_highTask(uint8 event,uint8 data);
+static void BENCH_middleTask(uint8 event,uint8 data);
+static void BENCH_lowTask(uint8 event,uint8 data);
+static void BENCH_timer0(void);
+static void BENCH_print(const BenchLatency * a_latency);
+static double BENCH_nowNs(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(int argc,char * argv[]){
+
+	uint32 events = (argc > 1) ? (uint32)strtoul(argv[1],NULL,0) : BENCH_DEFAULT_EVENTS;
+
+	if(events == 0){
+		return 0;
+	}
+	BENCH_run(&g_taskLatency,events,FALSE);
+	BENCH_run(&g_isrLatency,events,TRUE);
+
+	printf("%-14s %9s %10s %10s %10s\n","post to run","events","avg ns","min ns","max ns");
+	BENCH_print(&g_taskLatency);
+	BENCH_print(&g_isrLatency);
+	if(g_errors != 0){
+		printf("%lu events lost or out of order  FAIL\n",(unsigned long)g_errors);
+		return 1;
+	}
+	return 0;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+static void BENCH_run(BenchLatency * a_latency,uint32 events,uint8 fromIsr){
+
+	TimersConfigType timerConfig = {COMPARE,F_CPU_8,1,TIMER0};
+	TimersCompareModeConfig compareConfig = {BENCH_TIMER0_COMPARE,0,OCN_DISCONNECTED,OCN_DISCONNECTED};
+
+	HAL_HOST_reset(F_CPU);
+	SCHEDULER_init();
+	SCHEDULER_addTask(LINK_TASK,BENCH_highTask);
+	SCHEDULER_addTask(GATE_TASK,BENCH_middleTask);
+	SCHEDULER_addTask(STORAGE_TASK,BENCH_lowTask);
+
+	a_latency->nsMin = 1e30;
+	g_latency = a_latency;
+	g_left = events;
+
+	if(fromIsr){
+		TIMERS_setCallBackTimer0(BENCH_timer0);
+		TIMERS_init(&timerConfig,&compareConfig);
+	}else{
+		BENCH_post(STORAGE_TASK,BENCH_EV_PING);
+	}
+	/* the tasks leave the scheduler after the last event */
+	if(setjmp(g_exit) == 0){
+		SCHEDULER_run();
+	}
+	cli();
+	TIMERS_deinit(TIMER0);
+}
+
+static void BENCH_post(SchedulerTaskId id,uint8 event){
+
+	g_postNs = BENCH_nowNs();
+	if(!SCHEDULER_post(id,event,0)){
+		g_errors++;
+	}
+}
+
+/* highest priority : takes the latency of every ping */
+static void BENCH_highTask(uint8 event,uint8 data){
+
+	double ns = BENCH_nowNs() - g_postNs;
+
+	if(event != BENCH_EV_PING || g_busyRan){
+		g_errors++;
+	}
+	g_latency->samples++;
+	g_latency->nsSum += ns;
+	if(ns < g_latency->nsMin){
+		g_latency->nsMin = ns;
+	}
+	if(ns > g_latency->nsMax){
+		g_latency->nsMax = ns;
+	}
+
+	if(--g_left == 0){
+		longjmp(g_exit,1);
+	}
+	if(g_latency == &g_taskLatency){
+		SCHEDULER_post(STORAGE_TASK,BENCH_EV_PING,0);
+	}
+}
+
+static void BENCH_middleTask(uint8 event,uint8 data){
+	g_busyRan = TRUE;
+}
+
+/* lowest priority : the middle one ran before it ,make it ready again then
+ * post the ping */
+static void BENCH_lowTask(uint8 event,uint8 data){
+	if(!g_busyRan && g_taskLatency.samples != 0){
+		g_errors++;
+	}
+	g_busyRan = FALSE;
+	SCHEDULER_post(GATE_TASK,BENCH_EV_BUSY,0);
+	BENCH_post(LINK_TASK,BENCH_EV_PING);
+}
+
+/* TIMER0 compare ISR call back ,the scheduler sleeps */
+static void BENCH_timer0(void){
+	g_busyRan = FALSE;
+	BENCH_post(LINK_TASK,BENCH_EV_PING);
+}
+
+static void BENCH_print(const BenchLatency * a_latency){
+	printf("%-14s %9lu %10.1f %10.1f %10.1f\n",a_latency->name,
+			(unsigned long)a_latency->samples,a_latency->nsSum/a_latency->samples,
+			a_latency->nsMin,a_latency->nsMax);
+}
+
+static double BENCH_nowNs(void){
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return now.tv_sec*1e9 + now.tv_nsec;
+}
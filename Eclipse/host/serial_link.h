@@ -0,0 +1,98 @@
+/******************************************************************************
+ *
+ * Module: Serial Link
+ *
+ * File Name: serial_link.h
+ *
+ * Description: bytes of the 9 bits bus frames on a host serial link (the
+ * 				gateway and the simulated doors)
+ * 				the encoding is the one a Linux serial port gives with PARMRK
+ * 				when its parity is set to space : an address frame (9th bit
+ * 				set) is a parity error
+ * 				1- address frame a   : ESCAPE ADDRESS a
+ * 				2- data frame ESCAPE : ESCAPE ESCAPE
+ * 				3- other data frames : the byte itself
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#ifndef SERIAL_LINK_H_
+#define SERIAL_LINK_H_
+
+#include <stdint.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define SERIAL_LINK_ESCAPE  0xFF
+#define SERIAL_LINK_ADDRESS 0x00
+
+/* 9th bit of a frame */
+#define SERIAL_LINK_BIT8 0x100
+
+/* longest encoding of a frame */
+#define SERIAL_LINK_FRAME_MAX 3
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* state of a decoder (the bytes of a frame may arrive in different reads) */
+typedef enum{
+	SERIAL_LINK_IDLE,     /* next byte starts a frame */
+	SERIAL_LINK_ESCAPED,  /* ESCAPE received */
+	SERIAL_LINK_ADDRESSED /* ESCAPE ADDRESS received */
+}SerialLinkDecoder;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/* bytes of a frame ,returns their number */
+static inline uint8_t SERIAL_LINK_encode(uint16_t frame,uint8_t * a_bytes){
+
+	if(frame & SERIAL_LINK_BIT8){
+		a_bytes[0] = SERIAL_LINK_ESCAPE;
+		a_bytes[1] = SERIAL_LINK_ADDRESS;
+		a_bytes[2] = (uint8_t)frame;
+		return 3;
+	}
+	if((uint8_t)frame == SERIAL_LINK_ESCAPE){
+		a_bytes[0] = SERIAL_LINK_ESCAPE;
+		a_bytes[1] = SERIAL_LINK_ESCAPE;
+		return 2;
+	}
+	a_bytes[0] = (uint8_t)frame;
+	return 1;
+}
+
+/* one byte of the link ,returns 1 and the frame when it is complete */
+static inline uint8_t SERIAL_LINK_decode(SerialLinkDecoder * a_decoder,uint8_t byte,uint16_t * a_frame){
+
+	switch(*a_decoder){
+	case SERIAL_LINK_IDLE:
+		if(byte == SERIAL_LINK_ESCAPE){
+			*a_decoder = SERIAL_LINK_ESCAPED;
+			return 0;
+		}
+		*a_frame = byte;
+		return 1;
+	case SERIAL_LINK_ESCAPED:
+		if(byte == SERIAL_LINK_ADDRESS){
+			*a_decoder = SERIAL_LINK_ADDRESSED;
+			return 0;
+		}
+		/* ESCAPE ESCAPE ,any other byte is not sent by the encoder */
+		*a_decoder = SERIAL_LINK_IDLE;
+		*a_frame = byte;
+		return 1;
+	default:
+		*a_decoder = SERIAL_LINK_IDLE;
+		*a_frame = (uint16_t)(SERIAL_LINK_BIT8 | byte);
+		return 1;
+	}
+}
+
+#endif /* SERIAL_LINK_H_ */
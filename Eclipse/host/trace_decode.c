@@ -0,0 +1,199 @@
+/******************************************************************************
+ *
+ * Module: Trace Decoder
+ *
+ * File Name: trace_decode.c
+ *
+ * Description: prints the timeline of a MC1 trace dump (trace.h)
+ * 				the dump is pulled from a door by the audit job of the
+ * 				gateway (gateway.c) ,MC1 sends it on the bus to the node
+ * 				asking for it ,the bytes before the dump header are skipped
+ *
+ * 				usage : trace_decode [dump file]
+ *
+ * Author: Ahmed Emad
+ *
+ *******************************************************************************/
+
+#include "trace.h"
+#include "systick.h"
+#include "system_states.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define TRACE_EVENT_NAME(NAME) #NAME,
+
+/* login latency budget of a password check (TRACE_PASSWORD_CYCLES) */
+#define PASSWORD_CHECK_BUDGET_MS 50
+
+/* unit of the argument of TRACE_PASSWORD_CYCLES */
+#define PASSWORD_CYCLES_UNIT 256UL
+
+/* reset to first screen budget ,MC1 must have sent the state before
+ * (TRACE_BOOT_LINKED) and unit of the boot time stamps */
+#define BOOT_BUDGET_MS 50
+#define BOOT_CYCLES_UNIT 256UL
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static const char * const g_eventNames[TRACE_EVENTS_NUM] = {
+		TRACE_EVENTS(TRACE_EVENT_NAME)
+};
+
+static const char * const g_systemStates[SYSTEM_STATES_NUM] = {
+		"NEW_PASSWORD","CHECK_PASSWORD_TO_LOG_IN","CHECK_PASSWORD_FOR_NEW_PASSWORD",
+		"VIEW_OPTIONS","OPENING_GATE","BUZZER_ON"
+};
+
+static const char * const g_gateStates[GATE_STATES_NUM] = {
+		"CLOSED","GATE_OPENING","OPENED","GATE_CLOSING","GATE_OBSTRUCTED",
+		"GATE_BLOCKED"
+};
+
+static const char * const g_timers[SYSTICK_TIMERS_NUM] = {
+		"GATE_TIMER","ALARM_TIMER","BUZZER_TIMER","STORAGE_TIMER","PROVISION_TIMER",
+		"PROGRESS_TIMER"
+};
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static int DECODE_open(const char * path);
+static int DECODE_readByte(int fd,uint8 * a_data);
+static void DECODE_printArgument(uint8 id,uint8 arg);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(int argc,char * argv[]){
+
+	int fd = (argc > 1) ? DECODE_open(argv[1]) : STDIN_FILENO;
+	uint8 previous = 0,data = 0;
+	uint8 count,i;
+	uint32 time = 0;
+	uint16 lastTick = 0;
+
+	if(fd < 0){
+		return 1;
+	}
+
+	/* skip the link bytes until the header */
+	do{
+		previous = data;
+		if(!DECODE_readByte(fd,&data)){
+			fprintf(stderr,"no trace dump found\n");
+			return 1;
+		}
+	}while(previous != TRACE_DUMP_MAGIC1 || data != TRACE_DUMP_MAGIC2);
+
+	if(!DECODE_readByte(fd,&count)){
+		fprintf(stderr,"truncated dump\n");
+		return 1;
+	}
+	printf("%u records ,tick %u ms\n",count,SYSTICK_PERIOD_MS);
+
+	for(i = 0; i < count; i++){
+		uint8 record[4];
+		uint8 j;
+		uint16 tick;
+
+		for(j = 0; j < 4; j++){
+			if(!DECODE_readByte(fd,&record[j])){
+				fprintf(stderr,"truncated dump after %u records\n",i);
+				return 1;
+			}
+		}
+		tick = (uint16)(record[0] | (record[1] << 8));
+
+		/* the 16 bits tick wraps ,the records are in time order */
+		time = (i == 0) ? tick : time + (uint16)(tick - lastTick);
+		lastTick = tick;
+
+		printf("%10.3f s  %-22s",(double)time * SYSTICK_PERIOD_MS / 1000.0,
+				(record[2] < TRACE_EVENTS_NUM) ? g_eventNames[record[2]] : "UNKNOWN");
+		DECODE_printArgument(record[2],record[3]);
+	}
+	return 0;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions(Private)                          *
+ *******************************************************************************/
+
+static int DECODE_open(const char * path){
+
+	int fd = open(path,O_RDONLY);
+
+	if(fd < 0){
+		perror(path);
+	}
+	return fd;
+}
+
+static int DECODE_readByte(int fd,uint8 * a_data){
+	return read(fd,a_data,1) == 1;
+}
+
+static void DECODE_printArgument(uint8 id,uint8 arg){
+
+	switch(id){
+	case TRACE_BOOT:
+	case TRACE_SYSTEM_STATE:
+		printf("%s\n",(arg < SYSTEM_STATES_NUM) ? g_systemStates[arg] : "?");
+		break;
+	case TRACE_GATE_STATE:
+	case TRACE_GATE_STALL:
+		printf("%s\n",(arg < GATE_STATES_NUM) ? g_gateStates[arg] : "?");
+		break;
+	case TRACE_TIMER_EXPIRED:
+		printf("%s\n",(arg < SYSTICK_TIMERS_NUM) ? g_timers[arg] : "?");
+		break;
+	case TRACE_PASSWORD_CYCLES:
+	{
+		/* the last unit is a saturated measurement */
+		double ms = arg * PASSWORD_CYCLES_UNIT * 1000.0 / F_CPU;
+		printf("%s%lu cycles ,%.1f ms at %lu Hz%s\n",(arg == 0XFF) ? ">= " : "",
+				arg * PASSWORD_CYCLES_UNIT,ms,F_CPU,
+				(ms > PASSWORD_CHECK_BUDGET_MS) ? " OVER BUDGET" : "");
+		break;
+	}
+	case TRACE_BOOT_LOADED:
+	case TRACE_BOOT_READY:
+	case TRACE_BOOT_LINKED:
+	{
+		double ms = arg * BOOT_CYCLES_UNIT * 1000.0 / F_CPU;
+		printf("%s%.1f ms after reset%s\n",(arg == 0XFF) ? ">= " : "",ms,
+				(id == TRACE_BOOT_LINKED && ms > BOOT_BUDGET_MS) ? " OVER BUDGET" : "");
+		break;
+	}
+	case TRACE_TWI_ERROR:
+		printf("status 0x%02X\n",arg);
+		break;
+	case TRACE_EEPROM_WRITE:
+	case TRACE_EEPROM_READ:
+		printf("address 0x%02X\n",arg);
+		break;
+	case TRACE_USERS_STORED:
+		printf("%s\n",(arg == 0) ? "user table valid" : "pages wrong ,user table not used");
+		break;
+	case TRACE_GATE_CONFIG:
+		printf("%s\n",arg ? "gate profile used" : "no valid gate profile ,defaults");
+		break;
+	case TRACE_STATE_LOST:
+		printf("%u reads failed ,locked out until the state is read\n",arg);
+		break;
+	default:
+		printf("%u\n",arg);
+		break;
+	}
+}